@@ -0,0 +1,82 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_EXAMPLES_ALLOC_COUNTER_H_
+#define _ID3LIB_EXAMPLES_ALLOC_COUNTER_H_
+
+// Replaces the global operator new and delete of the program to count the
+// memory allocations it makes, those of the library included.  Include it in
+// a single source file of the program.
+
+#include <stdlib.h>
+#include <new>
+
+namespace
+{
+  size_t allocations = 0;   // made through operator new so far
+};
+
+// gcc would inline the operators into their callers and then warn of the
+// pointers returned by new being passed to free (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+# define ALLOC_COUNTER_NOINLINE __attribute__((noinline))
+#else
+# define ALLOC_COUNTER_NOINLINE
+#endif
+
+#if __cplusplus >= 201103L
+ALLOC_COUNTER_NOINLINE void* operator new(size_t size)
+#else
+ALLOC_COUNTER_NOINLINE void* operator new(size_t size) throw (std::bad_alloc)
+#endif
+{
+  ++allocations;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+#if __cplusplus >= 201103L
+ALLOC_COUNTER_NOINLINE void operator delete(void* p) noexcept
+#else
+ALLOC_COUNTER_NOINLINE void operator delete(void* p) throw ()
+#endif
+{
+  free(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+ALLOC_COUNTER_NOINLINE void operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+#endif
+
+#endif /* _ID3LIB_EXAMPLES_ALLOC_COUNTER_H_ */
@@ -0,0 +1,310 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Measures how ID3_Batch scales with the number of threads, e.g.
+//   benchbatch -n 100000 -j 8 corpus
+// writes 100000 small tagged files to the directory corpus (unless they are
+// there already) and parses them all on 1, 2, 4 and 8 threads, delivering
+// the tags in completion order and in input order.  The results must be the
+// same for every run.  With -c cachedir the files are then parsed through an
+// ID3_ParseCache, once to fill it and once more to restore the tags from it.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+#if defined(HAVE_SYS_TYPES_H)
+# include <sys/types.h>
+#endif
+#if defined(HAVE_SYS_STAT_H)
+# include <sys/stat.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/batch.h"
+#include "id3/parse_cache.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  string audio()
+  {
+    // two frames of silence, mpeg 1 layer III, 128kbps, 44.1kHz
+    string frame(417, '\0');
+    frame[0] = '\xFF';
+    frame[1] = '\xFB';
+    frame[2] = '\x90';
+    return frame + frame;
+  }
+
+  string render(const ID3_Tag& tag, ID3_TagType type)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, type);
+    return os.str();
+  }
+
+  bool exists(const string& name)
+  {
+    ifstream file(name.c_str(), ios::in | ios::binary);
+    return file.is_open();
+  }
+
+  // every file gets an id3v2 tag with a handful of frames, every other one
+  // an id3v1 tag as well
+  bool generate(const string& dir, size_t count, vector<string>& paths)
+  {
+#if defined(HAVE_SYS_STAT_H)
+    mkdir(dir.c_str(), 0777);
+#endif
+    const string data = audio();
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      char name[32];
+      sprintf(name, "/%06lu.mp3", (unsigned long)i);
+      paths.push_back(dir + name);
+      if (exists(paths.back()))
+      {
+        continue;
+      }
+
+      char text[64];
+      ID3_Tag tag;
+      tag.SetPadding(false);
+      sprintf(text, "Title %lu", (unsigned long)i);
+      ID3_AddTitle(&tag, text);
+      sprintf(text, "Artist %lu", (unsigned long)(i % 97));
+      ID3_AddArtist(&tag, text);
+      sprintf(text, "Album %lu", (unsigned long)(i % 13));
+      ID3_AddAlbum(&tag, text);
+      ID3_AddTrack(&tag, (uchar)(i % 20 + 1), 20);
+      if (i % 3 == 0)
+      {
+        ID3_AddComment(&tag, "A comment", "");
+      }
+
+      ofstream file(paths.back().c_str(), ios::out | ios::binary | ios::trunc);
+      if (!file)
+      {
+        cerr << "can't write " << paths.back() << endl;
+        return false;
+      }
+      string v2 = render(tag, ID3TT_ID3V2);
+      file.write(v2.data(), v2.size());
+      file.write(data.data(), data.size());
+      if (i % 2 == 0)
+      {
+        string v1 = render(tag, ID3TT_ID3V1);
+        file.write(v1.data(), v1.size());
+      }
+      ++written;
+    }
+    if (written > 0)
+    {
+      cout << "wrote " << written << " files to " << dir << endl;
+    }
+    return true;
+  }
+
+  // adds up what was found, the same way whatever the order of the files
+  class Counter : public ID3_Batch::Handler
+  {
+  public:
+    Counter(bool inputOrder)
+      : _input_order(inputOrder), _count(0), _frames(0), _sum(0), _ordered(true)
+    { }
+
+    bool Handle(size_t index, const char* path, ID3_Tag& tag)
+    {
+      if (_input_order && index != _count)
+      {
+        _ordered = false;
+      }
+      ++_count;
+      _frames += tag.NumFrames();
+      _sum += (index + 1) * (tag.GetPrependedBytes() + 7 * tag.GetAppendedBytes() +
+                             31 * tag.NumFrames());
+      return true;
+    }
+
+    bool          _input_order;
+    size_t        _count;
+    size_t        _frames;
+    unsigned long _sum;
+    bool          _ordered;
+  };
+};
+
+int main(int argc, char *argv[])
+{
+  size_t count = 100000;
+  size_t maxthreads = ID3_Batch::NumProcessors();
+  const char* dir = "benchbatch-corpus";
+  const char* cachedir = NULL;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      count = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+    {
+      maxthreads = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+    {
+      cachedir = argv[++i];
+    }
+    else if (argv[i][0] != '-')
+    {
+      dir = argv[i];
+    }
+    else
+    {
+      cerr << "Usage: " << argv[0] << " [-n files] [-j threads] [-c cachedir] [directory]" << endl;
+      return 1;
+    }
+  }
+  if (count == 0 || maxthreads == 0)
+  {
+    cerr << "need at least one file and one thread" << endl;
+    return 1;
+  }
+
+  vector<string> names;
+  if (!generate(dir, count, names))
+  {
+    return 1;
+  }
+  vector<const char*> paths;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    paths.push_back(names[i].c_str());
+  }
+
+  vector<size_t> threads;
+  for (size_t n = 1; n < maxthreads; n *= 2)
+  {
+    threads.push_back(n);
+  }
+  threads.push_back(maxthreads);
+
+  ID3_Batch batch;
+  {
+    // read the files once so every run finds them in the cache
+    Counter warmup(false);
+    batch.Parse(&paths[0], paths.size(), warmup);
+  }
+
+  size_t failures = 0;
+  size_t frames = 0;
+  unsigned long sum = 0;
+  for (size_t order = 0; order < 2; ++order)
+  {
+    batch.SetInputOrder(order == 1);
+    cout << (order == 1 ? "input order:" : "completion order:") << endl;
+    double base = 0;
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+      batch.SetThreads(threads[i]);
+      Counter counter(batch.GetInputOrder());
+      double beg = now();
+      size_t delivered = batch.Parse(&paths[0], paths.size(), counter);
+      double seconds = now() - beg;
+      double rate = seconds > 0 ? delivered / seconds : 0;
+      if (base == 0)
+      {
+        base = rate;
+      }
+      if (frames == 0)
+      {
+        frames = counter._frames;
+        sum = counter._sum;
+      }
+
+      bool ok = delivered == paths.size() && counter._count == paths.size() &&
+                counter._frames == frames && counter._sum == sum && counter._ordered;
+      printf("%s %3lu threads: %8.0f files/s, %5.2fx, %lu frames\n",
+             ok ? "ok  " : "FAIL", (unsigned long)threads[i], rate,
+             base > 0 ? rate / base : 0.0, (unsigned long)counter._frames);
+      fflush(stdout);
+      if (!ok)
+      {
+        ++failures;
+      }
+    }
+  }
+
+  if (cachedir)
+  {
+#if defined(HAVE_SYS_STAT_H)
+    mkdir(cachedir, 0777);
+#endif
+    ID3_ParseCache cache(cachedir);
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+      cache.Invalidate(paths[i]);
+    }
+    batch.SetCache(&cache);
+    batch.SetThreads(maxthreads);
+    batch.SetInputOrder(false);
+    cout << "through the cache:" << endl;
+    const char* runs[] = { "filling", "restoring" };
+    for (size_t run = 0; run < 2; ++run)
+    {
+      Counter counter(false);
+      size_t hits = cache.GetHits();
+      double beg = now();
+      size_t delivered = batch.Parse(&paths[0], paths.size(), counter);
+      double seconds = now() - beg;
+      double rate = seconds > 0 ? delivered / seconds : 0;
+      hits = cache.GetHits() - hits;
+
+      bool ok = delivered == paths.size() && counter._frames == frames &&
+                counter._sum == sum && hits == (run == 0 ? 0 : paths.size());
+      printf("%s %-9s %3lu threads: %8.0f files/s, %lu hits\n",
+             ok ? "ok  " : "FAIL", runs[run], (unsigned long)maxthreads, rate,
+             (unsigned long)hits);
+      fflush(stdout);
+      if (!ok)
+      {
+        ++failures;
+      }
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Counts the memory allocations made while building tags in memory, e.g.
+//   benchbuild -n 5000
+// builds 5000 tags through the field setters and the ID3_Add* helpers, and
+// then hands each one off to a list of tags, once by copying it and once by
+// moving it where the compiler supports that.  The allocations of the
+// library are counted by replacing the global operator new.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#if __cplusplus >= 201103L
+# include <utility>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+#include "alloc_counter.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const size_t TEXTSIZE = 2048;
+
+  void build(ID3_Tag& tag, size_t i, const dami::String& notes)
+  {
+    char title[32];
+    sprintf(title, "Track %lu", (unsigned long)i);
+    ID3_AddTitle(&tag, title);
+    ID3_AddArtist(&tag, "The artist");
+    ID3_AddAlbum(&tag, "The album");
+    ID3_AddComment(&tag, notes.c_str(), "", "eng");
+    ID3_Frame* frame = new ID3_Frame(ID3FID_USERTEXT);
+    frame->GetField(ID3FN_DESCRIPTION)->Set("notes");
+    frame->GetField(ID3FN_TEXT)->SetText(dami::String(notes));
+    tag.AttachFrame(frame);
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t count = 5000;
+  if (argc > 2 && strcmp(argv[1], "-n") == 0)
+  {
+    count = atoi(argv[2]);
+  }
+  const dami::String notes(TEXTSIZE, 'n');
+
+  size_t failures = 0;
+  size_t before = allocations;
+  size_t built = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    ID3_Tag tag;
+    build(tag, i, notes);
+    built += tag.NumFrames();
+  }
+  size_t building = allocations - before;
+  failures += check(built == 5 * count, "tags built");
+
+  vector<ID3_Tag*> copies;
+  ID3_Tag tag;
+  build(tag, 0, notes);
+  before = allocations;
+  for (size_t i = 0; i < count; ++i)
+  {
+    copies.push_back(new ID3_Tag(tag));
+  }
+  size_t copying = allocations - before;
+  failures += check(copies.back()->NumFrames() == 5, "tags copied");
+
+  vector<ID3_Tag*> moved;
+  vector<ID3_Tag> built_tags(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    build(built_tags[i], i, notes);
+  }
+  before = allocations;
+  for (size_t i = 0; i < count; ++i)
+  {
+#if __cplusplus >= 201103L
+    moved.push_back(new ID3_Tag(std::move(built_tags[i])));
+#else
+    moved.push_back(new ID3_Tag(built_tags[i]));
+#endif
+  }
+  size_t moving = allocations - before;
+  failures += check(moved.back()->NumFrames() == 5, "tags handed off");
+
+  printf("%lu tags, allocations per tag:\n", (unsigned long)count);
+  printf("  build    %8.1f\n", (double)building / count);
+  printf("  copy     %8.1f\n", (double)copying / count);
+#if __cplusplus >= 201103L
+  printf("  move     %8.1f\n", (double)moving / count);
+#else
+  printf("  move     %8.1f (copied, no move support)\n", (double)moving / count);
+#endif
+
+#if __cplusplus >= 201103L
+  // what was moved from is left empty, and can be used again
+  ID3_Tag& left = built_tags[0];
+  failures += check(left.NumFrames() == 0 && left.Find(ID3FID_TITLE) == NULL,
+                    "moved-from tag left empty");
+  build(left, 0, notes);
+  failures += check(left.NumFrames() == 5, "moved-from tag rebuilt");
+
+  ID3_Frame frame(ID3FID_TITLE);
+  ID3_Frame taken(std::move(frame));
+  failures += check(frame.GetID() == ID3FID_NOFRAME && frame.NumFields() == 0 &&
+                    frame.SetID(ID3FID_ALBUM) && frame.GetField(ID3FN_TEXT) != NULL,
+                    "moved-from frame reusable");
+#endif
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    delete copies[i];
+    delete moved[i];
+  }
+  return failures == 0 ? 0 : 1;
+}
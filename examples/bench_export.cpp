@@ -0,0 +1,347 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Measures how fast ID3_Exporter writes the tags of many files, e.g.
+//   benchexport -n 20000 -j 4 corpus
+// writes 20000 small tagged files to the directory corpus (unless they are
+// there already), reads a few frames and properties of each file with
+// ID3_GetString() one file after the other, and then exports the same
+// columns on 1, 2, 4 threads.  Every export is read back and must hold the
+// same values.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+#if defined(HAVE_SYS_TYPES_H)
+# include <sys/types.h>
+#endif
+#if defined(HAVE_SYS_STAT_H)
+# include <sys/stat.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/exporter.h"
+#include "id3/batch.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* const NONE = "(none)";
+
+  const ID3_FrameID frameColumns[] =
+  {
+    ID3FID_TITLE, ID3FID_LEADARTIST, ID3FID_ALBUM, ID3FID_TRACKNUM, ID3FID_COMMENT
+  };
+  const size_t numFrameColumns = sizeof(frameColumns) / sizeof(frameColumns[0]);
+
+  string audio()
+  {
+    // two frames of silence, mpeg 1 layer III, 128kbps, 44.1kHz
+    string frame(417, '\0');
+    frame[0] = '\xFF';
+    frame[1] = '\xFB';
+    frame[2] = '\x90';
+    return frame + frame;
+  }
+
+  string render(const ID3_Tag& tag, ID3_TagType type)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, type);
+    return os.str();
+  }
+
+  bool exists(const string& name)
+  {
+    ifstream file(name.c_str(), ios::in | ios::binary);
+    return file.is_open();
+  }
+
+  string number(unsigned long val)
+  {
+    char text[32];
+    sprintf(text, "%lu", val);
+    return text;
+  }
+
+  bool generate(const string& dir, size_t count, vector<string>& paths)
+  {
+#if defined(HAVE_SYS_STAT_H)
+    mkdir(dir.c_str(), 0777);
+#endif
+    const string data = audio();
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      char name[32];
+      sprintf(name, "/%06lu.mp3", (unsigned long)i);
+      paths.push_back(dir + name);
+      if (exists(paths.back()))
+      {
+        continue;
+      }
+
+      ID3_Tag tag;
+      tag.SetPadding(false);
+      ID3_AddTitle(&tag, ("Title " + number(i)).c_str());
+      ID3_AddArtist(&tag, ("Artist " + number(i % 97)).c_str());
+      ID3_AddAlbum(&tag, ("Album " + number(i % 13)).c_str());
+      ID3_AddTrack(&tag, (uchar)(i % 20 + 1), 20);
+      if (i % 3 == 0)
+      {
+        ID3_AddComment(&tag, "A comment", "");
+      }
+
+      ofstream file(paths.back().c_str(), ios::out | ios::binary | ios::trunc);
+      if (!file)
+      {
+        cerr << "can't write " << paths.back() << endl;
+        return false;
+      }
+      string v2 = render(tag, ID3TT_ID3V2);
+      file.write(v2.data(), v2.size());
+      file.write(data.data(), data.size());
+      ++written;
+    }
+    if (written > 0)
+    {
+      cout << "wrote " << written << " files to " << dir << endl;
+    }
+    return true;
+  }
+
+  // the values the export should hold, one string per column: the file
+  // name, the frames above, the playing time and the bitrate
+  void readOneByOne(const vector<const char*>& paths, vector<vector<string> >& rows)
+  {
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+      ID3_Tag tag(paths[i]);
+      vector<string> row;
+      row.push_back(paths[i]);
+      for (size_t c = 0; c < numFrameColumns; ++c)
+      {
+        char* text = ID3_GetString(tag.Find(frameColumns[c]), ID3FN_TEXT);
+        row.push_back(text ? text : NONE);
+        ID3_FreeString(text);
+      }
+      const Mp3_Headerinfo* info = tag.GetMp3HeaderInfo();
+      row.push_back(number(info ? info->time : 0));
+      row.push_back(number(info ? info->bitrate : 0));
+      rows.push_back(row);
+    }
+  }
+
+  uint32 getNumber(const string& data, size_t pos)
+  {
+    if (pos + 4 > data.size())
+    {
+      return 0;
+    }
+    const uchar* p = reinterpret_cast<const uchar*>(data.data()) + pos;
+    return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+  }
+
+  // reads the rows of an exported file back, see ID3_Exporter for the layout
+  bool readExport(const string& data, vector<vector<string> >& rows, size_t& groups)
+  {
+    if (data.size() < 28 || data.compare(0, 4, "ID3X") != 0 ||
+        data.compare(data.size() - 4, 4, "ID3X") != 0 || getNumber(data, 4) != 1)
+    {
+      return false;
+    }
+    const size_t numColumns = getNumber(data, 8);
+    vector<uint32> types;
+    for (size_t c = 0; c < numColumns; ++c)
+    {
+      types.push_back(getNumber(data, 16 + c * 24 + 4));
+    }
+    size_t footer = getNumber(data, data.size() - 12);
+    groups = getNumber(data, footer);
+    for (size_t g = 0; g < groups; ++g)
+    {
+      size_t pos = getNumber(data, footer + 4 + g * 12);
+      const size_t numRows = getNumber(data, footer + 4 + g * 12 + 8);
+      if (getNumber(data, pos) != numRows)
+      {
+        return false;
+      }
+      pos += 4;
+      const size_t first = rows.size();
+      rows.resize(first + numRows);
+      for (size_t c = 0; c < numColumns; ++c)
+      {
+        vector<string> strings;
+        if (types[c] == 1)
+        {
+          const size_t numStrings = getNumber(data, pos);
+          const size_t poolSize = getNumber(data, pos + 4);
+          const size_t pool = pos + 8 + (numStrings + 1) * 4;
+          for (size_t s = 0; s < numStrings; ++s)
+          {
+            const size_t beg = getNumber(data, pos + 8 + s * 4);
+            const size_t end = getNumber(data, pos + 12 + s * 4);
+            strings.push_back(data.substr(pool + beg, end - beg));
+          }
+          pos = pool + (poolSize + 3) / 4 * 4;
+        }
+        for (size_t r = 0; r < numRows; ++r, pos += 4)
+        {
+          const uint32 val = getNumber(data, pos);
+          if (types[c] != 1)
+          {
+            rows[first + r].push_back(number(val));
+          }
+          else if (val == 0 || val > strings.size())
+          {
+            rows[first + r].push_back(NONE);
+          }
+          else
+          {
+            rows[first + r].push_back(strings[val - 1]);
+          }
+        }
+      }
+    }
+    return rows.size() == getNumber(data, footer + 4 + groups * 12);
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t count = 20000;
+  size_t maxthreads = ID3_Batch::NumProcessors();
+  size_t groupSize = 4096;
+  const char* dir = "benchexport-corpus";
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      count = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+    {
+      maxthreads = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+    {
+      groupSize = atoi(argv[++i]);
+    }
+    else if (argv[i][0] != '-')
+    {
+      dir = argv[i];
+    }
+    else
+    {
+      cerr << "Usage: " << argv[0] << " [-n files] [-j threads] [-g rows] [directory]" << endl;
+      return 1;
+    }
+  }
+  if (count == 0 || maxthreads == 0)
+  {
+    cerr << "need at least one file and one thread" << endl;
+    return 1;
+  }
+
+  vector<string> names;
+  if (!generate(dir, count, names))
+  {
+    return 1;
+  }
+  vector<const char*> paths;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    paths.push_back(names[i].c_str());
+  }
+
+  // read the files once so every run finds them in the cache
+  vector<vector<string> > expected;
+  readOneByOne(paths, expected);
+
+  expected.clear();
+  double beg = now();
+  readOneByOne(paths, expected);
+  double seconds = now() - beg;
+  printf("ok   ID3_GetString   1 thread:  %8.0f rows/s\n",
+         seconds > 0 ? paths.size() / seconds : 0.0);
+  fflush(stdout);
+
+  ID3_Exporter exporter;
+  exporter.AddColumn(ID3_Exporter::FILENAME);
+  for (size_t c = 0; c < numFrameColumns; ++c)
+  {
+    exporter.AddColumn(frameColumns[c]);
+  }
+  exporter.AddColumn(ID3_Exporter::SECONDS);
+  exporter.AddColumn(ID3_Exporter::BITRATE);
+  exporter.SetRowGroupSize(groupSize);
+
+  vector<size_t> threads;
+  for (size_t n = 1; n < maxthreads; n *= 2)
+  {
+    threads.push_back(n);
+  }
+  threads.push_back(maxthreads);
+
+  size_t failures = 0;
+  for (size_t i = 0; i < threads.size(); ++i)
+  {
+    exporter.SetThreads(threads[i]);
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    beg = now();
+    size_t rows = exporter.Export(&paths[0], paths.size(), writer);
+    seconds = now() - beg;
+
+    const string data = os.str();
+    vector<vector<string> > exported;
+    size_t groups = 0;
+    bool ok = rows == paths.size() && readExport(data, exported, groups) &&
+              exported == expected;
+    printf("%s ID3_Exporter %3lu threads: %8.0f rows/s, %lu row groups, %.1f bytes/row\n",
+           ok ? "ok  " : "FAIL", (unsigned long)threads[i],
+           seconds > 0 ? rows / seconds : 0.0, (unsigned long)groups,
+           rows > 0 ? (double)data.size() / rows : 0.0);
+    fflush(stdout);
+    if (!ok)
+    {
+      ++failures;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
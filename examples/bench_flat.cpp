@@ -0,0 +1,261 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Compares the flat form of a tag with a rendered id3v2 tag, e.g.
+//   benchflat -n 20000
+// builds 20000 tags in memory and times turning them into bytes and back,
+// once by rendering and parsing and once by ID3_Tag::Serialize() and
+// ID3_Tag::Deserialize(), and then the lookup of the title straight from the
+// flat data with an ID3_TagView.  Every tag must come back the way it was.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/tag_view.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  string render(const ID3_Tag& tag)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+    return os.str();
+  }
+
+  string serialize(const ID3_Tag& tag)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Serialize(writer);
+    return os.str();
+  }
+
+  const uchar* bytes(const string& data)
+  {
+    return reinterpret_cast<const uchar*>(data.data());
+  }
+
+  // a handful of text frames, a comment on every third tag and a small
+  // picture on every tenth
+  void generate(size_t count, vector<ID3_Tag*>& tags, vector<string>& titles)
+  {
+    const string picture(4096, '\x5A');
+    for (size_t i = 0; i < count; ++i)
+    {
+      char text[64];
+      ID3_Tag* tag = new ID3_Tag;
+      tag->SetPadding(false);
+      sprintf(text, "Title %lu", (unsigned long)i);
+      titles.push_back(text);
+      ID3_AddTitle(tag, text);
+      sprintf(text, "Artist %lu", (unsigned long)(i % 97));
+      ID3_AddArtist(tag, text);
+      sprintf(text, "Album %lu", (unsigned long)(i % 13));
+      ID3_AddAlbum(tag, text);
+      ID3_AddTrack(tag, (uchar)(i % 20 + 1), 20);
+      if (i % 3 == 0)
+      {
+        ID3_AddComment(tag, "A comment", "");
+      }
+      if (i % 10 == 0)
+      {
+        ID3_Frame* frame = new ID3_Frame(ID3FID_PICTURE);
+        frame->GetField(ID3FN_MIMETYPE)->Set("image/png");
+        frame->GetField(ID3FN_PICTURETYPE)->Set(ID3PT_COVERFRONT);
+        frame->GetField(ID3FN_DATA)->Set(bytes(picture), picture.size());
+        tag->AttachFrame(frame);
+      }
+      tags.push_back(tag);
+    }
+  }
+
+  void report(bool ok, const char* what, size_t count, double seconds, size_t size)
+  {
+    printf("%s %-22s %9.0f tags/s, %6.1f bytes/tag\n", ok ? "ok  " : "FAIL",
+           what, seconds > 0 ? count / seconds : 0.0,
+           count > 0 ? (double)size / count : 0.0);
+    fflush(stdout);
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t count = 20000;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      count = atoi(argv[++i]);
+    }
+    else
+    {
+      cerr << "Usage: " << argv[0] << " [-n tags]" << endl;
+      return 1;
+    }
+  }
+
+  vector<ID3_Tag*> tags;
+  vector<string> titles;
+  generate(count, tags, titles);
+  vector<string> expected;
+  for (size_t i = 0; i < count; ++i)
+  {
+    expected.push_back(render(*tags[i]));
+  }
+
+  size_t failures = 0;
+  vector<string> rendered(count), flat(count);
+  {
+    bool ok = true;
+    size_t size = 0;
+    double beg = now();
+    for (size_t i = 0; i < count; ++i)
+    {
+      rendered[i] = render(*tags[i]);
+      ID3_Tag copy;
+      copy.Parse(bytes(rendered[i]), rendered[i].size());
+      size += rendered[i].size();
+      if (copy.NumFrames() != tags[i]->NumFrames())
+      {
+        ok = false;
+      }
+    }
+    report(ok, "render + parse", count, now() - beg, size);
+    failures += ok ? 0 : 1;
+  }
+  {
+    bool ok = true;
+    size_t size = 0;
+    double beg = now();
+    for (size_t i = 0; i < count; ++i)
+    {
+      flat[i] = serialize(*tags[i]);
+      ID3_Tag copy;
+      copy.Deserialize(bytes(flat[i]), flat[i].size());
+      size += flat[i].size();
+      if (copy.NumFrames() != tags[i]->NumFrames())
+      {
+        ok = false;
+      }
+    }
+    report(ok, "serialize + deserialize", count, now() - beg, size);
+    failures += ok ? 0 : 1;
+  }
+  for (size_t run = 0; run < 2; ++run)
+  {
+    bool ok = true;
+    size_t size = 0;
+    double beg = now();
+    for (size_t i = 0; i < count; ++i)
+    {
+      ID3_Tag copy;
+      if (run == 0)
+      {
+        copy.Parse(bytes(rendered[i]), rendered[i].size());
+        size += rendered[i].size();
+      }
+      else
+      {
+        ok = copy.Deserialize(bytes(flat[i]), flat[i].size()) && ok;
+        size += flat[i].size();
+      }
+    }
+    double seconds = now() - beg;
+
+    // and once more to check the copies, off the clock
+    for (size_t i = 0; ok && i < count; ++i)
+    {
+      ID3_Tag copy;
+      if (run == 0)
+      {
+        copy.Parse(bytes(rendered[i]), rendered[i].size());
+      }
+      else
+      {
+        copy.Deserialize(bytes(flat[i]), flat[i].size());
+      }
+      ok = render(copy) == expected[i];
+    }
+    report(ok, run == 0 ? "parse" : "deserialize", count, seconds, size);
+    failures += ok ? 0 : 1;
+  }
+  {
+    bool ok = true;
+    size_t size = 0;
+    double beg = now();
+    for (size_t i = 0; i < count; ++i)
+    {
+      ID3_TagView view(bytes(flat[i]), flat[i].size());
+      size_t frame = view.Find(ID3FID_TITLE);
+      const char* title = view.GetText(frame, ID3FN_TEXT);
+      size += flat[i].size();
+      ok = ok && view.IsValid() && title != NULL && titles[i] == title &&
+           strcmp(view.GetTextID(frame), "TIT2") == 0;
+    }
+    report(ok, "view title lookup", count, now() - beg, size);
+    failures += ok ? 0 : 1;
+  }
+  {
+    // damaged data must be refused, not read
+    bool ok = true;
+    if (count > 0)
+    {
+      string damaged = flat[0];
+      ID3_TagView view(bytes(damaged), damaged.size() - 1);
+      ID3_Tag copy;
+      ok = !view.IsValid() && view.NumFrames() == 0 &&
+           view.GetText(0, ID3FN_TEXT) == NULL &&
+           !copy.Deserialize(bytes(damaged), damaged.size() - 1);
+      damaged[4] = 'x';
+      ok = ok && !view.Set(bytes(damaged), damaged.size()) &&
+           !copy.Deserialize(bytes(damaged), damaged.size()) &&
+           copy.NumFrames() == 0;
+    }
+    printf("%s damaged data refused\n", ok ? "ok  " : "FAIL");
+    failures += ok ? 0 : 1;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    delete tags[i];
+  }
+  return failures == 0 ? 0 : 1;
+}
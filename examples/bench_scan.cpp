@@ -0,0 +1,90 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Measures the throughput of ID3_Tag::ScanMp3Frames(), e.g.
+//   benchscan $(srcdir)/*.mp3
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+
+using namespace std;
+
+int main( int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    cerr << "Usage: " << argv[0] << " file.mp3 [file.mp3 ...]" << endl;
+    return 1;
+  }
+
+  const double MINSECONDS = 0.5;
+  double totalbytes = 0, totalseconds = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    ID3_Tag tag;
+    tag.Link(argv[i], ID3TT_ALL);
+    const Mp3_Scaninfo* info = tag.ScanMp3Frames();
+    if (info == NULL)
+    {
+      cout << argv[i] << ": no mpeg frames found" << endl;
+      continue;
+    }
+    cout << argv[i] << ": " << info->frames << " frames, "
+         << info->time << " ms, " << info->bitrate / 1000 << " kbps "
+         << (info->vbr ? "vbr" : "cbr") << ", " << info->resyncs
+         << " resyncs, " << info->skipped << " bytes skipped, "
+         << info->crcerrors << "/" << info->crcframes << " crc errors" << endl;
+
+    // repeat the scan until the time spent is measurable
+    size_t runs = 0;
+    clock_t beg = clock();
+    double seconds = 0;
+    do
+    {
+      tag.ScanMp3Frames();
+      ++runs;
+      seconds = (double)(clock() - beg) / CLOCKS_PER_SEC;
+    } while (seconds < MINSECONDS);
+
+    double bytes = (double)tag.GetMp3HeaderInfo()->datasize * runs;
+    cout << "  " << runs << " scans, " << bytes / seconds / 1e6 << " MB/s" << endl;
+    totalbytes += bytes;
+    totalseconds += seconds;
+  }
+
+  if (totalseconds > 0)
+  {
+    cout << "total: " << totalbytes / totalseconds / 1e9 << " GB/s" << endl;
+  }
+
+  return 0;
+}
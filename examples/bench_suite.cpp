@@ -0,0 +1,589 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// The benchmark suite run by "make bench", e.g.
+//   benchsuite -r 5 -f parse
+// runs every benchmark whose name contains "parse" 5 times and prints the
+// best run of each as a tab separated line:
+//   name  ops  ns/op  MB/s  allocs/op
+// Lines starting with '#' are comments.  The input tags are synthetic and
+// depend on nothing but the program, so two runs on the same machine measure
+// the same work, and the output of two builds can be compared line by line.
+// A benchmark whose result is wrong is reported as FAIL and makes the program
+// exit with 1.  Each file named on the command line, such as the ones id3synth
+// writes, adds a benchmark parse_file:<file> that parses all its tags from
+// memory.
+//
+// Options:
+//   -n <scale>   multiply the number of operations of every benchmark
+//   -r <runs>    runs of each benchmark, the fastest is reported (3)
+//   -f <text>    run only the benchmarks whose name contains text
+//   -l           list the benchmarks and exit
+//   file...      files to parse
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+#include "id3/readers.h"
+#include "id3/writers.h"
+#include "synth_tags.h"
+#include "alloc_counter.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* FILENAME = "bench-suite.mp3";
+
+  // adds up the time and allocations between Start() and Stop(), so that
+  // preparing each operation can be left out
+  class Timer
+  {
+  public:
+    Timer() : _secs(0), _allocs(0), _beg(0), _allocsBeg(0) { }
+    void   Start() { _allocsBeg = allocations; _beg = now(); }
+    void   Stop()
+    {
+      _secs += now() - _beg;
+      _allocs += allocations - _allocsBeg;
+    }
+    double Seconds() const { return _secs; }
+    size_t Allocations() const { return _allocs; }
+  private:
+    double _secs;
+    size_t _allocs;
+    double _beg;
+    size_t _allocsBeg;
+  };
+
+  // the inputs, built once
+  string v2plain;       // rendered id3v2 tag with text, lyrics and a picture
+  string v2unsync;      // the same, unsynchronized
+  string v2compressed;  // the same, every frame compressed
+  string v1file;        // audio and an id3v1 tag
+  string lyrics3file;   // audio, a Lyrics3 v2.00 tag and an id3v1 tag
+  string mmfile;        // audio, a MusicMatch tag and an id3v1 tag
+  string mp3file;       // a padded id3v2 tag, audio and an id3v1 tag
+  ID3_Tag source;       // the tag that was rendered for v2plain
+  ID3_Tag manyFrames;   // 50 frames, the title last
+  size_t  numFrames = 0;
+  string  input;        // the contents of a file named on the command line
+
+  const uchar* bytes(const string& data)
+  {
+    return reinterpret_cast<const uchar*>(data.data());
+  }
+
+  string render(const ID3_Tag& tag, ID3_TagType type = ID3TT_ID3V2)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, type);
+    return os.str();
+  }
+
+  void addText(ID3_Tag& tag, ID3_FrameID id, const string& text, bool compress)
+  {
+    ID3_Frame* frame = new ID3_Frame(id);
+    frame->GetField(ID3FN_TEXT)->Set(text.c_str());
+    frame->SetCompression(compress);
+    tag.AttachFrame(frame);
+  }
+
+  void build(ID3_Tag& tag, bool compress, bool unsyncable)
+  {
+    synth::Random rnd(1);
+    tag.SetPadding(false);
+    addText(tag, ID3FID_TITLE, "A synthetic title", compress);
+    addText(tag, ID3FID_LEADARTIST, "A synthetic artist", compress);
+    addText(tag, ID3FID_ALBUM, "A synthetic album", compress);
+    addText(tag, ID3FID_TRACKNUM, "3/12", compress);
+    addText(tag, ID3FID_YEAR, "2002", compress);
+    addText(tag, ID3FID_CONTENTTYPE, "(17)", compress);
+    for (size_t i = 0; i < 3; ++i)
+    {
+      ID3_Frame* frame = new ID3_Frame(ID3FID_COMMENT);
+      char desc[16];
+      sprintf(desc, "comment %lu", (unsigned long)i);
+      frame->GetField(ID3FN_DESCRIPTION)->Set(desc);
+      frame->GetField(ID3FN_LANGUAGE)->Set("eng");
+      frame->GetField(ID3FN_TEXT)->Set(synth::text(200, rnd).c_str());
+      frame->SetCompression(compress);
+      tag.AttachFrame(frame);
+    }
+    ID3_Frame* frame = new ID3_Frame(ID3FID_UNSYNCEDLYRICS);
+    frame->GetField(ID3FN_LANGUAGE)->Set("eng");
+    frame->GetField(ID3FN_TEXT)->Set(synth::text(2048, rnd).c_str());
+    frame->SetCompression(compress);
+    tag.AttachFrame(frame);
+
+    // a picture of noise; the unsynchronized one has a false sync in every
+    // 4 bytes
+    string picture(16 * 1024, '\0');
+    for (size_t i = 0; i < picture.size(); ++i)
+    {
+      picture[i] = (char)rnd.Next(256);
+      if (unsyncable && i % 4 == 0)
+      {
+        picture[i] = (char)0xFF;
+      }
+      else if (unsyncable && i % 4 == 1)
+      {
+        picture[i] = (char)(0xE0 | rnd.Next(32));
+      }
+    }
+    frame = new ID3_Frame(ID3FID_PICTURE);
+    frame->GetField(ID3FN_MIMETYPE)->Set("image/jpeg");
+    frame->GetField(ID3FN_PICTURETYPE)->Set(ID3PT_COVERFRONT);
+    frame->GetField(ID3FN_DATA)->Set(bytes(picture), picture.size());
+    frame->SetCompression(compress);
+    tag.AttachFrame(frame);
+  }
+
+  void prepare()
+  {
+    synth::Random rnd(2);
+    const string audio = synth::mpegFrames(8, rnd);
+
+    build(source, false, false);
+    numFrames = source.NumFrames();
+    v2plain = render(source);
+
+    ID3_Tag unsync;
+    build(unsync, false, true);
+    unsync.SetUnsync(true);
+    v2unsync = render(unsync);
+
+    ID3_Tag compressed;
+    build(compressed, true, false);
+    v2compressed = render(compressed);
+
+    ID3_Tag v1;
+    ID3_AddTitle(&v1, "A synthetic title");
+    ID3_AddArtist(&v1, "A synthetic artist");
+    ID3_AddAlbum(&v1, "A synthetic album");
+    ID3_AddYear(&v1, "2002");
+    ID3_AddTrack(&v1, 3);
+    const string v1tag = render(v1, ID3TT_ID3V1);
+
+    v1file = audio + v1tag;
+    lyrics3file = audio + synth::lyrics3v2("A synthetic title",
+                                           synth::text(2048, rnd)) + v1tag;
+    string image(4096, '\0');
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+      image[i] = (char)rnd.Next(256);
+    }
+    mmfile = audio + synth::musicMatch("A synthetic title", "A synthetic artist",
+                                       "A synthetic album", image) + v1tag;
+
+    ID3_Tag padded(source);
+    padded.SetPadding(true);
+    mp3file = render(padded) + synth::mpegFrames(200, rnd) + v1tag;
+
+    for (size_t i = 0; i < 49; ++i)
+    {
+      ID3_Frame* frame = new ID3_Frame(ID3FID_USERTEXT);
+      char desc[16];
+      sprintf(desc, "user %lu", (unsigned long)i);
+      frame->GetField(ID3FN_DESCRIPTION)->Set(desc);
+      frame->GetField(ID3FN_TEXT)->Set("some text");
+      manyFrames.AttachFrame(frame);
+    }
+    ID3_AddTitle(&manyFrames, "The last frame");
+  }
+
+  void writeFile(const string& data)
+  {
+    ofstream file(FILENAME, ios::out | ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  size_t fileSize()
+  {
+    ifstream file(FILENAME, ios::in | ios::binary);
+    file.seekg(0, ios::end);
+    return (size_t)file.tellg();
+  }
+
+  // every benchmark runs ops operations, timing only what it measures, and
+  // returns whether the results were right
+  typedef bool (*Run)(Timer&, size_t ops);
+
+  bool parseHeader(Timer& t, size_t ops)
+  {
+    size_t sum = 0;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      sum += ID3_Tag::IsV2Tag(bytes(v2plain));
+    }
+    t.Stop();
+    return sum == ops * v2plain.size();
+  }
+
+  bool parseV2(Timer& t, size_t ops, const string& data)
+  {
+    bool ok = true;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      ID3_Tag tag;
+      tag.Parse(bytes(data), data.size());
+      ok = ok && tag.NumFrames() == numFrames;
+    }
+    t.Stop();
+    return ok;
+  }
+
+  bool parsePlain(Timer& t, size_t ops)      { return parseV2(t, ops, v2plain); }
+  bool parseUnsync(Timer& t, size_t ops)     { return parseV2(t, ops, v2unsync); }
+  bool parseCompressed(Timer& t, size_t ops) { return parseV2(t, ops, v2compressed); }
+
+  bool parseAppended(Timer& t, size_t ops, const string& data, flags_t type)
+  {
+    bool ok = true;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      ID3_Tag tag;
+      ID3_MemoryReader reader(data.data(), data.size());
+      tag.Link(reader, type | ID3TT_ID3V1);
+      ok = ok && tag.HasTagType((ID3_TagType)type) && tag.Find(ID3FID_TITLE) != NULL;
+    }
+    t.Stop();
+    return ok;
+  }
+
+  bool parseV1(Timer& t, size_t ops)         { return parseAppended(t, ops, v1file, ID3TT_ID3V1); }
+  bool parseLyrics3(Timer& t, size_t ops)    { return parseAppended(t, ops, lyrics3file, ID3TT_LYRICS3V2); }
+  bool parseMusicMatch(Timer& t, size_t ops) { return parseAppended(t, ops, mmfile, ID3TT_MUSICMATCH); }
+
+  bool parseFile(Timer& t, size_t ops)
+  {
+    ID3_Tag first;
+    ID3_MemoryReader reader(input.data(), input.size());
+    first.Link(reader, ID3TT_ALL);
+    bool ok = true;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      ID3_Tag tag;
+      ID3_MemoryReader reader(input.data(), input.size());
+      tag.Link(reader, ID3TT_ALL);
+      ok = ok && tag.NumFrames() == first.NumFrames() &&
+        tag.GetPrependedBytes() == first.GetPrependedBytes();
+    }
+    t.Stop();
+    return ok;
+  }
+
+  bool renderFrame(Timer& t, size_t ops)
+  {
+    const ID3_Frame* frame = source.Find(ID3FID_UNSYNCEDLYRICS);
+    static uchar buf[64 * 1024];
+    size_t size = 0;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      ID3_MemoryWriter writer(buf, sizeof(buf));
+      frame->Render(writer);
+      size += writer.getCur() - writer.getBeg();
+    }
+    t.Stop();
+    return size > 2048 * ops;
+  }
+
+  bool renderTag(Timer& t, size_t ops)
+  {
+    static uchar buf[64 * 1024];
+    bool ok = true;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      ok = ok && source.Render(buf, ID3TT_ID3V2) == v2plain.size();
+    }
+    t.Stop();
+    return ok && memcmp(buf, v2plain.data(), v2plain.size()) == 0;
+  }
+
+  bool updateInPlace(Timer& t, size_t ops)
+  {
+    writeFile(mp3file);
+    ID3_Tag tag(FILENAME);
+    for (size_t i = 0; i < ops; ++i)
+    {
+      char title[32];
+      sprintf(title, "Title %06lu", (unsigned long)i);
+      ID3_AddTitle(&tag, title, true);
+      t.Start();
+      tag.Update(ID3TT_ID3V2);
+      t.Stop();
+    }
+    return fileSize() == mp3file.size();
+  }
+
+  bool updateGrowing(Timer& t, size_t ops)
+  {
+    const string big(32 * 1024, 'x');
+    bool ok = true;
+    for (size_t i = 0; i < ops; ++i)
+    {
+      writeFile(mp3file);
+      ID3_Tag tag(FILENAME);
+      ID3_AddLyrics(&tag, big.c_str(), "more", true);
+      size_t before = tag.GetPrependedBytes();
+      t.Start();
+      tag.Update(ID3TT_ID3V2);
+      t.Stop();
+      ok = ok && tag.GetPrependedBytes() > before + big.size() / 2;
+    }
+    return ok && fileSize() > mp3file.size() + big.size() / 2;
+  }
+
+  bool strip(Timer& t, size_t ops)
+  {
+    bool ok = true;
+    for (size_t i = 0; i < ops; ++i)
+    {
+      writeFile(mp3file);
+      ID3_Tag tag(FILENAME);
+      t.Start();
+      tag.Strip(ID3TT_ALL);
+      t.Stop();
+      ok = ok && tag.GetPrependedBytes() == 0 && tag.GetAppendedBytes() == 0;
+    }
+    return ok;
+  }
+
+  bool findByID(Timer& t, size_t ops)
+  {
+    const ID3_Tag& tag = manyFrames;
+    size_t found = 0;
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      found += tag.Find(ID3FID_TITLE) != NULL;
+    }
+    t.Stop();
+    return found == ops;
+  }
+
+  bool convertText(Timer& t, size_t ops)
+  {
+    synth::Random rnd(3);
+    ID3_Frame frame(ID3FID_COMMENT);
+    ID3_Field* fld = frame.GetField(ID3FN_TEXT);
+    const string text = synth::text(1024, rnd);
+    fld->Set(text.c_str());
+    t.Start();
+    for (size_t i = 0; i < ops; ++i)
+    {
+      fld->SetEncoding(ID3TE_UTF16);
+      fld->SetEncoding(ID3TE_ISO8859_1);
+    }
+    t.Stop();
+    return fld->GetRawText() && text == fld->GetRawText();
+  }
+
+  struct Benchmark
+  {
+    const char* name;
+    Run         run;
+    size_t      ops;    // before scaling
+    size_t      bytes;  // per operation, for MB/s
+  };
+
+  Benchmark benchmarks[] =
+  {
+    { "parse_header",         parseHeader,     200000, 10 },
+    { "parse_v2_plain",       parsePlain,      2000,   0 },
+    { "parse_v2_unsync",      parseUnsync,     1000,   0 },
+    { "parse_v2_compressed",  parseCompressed, 1000,   0 },
+    { "parse_v1",             parseV1,         5000,   0 },
+    { "parse_lyrics3",        parseLyrics3,    2000,   0 },
+    { "parse_musicmatch",     parseMusicMatch, 2000,   0 },
+    { "render_frame",         renderFrame,     20000,  0 },
+    { "render_tag",           renderTag,       2000,   0 },
+    { "update_in_place",      updateInPlace,   200,    0 },
+    { "update_growing",       updateGrowing,   50,     0 },
+    { "strip",                strip,           100,    0 },
+    { "find_by_id",           findByID,        200000, 0 },
+    { "convert_text",         convertText,     5000,   2048 }
+  };
+  const size_t NUMBENCHMARKS = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+  // the input sizes are known only once they are built
+  void setBytes()
+  {
+    for (size_t i = 0; i < NUMBENCHMARKS; ++i)
+    {
+      Benchmark& b = benchmarks[i];
+      if (b.run == parsePlain || b.run == renderTag)  b.bytes = v2plain.size();
+      if (b.run == parseUnsync)                       b.bytes = v2unsync.size();
+      if (b.run == parseCompressed)                   b.bytes = v2compressed.size();
+      if (b.run == parseV1)                           b.bytes = v1file.size();
+      if (b.run == parseLyrics3)                      b.bytes = lyrics3file.size();
+      if (b.run == parseMusicMatch)                   b.bytes = mmfile.size();
+      if (b.run == renderFrame)                       b.bytes = 2048;
+      if (b.run == updateInPlace || b.run == strip)   b.bytes = mp3file.size();
+      if (b.run == updateGrowing)                     b.bytes = mp3file.size() + 32 * 1024;
+    }
+  }
+
+  // runs a benchmark and prints its line, returns 1 if it failed
+  int measure(const Benchmark& bench, double scale, size_t runs)
+  {
+    size_t ops = (size_t)(bench.ops * scale);
+    if (ops == 0)
+    {
+      ops = 1;
+    }
+    bool ok = true;
+    double best = 0;
+    size_t allocs = 0;
+    for (size_t r = 0; r < runs; ++r)
+    {
+      Timer timer;
+      ok = bench.run(timer, ops) && ok;
+      if (r == 0 || timer.Seconds() < best)
+      {
+        best = timer.Seconds();
+        allocs = timer.Allocations();
+      }
+    }
+    if (!ok)
+    {
+      printf("# FAIL %s\n", bench.name);
+      return 1;
+    }
+    double nsPerOp = best * 1e9 / ops;
+    double mbPerSec = best > 0 ? (double)bench.bytes * ops / best / 1e6 : 0.0;
+    printf("%s\t%lu\t%.1f\t%.2f\t%.1f\n", bench.name, (unsigned long)ops,
+           nsPerOp, mbPerSec, (double)allocs / ops);
+    fflush(stdout);
+    return 0;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  double scale = 1.0;
+  size_t runs = 3;
+  const char* filter = NULL;
+  vector<string> files;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      scale = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+    {
+      runs = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+    {
+      filter = argv[++i];
+    }
+    else if (strcmp(argv[i], "-l") == 0)
+    {
+      for (size_t b = 0; b < NUMBENCHMARKS; ++b)
+      {
+        printf("%s\n", benchmarks[b].name);
+      }
+      return 0;
+    }
+    else if (argv[i][0] != '-')
+    {
+      files.push_back(argv[i]);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [-n scale] [-r runs] [-f text] [-l] [file...]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (runs == 0)
+  {
+    runs = 1;
+  }
+
+  prepare();
+  setBytes();
+
+  printf("# %s, %lu runs, scale %g\n", ID3LIB_FULL_NAME, (unsigned long)runs, scale);
+  printf("# name\tops\tns/op\tMB/s\tallocs/op\n");
+  fflush(stdout);
+  int result = 0;
+  for (size_t b = 0; b < NUMBENCHMARKS; ++b)
+  {
+    if (filter && strstr(benchmarks[b].name, filter) == NULL)
+    {
+      continue;
+    }
+    result |= measure(benchmarks[b], scale, runs);
+  }
+
+  for (size_t f = 0; f < files.size(); ++f)
+  {
+    const string name = "parse_file:" + files[f];
+    if (filter && strstr(name.c_str(), filter) == NULL)
+    {
+      continue;
+    }
+    ifstream file(files[f].c_str(), ios::in | ios::binary);
+    if (!file)
+    {
+      printf("# FAIL %s: can't read the file\n", name.c_str());
+      result = 1;
+      continue;
+    }
+    ostringstream data;
+    data << file.rdbuf();
+    input = data.str();
+    // about 50 MB parsed in every run
+    Benchmark bench = { name.c_str(), parseFile, 0, input.size() };
+    bench.ops = input.empty() ? 1 : 50 * 1000 * 1000 / input.size();
+    bench.ops = bench.ops < 1 ? 1 : bench.ops > 2000 ? 2000 : bench.ops;
+    result |= measure(bench, scale, runs);
+  }
+  remove(FILENAME);
+
+  return result;
+}
@@ -29,9 +29,11 @@
 #endif
 
 #include <string.h>
+#include <vector>
 #include "id3/id3lib_streams.h"
-#include "id3/tag.h"
+#include "id3/batch.h"
 #include "demo_convert_options.h"
+#include "demo_update.h"
 
 using std::cout;
 using std::endl;
@@ -76,25 +78,67 @@ void PrintVersion(const char *sName)
   cout << "tags to ID3v2 tags." << endl << endl;
 }
 
-void DisplayTags(ostream &os, luint nTags)
+// Strips or updates the tags of each file on the parsing threads, then
+// reports the results in the order the files were given.
+class Converter : public ID3_Batch::Handler
 {
-  if (!((nTags & ID3TT_ID3V1) || (nTags & ID3TT_ID3V2)))
-  {
-    os << "no tag";
-  }
-  if (nTags & ID3TT_ID3V1)
-  {
-    os << "v1";
-  }
-  if ((nTags & ID3TT_ID3V1) && (nTags & ID3TT_ID3V2))
+public:
+  Converter(const gengetopt_args_info& args, flags_t tags)
+    : _args(args), _tags(tags), _results(args.inputs_num)
+  { }
+
+  void Process(size_t index, const char* filename, ID3_Tag& tag)
   {
-    os << " and ";
+    UpdateResult& result = _results[index];
+    const size_t prepended = tag.GetPrependedBytes();
+    const size_t fileSize = tag.GetFileSize();
+    tag.GetLastError();  // resets the error left by parsing the file
+    tag.SetPadding(_args.padding_flag);
+
+    if (_args.strip_flag)
+    {
+      result.tags = tag.Strip(_tags);
+      // stripping the id3v2 tag moves the rest of the file to the front
+      result.rewritten = (result.tags & ID3TT_ID3V2) != 0;
+      result.bytes = result.rewritten ? fileSize - prepended : 0;
+    }
+    else
+    {
+      UpdateFile(tag, _tags, result);
+    }
+    result.error = tag.GetLastError();
+    if (result.error == ID3E_NoData)
+    {
+      result.error = ID3E_NoError;  // there was nothing to render
+    }
   }
-  if (nTags & ID3TT_ID3V2)
+
+  bool Handle(size_t index, const char* filename, ID3_Tag& tag)
   {
-    os << "v2";
+    UpdateResult& result = _results[index];
+    CheckBatchError(tag, result);
+    cout << (_args.strip_flag ? "Stripping " : "Converting ") << filename
+         << ": attempting ";
+    DisplayTags(cout, _tags);
+    cout << (_args.strip_flag ? ", stripped " : ", converted ");
+    DisplayTags(cout, result.tags);
+    if (result.error != ID3E_NoError)
+    {
+      cout << ", error: " << ErrorText(result.error);
+    }
+    cout << endl;
+    _summary.Add(result);
+    return true;
   }
-}
+
+  const UpdateSummary& Summary() const { return _summary; }
+
+private:
+  const gengetopt_args_info& _args;
+  flags_t                   _tags;
+  std::vector<UpdateResult> _results;   // each one is written by a single thread
+  UpdateSummary             _summary;
+};
 
 int main( int argc, char * const argv[])
 {
@@ -130,46 +174,22 @@ int main( int argc, char * const argv[])
   }
 
 
-  const char* filename = NULL;
-  for (size_t i = 0; i < args.inputs_num; ++i)
+  size_t jobs = 1;
+  if (args.jobs_given && args.jobs_arg >= 0)
   {
-    filename = args.inputs[i];
-    ID3_Tag myTag;
-
-    if (args.strip_given)
-    {
-      cout << "Stripping ";
-    }
-    else
-    {
-      cout << "Converting ";
-    }
-    cout << filename << ": ";
-
-    myTag.Clear();
-    myTag.Link(filename, ID3TT_ALL);
-    myTag.SetPadding(args.padding_flag);
+    jobs = args.jobs_arg;
+  }
 
-    cout << "attempting ";
-    DisplayTags(cout, ulFlag);
-    luint nTags;
+  Converter converter(args, ulFlag);
+  ID3_Batch batch(ID3TT_ALL);
+  batch.SetThreads(jobs);
+  batch.SetInputOrder(true);
 
-    if (args.strip_flag)
-    {
-      nTags = myTag.Strip(ulFlag);
-      cout << ", stripped ";
-    }
-    else
-    {
-      nTags = myTag.Update(ulFlag);
-      cout << ", converted ";
-    }
-
-    DisplayTags(cout, nTags);
-    cout << endl;
-  }
+  double beg = Now();
+  batch.Parse(args.inputs, args.inputs_num, converter);
+  converter.Summary().Print(cout, Now() - beg);
 
-  return 0;
+  return converter.Summary().Errors() == 0 ? 0 : 1;
 }
 
 
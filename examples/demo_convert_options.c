@@ -48,14 +48,15 @@ print_help (void)
 {
   print_version ();
   printf ("Usage: %s [OPTIONS]... [FILES]...\n\
-   -h  --help      Print help and exit\n\
-   -V  --version   Print version and exit\n\
-   -1  --v1tag     Render only the id3v1 tag (default=off)\n\
-   -2  --v2tag     Render only the id3v2 tag (default=off)\n\
-   -s  --strip     Strip the tags instead of rendering (default=off)\n\
-   -p  --padding   Use padding in the tag (default=off)\n\
-   -w  --warning   Turn on warnings (for debugging) (default=off)\n\
-   -n  --notice    Turn on notices (for debugging) (default=off)\n\
+   -h       --help       Print help and exit\n\
+   -V       --version    Print version and exit\n\
+   -1       --v1tag      Render only the id3v1 tag (default=off)\n\
+   -2       --v2tag      Render only the id3v2 tag (default=off)\n\
+   -s       --strip      Strip the tags instead of rendering (default=off)\n\
+   -p       --padding    Use padding in the tag (default=off)\n\
+   -jINT    --jobs=INT   Process this many files at once (0 for one per processor)\n\
+   -w       --warning    Turn on warnings (for debugging) (default=off)\n\
+   -n       --notice     Turn on notices (for debugging) (default=off)\n\
 ", GGO_PACKAGE);
 }
 
@@ -72,6 +73,7 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
   args_info->v2tag_given = 0 ;
   args_info->strip_given = 0 ;
   args_info->padding_given = 0 ;
+  args_info->jobs_given = 0 ;
   args_info->warning_given = 0 ;
   args_info->notice_given = 0 ;
 
@@ -100,12 +102,13 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
         { "v2tag",	0, NULL, '2' },
         { "strip",	0, NULL, 's' },
         { "padding",	0, NULL, 'p' },
+        { "jobs",	1, NULL, 'j' },
         { "warning",	0, NULL, 'w' },
         { "notice",	0, NULL, 'n' },
         { NULL,	0, NULL, 0 }
       };
 
-      c = getopt_long (argc, argv, "hV12spwn", long_options, &option_index);
+      c = getopt_long (argc, argv, "hV12spj:wn", long_options, &option_index);
 
       if (c == -1) break;	/* Exit from `while (1)' loop.  */
 
@@ -137,6 +140,18 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
           args_info->padding_flag = !(args_info->padding_flag);
           break;
 
+        case 'j':	/* Process this many files at once (0 for one per processor).  */
+          if (args_info->jobs_given)
+            {
+              fprintf (stderr, "%s: `--jobs' (`-j') option given more than once\n", GGO_PACKAGE);
+              clear_args ();
+              print_help ();
+              exit (1);
+            }
+          args_info->jobs_given = 1;
+          args_info->jobs_arg = atoi (optarg);
+          break;
+
         case 'w':	/* Turn on warnings (for debugging).  */
           args_info->warning_flag = !(args_info->warning_flag);
           break;
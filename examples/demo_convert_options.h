@@ -14,6 +14,7 @@ struct gengetopt_args_info {
   int v2tag_flag;	/* Render only the id3v2 tag (default=off).  */
   int strip_flag;	/* Strip the tags instead of rendering (default=off).  */
   int padding_flag;	/* Use padding in the tag (default=off).  */
+  int jobs_arg;	/* Process this many files at once (0 for one per processor).  */
   int warning_flag;	/* Turn on warnings (for debugging) (default=off).  */
   int notice_flag;	/* Turn on notices (for debugging) (default=off).  */
 
@@ -23,6 +24,7 @@ struct gengetopt_args_info {
   int v2tag_given ;	/* Whether v2tag was given.  */
   int strip_given ;	/* Whether strip was given.  */
   int padding_given ;	/* Whether padding was given.  */
+  int jobs_given ;	/* Whether jobs was given.  */
   int warning_given ;	/* Whether warning was given.  */
   int notice_given ;	/* Whether notice was given.  */
 
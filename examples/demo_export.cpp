@@ -0,0 +1,192 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Exports the tags of many files to a columnar file with ID3_Exporter, e.g.
+//   find music -name '*.mp3' | id3export -o library.id3x -c file,TIT2,TPE1,TALB,seconds
+// The paths are taken from the command line or, if there are none, one per
+// line from standard input.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#if defined(HAVE_SYS_TIME_H)
+# include <sys/time.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/exporter.h"
+#include "id3/writers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* const DEFAULT_COLUMNS = "file,TIT2,TPE1,TALB,TRCK,TYER,TCON,seconds,bitrate";
+
+  double now()
+  {
+#if defined(HAVE_SYS_TIME_H)
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+    return (double)time(NULL);
+#endif
+  }
+
+  // a property name or the text id of a frame, whose text is exported
+  bool addColumn(ID3_Exporter& exporter, const string& name)
+  {
+    for (size_t i = 0; i < ID3_Exporter::NUMPROPERTIES; ++i)
+    {
+      if (name == ID3_Exporter::GetPropertyName((ID3_Exporter::Property) i))
+      {
+        return exporter.AddColumn((ID3_Exporter::Property) i);
+      }
+    }
+    for (int id = ID3FID_NOFRAME + 1; id < ID3FID_LASTFRAMEID; ++id)
+    {
+      ID3_Frame frame((ID3_FrameID) id);
+      const char* textid = frame.GetTextID();
+      if (textid && name == textid)
+      {
+        ID3_FieldID fld = frame.Contains(ID3FN_TEXT) ? ID3FN_TEXT : ID3FN_URL;
+        return exporter.AddColumn((ID3_FrameID) id, fld);
+      }
+    }
+    return false;
+  }
+
+  void usage(const char* name)
+  {
+    cerr << "Usage: " << name << " -o file [-c columns] [-j threads] [-g rows] [path...]" << endl
+         << "  columns is a comma separated list of frame ids (e.g. TIT2) and" << endl
+         << "  file, size, tags, layer, version, bitrate, freq, mode, seconds," << endl
+         << "  frames, vbrrate, encoder; by default " << DEFAULT_COLUMNS << endl;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  const char* output = NULL;
+  string columns = DEFAULT_COLUMNS;
+  ID3_Exporter exporter;
+  vector<string> names;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+    {
+      output = argv[++i];
+    }
+    else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+    {
+      columns = argv[++i];
+    }
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+    {
+      exporter.SetThreads(atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+    {
+      exporter.SetRowGroupSize(atoi(argv[++i]));
+    }
+    else if (argv[i][0] != '-')
+    {
+      names.push_back(argv[i]);
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (output == NULL)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  for (size_t beg = 0; beg <= columns.size(); )
+  {
+    size_t end = columns.find(',', beg);
+    if (end == string::npos)
+    {
+      end = columns.size();
+    }
+    string name = columns.substr(beg, end - beg);
+    if (!addColumn(exporter, name))
+    {
+      cerr << "unknown column " << name << endl;
+      return 1;
+    }
+    beg = end + 1;
+  }
+
+  if (names.empty())
+  {
+    string line;
+    while (getline(cin, line))
+    {
+      if (!line.empty())
+      {
+        names.push_back(line);
+      }
+    }
+  }
+  vector<const char*> paths;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    paths.push_back(names[i].c_str());
+  }
+
+  ofstream file(output, ios::out | ios::binary | ios::trunc);
+  if (!file)
+  {
+    cerr << "can't write " << output << endl;
+    return 1;
+  }
+  ID3_OStreamWriter writer(file);
+  double beg = now();
+  size_t rows = exporter.Export(paths.empty() ? NULL : &paths[0], paths.size(), writer);
+  file.close();
+  double seconds = now() - beg;
+  if (!file)
+  {
+    cerr << "error writing " << output << endl;
+    return 1;
+  }
+
+  printf("%lu rows, %lu columns: %.0f rows/s\n", (unsigned long)rows,
+         (unsigned long)exporter.NumColumns(), seconds > 0 ? rows / seconds : 0.0);
+  return 0;
+}
@@ -316,6 +316,36 @@ void PrintInformation(const ID3_Tag &myTag)
 
 #define DEBUG
 
+void PrintStats(const ID3_ParseStats& stats)
+{
+  cout << "*** parse statistics\n";
+  cout << "Reads: " << stats.reads << ", seeks: " << stats.seeks << "\n";
+  cout << "Bytes read: " << stats.bytes_read << ", skipped: " << stats.bytes_skipped << "\n";
+  cout << "Frames:";
+  ID3_FrameInfo info;
+  for (int id = ID3FID_NOFRAME + 1; id < ID3FID_LASTFRAMEID; ++id)
+  {
+    if (stats.frames[id] > 0)
+    {
+      cout << " " << info.LongName(ID3_FrameID(id)) << "=" << stats.frames[id];
+    }
+  }
+  cout << "\n";
+  cout << "Unknown frames: " << stats.unknown_frames << ", bad frames: " << stats.bad_frames << "\n";
+  cout << "Unsynchronized: " << (stats.unsynced ? "yes" : "no") << "\n";
+  cout << "Compressed: " << (stats.compressed ? "yes" : "no");
+  if (stats.compressed)
+  {
+    cout << ", " << stats.decompressed << " bytes decompressed";
+  }
+  cout << "\n";
+  cout << "Seconds: id3v2 " << stats.v2_seconds
+       << ", musicmatch " << stats.musicmatch_seconds
+       << ", lyrics3 " << stats.lyrics3_seconds
+       << ", id3v1 " << stats.v1_seconds
+       << ", mp3 " << stats.mp3_seconds << "\n";
+}
+
 int main( int argc, char * const argv[])
 {
   ID3D_INIT_DOUT();
@@ -347,6 +377,7 @@ int main( int argc, char * const argv[])
     filename = args.inputs[i];
     ID3_Tag myTag;
 
+    myTag.SetParseStats(args.stats_flag != 0);
     myTag.Link(filename, ID3TT_ALL);
     const Mp3_Headerinfo* mp3info;
     mp3info = myTag.GetMp3HeaderInfo();
@@ -398,8 +429,33 @@ int main( int argc, char * const argv[])
 
       cout << "Bitrate: " << mp3info->bitrate/1000 << "KBps\n";
       cout << "Frequency: " << mp3info->frequency/1000 << "KHz\n";
-    }
 
+      switch (mp3info->vbrheader)
+      {
+      case MP3VBRHEADER_XING:
+        cout << "VBR (Xing header), average bitrate: " << mp3info->vbr_bitrate/1000 << "KBps\n";
+        break;
+      case MP3VBRHEADER_VBRI:
+        cout << "VBR (VBRI header), average bitrate: " << mp3info->vbr_bitrate/1000 << "KBps\n";
+        break;
+      case MP3VBRHEADER_INFO:
+        cout << "CBR (Info header)\n";
+        break;
+      default:
+        break;
+      }
+      if (mp3info->encoder[0] != '\0')
+      {
+        cout << "Encoder: " << mp3info->encoder << ", delay: " << mp3info->encoder_delay
+             << ", padding: " << mp3info->encoder_padding << " samples\n";
+      }
+      cout << "Frames: " << mp3info->frames << "\n";
+      cout << "Length: " << mp3info->time << " seconds\n";
+    }
+    if (myTag.GetParseStats())
+    {
+      PrintStats(*myTag.GetParseStats());
+    }
 
   }
 
@@ -43,6 +43,7 @@ cmdline_parser_print_help (void)
    -a  --assign    Test the assignment operator (default=off)\n\
    -w  --warning   Turn on warnings (for debugging) (default=off)\n\
    -n  --notice    Turn on notices (for debugging) (default=off)\n\
+   -s  --stats     Print the statistics of each parse (default=off)\n\
 ", PACKAGE);
 }
 
@@ -74,10 +75,12 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
   args_info->assign_given = 0 ;
   args_info->warning_given = 0 ;
   args_info->notice_given = 0 ;
+  args_info->stats_given = 0 ;
 #define clear_args() { \
   args_info->assign_flag = 0;\
   args_info->warning_flag = 0;\
   args_info->notice_flag = 0;\
+  args_info->stats_flag = 0;\
 }
 
   clear_args();
@@ -94,10 +97,11 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
         { "assign",	0, NULL, 'a' },
         { "warning",	0, NULL, 'w' },
         { "notice",	0, NULL, 'n' },
+        { "stats",	0, NULL, 's' },
         { NULL,	0, NULL, 0 }
       };
 
-      c = getopt_long (argc, argv, "hVawn", long_options, &option_index);
+      c = getopt_long (argc, argv, "hVawns", long_options, &option_index);
 
       if (c == -1) break;	/* Exit from `while (1)' loop.  */
 
@@ -125,6 +129,10 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
           args_info->notice_flag = !(args_info->notice_flag);
           break;
 
+        case 's':	/* Print the statistics of each parse.  */
+          args_info->stats_flag = !(args_info->stats_flag);
+          break;
+
         case 0:	/* Long option with no short option */
 
         case '?':	/* Invalid option.  */
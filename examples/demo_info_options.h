@@ -23,12 +23,14 @@ struct gengetopt_args_info {
   int assign_flag;	/* Test the assignment operator (default=off).  */
   int warning_flag;	/* Turn on warnings (for debugging) (default=off).  */
   int notice_flag;	/* Turn on notices (for debugging) (default=off).  */
+  int stats_flag;	/* Print the statistics of each parse (default=off).  */
 
   int help_given ;	/* Whether help was given.  */
   int version_given ;	/* Whether version was given.  */
   int assign_given ;	/* Whether assign was given.  */
   int warning_given ;	/* Whether warning was given.  */
   int notice_given ;	/* Whether notice was given.  */
+  int stats_given ;	/* Whether stats was given.  */
 
   char **inputs ; /* unamed options */
   unsigned inputs_num ; /* unamed options number */
@@ -0,0 +1,481 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Writes synthetic mp3 files with tags of a given shape for scale testing,
+// e.g.
+//   id3synth -x txxx1000 -s 7 -o many.mp3
+//   id3synth -p 20M -u -P 64k -m -L 4k -n 100 -o corpus/%03d.mp3 -v
+// The files hold fake MPEG audio between the tags and depend on nothing but
+// the options, so the same seed and shape always give the same bytes.  The
+// id3v2.3 tags are built and rendered with ID3_Tag; the shapes id3lib can
+// parse but not render (id3v2.2.1 tags with compressed CDM frames, stacked
+// tags, Lyrics3 and MusicMatch tags) are put together byte by byte.  With
+// -v every file is parsed back and checked against what was written.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "synth_tags.h"
+
+using namespace std;
+
+namespace
+{
+  struct Shape
+  {
+    size_t audio;       // MPEG frames
+    size_t txxx;        // user text frames in each id3v2 tag
+    size_t picture;     // bytes of the attached picture, none if 0
+    bool   unsync;      // unsynchronize, with a false sync in every 2 bytes
+    bool   cdm;         // id3v2.2.1 with the frames in one compressed frame
+    size_t padding;     // bytes after the frames of each id3v2 tag
+    size_t stack;       // id3v2 tags, one after the other
+    size_t lyrics;      // bytes of Lyrics3 v2.00 lyrics, no tag if 0
+    bool   musicMatch;
+    bool   v1;
+  };
+
+  struct Preset
+  {
+    const char* name;
+    const char* description;
+    Shape       shape;
+  };
+
+  const size_t MB = 1024 * 1024;
+
+  // audio, txxx, picture, unsync, cdm, padding, stack, lyrics, musicMatch, v1
+  const Preset PRESETS[] =
+  {
+    { "plain",    "a small id3v2.3 tag and an id3v1 tag",
+      { 40,    2,        0, false, false,     0, 1,    0, false, true  } },
+    { "txxx1000", "1000 TXXX frames",
+      { 40, 1000,        0, false, false,     0, 1,    0, false, false } },
+    { "apic20m",  "a 20 MB picture",
+      { 40,    0, 20 * MB,  false, false,     0, 1,    0, false, false } },
+    { "unsync",   "a 1 MB picture unsynchronized throughout",
+      { 40,   20,      MB,  true,  false,     0, 1,    0, false, false } },
+    { "cdm",      "an id3v2.2.1 tag in a compressed CDM frame",
+      { 40,  100,    16384, false, true,      0, 1,    0, false, false } },
+    { "pad64k",   "64 KB of padding",
+      { 40,    2,        0, false, false, 65536, 1,    0, false, false } },
+    { "stacked",  "three id3v2 tags in a row",
+      { 40,   10,     4096, false, false,  1024, 3,    0, false, false } },
+    { "appended", "MusicMatch, Lyrics3 v2.00 and id3v1 tags",
+      { 40,    2,        0, false, false,     0, 1, 4096, true,  true  } }
+  };
+  const size_t NUMPRESETS = sizeof(PRESETS) / sizeof(PRESETS[0]);
+
+  // what was written, for checking it when it's read back
+  struct Expected
+  {
+    size_t prepended;
+    size_t appended;
+    size_t txxx;
+    size_t picture;     // the largest one
+  };
+
+  // a size in bytes, with an optional k or M suffix
+  bool parseSize(const char* arg, size_t& size)
+  {
+    char* end = NULL;
+    unsigned long val = strtoul(arg, &end, 10);
+    if (end == arg)
+    {
+      return false;
+    }
+    if (*end == 'k' || *end == 'K')
+    {
+      val *= 1024;
+      ++end;
+    }
+    else if (*end == 'm' || *end == 'M')
+    {
+      val *= 1024 * 1024;
+      ++end;
+    }
+    size = val;
+    return *end == '\0';
+  }
+
+  string render(const ID3_Tag& tag, ID3_TagType type)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, type);
+    return os.str();
+  }
+
+  string picture(const Shape& shape, synth::Random& rnd)
+  {
+    string data(shape.picture, '\0');
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      data[i] = (char)rnd.Next(256);
+      if (shape.unsync)
+      {
+        data[i] = (char)(i % 2 ? 0xE0 | rnd.Next(32) : 0xFF);
+      }
+    }
+    return data;
+  }
+
+  string v23Tag(const Shape& shape, synth::Random& rnd, const string& title,
+                const string& artist, const string& album)
+  {
+    ID3_Tag tag;
+    tag.SetPadding(false);
+    tag.SetUnsync(shape.unsync);
+    ID3_AddTitle(&tag, title.c_str());
+    ID3_AddArtist(&tag, artist.c_str());
+    ID3_AddAlbum(&tag, album.c_str());
+    for (size_t i = 0; i < shape.txxx; ++i)
+    {
+      char desc[32];
+      sprintf(desc, "user %lu", (unsigned long)i);
+      ID3_Frame* frame = new ID3_Frame(ID3FID_USERTEXT);
+      frame->GetField(ID3FN_DESCRIPTION)->Set(desc);
+      frame->GetField(ID3FN_TEXT)->Set(synth::text(16 + rnd.Next(48), rnd).c_str());
+      tag.AttachFrame(frame);
+    }
+    if (shape.picture)
+    {
+      const string data = picture(shape, rnd);
+      ID3_Frame* frame = new ID3_Frame(ID3FID_PICTURE);
+      frame->GetField(ID3FN_MIMETYPE)->Set("image/jpeg");
+      frame->GetField(ID3FN_PICTURETYPE)->Set(ID3PT_COVERFRONT);
+      frame->GetField(ID3FN_DATA)->Set(reinterpret_cast<const uchar*>(data.data()),
+                                        data.size());
+      tag.AttachFrame(frame);
+    }
+    return render(tag, ID3TT_ID3V2);
+  }
+
+  // the text frames of id3v2.2 start with the encoding, 0 for iso-8859-1
+  string v22Tag(const Shape& shape, synth::Random& rnd, const string& title,
+                const string& artist, const string& album)
+  {
+    string frames = synth::v22Frame("TT2", '\0' + title);
+    frames += synth::v22Frame("TP1", '\0' + artist);
+    frames += synth::v22Frame("TAL", '\0' + album);
+    for (size_t i = 0; i < shape.txxx; ++i)
+    {
+      char desc[32];
+      sprintf(desc, "user %lu", (unsigned long)i);
+      string data(1, '\0');
+      data += desc;
+      data += '\0';
+      data += synth::text(16 + rnd.Next(48), rnd);
+      frames += synth::v22Frame("TXX", data);
+    }
+    if (shape.picture)
+    {
+      // encoding, image format, picture type, empty description
+      string data("\0JPG\3\0", 6);
+      data += picture(shape, rnd);
+      frames += synth::v22Frame("PIC", data);
+    }
+    return synth::v22Tag(frames, true);
+  }
+
+  string generate(const Shape& shape, uint32 seed, Expected& expected)
+  {
+    synth::Random rnd(seed);
+    const string title  = synth::text(8 + rnd.Next(20), rnd);
+    const string artist = synth::text(8 + rnd.Next(20), rnd);
+    const string album  = synth::text(8 + rnd.Next(20), rnd);
+
+    string v2;
+    for (size_t i = 0; i < shape.stack; ++i)
+    {
+      string tag = shape.cdm ? v22Tag(shape, rnd, title, artist, album)
+                             : v23Tag(shape, rnd, title, artist, album);
+      synth::padV2Tag(tag, shape.padding);
+      v2 += tag;
+    }
+
+    string appended;
+    const size_t image = 1024;
+    if (shape.musicMatch)
+    {
+      appended += synth::musicMatch(title, artist, album, string(image, 'i'));
+    }
+    if (shape.lyrics)
+    {
+      appended += synth::lyrics3v2(title, synth::text(shape.lyrics, rnd));
+    }
+    if (shape.v1)
+    {
+      ID3_Tag tag;
+      ID3_AddTitle(&tag, title.c_str());
+      ID3_AddArtist(&tag, artist.c_str());
+      ID3_AddAlbum(&tag, album.c_str());
+      appended += render(tag, ID3TT_ID3V1);
+    }
+
+    expected.prepended = v2.size();
+    expected.appended = appended.size();
+    expected.txxx = shape.stack * shape.txxx;
+    expected.picture = shape.stack ? shape.picture : 0;
+    if (shape.musicMatch && image > expected.picture)
+    {
+      expected.picture = image;
+    }
+    return v2 + synth::mpegFrames(shape.audio, rnd) + appended;
+  }
+
+  bool fail(const char* name, const char* what)
+  {
+    cerr << name << ": " << what << " wrong when read back" << endl;
+    return false;
+  }
+
+  bool verify(const char* name, const Shape& shape, const Expected& expected)
+  {
+    ID3_Tag tag;
+    tag.Link(name, ID3TT_ALL);
+    size_t txxx = 0;
+    size_t picture = 0;
+    ID3_Tag::Iterator* iter = tag.CreateIterator();
+    for (ID3_Frame* frame = iter->GetNext(); frame; frame = iter->GetNext())
+    {
+      if (frame->GetID() == ID3FID_USERTEXT)
+      {
+        ++txxx;
+      }
+      else if (frame->GetID() == ID3FID_PICTURE &&
+               frame->GetField(ID3FN_DATA)->Size() > picture)
+      {
+        picture = frame->GetField(ID3FN_DATA)->Size();
+      }
+    }
+    delete iter;
+
+    if (tag.HasTagType(ID3TT_ID3V2) != (shape.stack > 0))
+      return fail(name, "id3v2 tag");
+    if (tag.HasTagType(ID3TT_MUSICMATCH) != shape.musicMatch)
+      return fail(name, "MusicMatch tag");
+    if (tag.HasTagType(ID3TT_LYRICS3V2) != (shape.lyrics > 0))
+      return fail(name, "Lyrics3 tag");
+    if (tag.HasTagType(ID3TT_ID3V1) != shape.v1)
+      return fail(name, "id3v1 tag");
+    if (tag.GetPrependedBytes() != expected.prepended)
+      return fail(name, "size of the id3v2 tags");
+    if (tag.GetAppendedBytes() != expected.appended)
+      return fail(name, "size of the appended tags");
+    if (txxx != expected.txxx)
+      return fail(name, "number of TXXX frames");
+    if (picture != expected.picture)
+      return fail(name, "size of the picture");
+    if (expected.prepended && tag.Find(ID3FID_TITLE) == NULL)
+      return fail(name, "title");
+    return true;
+  }
+
+  void usage(const char* name)
+  {
+    cerr << "Usage: " << name << " [options] -o file" << endl
+         << "  -s seed    seed of the file contents (1)" << endl
+         << "  -n count   write count files with seeds seed, seed + 1, ...;" << endl
+         << "             file is a printf pattern for the number, e.g. %03d.mp3" << endl
+         << "  -x preset  start from a preset shape, -x list lists them" << endl
+         << "  -a frames  MPEG audio frames (40)" << endl
+         << "  -t count   TXXX frames in each id3v2 tag" << endl
+         << "  -p size    bytes of the attached picture" << endl
+         << "  -u         unsynchronize the id3v2 tags" << endl
+         << "  -z         id3v2.2.1 tags with the frames in a compressed CDM frame" << endl
+         << "  -P size    bytes of padding in each id3v2 tag" << endl
+         << "  -k count   id3v2 tags one after the other (1), 0 for none" << endl
+         << "  -L size    a Lyrics3 v2.00 tag with lyrics of size bytes" << endl
+         << "  -m         a MusicMatch tag" << endl
+         << "  -1         an id3v1 tag, always written after a Lyrics3 tag" << endl
+         << "  -v         read every file back and check it" << endl
+         << "  sizes may end in k or M" << endl;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  const char* output = NULL;
+  uint32 seed = 1;
+  size_t count = 0;
+  bool check = false;
+  Shape shape = { 40, 0, 0, false, false, 0, 1, 0, false, false };
+  for (int i = 1; i < argc; ++i)
+  {
+    const char* opt = argv[i];
+    const char* arg = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = true;
+    if (strcmp(opt, "-x") == 0 && arg)
+    {
+      ++i;
+      if (strcmp(arg, "list") == 0)
+      {
+        for (size_t p = 0; p < NUMPRESETS; ++p)
+        {
+          printf("%-10s %s\n", PRESETS[p].name, PRESETS[p].description);
+        }
+        return 0;
+      }
+      size_t p = 0;
+      while (p < NUMPRESETS && strcmp(arg, PRESETS[p].name) != 0)
+      {
+        ++p;
+      }
+      ok = p < NUMPRESETS;
+      if (ok)
+      {
+        shape = PRESETS[p].shape;
+      }
+    }
+    else if (strcmp(opt, "-o") == 0 && arg)
+    {
+      output = argv[++i];
+    }
+    else if (strcmp(opt, "-s") == 0 && arg)
+    {
+      seed = strtoul(argv[++i], NULL, 10);
+    }
+    else if (strcmp(opt, "-n") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], count);
+    }
+    else if (strcmp(opt, "-a") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], shape.audio);
+    }
+    else if (strcmp(opt, "-t") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], shape.txxx);
+    }
+    else if (strcmp(opt, "-p") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], shape.picture);
+    }
+    else if (strcmp(opt, "-P") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], shape.padding);
+    }
+    else if (strcmp(opt, "-k") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], shape.stack);
+    }
+    else if (strcmp(opt, "-L") == 0 && arg)
+    {
+      ok = parseSize(argv[++i], shape.lyrics);
+    }
+    else if (strcmp(opt, "-u") == 0)
+    {
+      shape.unsync = true;
+    }
+    else if (strcmp(opt, "-z") == 0)
+    {
+      shape.cdm = true;
+    }
+    else if (strcmp(opt, "-m") == 0)
+    {
+      shape.musicMatch = true;
+    }
+    else if (strcmp(opt, "-1") == 0)
+    {
+      shape.v1 = true;
+    }
+    else if (strcmp(opt, "-v") == 0)
+    {
+      check = true;
+    }
+    else
+    {
+      ok = false;
+    }
+    if (!ok)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (output == NULL || (count > 0 && strchr(output, '%') == NULL))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+  if (shape.cdm && shape.unsync)
+  {
+    cerr << "id3v2.2.1 tags can't be unsynchronized here" << endl;
+    return 1;
+  }
+  if (shape.lyrics)
+  {
+    shape.v1 = true;
+  }
+
+  size_t failures = 0;
+  for (size_t n = 0; n < (count ? count : 1); ++n)
+  {
+    char name[1024];
+    if (count)
+    {
+      snprintf(name, sizeof(name), output, (int)n);
+    }
+    else
+    {
+      snprintf(name, sizeof(name), "%s", output);
+    }
+
+    Expected expected;
+    const string data = generate(shape, seed + n, expected);
+    ofstream file(name, ios::out | ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+    file.close();
+    if (!file)
+    {
+      cerr << "can't write " << name << endl;
+      return 1;
+    }
+    if (check && !verify(name, shape, expected))
+    {
+      ++failures;
+    }
+  }
+
+  if (check)
+  {
+    printf("%lu files, %lu failed\n", (unsigned long)(count ? count : 1),
+           (unsigned long)failures);
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -31,11 +31,13 @@
 #include "id3/id3lib_streams.h"
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
-#include <id3/tag.h>
+#include <id3/batch.h>
 #include <id3/misc_support.h>
 
 #include "demo_tag_options.h"
+#include "demo_update.h"
 
 using std::cout;
 using std::endl;
@@ -58,17 +60,93 @@ void PrintVersion(const char *sName)
   cout << "This program tags mp3 files with ID3v1/1.1 and/or id3v2 tags" << endl;
 }
 
-void DisplayTags(ostream &os, luint nTags)
+// Sets the frames and updates each file on the parsing threads, then
+// reports the results in the order the files were given.
+class Tagger : public ID3_Batch::Handler
 {
-  if (!((nTags & ID3TT_ID3V1) || (nTags & ID3TT_ID3V2)))
-    os << "no tag";
-  if (nTags & ID3TT_ID3V1)
-    os << "v1";
-  if ((nTags & ID3TT_ID3V1) && (nTags & ID3TT_ID3V2))
-    os << " and ";
-  if (nTags & ID3TT_ID3V2)
-    os << "v2";
-}
+public:
+  Tagger(const gengetopt_args_info& args, flags_t tags)
+    : _args(args), _tags(tags), _results(args.inputs_num)
+  { }
+
+  void Process(size_t index, const char* filename, ID3_Tag& tag)
+  {
+    UpdateResult& result = _results[index];
+    tag.GetLastError();  // resets the error left by parsing the file
+
+    if (_args.artist_given)
+    {
+      ID3_AddArtist(&tag, sArtist, true);
+    }
+    if (_args.album_given)
+    {
+      ID3_AddAlbum(&tag, sAlbum, true);
+    }
+    if (_args.song_given)
+    {
+      ID3_AddTitle(&tag, sTitle, true);
+    }
+    if (_args.year_given)
+    {
+      ID3_AddYear(&tag, sYear, true);
+    }
+    if (_args.comment_given)
+    {
+      ID3_AddComment(&tag, sComment, sDesc, true);
+    }
+    if (_args.genre_given)
+    {
+      ID3_AddGenre(&tag, nGenre, true);
+    }
+    if (_args.track_given)
+    {
+      ID3_AddTrack(&tag, nTrack, nTotal, true);
+    }
+    UpdateFile(tag, _tags, result);
+    result.error = tag.GetLastError();
+    if (result.error == ID3E_NoData)
+    {
+      result.error = ID3E_NoError;  // there was nothing to render
+    }
+  }
+
+  bool Handle(size_t index, const char* filename, ID3_Tag& tag)
+  {
+    UpdateResult& result = _results[index];
+    CheckBatchError(tag, result);
+    cout << "Tagging " << filename << ": attempting ";
+    DisplayTags(cout, _tags);
+    cout << ", tagged ";
+    DisplayTags(cout, result.tags);
+    if (result.error != ID3E_NoError)
+    {
+      cout << ", error: " << ErrorText(result.error);
+    }
+    cout << endl;
+    _summary.Add(result);
+    return true;
+  }
+
+  const UpdateSummary& Summary() const { return _summary; }
+
+  const char
+    *sArtist,
+    *sAlbum,
+    *sTitle,
+    *sComment,
+    *sYear,
+    *sDesc;
+  unsigned short
+    nTrack,
+    nTotal,
+    nGenre;
+
+private:
+  const gengetopt_args_info& _args;
+  flags_t                   _tags;
+  std::vector<UpdateResult> _results;   // each one is written by a single thread
+  UpdateSummary             _summary;
+};
 
 int main( int argc, char * const argv[])
 {
@@ -169,55 +247,30 @@ int main( int argc, char * const argv[])
     nTotal = ::strtol(args.total_arg, NULL, 10);
     cout << "+++ Total   = " << nTotal << endl;
   }
-  const char* filename = NULL;
-  for (size_t i = 0; i < args.inputs_num; ++i)
+  size_t jobs = 1;
+  if (args.jobs_given && args.jobs_arg >= 0)
   {
-    filename = args.inputs[i];
-    ID3_Tag myTag;
+    jobs = args.jobs_arg;
+  }
 
-    cout << "Tagging " << filename << ": ";
+  Tagger tagger(args, ulFlag);
+  tagger.sArtist  = sArtist;
+  tagger.sAlbum   = sAlbum;
+  tagger.sTitle   = sTitle;
+  tagger.sComment = sComment;
+  tagger.sYear    = sYear;
+  tagger.sDesc    = sDesc;
+  tagger.nTrack   = nTrack;
+  tagger.nTotal   = nTotal;
+  tagger.nGenre   = nGenre;
 
-    myTag.Link(filename);
+  ID3_Batch batch(ID3TT_ALL);
+  batch.SetThreads(jobs);
+  batch.SetInputOrder(true);
 
-    cout << "attempting ";
-    DisplayTags(cout, ulFlag);
+  double beg = Now();
+  batch.Parse(args.inputs, args.inputs_num, tagger);
+  tagger.Summary().Print(cout, Now() - beg);
 
-    if (args.artist_given)
-    {
-      ID3_AddArtist(&myTag, sArtist, true);
-    }
-    if (args.album_given)
-    {
-      ID3_AddAlbum(&myTag, sAlbum, true);
-    }
-    if (args.song_given)
-    {
-      ID3_AddTitle(&myTag, sTitle, true);
-    }
-    if (args.year_given)
-    {
-      ID3_AddYear(&myTag, sYear, true);
-    }
-    if (args.comment_given)
-    {
-      ID3_AddComment(&myTag, sComment, sDesc, true);
-    }
-    if (args.genre_given)
-    {
-      ID3_AddGenre(&myTag, nGenre, true);
-    }
-    if (args.track_given)
-    {
-      ID3_AddTrack(&myTag, nTrack, nTotal, true);
-    }
-    luint nTags = myTag.Update(ulFlag);
-    cout << ", tagged ";
-
-    DisplayTags(cout, nTags);
-
-    cout << endl;
-  }
-
-  return 0;
+  return tagger.Summary().Errors() == 0 ? 0 : 1;
 }
-
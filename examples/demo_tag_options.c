@@ -61,6 +61,7 @@ print_help (void)
    -tSTRING   --track=STRING    Set the track number\n\
    -TSTRING   --total=STRING    Set the total number of tracks\n\
    -gSHORT    --genre=SHORT     Set the genre\n\
+   -jINT      --jobs=INT        Process this many files at once (0 for one per processor)\n\
    -w         --warning         Turn on warnings (for debugging) (default=off)\n\
    -n         --notice          Turn on notices (for debugging) (default=off)\n\
 ", GGO_PACKAGE);
@@ -102,6 +103,7 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
   args_info->track_given = 0 ;
   args_info->total_given = 0 ;
   args_info->genre_given = 0 ;
+  args_info->jobs_given = 0 ;
   args_info->warning_given = 0 ;
   args_info->notice_given = 0 ;
 
@@ -143,12 +145,13 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
         { "track",	1, NULL, 't' },
         { "total",	1, NULL, 'T' },
         { "genre",	1, NULL, 'g' },
+        { "jobs",	1, NULL, 'j' },
         { "warning",	0, NULL, 'w' },
         { "notice",	0, NULL, 'n' },
         { NULL,	0, NULL, 0 }
       };
 
-      c = getopt_long (argc, argv, "hV12a:A:s:c:C:y:t:T:g:wn", long_options, &option_index);
+      c = getopt_long (argc, argv, "hV12a:A:s:c:C:y:t:T:g:j:wn", long_options, &option_index);
 
       if (c == -1) break;	/* Exit from `while (1)' loop.  */
 
@@ -280,6 +283,18 @@ cmdline_parser (int argc, char * const *argv, struct gengetopt_args_info *args_i
           args_info->genre_arg = (short)atoi (optarg);
           break;
 
+        case 'j':	/* Process this many files at once (0 for one per processor).  */
+          if (args_info->jobs_given)
+            {
+              fprintf (stderr, "%s: `--jobs' (`-j') option given more than once\n", GGO_PACKAGE);
+              clear_args ();
+              print_help ();
+              exit (1);
+            }
+          args_info->jobs_given = 1;
+          args_info->jobs_arg = atoi (optarg);
+          break;
+
         case 'w':	/* Turn on warnings (for debugging).  */
           args_info->warning_flag = !(args_info->warning_flag);
           break;
@@ -21,6 +21,7 @@ struct gengetopt_args_info {
   char * track_arg;	/* Set the track number.  */
   char * total_arg;	/* Set the total number of tracks.  */
   short genre_arg;	/* Set the genre.  */
+  int jobs_arg;	/* Process this many files at once (0 for one per processor).  */
   int warning_flag;	/* Turn on warnings (for debugging) (default=off).  */
   int notice_flag;	/* Turn on notices (for debugging) (default=off).  */
 
@@ -37,6 +38,7 @@ struct gengetopt_args_info {
   int track_given ;	/* Whether track was given.  */
   int total_given ;	/* Whether total was given.  */
   int genre_given ;	/* Whether genre was given.  */
+  int jobs_given ;	/* Whether jobs was given.  */
   int warning_given ;	/* Whether warning was given.  */
   int notice_given ;	/* Whether notice was given.  */
 
@@ -0,0 +1,189 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <iomanip>
+#if defined HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+#include <time.h>
+#include <id3/tag.h>
+#include <id3/tracer.h>
+#include "demo_update.h"
+
+using std::ostream;
+using std::endl;
+using std::ios;
+using std::setprecision;
+
+void DisplayTags(ostream &os, luint nTags)
+{
+  if (!((nTags & ID3TT_ID3V1) || (nTags & ID3TT_ID3V2)))
+  {
+    os << "no tag";
+  }
+  if (nTags & ID3TT_ID3V1)
+  {
+    os << "v1";
+  }
+  if ((nTags & ID3TT_ID3V1) && (nTags & ID3TT_ID3V2))
+  {
+    os << " and ";
+  }
+  if (nTags & ID3TT_ID3V2)
+  {
+    os << "v2";
+  }
+}
+
+const char* ErrorText(ID3_Err err)
+{
+  switch (err)
+  {
+    case ID3E_NoError:
+      return "no error";
+    case ID3E_NoData:
+      return "no data to render";
+    case ID3E_InvalidFrameID:
+      return "invalid frame id";
+    case ID3E_InvalidFrameSize:
+      return "invalid frame size";
+    case ID3E_UnknownFieldType:
+      return "unknown field type";
+    case ID3E_NoFile:
+      return "can't open the file";
+    case ID3E_ReadOnly:
+      return "can't write the file";
+    case ID3E_InvalidTag:
+      return "invalid tag";
+    case ID3E_zlibError:
+      return "compression failed";
+    default:
+      return "unknown error";
+  }
+}
+
+double Now()
+{
+#if defined HAVE_SYS_TIME_H
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+  return (double) time(NULL);
+#endif
+}
+
+namespace
+{
+  // the tracer of the calling thread while in scope
+  class TracerScope
+  {
+  public:
+    TracerScope(ID3_Tracer& tracer) : _previous(ID3_Tracer::Install(&tracer)) { }
+    ~TracerScope() { ID3_Tracer::Install(_previous); }
+  private:
+    ID3_Tracer* _previous;
+  };
+};
+
+void UpdateFile(ID3_Tag& tag, flags_t tags, UpdateResult& result)
+{
+  const size_t prepended = tag.GetPrependedBytes();
+  const size_t fileSize = tag.GetFileSize();
+
+  ID3_Tracer tracer;
+  {
+    TracerScope scope(tracer);
+    result.tags = tag.Update(tags);
+  }
+  // an id3v2 tag is written in place if it fits where the old one was,
+  // otherwise the whole file is copied
+  result.rewritten = tracer.GetCount(ID3_Tracer::REWRITES) > 0;
+  result.bytes = 0;
+  if (result.tags & ID3TT_ID3V2)
+  {
+    result.bytes += result.rewritten ? fileSize - prepended : 0;
+    result.bytes += tag.GetPrependedBytes();
+  }
+  if (result.tags & ID3TT_ID3V1)
+  {
+    result.bytes += 128;  // the id3v1 tag replaces the old one or is appended
+  }
+}
+
+void CheckBatchError(ID3_Tag& tag, UpdateResult& result)
+{
+  ID3_Err err = tag.GetLastError();
+  if (err != ID3E_NoError)
+  {
+    result = UpdateResult();
+    result.error = err;
+  }
+}
+
+UpdateSummary::UpdateSummary()
+  : _files(0), _errors(0), _rewritten(0), _rewritten_bytes(0),
+    _in_place(0), _in_place_bytes(0)
+{
+}
+
+void UpdateSummary::Add(const UpdateResult& result)
+{
+  ++_files;
+  if (result.error != ID3E_NoError)
+  {
+    ++_errors;
+  }
+  if (result.rewritten)
+  {
+    ++_rewritten;
+    _rewritten_bytes += result.bytes;
+  }
+  else if (result.tags != ID3TT_NONE)
+  {
+    ++_in_place;
+    _in_place_bytes += result.bytes;
+  }
+}
+
+void UpdateSummary::Print(ostream& os, double seconds) const
+{
+  os.setf(ios::fixed, ios::floatfield);
+  os << _files << " files in " << setprecision(2) << seconds << " s"
+     << setprecision(0);
+  if (seconds > 0)
+  {
+    os << " (" << _files / seconds << " files/s)";
+  }
+  os << ": " << _rewritten << " rewritten (" << _rewritten_bytes
+     << " bytes), " << _in_place << " in place (" << _in_place_bytes
+     << " bytes), " << _errors << " errors" << endl;
+}
@@ -0,0 +1,83 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_EXAMPLES_DEMO_UPDATE_H_
+#define _ID3LIB_EXAMPLES_DEMO_UPDATE_H_
+
+#include "id3/id3lib_streams.h"
+#include "id3/globals.h"
+
+class ID3_Tag;
+
+// What id3convert and id3tag report about the files they strip or update.
+
+// prints which of the tags in flags are set, e.g. "v1 and v2"
+void DisplayTags(std::ostream&, luint flags);
+
+// a short description of an error of ID3_Tag::Update() or Strip()
+const char* ErrorText(ID3_Err);
+
+// the wall clock time in seconds
+double Now();
+
+// the outcome of stripping or updating the tags of one file
+struct UpdateResult
+{
+  UpdateResult() : tags(ID3TT_NONE), error(ID3E_NoError), rewritten(false), bytes(0) { }
+  flags_t tags;       // the tags stripped or written
+  ID3_Err error;
+  bool    rewritten;  // was the whole file copied?
+  size_t  bytes;      // the number of bytes written to the file
+};
+
+// updates the tags of the file tag is linked to and fills in result
+void UpdateFile(ID3_Tag&, flags_t tags, UpdateResult& result);
+
+// passed the tag an ID3_Batch handler gets, replaces result with the error
+// of a file whose linking or processing threw, if it did
+void CheckBatchError(ID3_Tag&, UpdateResult& result);
+
+// counts the results of the files and prints a summary of them
+class UpdateSummary
+{
+public:
+  UpdateSummary();
+
+  void   Add(const UpdateResult&);
+  void   Print(std::ostream&, double seconds) const;
+  size_t Errors() const { return _errors; }
+
+private:
+  size_t _files;
+  size_t _errors;
+  size_t _rewritten;
+  double _rewritten_bytes;
+  size_t _in_place;
+  double _in_place_bytes;
+};
+
+#endif /* _ID3LIB_EXAMPLES_DEMO_UPDATE_H_ */
@@ -0,0 +1,55 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Fuzz target for the parsers of the tags at the end of a file: id3v1,
+// Lyrics3 v1.00 and v2.00 and MusicMatch.  The input is linked as a file
+// with none of the tags at the start parsed, so all of it is read by these
+// parsers: their sizes, offsets and fields come straight from the input.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include "id3/tag.h"
+#include "id3/readers.h"
+#include "fuzz_target.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uchar* data, size_t size)
+{
+  ID3_MemoryReader reader(data, size);
+  ID3_Tag tag;
+  tag.Link(reader, ID3TT_APPENDED);
+
+  // sizing a frame goes through all of its fields
+  ID3_Tag::Iterator* iter = tag.CreateIterator();
+  ID3_Frame* frame = NULL;
+  while (NULL != (frame = iter->GetNext()))
+  {
+    frame->Size();
+  }
+  delete iter;
+  return 0;
+}
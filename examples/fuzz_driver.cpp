@@ -0,0 +1,205 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Runs inputs through a fuzz target without libFuzzer, e.g.
+//   fuzzlink -t 100 -x 20 *.tag *.mp3
+// for a seed corpus, or to reproduce a crash found by libFuzzer.  Each
+// input is timed over a number of runs (-r), and reported as slow when a
+// run takes more than -t milliseconds per megabyte of input, counting
+// smaller inputs as a megabyte, or when it takes more than -x times as long
+// per byte as the median input and more than a millisecond: that is how
+// quadratic scans and restarts show up on inputs of ordinary size.  An
+// input still running after -T seconds is reported and ends the program.
+// Prints the throughput over all inputs and returns 1 if any was slow.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#if defined HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include "fuzz_target.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  struct Input
+  {
+    const char* name;
+    size_t      size;
+    double      seconds;            // of the slowest run
+    double      perByte() const { return seconds / (size ? size : 1); }
+  };
+
+  const char* current = NULL;
+
+#if defined HAVE_UNISTD_H
+  void timeout(int)
+  {
+    const char msg[] = "TIMEOUT ";
+    write(2, msg, sizeof(msg) - 1);
+    write(2, current, strlen(current));
+    write(2, "\n", 1);
+    _exit(1);
+  }
+#endif
+
+  bool readFile(const char* name, string& data)
+  {
+    ifstream file(name, ios::in | ios::binary);
+    if (!file)
+    {
+      return false;
+    }
+    char buf[8192];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+    {
+      data.append(buf, file.gcount());
+    }
+    return true;
+  }
+
+  bool slowerPerByte(const Input& a, const Input& b)
+  {
+    return a.perByte() < b.perByte();
+  }
+
+  void usage(const char* prog)
+  {
+    fprintf(stderr, "usage: %s [-r runs] [-t ms] [-x factor] [-T seconds] file...\n",
+            prog);
+    exit(1);
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t runs    = 1;
+  double limit   = 100;             // ms per megabyte and run
+  double factor  = 20;              // times the median time per byte
+  unsigned hard  = 10;              // seconds before giving up on an input
+
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; ++i)
+  {
+    if (i + 1 == argc)
+    {
+      usage(argv[0]);
+    }
+    switch (argv[i][1])
+    {
+      case 'r': runs   = atoi(argv[++i]); break;
+      case 't': limit  = atof(argv[++i]); break;
+      case 'x': factor = atof(argv[++i]); break;
+      case 'T': hard   = atoi(argv[++i]); break;
+      default:  usage(argv[0]);
+    }
+  }
+  if (i == argc || runs == 0)
+  {
+    usage(argv[0]);
+  }
+#if defined HAVE_UNISTD_H
+  signal(SIGALRM, timeout);
+#endif
+
+  vector<Input> inputs;
+  double total = 0;
+  size_t bytes = 0;
+  for (; i < argc; ++i)
+  {
+    string data;
+    if (!readFile(argv[i], data))
+    {
+      fprintf(stderr, "can't read %s\n", argv[i]);
+      continue;
+    }
+    Input input;
+    input.name = current = argv[i];
+    input.size = data.size();
+    input.seconds = 0;
+#if defined HAVE_UNISTD_H
+    alarm(hard);
+#endif
+    for (size_t run = 0; run < runs; ++run)
+    {
+      // a copy of exactly the input's size, so reads past it are caught by
+      // the memory checkers
+      uchar* buf = new uchar[input.size ? input.size : 1];
+      memcpy(buf, data.data(), input.size);
+      double beg = now();
+      LLVMFuzzerTestOneInput(buf, input.size);
+      double seconds = now() - beg;
+      delete [] buf;
+      input.seconds = max(input.seconds, seconds);
+      total += seconds;
+      bytes += input.size;
+    }
+#if defined HAVE_UNISTD_H
+    alarm(0);
+#endif
+    inputs.push_back(input);
+  }
+  if (inputs.empty())
+  {
+    return 1;
+  }
+
+  vector<Input> sorted(inputs);
+  sort(sorted.begin(), sorted.end(), slowerPerByte);
+  const double median = sorted[sorted.size() / 2].perByte();
+
+  size_t slow = 0;
+  for (size_t j = 0; j < inputs.size(); ++j)
+  {
+    const Input& input = inputs[j];
+    const double ms = input.seconds * 1000;
+    const double mb = max(1.0, input.size / 1e6);
+    if (ms > limit * mb || (ms > 1 && input.perByte() > factor * median))
+    {
+      printf("SLOW %s: %.1f ms, %lu bytes, %.0f ns/byte (median %.0f)\n",
+             input.name, ms, (unsigned long)input.size,
+             input.perByte() * 1e9, median * 1e9);
+      ++slow;
+    }
+  }
+  printf("%lu inputs, %lu runs, %.1f inputs/s, %.1f MB/s, %lu slow\n",
+         (unsigned long)inputs.size(), (unsigned long)(inputs.size() * runs),
+         total > 0 ? inputs.size() * runs / total : 0.0,
+         total > 0 ? bytes / total / 1e6 : 0.0, (unsigned long)slow);
+  return slow == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Fuzz target for ID3_Tag::Link(ID3_Reader&), which takes the input for a
+// whole file: the id3v2 tags at the start, the tags at the end and the mpeg
+// header in between.  The tags found are rendered again, so the frames made
+// from the input are read back as well.  The input is also fed to an
+// ID3_StreamParser, in chunks of a size taken from its first byte and with a
+// small tail, so the parts of the stream it doesn't keep are read as well.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <sstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/stream_parser.h"
+#include "id3/readers.h"
+#include "id3/writers.h"
+#include "fuzz_target.h"
+
+using namespace std;
+
+extern "C" int LLVMFuzzerTestOneInput(const uchar* data, size_t size)
+{
+  ID3_MemoryReader reader(data, size);
+  ID3_Tag tag;
+  tag.Link(reader, ID3TT_ALL);
+  tag.GetMp3HeaderInfo();
+
+  ostringstream os;
+  ID3_OStreamWriter writer(os);
+  tag.Render(writer, ID3TT_ID3V2);
+  tag.Render(writer, ID3TT_ID3V1);
+
+  ID3_Tag streamed;
+  ID3_StreamParser parser(streamed, ID3TT_ALL, 1024);
+  const size_t chunk = size > 0 ? 1 + data[0] * 16 : 1;
+  for (size_t pos = 0; pos < size; pos += chunk)
+  {
+    parser.Feed(data + pos, size - pos < chunk ? size - pos : chunk);
+  }
+  parser.Finish();
+  streamed.Render(writer, ID3TT_ID3V2);
+  return 0;
+}
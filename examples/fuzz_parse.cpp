@@ -0,0 +1,85 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Fuzz target for ID3_Tag::Parse(const uchar*, size_t), which parses an
+// id3v2 tag from memory, header and all.  A tag that parses is rendered
+// again, so the frames made from the input are read back as well.  The input
+// is also fed to an ID3_IncrementalParser, in chunks of a size taken from its
+// last byte, and the frames it hands out are attached to a tag of their own.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <sstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/incremental_parser.h"
+#include "id3/writers.h"
+#include "fuzz_target.h"
+
+using namespace std;
+
+namespace
+{
+  class Attach : public ID3_IncrementalParser::Callback
+  {
+  public:
+    Attach(ID3_Tag& tag) : _tag(tag) { }
+    void Frame(ID3_Frame* frame) { _tag.AttachFrame(frame); }
+  private:
+    ID3_Tag& _tag;
+  };
+};
+
+extern "C" int LLVMFuzzerTestOneInput(const uchar* data, size_t size)
+{
+  ID3_Tag tag;
+  tag.Parse(data, size);
+  if (tag.NumFrames() > 0)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+  }
+
+  ID3_Tag incremental;
+  Attach attach(incremental);
+  ID3_IncrementalParser parser(attach);
+  const size_t chunk = size > 0 ? 1 + data[size - 1] % 64 : 1;
+  for (size_t pos = 0; pos < size && !parser.IsDone(); pos += chunk)
+  {
+    parser.Feed(data + pos, size - pos < chunk ? size - pos : chunk);
+    parser.GetBytesNeeded();
+  }
+  if (incremental.NumFrames() > 0)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    incremental.Render(writer, ID3TT_ID3V2);
+  }
+  return 0;
+}
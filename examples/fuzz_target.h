@@ -0,0 +1,43 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_EXAMPLES_FUZZ_TARGET_H_
+#define _ID3LIB_EXAMPLES_FUZZ_TARGET_H_
+
+#include <stddef.h>
+#include "id3/globals.h"
+
+// The entry point of a fuzz target, in the form libFuzzer calls it.  Each of
+// fuzz_parse.cpp, fuzz_link.cpp and fuzz_appended.cpp defines one, to be
+// linked either with libFuzzer, e.g.
+//   clang++ -fsanitize=fuzzer,address -Iinclude fuzz_link.cpp libid3.a -lz
+// with the library built with CXXFLAGS="-fsanitize=fuzzer-no-link,address",
+// or with fuzz_driver.cpp, which runs a corpus through it without libFuzzer
+// and reports slow inputs.
+extern "C" int LLVMFuzzerTestOneInput(const uchar* data, size_t size);
+
+#endif /* _ID3LIB_EXAMPLES_FUZZ_TARGET_H_ */
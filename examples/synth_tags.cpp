@@ -0,0 +1,239 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <zlib.h>
+#include "synth_tags.h"
+
+using namespace std;
+
+namespace
+{
+  // MPEG-1 layer III, no crc, 128 kbit/s, 44.1 kHz, joint stereo, original
+  const unsigned char MPEG_HEADER[4] = { 0xFF, 0xFB, 0x90, 0x64 };
+  const size_t MPEG_FRAME_SIZE = 144 * 128000 / 44100;
+
+  const size_t MM_METADATA_SIZE = 7868;  // for versions up to 3.00
+
+  const char* WORDS[] =
+  {
+    "id3", "tag", "frame", "field", "the", "of", "and", "a", "song", "album",
+    "track", "lyrics", "picture", "artist", "night", "day", "love", "road",
+    "rain", "city", "light", "river", "dance", "heart", "time", "home"
+  };
+
+  void putBE(string& data, uint32 val, size_t size)
+  {
+    for (size_t i = size; i > 0; --i)
+    {
+      data += (char)((val >> (8 * (i - 1))) & 0xFF);
+    }
+  }
+
+  // the id3v2 tag size: 4 bytes of 7 bits each
+  void setSyncSafe(string& data, size_t pos, uint32 val)
+  {
+    for (size_t i = 0; i < 4; ++i)
+    {
+      data[pos + i] = (char)((val >> (7 * (3 - i))) & 0x7F);
+    }
+  }
+
+  void putLE(string& data, uint32 val, size_t size)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      data += (char)((val >> (8 * i)) & 0xFF);
+    }
+  }
+
+  // a MusicMatch text field: its size as 2 bytes, little endian, then text
+  void putText(string& data, const string& text)
+  {
+    putLE(data, text.size(), 2);
+    data += text;
+  }
+
+  // a Lyrics3 v2.00 field: 3 character name, 5 digit size, then data
+  void putField(string& data, const char* name, const string& text)
+  {
+    char size[8];
+    sprintf(size, "%05lu", (unsigned long)text.size());
+    data += name;
+    data += size;
+    data += text;
+  }
+};
+
+string synth::mpegFrames(size_t count, Random& rnd)
+{
+  string data;
+  data.reserve(count * MPEG_FRAME_SIZE);
+  for (size_t i = 0; i < count; ++i)
+  {
+    data.append(reinterpret_cast<const char*>(MPEG_HEADER), sizeof(MPEG_HEADER));
+    for (size_t j = sizeof(MPEG_HEADER); j < MPEG_FRAME_SIZE; ++j)
+    {
+      data += (char)(rnd.Next() & 0x7F);
+    }
+  }
+  return data;
+}
+
+string synth::text(size_t size, Random& rnd)
+{
+  const size_t numWords = sizeof(WORDS) / sizeof(WORDS[0]);
+  string data;
+  data.reserve(size + 16);
+  size_t line = 0;
+  while (data.size() < size)
+  {
+    data += WORDS[rnd.Next(numWords)];
+    if (++line % 8 == 0)
+    {
+      data += "\r\n";
+    }
+    else
+    {
+      data += ' ';
+    }
+  }
+  data.resize(size);
+  return data;
+}
+
+string synth::lyrics3v2(const string& title, const string& lyrics)
+{
+  string data = "LYRICSBEGIN";
+  putField(data, "IND", "10");
+  putField(data, "ETT", title);
+  putField(data, "LYR", lyrics);
+  char size[8];
+  sprintf(size, "%06lu", (unsigned long)data.size());
+  data += size;
+  data += "LYRICS200";
+  return data;
+}
+
+string synth::musicMatch(const string& title, const string& artist,
+                         const string& album, const string& image)
+{
+  // the optional header, 256 bytes before the data
+  string data = "18273645";
+  data.append(256 - data.size(), ' ');
+
+  const size_t beg = data.size();
+  uint32 offsets[5];
+
+  // image extension and image
+  offsets[0] = 0;
+  data += image.empty() ? "    " : "jpg ";
+  offsets[1] = data.size() - beg;
+  putLE(data, image.size(), 4);
+  data += image;
+  // the two unused sections are empty
+  offsets[2] = offsets[3] = offsets[4] = data.size() - beg;
+
+  // the metadata
+  const size_t meta = data.size();
+  putText(data, title);
+  putText(data, album);
+  putText(data, artist);
+  putText(data, "Rock");
+  putText(data, "");                    // tempo
+  putText(data, "");                    // mood
+  putText(data, "");                    // situation
+  putText(data, "");                    // preference
+  putText(data, "3:25");                // song length
+  data.append(12, '\0');                // creation date and play counter
+  putText(data, "");                    // path
+  putText(data, "");                    // serial
+  putLE(data, 1, 2);                    // track
+  putText(data, "");                    // notes
+  putText(data, "");                    // bio
+  putText(data, "");                    // lyrics
+  putText(data, "");                    // artist's url
+  putText(data, "");                    // buy cd url
+  putText(data, "");                    // artist's email
+  data.append(MM_METADATA_SIZE - (data.size() - meta), '\0');
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    putLE(data, offsets[i], 4);
+  }
+  data += "Brava Software Inc.             ";
+  data += "3.00";
+  data.append(12, ' ');
+  return data;
+}
+
+string synth::v22Frame(const char* id, const string& data)
+{
+  string frame(id, 3);
+  putBE(frame, data.size(), 3);
+  frame += data;
+  return frame;
+}
+
+string synth::v22Tag(const string& frames, bool compress)
+{
+  string data = frames;
+  if (compress)
+  {
+    uLongf size = compressBound(frames.size());
+    string packed(size, '\0');
+    ::compress2(reinterpret_cast<Bytef*>(&packed[0]), &size,
+                reinterpret_cast<const Bytef*>(frames.data()), frames.size(),
+                Z_BEST_COMPRESSION);
+    packed.resize(size);
+    string cdm = "z";
+    putBE(cdm, frames.size(), 4);
+    cdm += packed;
+    data = v22Frame("CDM", cdm);
+  }
+  string tag = "ID3";
+  tag += (char)2;
+  tag += (char)1;
+  tag += (char)0;
+  tag.append(4, '\0');
+  setSyncSafe(tag, 6, data.size());
+  return tag + data;
+}
+
+void synth::padV2Tag(string& tag, size_t padding)
+{
+  uint32 size = 0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    size = (size << 7) | (tag[6 + i] & 0x7F);
+  }
+  tag.insert(10 + size, padding, '\0');
+  setSyncSafe(tag, 6, size + padding);
+}
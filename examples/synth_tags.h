@@ -0,0 +1,79 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_EXAMPLES_SYNTH_TAGS_H_
+#define _ID3LIB_EXAMPLES_SYNTH_TAGS_H_
+
+#include <string>
+#include "id3/globals.h"
+
+// Builds the pieces of synthetic mp3 files for the benchmarks and id3synth:
+// fake audio and the tags id3lib parses but can't render.  Everything depends
+// only on the seed, so the same seed always gives the same bytes.
+namespace synth
+{
+  // a small linear congruential generator, the same on every platform
+  class Random
+  {
+  public:
+    Random(uint32 seed) : _state(seed * 2654435761UL + 1) { }
+    uint32 Next()
+    {
+      _state = _state * 1664525UL + 1013904223UL;
+      return _state >> 8;
+    }
+    uint32 Next(uint32 range) { return range ? this->Next() % range : 0; }
+  private:
+    uint32 _state;
+  };
+
+  // count MPEG-1 layer III frames at 128 kbit/s, 44.1 kHz, with noise for
+  // audio that never contains a false frame sync
+  std::string mpegFrames(size_t count, Random&);
+
+  // printable text of the given size, in lines of words
+  std::string text(size_t size, Random&);
+
+  // a Lyrics3 v2.00 tag without the id3v1 tag that must follow it
+  std::string lyrics3v2(const std::string& title, const std::string& lyrics);
+
+  // a MusicMatch 3.00 tag with the given image, which may be empty
+  std::string musicMatch(const std::string& title, const std::string& artist,
+                         const std::string& album, const std::string& image);
+
+  // an id3v2.2 frame with a 3 character id
+  std::string v22Frame(const char* id, const std::string& data);
+
+  // an id3v2.2.1 tag holding frames, packed into a single compressed data
+  // meta frame (CDM) if compress is set
+  std::string v22Tag(const std::string& frames, bool compress);
+
+  // adds padding zero bytes to the end of a rendered id3v2 tag
+  void padV2Tag(std::string& tag, size_t padding);
+};
+
+#endif /* _ID3LIB_EXAMPLES_SYNTH_TAGS_H_ */
@@ -0,0 +1,159 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Counts the memory allocations of common operations on the sample tag
+// ozzy.tag and fails when one of them makes more than its budget below, e.g.
+//   testallocs [ozzy.tag]
+// The tag is looked for in the current directory, then in $srcdir.  The
+// allocations are counted by replacing the global operator new.  When a
+// change brings a count down, lower its measured count below along with it,
+// so the gain can't be lost again unnoticed.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <fstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/readers.h"
+#include "id3/writers.h"
+#include "id3/misc_support.h"
+#include "alloc_counter.h"
+
+using namespace std;
+
+namespace
+{
+  const char* SAMPLE = "ozzy.tag";
+
+  // the allocations of each operation as measured with gcc and libstdc++.
+  // Those of parse, render and copy depend on how the standard library grows
+  // its strings and containers, so their budget is the count plus MARGIN
+  // percent.  The others are fixed by id3lib alone and their budget is the
+  // count itself.
+  const size_t PARSE_COUNT  = 132;
+  const size_t RENDER_COUNT = 165;
+  const size_t FIND_COUNT   = 0;
+  const size_t TEXT_COUNT   = 1;
+  const size_t GET_COUNT    = 2;   // including the copy handed to the caller
+  const size_t COPY_COUNT   = 135;
+  const size_t MARGIN       = 10;
+
+  size_t withMargin(size_t count)
+  {
+    return count + (count * MARGIN + 99) / 100;
+  }
+
+  bool readSample(const char* name, string& data)
+  {
+    ifstream file(name, ios::in | ios::binary);
+    if (!file)
+    {
+      return false;
+    }
+    char buf[4096];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+    {
+      data.append(buf, file.gcount());
+    }
+    return true;
+  }
+
+  size_t check(const char* what, size_t count, size_t budget)
+  {
+    bool ok = count <= budget;
+    printf("%s %-8s %5lu allocations, budget %lu\n", ok ? "ok  " : "FAIL", what,
+           (unsigned long)count, (unsigned long)budget);
+    return ok ? 0 : 1;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  string name = argc > 1 ? argv[1] : SAMPLE;
+  string data;
+  if (!readSample(name.c_str(), data) && argc == 1 && getenv("srcdir"))
+  {
+    name = string(getenv("srcdir")) + "/" + SAMPLE;
+    readSample(name.c_str(), data);
+  }
+  if (data.empty())
+  {
+    printf("FAIL can't read %s\n", name.c_str());
+    return 1;
+  }
+
+  size_t failures = 0;
+  ID3_Tag tag;
+  ID3_MemoryReader reader(reinterpret_cast<const uchar*>(data.data()), data.size());
+  size_t before = allocations;
+  tag.Link(reader, ID3TT_ID3V2);
+  failures += check("parse", allocations - before, withMargin(PARSE_COUNT));
+  if (tag.Find(ID3FID_TITLE) == NULL)
+  {
+    printf("FAIL no title in %s\n", name.c_str());
+    return 1;
+  }
+
+  // Size() doesn't allow for all of the padding Render() adds
+  const size_t bufSize = tag.Size() + 4096;
+  uchar* buffer = new uchar[bufSize];
+  ID3_MemoryWriter writer(buffer, bufSize);
+  before = allocations;
+  size_t size = tag.Render(writer, ID3TT_ID3V2);
+  failures += check("render", allocations - before, withMargin(RENDER_COUNT));
+  delete [] buffer;
+  failures += size == 0;
+
+  before = allocations;
+  ID3_Frame* frame = tag.Find(ID3FID_TITLE);
+  failures += check("find", allocations - before, FIND_COUNT);
+
+  char title[256];
+  before = allocations;
+  frame->GetField(ID3FN_TEXT)->Get(title, sizeof(title));
+  failures += check("text", allocations - before, TEXT_COUNT);
+
+  before = allocations;
+  char* copy = ID3_GetTitle(&tag);
+  failures += check("gettitle", allocations - before, GET_COUNT);
+  failures += strcmp(copy, title) != 0;
+  delete [] copy;
+
+  before = allocations;
+  {
+    ID3_Tag other(tag);
+  }
+  failures += check("copy", allocations - before, withMargin(COPY_COUNT));
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Writes files with combinations of appended tags (id3v1, lyrics3 v1.00 and
+// v2.00, musicmatch) to test-appended.mp3, links them and compares what was
+// found with the results of the parser that had each tag read itself from
+// the file.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <sstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/writers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* FILENAME = "test-appended.mp3";
+
+  string audio()
+  {
+    // ten frames of silence, mpeg 1 layer III, 128kbps, 44.1kHz
+    string frame(417, '\0');
+    frame[0] = '\xFF';
+    frame[1] = '\xFB';
+    frame[2] = '\x90';
+    string data;
+    for (size_t i = 0; i < 10; ++i)
+    {
+      data += frame;
+    }
+    return data;
+  }
+
+  string fixed(const string& text, size_t size, char fill = '\0')
+  {
+    string str = text.substr(0, size);
+    str.append(size - str.size(), fill);
+    return str;
+  }
+
+  string number(size_t val, size_t digits)
+  {
+    char buf[16];
+    sprintf(buf, "%0*lu", (int)digits, (unsigned long)val);
+    return buf;
+  }
+
+  string le(size_t val, size_t bytes)
+  {
+    string str;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+      str += (char)((val >> (8 * i)) & 0xFF);
+    }
+    return str;
+  }
+
+  string id3v1(const string& title)
+  {
+    return "TAG" + fixed(title, 30) + fixed("Artist", 30) +
+      fixed("Album", 30) + "2002" + fixed("Comment", 28) + '\0' + '\7' +
+      '\x11';
+  }
+
+  string lyrics3v1(const string& lyrics)
+  {
+    return "LYRICSBEGIN" + lyrics + "LYRICSEND";
+  }
+
+  string lyrics3v2(const string& lyrics, bool timestamps)
+  {
+    string ind = timestamps ? "110" : "100";
+    string data = "LYRICSBEGIN";
+    data += "IND" + number(ind.size(), 5) + ind;
+    data += "ETT" + number(12, 5) + "Lyrics title";
+    data += "EAR" + number(13, 5) + "Lyrics artist";
+    data += "INF" + number(11, 5) + "Information";
+    data += "LYR" + number(lyrics.size(), 5) + lyrics;
+    return data + number(data.size(), 6) + "LYRICS200";
+  }
+
+  string musicmatch(size_t imgsize, bool header)
+  {
+    string img;
+    for (size_t i = 0; i < imgsize; ++i)
+    {
+      img += (char)(i * 7);
+    }
+    string meta;
+    const char* fields[] = { "MM title", "MM album", "MM artist", "Rock",
+                             "Fast", "Happy", "Party", "Excellent", "3:25" };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+    {
+      meta += le(strlen(fields[i]), 2) + fields[i];
+    }
+    meta += string(12, '\0');
+    meta += le(7, 2) + "c:\\path";
+    meta += le(6, 2) + "serial";
+    meta += le(5, 2);
+    meta += le(5, 2) + "Notes";
+    meta += le(3, 2) + "Bio";
+    meta += le(6, 2) + "Lyrics";
+    meta += le(18, 2) + "http://artist.com/";
+    meta += le(15, 2) + "http://buy.com/";
+    meta += le(15, 2) + "mail@artist.com";
+    meta = fixed(meta, 7868);
+
+    string sections[4] = { "jpg ", le(img.size(), 4) + img,
+                           string(4, '\0'), string(4, '\0') };
+    string data = header ? fixed("18273645", 256) : "";
+    string offsets;
+    size_t offset = 1000;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      offsets += le(offset, 4);
+      offset += sections[i].size();
+      data += sections[i];
+    }
+    offsets += le(offset, 4);
+    data += meta + offsets;
+    data += fixed("Brava Software Inc.", 32, ' ') + "3.00" + string(12, ' ');
+    return data;
+  }
+
+  string repeat(const string& text, size_t times)
+  {
+    string str;
+    for (size_t i = 0; i < times; ++i)
+    {
+      str += text;
+    }
+    return str;
+  }
+
+  // a checksum over everything the tag holds after linking
+  unsigned long checksum(const ID3_Tag& tag)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+    string data = os.str();
+    unsigned long sum = 2166136261UL;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      sum = ((sum ^ (unsigned char)data[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return sum;
+  }
+
+  struct TestCase
+  {
+    const char*   name;
+    string        appended;
+    unsigned int  tags;           // expected results
+    size_t        tagbytes;
+    size_t        frames;
+    unsigned long sum;
+  };
+};
+
+int main(int argc, char *argv[])
+{
+  const string lyrics = "[00:01]First line\r\n[00:05]Second line\r\n";
+  const string longlyrics = repeat("A rather long line of lyrics\r\n", 2500);
+  const string v1 = id3v1("Title");
+
+  // a lyrics3 v1.00 tag covers the id3v1 tag following it, a lyrics3 v2.00
+  // tag is only found right before an id3v1 tag
+  TestCase cases[] =
+  {
+    { "id3v1", v1,
+      ID3TT_ID3V1, 128, 6, 414146016UL },
+    { "lyrics3v1", lyrics3v1(lyrics),
+      ID3TT_NONE, 0, 0, 2166136261UL },
+    { "lyrics3v1+id3v1", lyrics3v1(lyrics) + v1,
+      ID3TT_LYRICS3, 187, 1, 578927936UL },
+    { "no LYRICSBEGIN+id3v1", "LYRICS" + lyrics + "LYRICSEND" + v1,
+      ID3TT_ID3V1, 128, 6, 414146016UL },
+    { "lyrics3v2+id3v1", lyrics3v2(lyrics, false) + v1,
+      ID3TT_ID3V1 | ID3TT_LYRICS3V2, 272, 8, 2997157594UL },
+    { "lyrics3v2 timestamps+id3v1", lyrics3v2(lyrics, true) + v1,
+      ID3TT_ID3V1 | ID3TT_LYRICS3V2, 272, 8, 2476311223UL },
+    { "long lyrics3v2+id3v1", lyrics3v2(longlyrics, false) + v1,
+      ID3TT_ID3V1 | ID3TT_LYRICS3V2, 75233, 8, 4151731775UL },
+    { "musicmatch", musicmatch(100, false),
+      ID3TT_MUSICMATCH, 8052, 19, 1174267174UL },
+    { "musicmatch header+id3v1", musicmatch(100, true) + v1,
+      ID3TT_ID3V1 | ID3TT_MUSICMATCH, 8436, 25, 743024716UL },
+    { "musicmatch large image+id3v1", musicmatch(100000, true) + v1,
+      ID3TT_ID3V1 | ID3TT_MUSICMATCH, 108336, 25, 1969908777UL },
+    { "musicmatch+lyrics3v2+id3v1",
+      musicmatch(2000, true) + lyrics3v2(lyrics, true) + v1,
+      ID3TT_ID3V1 | ID3TT_LYRICS3V2 | ID3TT_MUSICMATCH, 10480, 27, 1128505436UL },
+    { "musicmatch+lyrics3v1+id3v1",
+      musicmatch(2000, false) + lyrics3v1(lyrics) + v1,
+      ID3TT_LYRICS3 | ID3TT_MUSICMATCH, 10139, 20, 3674177583UL },
+    { "lyrics3v2+musicmatch+id3v1",
+      lyrics3v2(lyrics, false) + musicmatch(10, true) + v1,
+      ID3TT_ID3V1 | ID3TT_MUSICMATCH, 8346, 25, 3328904763UL },
+  };
+  const size_t numcases = sizeof(cases) / sizeof(cases[0]);
+
+  const string data = audio();
+  size_t failures = 0;
+  for (size_t i = 0; i < numcases; ++i)
+  {
+    const TestCase& tc = cases[i];
+    {
+      ofstream file(FILENAME, ios::out | ios::binary | ios::trunc);
+      file.write(data.data(), data.size());
+      file.write(tc.appended.data(), tc.appended.size());
+    }
+
+    ID3_Tag tag;
+    tag.Link(FILENAME, ID3TT_ALL);
+    tag.SetPadding(false);
+
+    unsigned int tags = ID3TT_NONE;
+    ID3_TagType types[] = { ID3TT_ID3V1, ID3TT_LYRICS3, ID3TT_LYRICS3V2,
+                            ID3TT_MUSICMATCH };
+    for (size_t j = 0; j < sizeof(types) / sizeof(types[0]); ++j)
+    {
+      if (tag.HasTagType(types[j]))
+      {
+        tags |= types[j];
+      }
+    }
+    const Mp3_Headerinfo* info = tag.GetMp3HeaderInfo();
+    unsigned long sum = checksum(tag);
+
+    bool ok = tags == tc.tags && tag.GetAppendedBytes() == tc.tagbytes &&
+              tag.NumFrames() == tc.frames && sum == tc.sum &&
+              info != NULL && info->datasize == data.size() + tc.appended.size() - tc.tagbytes;
+    cout << (ok ? "ok   " : "FAIL ") << tc.name << ": tags = " << tags
+         << ", appended = " << tag.GetAppendedBytes()
+         << ", frames = " << tag.NumFrames() << ", sum = " << sum << endl;
+    if (!ok)
+    {
+      ++failures;
+    }
+  }
+  remove(FILENAME);
+
+  return failures == 0 ? 0 : 1;
+}
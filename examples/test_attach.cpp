@@ -0,0 +1,154 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Attaches frames to tags through ID3_Tag::AttachFrames(), checked and
+// trusted, and checks that they end up in the tag as they would through
+// AttachFrame().  Then times building many tags both ways, e.g.
+//   testattach -n 20000
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const size_t NUMFRAMES = 8;
+
+  ID3_Frame* textFrame(ID3_FrameID id, const char* text)
+  {
+    ID3_Frame* frame = new ID3_Frame(id);
+    frame->GetField(ID3FN_TEXT)->Set(text);
+    return frame;
+  }
+
+  ID3_Frame* ufidFrame(const char* owner, const char* id)
+  {
+    ID3_Frame* frame = new ID3_Frame(ID3FID_UNIQUEFILEID);
+    frame->GetField(ID3FN_OWNER)->Set(owner);
+    frame->GetField(ID3FN_DATA)->Set(reinterpret_cast<const uchar*>(id), strlen(id));
+    return frame;
+  }
+
+  // the frames of a tag as an application would build them from a database
+  void makeFrames(ID3_Frame** frames, size_t n)
+  {
+    char track[16];
+    sprintf(track, "%lu", (unsigned long)(n % 20 + 1));
+    frames[0] = textFrame(ID3FID_TITLE, "A title");
+    frames[1] = textFrame(ID3FID_LEADARTIST, "An artist");
+    frames[2] = textFrame(ID3FID_ALBUM, "An album");
+    frames[3] = textFrame(ID3FID_TRACKNUM, track);
+    frames[4] = textFrame(ID3FID_CONTENTTYPE, "(17)");
+    frames[5] = textFrame(ID3FID_COMPOSER, "A composer");
+    frames[6] = textFrame(ID3FID_PUBLISHER, "A publisher");
+    frames[7] = ufidFrame("http://www.id3.org/dummy/ufid.html", "0123456789");
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t count = 5000;
+  if (argc > 2 && strcmp(argv[1], "-n") == 0)
+  {
+    count = atoi(argv[2]);
+  }
+  size_t failures = 0;
+  ID3_Frame* frames[NUMFRAMES + 3];
+
+  {
+    ID3_Tag tag;
+    makeFrames(frames, 0);
+    failures += check(tag.AttachFrames(frames, NUMFRAMES, true) == NUMFRAMES &&
+                      tag.NumFrames() == NUMFRAMES && tag.HasChanged(),
+                      "trusted frames attached");
+    ID3_Tag::Iterator* iter = tag.CreateIterator();
+    bool inOrder = true;
+    for (size_t i = 0; i < NUMFRAMES; ++i)
+    {
+      inOrder = inOrder && iter->GetNext() == frames[i];
+    }
+    delete iter;
+    failures += check(inOrder && tag.Find(ID3FID_ALBUM) == frames[2],
+                      "trusted frames found in order");
+  }
+  {
+    ID3_Tag tag;
+    tag.AttachFrame(textFrame(ID3FID_TITLE, "Found first"));
+    tag.Find(ID3FID_TITLE);
+    makeFrames(frames, 1);
+    frames[NUMFRAMES] = NULL;
+    // replaces the first ufid frame, which has the same owner
+    frames[NUMFRAMES + 1] = ufidFrame("http://www.id3.org/dummy/ufid.html", "9876543210");
+    // not a url, so dropped
+    frames[NUMFRAMES + 2] = ufidFrame("no owner", "0123456789");
+    failures += check(tag.AttachFrames(frames, NUMFRAMES + 3) == NUMFRAMES + 1 &&
+                      tag.NumFrames() == NUMFRAMES + 1,
+                      "checked frames attached");
+    failures += check(tag.Find(ID3FID_UNIQUEFILEID) == frames[NUMFRAMES + 1],
+                      "duplicate in the batch replaced");
+    // the cursor was reset, so the search starts over at the first title
+    ID3_Frame* title = tag.Find(ID3FID_TITLE);
+    failures += check(title != NULL && title != frames[0] &&
+                      tag.Find(ID3FID_TITLE) == frames[0], "cursor reset");
+  }
+
+  double beg = now();
+  for (size_t n = 0; n < count; ++n)
+  {
+    ID3_Tag tag;
+    makeFrames(frames, n);
+    for (size_t i = 0; i < NUMFRAMES; ++i)
+    {
+      tag.AttachFrame(frames[i]);
+    }
+  }
+  double single = now() - beg;
+
+  beg = now();
+  for (size_t n = 0; n < count; ++n)
+  {
+    ID3_Tag tag;
+    makeFrames(frames, n);
+    tag.AttachFrames(frames, NUMFRAMES, true);
+  }
+  double trusted = now() - beg;
+
+  printf("%lu tags of %lu frames: %.1f ms one by one, %.1f ms trusted\n",
+         (unsigned long)count, (unsigned long)NUMFRAMES, single * 1000,
+         trusted * 1000);
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,457 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Links files through an ID3_ParseCache in the directory test-cache.d and
+// compares the tags restored from the cache with those of a plain Link(),
+// also after the files are updated, changed behind the cache's back or the
+// entries are damaged.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+#if defined(HAVE_SYS_TYPES_H)
+# include <sys/types.h>
+#endif
+#if defined(HAVE_SYS_STAT_H)
+# include <sys/stat.h>
+#endif
+#if defined(HAVE_UNISTD_H)
+# include <unistd.h>
+# include <dirent.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/batch.h"
+#include "id3/parse_cache.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* DIRNAME = "test-cache.d";
+
+  string audio()
+  {
+    // ten frames of silence, mpeg 1 layer III, 128kbps, 44.1kHz
+    string frame(417, '\0');
+    frame[0] = '\xFF';
+    frame[1] = '\xFB';
+    frame[2] = '\x90';
+    string data;
+    for (size_t i = 0; i < 10; ++i)
+    {
+      data += frame;
+    }
+    return data;
+  }
+
+  string render(const ID3_Tag& tag, ID3_TagType type)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, type);
+    return os.str();
+  }
+
+  string number(size_t val, size_t digits)
+  {
+    char buf[16];
+    sprintf(buf, "%0*lu", (int)digits, (unsigned long)val);
+    return buf;
+  }
+
+  string be(size_t val, size_t bytes)
+  {
+    string str;
+    for (size_t i = bytes; i > 0; --i)
+    {
+      str += (char)((val >> (8 * (i - 1))) & 0xFF);
+    }
+    return str;
+  }
+
+  // an id3v2.3 tag with a frame id3lib doesn't know
+  string unknownFrameTag()
+  {
+    string frames = string("ZZZZ") + be(5, 4) + '\0' + '\0' + "hello";
+    frames += string("TIT2") + be(6, 4) + '\0' + '\0' + '\0' + "Title";
+    frames += string(16, '\0');
+    size_t size = frames.size();
+    string hdr = string("ID3") + '\3' + '\0' + '\0';
+    for (size_t i = 4; i > 0; --i)
+    {
+      hdr += (char)((size >> (7 * (i - 1))) & 0x7F);
+    }
+    return hdr + frames;
+  }
+
+  string lyrics3v2()
+  {
+    string data = "LYRICSBEGIN";
+    data += "IND" + number(2, 5) + "10";
+    data += "ETT" + number(12, 5) + "Lyrics title";
+    data += "LYR" + number(11, 5) + "Some lyrics";
+    return data + number(data.size(), 6) + "LYRICS200";
+  }
+
+  string v2tag()
+  {
+    ID3_Tag tag;
+    ID3_AddTitle(&tag, "A title");
+    ID3_AddArtist(&tag, "An artist");
+    ID3_AddAlbum(&tag, "An album");
+    ID3_AddTrack(&tag, 3, 12);
+    ID3_AddComment(&tag, "A comment", "desc");
+
+    ID3_Frame* frame = new ID3_Frame(ID3FID_USERTEXT);
+    frame->GetField(ID3FN_TEXTENC)->Set(ID3TE_UTF16);
+    frame->GetField(ID3FN_DESCRIPTION)->Set("description");
+    frame->GetField(ID3FN_TEXT)->Set("user text");
+    frame->GetField(ID3FN_TEXT)->SetEncoding(ID3TE_UTF16);
+    tag.AttachFrame(frame);
+
+    frame = new ID3_Frame(ID3FID_PICTURE);
+    frame->GetField(ID3FN_MIMETYPE)->Set("image/png");
+    frame->GetField(ID3FN_PICTURETYPE)->Set(3);
+    frame->GetField(ID3FN_DESCRIPTION)->Set("cover");
+    string image;
+    for (size_t i = 0; i < 3000; ++i)
+    {
+      image += (char)(i * 31);
+    }
+    frame->GetField(ID3FN_DATA)->Set(reinterpret_cast<const uchar*>(image.data()), image.size());
+    tag.AttachFrame(frame);
+
+    frame = new ID3_Frame(ID3FID_UNSYNCEDLYRICS);
+    frame->GetField(ID3FN_LANGUAGE)->Set("eng");
+    frame->GetField(ID3FN_TEXT)->Set(string(2000, 'x').c_str());
+    tag.AttachFrame(frame);
+    return render(tag, ID3TT_ID3V2);
+  }
+
+  string v1tag()
+  {
+    ID3_Tag tag;
+    ID3_AddTitle(&tag, "v1 title");
+    ID3_AddArtist(&tag, "v1 artist");
+    ID3_AddYear(&tag, "2002");
+    return render(tag, ID3TT_ID3V1);
+  }
+
+  bool write(const string& name, const string& data, bool append = false)
+  {
+    ofstream file(name.c_str(), ios::out | ios::binary | (append ? ios::app : ios::trunc));
+    file.write(data.data(), data.size());
+    return file.good();
+  }
+
+  unsigned long checksum(const string& data)
+  {
+    unsigned long sum = 2166136261UL;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      sum = ((sum ^ (unsigned char)data[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return sum;
+  }
+
+  // everything a Link() finds out about a file
+  string describe(const ID3_Tag& tag)
+  {
+    ostringstream os;
+    os << "tags";
+    ID3_TagType types[] = { ID3TT_ID3V1, ID3TT_ID3V2, ID3TT_LYRICS3,
+                            ID3TT_LYRICS3V2, ID3TT_MUSICMATCH };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i)
+    {
+      os << (tag.HasTagType(types[i]) ? " 1" : " 0");
+    }
+    os << ", prepended " << tag.GetPrependedBytes()
+       << ", appended " << tag.GetAppendedBytes()
+       << ", size " << tag.GetFileSize()
+       << ", frames " << tag.NumFrames()
+       << ", spec " << tag.GetSpec()
+       << ", unsync " << tag.GetUnsync()
+       << ", changed " << tag.HasChanged()
+       << ", v2 " << checksum(render(tag, ID3TT_ID3V2))
+       << ", v1 " << checksum(render(tag, ID3TT_ID3V1));
+
+    ID3_Tag::ConstIterator* iter = tag.CreateIterator();
+    const ID3_Frame* frame;
+    while (NULL != (frame = iter->GetNext()))
+    {
+      os << ", " << frame->GetID() << ":" << frame->GetTextID()
+         << (frame->GetCompression() ? "z" : "");
+    }
+    delete iter;
+
+    const Mp3_Headerinfo* info = tag.GetMp3HeaderInfo();
+    if (info)
+    {
+      os << ", mp3 " << info->layer << " " << info->version << " "
+         << info->bitrate << " " << info->frequency << " " << info->frames
+         << " " << info->time << " " << info->datasize << " "
+         << info->vbrheader;
+    }
+    return os.str();
+  }
+
+  size_t damageEntries()
+  {
+    size_t damaged = 0;
+#if defined(HAVE_UNISTD_H)
+    DIR* dir = opendir(DIRNAME);
+    struct dirent* ent;
+    while (dir && NULL != (ent = readdir(dir)))
+    {
+      string name = ent->d_name;
+      if (name.size() > 5 && name.substr(name.size() - 5) == ".id3c")
+      {
+        // keep the header intact, garble the rest
+        string path = string(DIRNAME) + "/" + name;
+        fstream file(path.c_str(), ios::in | ios::out | ios::binary);
+        file.seekp(100);
+        file.write(string(400, '\x7F').data(), 400);
+        ++damaged;
+      }
+    }
+    if (dir)
+    {
+      closedir(dir);
+    }
+#endif
+    return damaged;
+  }
+
+  class Collector : public ID3_Batch::Handler
+  {
+  public:
+    Collector(size_t count) : _found(count) { }
+    bool Handle(size_t index, const char* path, ID3_Tag& tag)
+    {
+      _found[index] = describe(tag);
+      return true;
+    }
+    vector<string> _found;
+  };
+
+  // throws while processing one of the files
+  class Failer : public ID3_Batch::Handler
+  {
+  public:
+    Failer(size_t count, size_t failing)
+      : _errors(count, ID3E_NoError), _frames(count, 0), _failing(failing) { }
+    void Process(size_t index, const char* path, ID3_Tag& tag)
+    {
+      if (index == _failing)
+      {
+        throw index;
+      }
+    }
+    bool Handle(size_t index, const char* path, ID3_Tag& tag)
+    {
+      _errors[index] = tag.GetLastError();
+      _frames[index] = tag.NumFrames();
+      return true;
+    }
+    vector<ID3_Err> _errors;
+    vector<size_t> _frames;
+    size_t _failing;
+  };
+};
+
+int main(int argc, char *argv[])
+{
+#if defined(HAVE_SYS_STAT_H)
+  mkdir(DIRNAME, 0777);
+#endif
+  const string data = audio();
+  vector<string> names;
+  names.push_back(string(DIRNAME) + "/v2+v1.mp3");
+  write(names.back(), v2tag() + data + v1tag());
+  names.push_back(string(DIRNAME) + "/unknown.mp3");
+  write(names.back(), unknownFrameTag() + data);
+  names.push_back(string(DIRNAME) + "/lyrics.mp3");
+  write(names.back(), data + lyrics3v2() + v1tag());
+  names.push_back(string(DIRNAME) + "/tagonly.mp3");
+  write(names.back(), v2tag());
+  names.push_back(string(DIRNAME) + "/empty.mp3");
+  write(names.back(), "");
+
+  ID3_ParseCache cache(DIRNAME);
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    cache.Invalidate(names[i].c_str());
+  }
+
+  size_t failures = 0;
+  vector<string> expected;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    const char* name = names[i].c_str();
+    ID3_Tag plain, missed, hit;
+    plain.Link(name);
+    missed.Link(name, cache);
+    size_t misses = cache.GetMisses();
+    hit.Link(name, cache);
+    expected.push_back(describe(plain));
+
+    failures += check(describe(missed) == expected.back() &&
+                      describe(hit) == expected.back() &&
+                      cache.GetMisses() == misses,
+                      names[i] + ": " + expected.back());
+  }
+  failures += check(cache.GetHits() == names.size() && cache.GetMisses() == names.size(),
+                    "every file parsed once, restored once");
+
+  {
+    // linking through the cache starts from an empty tag
+    ID3_Tag tag;
+    tag.Link(names[1].c_str(), cache);
+    tag.Link(names[0].c_str(), cache);
+    failures += check(describe(tag) == expected[0], "cached link clears the tag");
+  }
+
+  {
+    ID3_Tag tag;
+    tag.Link(names[0].c_str(), cache);
+    ID3_AddTitle(&tag, "A much longer title than before, so the tag grows", true);
+    tag.Update();
+    failures += check(!cache.Invalidate(names[0].c_str()), "update removes the entry");
+
+    ID3_Tag plain, cached;
+    plain.Link(names[0].c_str());
+    size_t misses = cache.GetMisses();
+    cached.Link(names[0].c_str(), cache);
+    failures += check(cache.GetMisses() == misses + 1 &&
+                      describe(cached) == describe(plain) &&
+                      describe(plain) != expected[0],
+                      "updated file is parsed again");
+
+    cached.Strip(ID3TT_ID3V1);
+    failures += check(!cache.Invalidate(names[0].c_str()), "strip removes the entry");
+    expected[0] = describe(plain);
+  }
+
+  {
+    // a change behind the cache's back
+    write(names[2], v1tag(), true);
+    ID3_Tag plain, cached;
+    plain.Link(names[2].c_str());
+    size_t misses = cache.GetMisses();
+    cached.Link(names[2].c_str(), cache);
+    failures += check(cache.GetMisses() == misses + 1 &&
+                      describe(cached) == describe(plain),
+                      "file changed elsewhere is parsed again");
+  }
+
+  {
+    // with every file cached, a batch only restores
+    vector<const char*> paths;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+      ID3_Tag tag;
+      tag.Link(names[i].c_str(), cache);
+      ID3_Tag plain;
+      plain.Link(names[i].c_str());
+      expected[i] = describe(plain);
+      paths.push_back(names[i].c_str());
+    }
+    ID3_Batch batch;
+    batch.SetCache(&cache);
+    batch.SetThreads(3);
+    size_t misses = cache.GetMisses();
+    Collector collector(paths.size());
+    batch.Parse(&paths[0], paths.size(), collector);
+    failures += check(cache.GetMisses() == misses && collector._found == expected,
+                      "batch through the cache");
+
+    Failer failer(paths.size(), 0);
+    batch.Parse(&paths[0], paths.size(), failer);
+    bool reported = failer._errors[0] == ID3E_InvalidTag && failer._frames[0] == 0;
+    for (size_t i = 1; i < paths.size(); ++i)
+    {
+      reported = reported && failer._errors[i] == ID3E_NoError;
+    }
+    failures += check(reported, "batch reports the file that failed");
+  }
+
+  {
+    size_t damaged = damageEntries();
+    size_t mismatches = 0;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+      ID3_Tag tag;
+      tag.Link(names[i].c_str(), cache);
+      if (describe(tag) != expected[i])
+      {
+        ++mismatches;
+      }
+    }
+    failures += check(damaged > 0 && mismatches == 0, "damaged entries are parsed again");
+  }
+
+#if defined(HAVE_UNISTD_H)
+  if (sizeof(size_t) > 4 && sizeof(off_t) > 4)
+  {
+    // a sparse file of 5 GiB keeps its size through the cache
+    const string big = string(DIRNAME) + "/big.mp3";
+    const off_t bigSize = ((off_t)5 << 16) << 14;
+    write(big, v2tag() + data);
+    if (truncate(big.c_str(), bigSize) == 0)
+    {
+      ID3_Tag plain, missed, hit;
+      plain.Link(big.c_str());
+      missed.Link(big.c_str(), cache);
+      hit.Link(big.c_str(), cache);
+      failures += check(plain.GetFileSize() == (size_t)bigSize &&
+                        missed.GetFileSize() == (size_t)bigSize &&
+                        hit.GetFileSize() == (size_t)bigSize,
+                        "file over 4 GiB keeps its size");
+    }
+    cache.Invalidate(big.c_str());
+    remove(big.c_str());
+  }
+#endif
+
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    cache.Invalidate(names[i].c_str());
+    remove(names[i].c_str());
+  }
+#if defined(HAVE_UNISTD_H)
+  rmdir(DIRNAME);
+#endif
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Writes an id3v2.2 tag with 5000 frames that are outdated in id3v2.4, half
+// of them year frames that are dropped and half involved people lists that
+// are converted, to test-check-frames.mp3, and updates it.  Checks that the
+// update drops and converts them all, reporting them to the tracer, and
+// that it takes a time linear in the number of frames.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <fstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/tracer.h"
+#include "synth_tags.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* FILENAME = "test-check-frames.mp3";
+
+  // a tag with a title and count outdated frames, then some audio
+  void writeFile(size_t count)
+  {
+    string frames = synth::v22Frame("TT2", string("\0The title", 10));
+    for (size_t i = 0; i < count; ++i)
+    {
+      char text[32];
+      if (i % 2 == 0)
+      {
+        sprintf(text, "%c%04lu", '\0', (unsigned long)(1900 + i % 100));
+        frames += synth::v22Frame("TYE", string(text, 5));
+      }
+      else
+      {
+        sprintf(text, "%cperson %lu", '\0', (unsigned long)i);
+        frames += synth::v22Frame("IPL", string(text, strlen(text + 1) + 1));
+      }
+    }
+    synth::Random rnd(1);
+    string data = synth::v22Tag(frames, false) + synth::mpegFrames(10, rnd);
+    ofstream file(FILENAME, ios::out | ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  // the seconds an update of a tag with count outdated frames takes
+  double update(size_t count, ID3_Tracer& tracer)
+  {
+    writeFile(count);
+    ID3_Tag tag(FILENAME);
+    tracer.Reset();
+    double beg = now();
+    tag.Update(ID3TT_ID3V2);
+    return now() - beg;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  const size_t COUNT = 5000;
+  size_t failures = 0;
+
+  ID3_Tracer tracer;
+  ID3_Tracer::Install(&tracer);
+
+  writeFile(COUNT);
+  {
+    ID3_Tag tag(FILENAME);
+    failures += check(tag.NumFrames() == 1 + COUNT &&
+                      tag.GetSpec() == ID3V2_2_1, "id3v2.2 tag parsed");
+    tracer.Reset();
+    tag.Update(ID3TT_ID3V2);
+    failures += check(tracer.GetCount(ID3_Tracer::DROPPEDFRAMES) == COUNT / 2 &&
+                      tracer.GetCount(ID3_Tracer::CONVERTEDFRAMES) == COUNT / 2,
+                      "outdated frames reported");
+    failures += check(tag.NumFrames() == 1 + COUNT / 2 &&
+                      tag.Find(ID3FID_YEAR) == NULL &&
+                      tag.Find(ID3FID_INVOLVEDPEOPLE) == NULL &&
+                      tag.Find(ID3FID_INVOLVEDPEOPLE2) != NULL,
+                      "outdated frames dropped and converted");
+  }
+  {
+    ID3_Tag tag(FILENAME);
+    size_t people = 0;
+    ID3_Tag::Iterator* iter = tag.CreateIterator();
+    ID3_Frame* frame = NULL;
+    while (NULL != (frame = iter->GetNext()))
+    {
+      people += frame->GetID() == ID3FID_INVOLVEDPEOPLE2;
+    }
+    delete iter;
+    failures += check(tag.GetSpec() == ID3V2_4_0 && people == COUNT / 2 &&
+                      tag.Find(ID3FID_TITLE) != NULL, "id3v2.4 tag written");
+  }
+
+  // a pass that restarts after every frame it drops takes four times as
+  // long for twice the frames, a linear one twice as long
+  update(COUNT / 4, tracer);
+  double small = update(COUNT / 2, tracer);
+  double large = update(COUNT * 2, tracer);
+  cout << "update of " << COUNT / 2 << " frames " << small * 1000 << " ms, of "
+       << COUNT * 2 << " frames " << large * 1000 << " ms" << endl;
+  failures += check(large < 8 * small || large < 0.05, "time linear in the frames");
+
+  ID3_Tracer::Install(NULL);
+  remove(FILENAME);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Copies a tag with large text and binary fields and checks that the copy
+// refers to the original's data rather than duplicating it, that changing
+// the copy leaves the original alone, and that many threads can copy, read,
+// change and drop copies of one tag at the same time.  Build the library and
+// this program with -fsanitize=thread to check for data races.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sstream>
+#if defined(HAVE_PTHREAD_H)
+# include <pthread.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/binary_store.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const size_t NUMTHREADS = 8;
+  const size_t NUMRUNS    = 100;
+  const size_t NUMCOPIES  = 20000;
+
+  string filler(size_t size, char first)
+  {
+    string data(size, ' ');
+    for (size_t i = 0; i < size; ++i)
+    {
+      data[i] = (char)(first + i % 26);
+    }
+    return data;
+  }
+
+  string render(const ID3_Tag& tag)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+    return os.str();
+  }
+
+  ID3_Field* field(const ID3_Tag& tag, ID3_FrameID id, ID3_FieldID fld)
+  {
+    ID3_Frame* frame = tag.Find(id);
+    return frame ? frame->GetField(fld) : NULL;
+  }
+
+  const void* text(const ID3_Tag& tag, ID3_FrameID id)
+  {
+    ID3_Field* fld = field(tag, id, ID3FN_TEXT);
+    return fld ? fld->GetRawText() : NULL;
+  }
+
+  const void* binary(const ID3_Tag& tag, ID3_FrameID id)
+  {
+    ID3_Field* fld = field(tag, id, ID3FN_DATA);
+    return fld ? fld->GetRawBinary() : NULL;
+  }
+
+  bool holds(const ID3_Tag& tag, ID3_FrameID id, const string& expected)
+  {
+    ID3_Field* fld = field(tag, id, ID3FN_TEXT);
+    return fld && fld->GetRawText() && expected == fld->GetRawText();
+  }
+
+  struct Job
+  {
+    const ID3_Tag* tag;
+    const string*  lyrics;
+    const string*  rendered;
+    size_t         mismatches;
+  };
+
+#if defined(HAVE_PTHREAD_H)
+  void* run(void* arg)
+  {
+    Job& job = *static_cast<Job*>(arg);
+    for (size_t i = 0; i < NUMRUNS; ++i)
+    {
+      ID3_Tag copy(*job.tag);
+      ID3_Tag second(copy);
+      if (!holds(copy, ID3FID_UNSYNCEDLYRICS, *job.lyrics) ||
+          render(second) != *job.rendered)
+      {
+        ++job.mismatches;
+      }
+      char changed[32];
+      sprintf(changed, "changed %lu", (unsigned long)i);
+      field(copy, ID3FID_UNSYNCEDLYRICS, ID3FN_TEXT)->Set(changed);
+      field(second, ID3FID_PICTURE, ID3FN_DATA)->Set((const uchar*)changed, strlen(changed));
+      if (!holds(copy, ID3FID_UNSYNCEDLYRICS, changed) ||
+          !holds(second, ID3FID_UNSYNCEDLYRICS, *job.lyrics) ||
+          render(*job.tag) != *job.rendered)
+      {
+        ++job.mismatches;
+      }
+    }
+    return NULL;
+  }
+#endif
+};
+
+int main(int argc, char *argv[])
+{
+  const string lyrics  = filler(4000, 'a');
+  const string comment = filler(600, 'A');
+  const string cover   = filler(200 * 1024, '0');
+  const string icon    = filler(500, 'k');
+
+  ID3_Tag tag;
+  ID3_AddTitle(&tag, "Title");
+  ID3_AddComment(&tag, comment.c_str(), "", "eng");
+  ID3_AddLyrics(&tag, lyrics.c_str(), "", "eng");
+  ID3_Frame* frame = new ID3_Frame(ID3FID_PICTURE);
+  frame->GetField(ID3FN_MIMETYPE)->Set("image/png");
+  frame->GetField(ID3FN_DATA)->Set((const uchar*)cover.data(), cover.size());
+  tag.AttachFrame(frame);
+  frame = new ID3_Frame(ID3FID_GENERALOBJECT);
+  frame->GetField(ID3FN_DATA)->Set((const uchar*)icon.data(), icon.size());
+  tag.AttachFrame(frame);
+  const string rendered = render(tag);
+
+  size_t failures = 0;
+  {
+    ID3_Tag copy(tag);
+    failures += check(render(copy) == rendered, "copy renders like the original");
+    failures += check(text(copy, ID3FID_UNSYNCEDLYRICS) == text(tag, ID3FID_UNSYNCEDLYRICS) &&
+                      text(copy, ID3FID_COMMENT) == text(tag, ID3FID_COMMENT),
+                      "copy shares large text");
+    failures += check(binary(copy, ID3FID_PICTURE) == binary(tag, ID3FID_PICTURE) &&
+                      binary(copy, ID3FID_GENERALOBJECT) == binary(tag, ID3FID_GENERALOBJECT),
+                      "copy shares large binary data");
+    failures += check(text(copy, ID3FID_TITLE) != text(tag, ID3FID_TITLE),
+                      "copy keeps small text to itself");
+
+    field(copy, ID3FID_UNSYNCEDLYRICS, ID3FN_TEXT)->Set("new lyrics");
+    failures += check(holds(copy, ID3FID_UNSYNCEDLYRICS, "new lyrics") &&
+                      holds(tag, ID3FID_UNSYNCEDLYRICS, lyrics) &&
+                      text(copy, ID3FID_COMMENT) == text(tag, ID3FID_COMMENT) &&
+                      binary(copy, ID3FID_PICTURE) == binary(tag, ID3FID_PICTURE),
+                      "changed text leaves the original and other frames alone");
+
+    field(copy, ID3FID_COMMENT, ID3FN_TEXT)->Add("second item");
+    failures += check(field(copy, ID3FID_COMMENT, ID3FN_TEXT)->GetNumTextItems() == 2 &&
+                      field(tag, ID3FID_COMMENT, ID3FN_TEXT)->GetNumTextItems() == 1 &&
+                      holds(tag, ID3FID_COMMENT, comment),
+                      "added item leaves the original alone");
+
+    ID3_Tag list(copy);
+    failures += check(field(list, ID3FID_COMMENT, ID3FN_TEXT)->GetNumTextItems() == 2 &&
+                      text(list, ID3FID_COMMENT) == text(copy, ID3FID_COMMENT),
+                      "copy of a list keeps all its items");
+
+    field(copy, ID3FID_GENERALOBJECT, ID3FN_DATA)->Set((const uchar*)"tiny", 4);
+    failures += check(field(copy, ID3FID_GENERALOBJECT, ID3FN_DATA)->Size() == 4 &&
+                      field(tag, ID3FID_GENERALOBJECT, ID3FN_DATA)->Size() == icon.size(),
+                      "changed binary data leaves the original alone");
+
+    field(copy, ID3FID_COMMENT, ID3FN_TEXT)->SetEncoding(ID3TE_UNICODE);
+    failures += check(holds(tag, ID3FID_COMMENT, comment) &&
+                      field(tag, ID3FID_COMMENT, ID3FN_TEXT)->GetEncoding() == ID3TE_ASCII,
+                      "re-encoded copy leaves the original alone");
+  }
+  failures += check(render(tag) == rendered, "original intact after the copy is gone");
+
+  {
+    clock_t start = clock();
+    for (size_t i = 0; i < NUMCOPIES; ++i)
+    {
+      ID3_Tag copy(tag);
+    }
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("     %lu copies of a %lu byte tag in %.2fs, %.0f copies/s\n",
+           (unsigned long)NUMCOPIES, (unsigned long)rendered.size(), secs,
+           secs > 0 ? NUMCOPIES / secs : 0.0);
+  }
+
+#if defined(HAVE_PTHREAD_H)
+  const ID3_Tag& ctag = tag;
+  Job jobs[NUMTHREADS];
+  pthread_t threads[NUMTHREADS];
+  for (size_t i = 0; i < NUMTHREADS; ++i)
+  {
+    jobs[i].tag = &ctag;
+    jobs[i].lyrics = &lyrics;
+    jobs[i].rendered = &rendered;
+    jobs[i].mismatches = 0;
+    pthread_create(&threads[i], NULL, run, &jobs[i]);
+  }
+  size_t mismatches = 0;
+  for (size_t i = 0; i < NUMTHREADS; ++i)
+  {
+    pthread_join(threads[i], NULL);
+    mismatches += jobs[i].mismatches;
+  }
+  cout << NUMTHREADS << " threads, " << NUMTHREADS * NUMRUNS * 2 << " copies, "
+       << mismatches << " mismatches" << endl;
+  failures += check(mismatches == 0, "concurrent copies of shared data");
+#else
+  cout << "no pthreads, concurrent copies not tested" << endl;
+#endif
+  failures += check(render(tag) == rendered &&
+                    ID3_BinaryStore::NumReferences() == 1,
+                    "original intact and sole owner of its picture");
+
+  return failures == 0 ? 0 : 1;
+}
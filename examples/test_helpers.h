@@ -0,0 +1,61 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_EXAMPLES_TEST_HELPERS_H_
+#define _ID3LIB_EXAMPLES_TEST_HELPERS_H_
+
+#include <stdio.h>
+#include <time.h>
+#include <string>
+#if defined(HAVE_SYS_TIME_H)
+# include <sys/time.h>
+#endif
+
+// What the tests and benchmarks of the examples have in common.
+namespace
+{
+  // the wall clock time in seconds
+  inline double now()
+  {
+#if defined(HAVE_SYS_TIME_H)
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+  }
+
+  // prints whether a check passed, returns the number of failures
+  inline size_t check(bool ok, const std::string& what)
+  {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what.c_str());
+    return ok ? 0 : 1;
+  }
+};
+
+#endif /* _ID3LIB_EXAMPLES_TEST_HELPERS_H_ */
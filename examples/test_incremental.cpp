@@ -0,0 +1,349 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Feeds the id3v2 tags of files to an ID3_IncrementalParser in chunks of
+// several sizes and checks that it hands out the frames linking the file
+// gives the tag, and that it hands them out as they arrive.  The files are
+// the sample files, looked for in the current directory, then in $srcdir, or
+// those given as arguments, and synthetic tags: unsynced, with an extended
+// header, and with a few thousand frames, e.g.
+//   testincremental [file...]
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/incremental_parser.h"
+#include "id3/readers.h"
+#include "id3/writers.h"
+#include "id3/misc_support.h"
+#include "synth_tags.h"
+
+using namespace std;
+
+namespace
+{
+  const char* SAMPLES[] =
+  {
+    "jules-goodtag.mp3", "crc53865.mp3", "thatspot.mp3", "win-xp.mp3",
+    "ozzy.tag", "230-picture.tag", "230-compressed.tag", "221-compressed.tag",
+    "230-unicode.tag", "230-syncedlyrics.tag"
+  };
+
+  const size_t CHUNKS[] = { 1, 7, 13, 4096, 0 };  // 0 for all at once
+
+  // keeps the frames handed out
+  class Frames : public ID3_IncrementalParser::Callback
+  {
+  public:
+    ~Frames()
+    {
+      for (size_t i = 0; i < _frames.size(); ++i)
+      {
+        delete _frames[i];
+      }
+    }
+    void Frame(ID3_Frame* frame) { _frames.push_back(frame); }
+    size_t Size() const { return _frames.size(); }
+
+    // hands the frames on to tag
+    void AttachTo(ID3_Tag& tag) const
+    {
+      for (size_t i = 0; i < _frames.size(); ++i)
+      {
+        tag.AttachFrame(new ID3_Frame(*_frames[i]));
+      }
+    }
+  private:
+    vector<ID3_Frame*> _frames;
+  };
+
+  bool readFile(const string& name, string& data)
+  {
+    ifstream file(name.c_str(), ios::in | ios::binary);
+    if (!file)
+    {
+      return false;
+    }
+    char buf[4096];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+    {
+      data.append(buf, file.gcount());
+    }
+    return true;
+  }
+
+  string render(const ID3_Tag& tag)
+  {
+    // Size() doesn't allow for all of the padding Render() adds
+    string buf(tag.Size() + 4096, '\0');
+    ID3_MemoryWriter writer(reinterpret_cast<uchar*>(&buf[0]), buf.size());
+    buf.resize(tag.Render(writer, ID3TT_ID3V2));
+    return buf;
+  }
+
+  // the frames of linked as they would be attached to a tag, and so to the
+  // tag the parser's frames are attached to
+  string renderFrames(const ID3_Tag& linked, ID3_V2Spec spec)
+  {
+    ID3_Tag tag;
+    tag.SetSpec(spec);
+    ID3_Tag::ConstIterator* iter = linked.CreateIterator();
+    for (const ID3_Frame* frame; (frame = iter->GetNext()) != NULL; )
+    {
+      tag.AttachFrame(new ID3_Frame(*frame));
+    }
+    delete iter;
+    return render(tag);
+  }
+
+  const uchar* bytes(const string& data)
+  {
+    return reinterpret_cast<const uchar*>(data.data());
+  }
+
+  // a tag with a picture holding bytes that have to be unsynced
+  string synthetic(bool unsync)
+  {
+    synth::Random rnd(11);
+    ID3_Tag tag;
+    tag.SetUnsync(unsync);
+    ID3_AddTitle(&tag, "Incremental");
+    ID3_AddArtist(&tag, "An artist");
+    string pic;
+    for (size_t i = 0; i < 20000; ++i)
+    {
+      pic += (char)(i % 3 ? rnd.Next() & 0xFF : 0xFF);
+    }
+    ID3_Frame* frame = new ID3_Frame(ID3FID_PICTURE);
+    frame->GetField(ID3FN_MIMETYPE)->Set("image/jpeg");
+    frame->GetField(ID3FN_DATA)->Set(bytes(pic), pic.size());
+    tag.AttachFrame(frame);
+    ID3_AddComment(&tag, "Comment", "", true);
+    return render(tag);
+  }
+
+  // the tag with an extended header, as id3lib doesn't render a readable one
+  string extended(const string& tag, ID3_V2Spec spec, bool crc)
+  {
+    string ext;
+    if (spec == ID3V2_4_0)
+    {
+      // the size of the header, 1 flag byte, no flags
+      ext.assign("\0\0\0\6\1\0", 6);
+    }
+    else
+    {
+      // the size after it, the flags, the size of the padding and a crc
+      ext.assign("\0\0\0\6\0\0\0\0\0\0", 10);
+      if (crc)
+      {
+        ext[3] = 10;
+        ext[4] = (char)0x80;
+        ext += "\x12\x34\x56\x78";
+      }
+    }
+    string data = tag;
+    data[3] = spec == ID3V2_4_0 ? 4 : 3;
+    data[5] |= 0x40;
+    data.insert(10, ext);
+    uint32 size = 0;
+    for (size_t i = 6; i < 10; ++i)
+    {
+      size = (size << 7) | (data[i] & 0x7F);
+    }
+    size += ext.size();
+    for (size_t i = 9; i >= 6; --i, size >>= 7)
+    {
+      data[i] = (char)(size & 0x7F);
+    }
+    return data;
+  }
+
+  // an id3v2.2 tag with thousands of frames, compressed or not
+  string manyFrames(bool compress)
+  {
+    string frames;
+    char text[32];
+    for (size_t i = 0; i < 3000; ++i)
+    {
+      sprintf(text, "%c%lu", '\0', (unsigned long)i);
+      frames += synth::v22Frame(i ? "TXX" : "TT2", string(text, 1 + strlen(text + 1)));
+    }
+    return synth::v22Tag(frames, compress);
+  }
+
+  // linking skips the padding after a tag along with it
+  bool paddingTo(const string& data, size_t beg, size_t end)
+  {
+    return beg <= end && data.find_first_not_of('\0', beg) >= end;
+  }
+
+  size_t check(const string& name, const string& data)
+  {
+    ID3_Tag linked;
+    ID3_MemoryReader reader(bytes(data), data.size());
+    linked.Link(reader, ID3TT_ID3V2);
+
+    size_t failures = 0;
+    for (size_t i = 0; i < sizeof(CHUNKS) / sizeof(CHUNKS[0]); ++i)
+    {
+      const size_t chunk = CHUNKS[i] ? CHUNKS[i] : data.size();
+      Frames frames;
+      ID3_IncrementalParser parser(frames);
+      size_t used = 0;
+      for (size_t pos = 0; pos < data.size() && !parser.IsDone(); pos += chunk)
+      {
+        size_t size = data.size() - pos < chunk ? data.size() - pos : chunk;
+        used += parser.Feed(bytes(data) + pos, size);
+      }
+      ID3_Tag tag;
+      tag.SetSpec(parser.GetSpec());
+      frames.AttachTo(tag);
+      const char* diff = NULL;
+      if (!parser.IsDone() || parser.GetBytesNeeded() != 0)
+      {
+        diff = "not done";
+      }
+      else if (parser.HasTag() != linked.HasTagType(ID3TT_ID3V2))
+      {
+        diff = "has tag";
+      }
+      else if (parser.HasTag() && (used != parser.GetTagSize() ||
+                                   !paddingTo(data, used, linked.GetPrependedBytes())))
+      {
+        diff = "bytes used";
+      }
+      else if (parser.NumFrames() != frames.Size() ||
+               parser.NumFrames() < linked.NumFrames())
+      {
+        diff = "number of frames";
+      }
+      else if (render(tag) != renderFrames(linked, parser.GetSpec()))
+      {
+        diff = "frames";
+      }
+      if (diff != NULL)
+      {
+        printf("FAIL %s in chunks of %lu: %s\n", name.c_str(),
+               (unsigned long)chunk, diff);
+        ++failures;
+      }
+    }
+    if (failures == 0)
+    {
+      printf("ok   %s, %lu frames\n", name.c_str(), (unsigned long)linked.NumFrames());
+    }
+    return failures;
+  }
+
+  // the frames are handed out before the tag is complete, and the parser
+  // asks only for the frame it is waiting for
+  size_t checkEarly(const string& name, const string& data, size_t expected)
+  {
+    Frames frames;
+    ID3_IncrementalParser parser(frames);
+    const size_t half = data.size() / 2;
+    size_t used = parser.Feed(bytes(data), half);
+    const size_t early = frames.Size();
+    const size_t needed = parser.GetBytesNeeded();
+    bool ok = used == half && early > 0 && early < expected &&
+      needed > 0 && needed < half;
+    used += parser.Feed(bytes(data) + half, data.size() - half);
+    ok = ok && used == parser.GetTagSize() && frames.Size() == expected;
+    printf("%s %s: %lu of %lu frames after half, %lu bytes needed\n",
+           ok ? "ok  " : "FAIL", name.c_str(), (unsigned long)early,
+           (unsigned long)frames.Size(), (unsigned long)needed);
+    return ok ? 0 : 1;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t failures = 0;
+  size_t found = 0;
+  const size_t numSamples = argc > 1 ? argc - 1 : sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    string name = argc > 1 ? argv[i + 1] : SAMPLES[i];
+    string data;
+    if (!readFile(name, data) && argc == 1 && getenv("srcdir"))
+    {
+      name = string(getenv("srcdir")) + "/" + name;
+      readFile(name, data);
+    }
+    if (data.empty())
+    {
+      continue;
+    }
+    ++found;
+    failures += check(name, data);
+  }
+  if (found == 0)
+  {
+    printf("FAIL no sample files found\n");
+    ++failures;
+  }
+  if (argc > 1)
+  {
+    return failures == 0 ? 0 : 1;
+  }
+
+  const string unsynced = synthetic(true);
+  const string synced = synthetic(false);
+  failures += check("unsynced", unsynced + "audio");
+  failures += check("extended id3v2.3", extended(synced, ID3V2_3_0, false));
+  failures += check("extended id3v2.3 crc", extended(synced, ID3V2_3_0, true));
+  failures += check("extended id3v2.4", extended(synced, ID3V2_4_0, false));
+  failures += check("extended unsynced", extended(unsynced, ID3V2_4_0, false));
+  failures += check("many frames", manyFrames(false));
+  failures += check("many compressed frames", manyFrames(true));
+  failures += check("no tag", "not a tag at all");
+  failures += checkEarly("unsynced", unsynced, 4);
+  failures += checkEarly("many frames", manyFrames(false), 3000);
+
+  // the bytes after the tag are left alone
+  Frames frames;
+  ID3_IncrementalParser parser(frames);
+  const string data = unsynced + "audio";
+  size_t used = parser.Feed(bytes(data), data.size());
+  bool ok = (unsynced[5] & 0x80) && parser.IsDone() && parser.HasTag() &&
+    used == unsynced.size() &&
+    parser.GetTagSize() == unsynced.size() && parser.Feed(bytes(data), 5) == 0;
+  printf("%s %lu of %lu bytes used\n", ok ? "ok  " : "FAIL",
+         (unsigned long)used, (unsigned long)data.size());
+  failures += !ok;
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Parses an album whose tracks all carry the same picture, in memory and on
+// several threads with ID3_Batch, and checks that the tags share a single
+// copy of it through ID3_BinaryStore, that changing one track's picture
+// leaves the others alone and that the copy goes away with the last tag.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+#if defined(HAVE_SYS_TYPES_H)
+# include <sys/types.h>
+#endif
+#if defined(HAVE_SYS_STAT_H)
+# include <sys/stat.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/batch.h"
+#include "id3/binary_store.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* DIRNAME = "test-intern.d";
+  const size_t TRACKS = 12;
+  const size_t PICTURE_SIZE = 500 * 1024;
+
+  string picture(size_t size, size_t seed)
+  {
+    string data(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+      data[i] = (char)((i * 31 + seed * 7) ^ (i >> 8));
+    }
+    return data;
+  }
+
+  string render(const ID3_Tag& tag)
+  {
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+    return os.str();
+  }
+
+  string track(size_t i, const string& cover)
+  {
+    ID3_Tag tag;
+    char title[32];
+    sprintf(title, "Track %lu", (unsigned long)(i + 1));
+    ID3_AddTitle(&tag, title);
+    ID3_AddAlbum(&tag, "The album");
+    ID3_AddTrack(&tag, (uchar)(i + 1), TRACKS);
+    ID3_Frame* frame = new ID3_Frame(ID3FID_PICTURE);
+    frame->GetField(ID3FN_MIMETYPE)->Set("image/jpeg");
+    frame->GetField(ID3FN_PICTURETYPE)->Set(ID3PT_COVERFRONT);
+    frame->GetField(ID3FN_DATA)->Set(reinterpret_cast<const uchar*>(cover.data()), cover.size());
+    tag.AttachFrame(frame);
+    return render(tag);
+  }
+
+  ID3_Field* data(const ID3_Tag& tag)
+  {
+    ID3_Frame* frame = tag.Find(ID3FID_PICTURE);
+    return frame ? frame->GetField(ID3FN_DATA) : NULL;
+  }
+
+  bool holds(const ID3_Tag& tag, const string& cover)
+  {
+    ID3_Field* fld = data(tag);
+    return fld && fld->Size() == cover.size() &&
+           memcmp(fld->GetRawBinary(), cover.data(), cover.size()) == 0;
+  }
+
+  class Keeper : public ID3_Batch::Handler
+  {
+  public:
+    Keeper(size_t count) : _tags(count, (ID3_Tag*)NULL) { }
+    ~Keeper()
+    {
+      for (size_t i = 0; i < _tags.size(); ++i)
+      {
+        delete _tags[i];
+      }
+    }
+    bool Handle(size_t index, const char* path, ID3_Tag& tag)
+    {
+      _tags[index] = new ID3_Tag(tag);
+      return true;
+    }
+    vector<ID3_Tag*> _tags;
+  };
+};
+
+int main(int argc, char *argv[])
+{
+  const string cover = picture(PICTURE_SIZE, 1);
+  const string other = picture(PICTURE_SIZE, 2);
+  vector<string> album;
+  for (size_t i = 0; i < TRACKS; ++i)
+  {
+    album.push_back(track(i, cover));
+  }
+
+  size_t failures = 0;
+  failures += check(ID3_BinaryStore::NumPayloads() == 0 && ID3_BinaryStore::NumBytes() == 0,
+                    "store empty without tags");
+  {
+    vector<ID3_Tag*> tags;
+    size_t fieldBytes = 0;
+    for (size_t i = 0; i < TRACKS; ++i)
+    {
+      tags.push_back(new ID3_Tag);
+      tags.back()->Parse(reinterpret_cast<const uchar*>(album[i].data()), album[i].size());
+      fieldBytes += data(*tags.back()) ? data(*tags.back())->Size() : 0;
+    }
+    bool all = true;
+    for (size_t i = 0; i < TRACKS; ++i)
+    {
+      all = all && holds(*tags[i], cover);
+    }
+    failures += check(all && ID3_BinaryStore::NumPayloads() == 1 &&
+                      ID3_BinaryStore::NumReferences() == TRACKS &&
+                      ID3_BinaryStore::NumBytes() == PICTURE_SIZE,
+                      "parsed album shares one picture");
+    printf("     %lu bytes of pictures held in %lu bytes, %.1fx less\n",
+           (unsigned long)fieldBytes, (unsigned long)ID3_BinaryStore::NumBytes(),
+           ID3_BinaryStore::NumBytes() ? (double)fieldBytes / ID3_BinaryStore::NumBytes() : 0.0);
+
+    ID3_Tag copy(*tags[0]);
+    failures += check(holds(copy, cover) && ID3_BinaryStore::NumPayloads() == 1 &&
+                      ID3_BinaryStore::NumReferences() == TRACKS + 1 &&
+                      render(copy) == render(*tags[0]),
+                      "copied tag refers to the same picture");
+
+    data(*tags[0])->Set(reinterpret_cast<const uchar*>(other.data()), other.size());
+    bool others = true;
+    for (size_t i = 1; i < TRACKS; ++i)
+    {
+      others = others && holds(*tags[i], cover);
+    }
+    failures += check(holds(*tags[0], other) && holds(copy, cover) && others &&
+                      ID3_BinaryStore::NumPayloads() == 2 &&
+                      ID3_BinaryStore::NumBytes() == 2 * PICTURE_SIZE,
+                      "changed picture leaves the other tracks alone");
+
+    data(*tags[1])->Set(reinterpret_cast<const uchar*>("small"), 5);
+    failures += check(data(*tags[1])->Size() == 5 && holds(*tags[2], cover) &&
+                      ID3_BinaryStore::NumReferences() == TRACKS,
+                      "small data isn't shared");
+
+    for (size_t i = 0; i < TRACKS; ++i)
+    {
+      delete tags[i];
+    }
+    failures += check(ID3_BinaryStore::NumPayloads() == 1 &&
+                      ID3_BinaryStore::NumReferences() == 1,
+                      "deleted tags let go of their pictures");
+  }
+  failures += check(ID3_BinaryStore::NumPayloads() == 0 && ID3_BinaryStore::NumBytes() == 0,
+                    "last tag frees the picture");
+
+  {
+#if defined(HAVE_SYS_STAT_H)
+    mkdir(DIRNAME, 0777);
+#endif
+    vector<string> names;
+    vector<const char*> paths;
+    for (size_t i = 0; i < TRACKS; ++i)
+    {
+      char name[64];
+      sprintf(name, "%s/%02lu.mp3", DIRNAME, (unsigned long)(i + 1));
+      names.push_back(name);
+      ofstream file(name, ios::out | ios::binary | ios::trunc);
+      file.write(album[i].data(), album[i].size());
+    }
+    for (size_t i = 0; i < TRACKS; ++i)
+    {
+      paths.push_back(names[i].c_str());
+    }
+
+    ID3_Batch batch;
+    batch.SetThreads(4);
+    Keeper keeper(TRACKS);
+    batch.Parse(&paths[0], paths.size(), keeper);
+    bool all = true;
+    for (size_t i = 0; i < TRACKS; ++i)
+    {
+      all = all && keeper._tags[i] && holds(*keeper._tags[i], cover);
+    }
+    failures += check(all && ID3_BinaryStore::NumPayloads() == 1 &&
+                      ID3_BinaryStore::NumReferences() == TRACKS,
+                      "album parsed on 4 threads shares one picture");
+  }
+  failures += check(ID3_BinaryStore::NumPayloads() == 0, "store empty again");
+
+  {
+    ID3_BinaryStore::SetThreshold(0);
+    ID3_Tag first, second;
+    first.Parse(reinterpret_cast<const uchar*>(album[0].data()), album[0].size());
+    second.Parse(reinterpret_cast<const uchar*>(album[1].data()), album[1].size());
+    failures += check(holds(first, cover) && holds(second, cover) &&
+                      ID3_BinaryStore::NumPayloads() == 0,
+                      "threshold 0 turns sharing off");
+    ID3_BinaryStore::SetThreshold(1024);
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Feeds files to an ID3_StreamParser in chunks of several sizes and checks
+// that the tag ends up as linking the file gives it: the same frames, tags,
+// sizes and mp3 header.  The files are the sample files, looked for in the
+// current directory, then in $srcdir, or those given as arguments, and
+// synthetic ones, with tags at both ends and with a late mp3 header, e.g.
+//   teststream [file...]
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <fstream>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/stream_parser.h"
+#include "id3/readers.h"
+#include "id3/writers.h"
+#include "id3/misc_support.h"
+#include "synth_tags.h"
+
+using namespace std;
+
+namespace
+{
+  const char* SAMPLES[] =
+  {
+    "jules.mp3", "jules-goodtag.mp3", "jules-badtag.mp3", "crc53865.mp3",
+    "thatspot.mp3", "win-xp.mp3", "ozzy.tag", "230-picture.tag",
+    "221-compressed.tag", "230-unicode.tag"
+  };
+
+  const size_t CHUNKS[] = { 1, 13, 4096, 0 };  // 0 for all at once
+
+  bool readFile(const string& name, string& data)
+  {
+    ifstream file(name.c_str(), ios::in | ios::binary);
+    if (!file)
+    {
+      return false;
+    }
+    char buf[4096];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+    {
+      data.append(buf, file.gcount());
+    }
+    return true;
+  }
+
+  string render(const ID3_Tag& tag, ID3_TagType tt)
+  {
+    // Size() doesn't allow for all of the padding Render() adds
+    string buf(tag.Size() + 4096, '\0');
+    ID3_MemoryWriter writer(reinterpret_cast<uchar*>(&buf[0]), buf.size());
+    buf.resize(tag.Render(writer, tt));
+    return buf;
+  }
+
+  // mp3 frames between an id3v2 tag with a picture and MusicMatch, Lyrics3
+  // and id3v1 tags
+  string synthetic()
+  {
+    synth::Random rnd(7);
+    string frames = synth::v22Frame("TT2", string("\0Streamed", 9));
+    frames += synth::v22Frame("TP1", string("\0An artist", 10));
+    string pic("\0JPG\3\0", 6);
+    pic += synth::text(40000, rnd);
+    frames += synth::v22Frame("PIC", pic);
+    string v2 = synth::v22Tag(frames, false);
+    synth::padV2Tag(v2, 1000);
+
+    ID3_Tag v1;
+    ID3_AddTitle(&v1, "Streamed");
+    ID3_AddArtist(&v1, "An artist");
+    return v2 + synth::mpegFrames(400, rnd) +
+      synth::musicMatch("Streamed", "An artist", "An album", string(1024, 'i')) +
+      synth::lyrics3v2("Streamed", synth::text(2000, rnd)) +
+      render(v1, ID3TT_ID3V1);
+  }
+
+  bool sameMp3Header(const Mp3_Headerinfo* a, const Mp3_Headerinfo* b)
+  {
+    if (a == NULL || b == NULL)
+    {
+      return a == b;
+    }
+    return a->bitrate == b->bitrate && a->frequency == b->frequency &&
+      a->frames == b->frames && a->time == b->time &&
+      a->datasize == b->datasize && a->vbrheader == b->vbrheader;
+  }
+
+  // what differs between the tag linked and the tag streamed, if anything
+  const char* compare(ID3_Tag& linked, ID3_Tag& streamed)
+  {
+    const ID3_TagType types[] =
+    {
+      ID3TT_ID3V1, ID3TT_LYRICS3, ID3TT_LYRICS3V2, ID3TT_MUSICMATCH, ID3TT_ID3V2
+    };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i)
+    {
+      if (linked.HasTagType(types[i]) != streamed.HasTagType(types[i]))
+      {
+        return "tag types";
+      }
+    }
+    if (linked.NumFrames() != streamed.NumFrames())
+    {
+      return "number of frames";
+    }
+    if (render(linked, ID3TT_ID3V2) != render(streamed, ID3TT_ID3V2))
+    {
+      return "frames";
+    }
+    if (linked.GetPrependedBytes() != streamed.GetPrependedBytes() ||
+        linked.GetAppendedBytes() != streamed.GetAppendedBytes() ||
+        linked.GetFileSize() != streamed.GetFileSize())
+    {
+      return "sizes";
+    }
+    if (!sameMp3Header(linked.GetMp3HeaderInfo(), streamed.GetMp3HeaderInfo()))
+    {
+      return "mp3 header";
+    }
+    return NULL;
+  }
+
+  size_t check(const string& name, const string& data,
+               flags_t flags = (flags_t) ID3TT_ALL)
+  {
+    ID3_Tag linked;
+    ID3_MemoryReader reader(reinterpret_cast<const uchar*>(data.data()), data.size());
+    linked.Link(reader, flags);
+
+    size_t failures = 0;
+    for (size_t i = 0; i < sizeof(CHUNKS) / sizeof(CHUNKS[0]); ++i)
+    {
+      size_t chunk = CHUNKS[i] ? CHUNKS[i] : data.size();
+      ID3_Tag streamed;
+      ID3_StreamParser parser(streamed, flags);
+      for (size_t pos = 0; pos < data.size(); pos += chunk)
+      {
+        size_t size = data.size() - pos < chunk ? data.size() - pos : chunk;
+        parser.Feed(reinterpret_cast<const uchar*>(data.data()) + pos, size);
+      }
+      parser.Finish();
+      const char* diff = compare(linked, streamed);
+      if (diff != NULL || parser.GetBytesFed() != data.size())
+      {
+        printf("FAIL %s in chunks of %lu: %s\n", name.c_str(),
+               (unsigned long)chunk, diff ? diff : "bytes fed");
+        ++failures;
+      }
+    }
+    if (failures == 0)
+    {
+      printf("ok   %s, %lu frames\n", name.c_str(), (unsigned long)linked.NumFrames());
+    }
+    return failures;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  size_t failures = 0;
+  size_t found = 0;
+  const size_t numSamples = argc > 1 ? argc - 1 : sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    string name = argc > 1 ? argv[i + 1] : SAMPLES[i];
+    string data;
+    if (!readFile(name, data) && argc == 1 && getenv("srcdir"))
+    {
+      name = string(getenv("srcdir")) + "/" + name;
+      readFile(name, data);
+    }
+    if (data.empty())
+    {
+      continue;
+    }
+    ++found;
+    failures += check(name, data);
+  }
+  if (found == 0)
+  {
+    printf("FAIL no sample files found\n");
+    ++failures;
+  }
+
+  const string data = synthetic();
+  failures += check("synthetic", data);
+  {
+    // without a tail, and the mp3 header just inside the part of the stream
+    // kept after the leading tag
+    synth::Random rnd(3);
+    string late = synth::v22Tag(synth::v22Frame("TT2", string("\0Late", 5)), false);
+    late += string(8180, 'j') + synth::mpegFrames(20, rnd);
+    failures += check("synthetic, late mp3 header, no tail", late, ID3TT_ID3V2);
+  }
+  {
+    ID3_Tag tag;
+    ID3_StreamParser parser(tag);
+    parser.Feed(reinterpret_cast<const uchar*>(data.data()), data.size());
+    parser.Finish();
+    bool all = tag.HasTagType(ID3TT_ID3V2) && tag.HasTagType(ID3TT_MUSICMATCH) &&
+      tag.HasTagType(ID3TT_LYRICS3V2) && tag.HasTagType(ID3TT_ID3V1);
+    printf("%s synthetic has tags at both ends\n", all ? "ok  " : "FAIL");
+    failures += !all;
+  }
+
+  // the leading tag and the mp3 header are there long before the end
+  ID3_Tag tag;
+  ID3_StreamParser parser(tag);
+  size_t pos = 0;
+  for (; pos < data.size() && !parser.HasHead(); pos += 1000)
+  {
+    parser.Feed(reinterpret_cast<const uchar*>(data.data()) + pos,
+                data.size() - pos < 1000 ? data.size() - pos : 1000);
+  }
+  char* title = ID3_GetTitle(&tag);
+  bool early = parser.HasHead() && pos < data.size() / 2 &&
+    title != NULL && strcmp(title, "Streamed") == 0 &&
+    tag.GetMp3HeaderInfo() != NULL && tag.GetMp3HeaderInfo()->bitrate == MP3BITRATE_128K;
+  delete [] title;
+  printf("%s head parsed after %lu of %lu bytes\n", early ? "ok  " : "FAIL",
+         (unsigned long)pos, (unsigned long)data.size());
+  failures += !early;
+
+  return failures == 0 ? 0 : 1;
+}
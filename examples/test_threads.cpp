@@ -0,0 +1,267 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Queries one tag through its const interface from several threads at once
+// and compares the answers with those of a single thread.  Build the library
+// and this program with -fsanitize=thread to check for data races.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <string.h>
+#include <sstream>
+#if defined(HAVE_PTHREAD_H)
+# include <pthread.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const size_t NUMTHREADS = 8;
+  const size_t NUMRUNS    = 200;
+  const size_t NUMCURSOR  = 4;
+
+  string getString(const ID3_Frame* frame, ID3_FieldID fld)
+  {
+    char* str = ID3_GetString(frame, fld);
+    string result = str ? str : "";
+    ID3_FreeString(str);
+    return result;
+  }
+
+  struct Answers
+  {
+    size_t           size;
+    unsigned long    sum;
+    bool             changed;
+    const ID3_Frame* title;
+    const ID3_Frame* comment;
+    const ID3_Frame* track;
+    const ID3_Frame* next[NUMCURSOR];
+    string           text;
+    string           usertext;
+
+    bool operator==(const Answers& rhs) const
+    {
+      for (size_t i = 0; i < NUMCURSOR; ++i)
+      {
+        if (next[i] != rhs.next[i])
+        {
+          return false;
+        }
+      }
+      return size == rhs.size && sum == rhs.sum && changed == rhs.changed &&
+        title == rhs.title && comment == rhs.comment && track == rhs.track &&
+        text == rhs.text && usertext == rhs.usertext;
+    }
+  };
+
+  Answers query(const ID3_Tag& tag)
+  {
+    Answers a;
+    a.size = tag.Size();
+
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+    string data = os.str();
+    a.sum = 2166136261UL;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      a.sum = ((a.sum ^ (unsigned char)data[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    a.changed = tag.HasChanged();
+    a.title   = tag.FindFirst(ID3FID_TITLE);
+    a.comment = tag.FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, "two");
+    a.track   = tag.FindFirst(ID3FID_TRACKNUM, ID3FN_TEXTENC, (uint32)ID3TE_ISO8859_1);
+
+    ID3_Tag::Cursor cursor;
+    for (size_t i = 0; i < NUMCURSOR; ++i)
+    {
+      a.next[i] = tag.Find(cursor, ID3FID_COMMENT);
+    }
+
+    char* str = ID3_GetComment(&tag);
+    a.text = str ? str : "";
+    ID3_FreeString(str);
+    a.usertext = getString(tag.FindFirst(ID3FID_USERTEXT), ID3FN_TEXT);
+    return a;
+  }
+
+  struct Job
+  {
+    const ID3_Tag* tag;
+    const Answers* expected;
+    size_t         mismatches;
+  };
+
+  void* run(void* arg)
+  {
+    Job* job = static_cast<Job*>(arg);
+    for (size_t i = 0; i < NUMRUNS; ++i)
+    {
+      if (!(query(*job->tag) == *job->expected))
+      {
+        ++job->mismatches;
+      }
+    }
+    return NULL;
+  }
+
+  // walks a cursor through count comments, back to the first one
+  double walk(size_t count, size_t& steps)
+  {
+    ID3_Tag tag;
+    for (size_t i = 0; i < count; ++i)
+    {
+      ID3_Frame* frame = new ID3_Frame(ID3FID_COMMENT);
+      tag.AttachFrame(frame);
+      tag.AttachFrame(new ID3_Frame(ID3FID_TITLE));
+    }
+    const ID3_Tag& ctag = tag;
+    ID3_Tag::Cursor cursor;
+    const ID3_Frame* first = ctag.Find(cursor, ID3FID_COMMENT);
+    steps = 0;
+    double beg = now();
+    do
+    {
+      ++steps;
+    }
+    while (ctag.Find(cursor, ID3FID_COMMENT) != first && steps <= count);
+    return now() - beg;
+  }
+
+  // a cursor left in a tag that is gone, with a new tag likely in its place
+  bool staleCursor()
+  {
+    ID3_Tag::Cursor cursor;
+    ID3_Tag* tag = new ID3_Tag;
+    ID3_AddComment(tag, "old comment", "old");
+    tag->Find(cursor, ID3FID_COMMENT);
+    delete tag;
+
+    tag = new ID3_Tag;
+    ID3_Frame* first = ID3_AddComment(tag, "first comment", "one");
+    ID3_AddComment(tag, "second comment", "two");
+    bool ok = tag->Find(cursor, ID3FID_COMMENT) == first;
+    delete tag;
+    return ok;
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  ID3_Tag tag;
+  ID3_AddTitle(&tag, "Title");
+  ID3_AddArtist(&tag, "Artist");
+  ID3_AddComment(&tag, "v1 comment", STR_V1_COMMENT_DESC);
+  ID3_AddComment(&tag, "first comment", "one");
+  ID3_AddComment(&tag, "second comment", "two");
+  ID3_AddTrack(&tag, 3, 12);
+
+  // a unicode frame whose description has yet to be converted to the frame's
+  // encoding
+  ID3_Frame* frame = new ID3_Frame(ID3FID_USERTEXT);
+  frame->GetField(ID3FN_TEXTENC)->Set(ID3TE_UTF16);
+  frame->GetField(ID3FN_DESCRIPTION)->Set("description");
+  frame->GetField(ID3FN_TEXT)->Set("user text");
+  frame->GetField(ID3FN_TEXT)->SetEncoding(ID3TE_UTF16);
+  tag.AttachFrame(frame);
+
+  const ID3_Tag& ctag = tag;
+  const Answers expected = query(ctag);
+
+  size_t failures = 0;
+  failures += check(expected.changed, "rendering leaves the tag changed");
+  failures += check(expected.title != NULL && ctag.FindFirst(ID3FID_TITLE) == expected.title,
+                    "FindFirst returns the first frame every time");
+  failures += check(expected.comment != NULL &&
+                    getString(expected.comment, ID3FN_TEXT) == "second comment",
+                    "FindFirst by field");
+  failures += check(expected.next[0] != expected.next[1] &&
+                    expected.next[1] != expected.next[2] &&
+                    expected.next[0] != expected.next[2] &&
+                    expected.next[3] == expected.next[0],
+                    "cursor steps through all comments and wraps");
+  failures += check(expected.text == "first comment", "ID3_GetComment skips the v1 comment");
+  failures += check(expected.usertext == "user text", "ID3_GetString converts a copy");
+
+  ID3_Frame* legacy[NUMCURSOR];
+  for (size_t i = 0; i < NUMCURSOR; ++i)
+  {
+    legacy[i] = ctag.Find(ID3FID_COMMENT);
+  }
+  failures += check(memcmp(legacy, expected.next, sizeof(legacy)) == 0,
+                    "Find steps through all comments and wraps");
+  failures += check(staleCursor(), "a cursor left in a deleted tag starts over");
+
+  // a cursor that searches from the first frame again for each match takes
+  // four times as long for twice the frames, one that continues where it
+  // stopped twice as long
+  const size_t WALK = 4000;
+  size_t smallSteps = 0, largeSteps = 0;
+  walk(WALK / 2, smallSteps);
+  double small = walk(WALK, smallSteps);
+  double large = walk(WALK * 4, largeSteps);
+  cout << "cursor walk of " << WALK << " comments " << small * 1000 << " ms, of "
+       << WALK * 4 << " comments " << large * 1000 << " ms" << endl;
+  failures += check(smallSteps == WALK && largeSteps == WALK * 4,
+                    "cursor walks through all comments once");
+  failures += check(large < 8 * small || large < 0.05, "cursor walk linear in the frames");
+
+#if defined(HAVE_PTHREAD_H)
+  Job jobs[NUMTHREADS];
+  pthread_t threads[NUMTHREADS];
+  for (size_t i = 0; i < NUMTHREADS; ++i)
+  {
+    jobs[i].tag = &ctag;
+    jobs[i].expected = &expected;
+    jobs[i].mismatches = 0;
+    pthread_create(&threads[i], NULL, run, &jobs[i]);
+  }
+  size_t mismatches = 0;
+  for (size_t i = 0; i < NUMTHREADS; ++i)
+  {
+    pthread_join(threads[i], NULL);
+    mismatches += jobs[i].mismatches;
+  }
+  cout << NUMTHREADS << " threads, " << NUMTHREADS * NUMRUNS << " queries, "
+       << mismatches << " mismatches" << endl;
+  failures += check(mismatches == 0, "concurrent const queries");
+#else
+  cout << "no pthreads, concurrent queries not tested" << endl;
+#endif
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+// Installs an ID3_Tracer and checks what it is told while tags are parsed
+// and written: bytes read, seeks, frames, decompressed bytes, text
+// conversions, buffers, in-place writes and rewrites, and the time of each
+// stage.  Also checks that a tracer sees only the work of its own thread,
+// and the statistics of a parse kept by the tag itself.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#if defined(HAVE_PTHREAD_H)
+# include <pthread.h>
+#endif
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/tracer.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const char* FILENAME = "test-tracer.mp3";
+  const size_t AUDIOSIZE = 8192;
+
+  // remembers the order of the frames
+  class FrameLog : public ID3_Tracer
+  {
+  public:
+    void FrameParsed(ID3_FrameID id, size_t size)
+    {
+      ids.push_back(id);
+      ID3_Tracer::FrameParsed(id, size);
+    }
+    vector<ID3_FrameID> ids;
+  };
+
+  string words(size_t size)
+  {
+    string text;
+    while (text.size() < size)
+    {
+      text += "tracing the tags ";
+    }
+    text.resize(size);
+    return text;
+  }
+
+  size_t writeFile(const char* name, size_t comments)
+  {
+    ID3_Tag tag;
+    ID3_AddTitle(&tag, "The title");
+    ID3_AddArtist(&tag, "The artist");
+    for (size_t i = 0; i < comments; ++i)
+    {
+      char desc[32];
+      sprintf(desc, "comment %lu", (unsigned long)i);
+      ID3_AddComment(&tag, words(100).c_str(), desc, "eng");
+    }
+    ID3_Frame* frame = new ID3_Frame(ID3FID_UNSYNCEDLYRICS);
+    frame->GetField(ID3FN_LANGUAGE)->Set("eng");
+    frame->GetField(ID3FN_TEXT)->Set(words(4000).c_str());
+    frame->SetCompression(true);
+    tag.AttachFrame(frame);
+
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+    tag.Render(writer, ID3TT_ID3V1);
+    string data = os.str();
+    // the audio goes between the two tags
+    data.insert(data.size() - ID3_V1_LEN, string(AUDIOSIZE, '\x55'));
+    ofstream file(name, ios::out | ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+    return data.size();
+  }
+
+  string rawFrame(const char* id, const string& data)
+  {
+    string frame(id, 4);
+    for (size_t i = 4; i > 0; --i)
+    {
+      frame += (char)((data.size() >> (8 * (i - 1))) & 0xFF);
+    }
+    frame.append(2, '\0');
+    return frame + data;
+  }
+
+  // an unsynchronized id3v2.3 tag with a title, an artist, a frame of an
+  // unknown id and a user text frame cut short by the end of the tag,
+  // followed by audio
+  void writeRawFile(const char* name)
+  {
+    string frames = rawFrame("TIT2", string("\0The title", 10)) +
+                    rawFrame("TPE1", string("\0The artist", 11)) +
+                    rawFrame("XYZW", "abcd") +
+                    rawFrame("TXXX", string(100, 'x')).substr(0, 14);
+    string data = "ID3";
+    data += (char)3;
+    data += (char)0;
+    data += (char)0x80;
+    for (size_t i = 4; i > 0; --i)
+    {
+      data += (char)((frames.size() >> (7 * (i - 1))) & 0x7F);
+    }
+    data += frames;
+    data.append(AUDIOSIZE, '\x55');
+    ofstream file(name, ios::out | ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+#if defined(HAVE_PTHREAD_H)
+  struct Job
+  {
+    const char* name;
+    size_t      frames;
+  };
+
+  void* run(void* arg)
+  {
+    Job& job = *static_cast<Job*>(arg);
+    ID3_Tracer tracer;
+    ID3_Tracer::Install(&tracer);
+    for (size_t i = 0; i < 50; ++i)
+    {
+      ID3_Tag tag(job.name);
+    }
+    ID3_Tracer::Install(NULL);
+    job.frames = tracer.GetCount(ID3_Tracer::FRAMES);
+    return NULL;
+  }
+#endif
+};
+
+int main(int argc, char *argv[])
+{
+  size_t failures = 0;
+  const size_t fileSize = writeFile(FILENAME, 2);
+
+  failures += check(ID3_Tracer::GetInstalled() == NULL, "no tracer installed at first");
+
+  FrameLog tracer;
+  failures += check(ID3_Tracer::Install(&tracer) == NULL &&
+                    ID3_Tracer::GetInstalled() == &tracer, "tracer installed");
+  {
+    ID3_Tag tag(FILENAME);
+    failures += check(tag.HasTagType(ID3TT_ID3V2) && tag.HasTagType(ID3TT_ID3V1),
+                      "file parsed");
+  }
+  // a small file is read twice: the id3v2 tag first, then all of it for the
+  // tags at the end
+  failures += check(tracer.GetCount(ID3_Tracer::BYTESREAD) > fileSize &&
+                    tracer.GetCount(ID3_Tracer::BYTESREAD) < 2 * fileSize,
+                    "bytes read counted");
+  failures += check(tracer.GetCount(ID3_Tracer::SEEKS) > 0, "seeks counted");
+  failures += check(tracer.GetCount(ID3_Tracer::FRAMES) == 5 &&
+                    tracer.GetFrames(ID3FID_TITLE) == 1 &&
+                    tracer.GetFrames(ID3FID_COMMENT) == 2 &&
+                    tracer.GetFrames(ID3FID_UNSYNCEDLYRICS) == 1 &&
+                    tracer.GetFrames(ID3FID_ALBUM) == 0,
+                    "frames counted by id");
+  failures += check(tracer.ids.size() == 5 && tracer.ids[0] == ID3FID_TITLE &&
+                    tracer.ids[4] == ID3FID_UNSYNCEDLYRICS,
+                    "subclass told of every frame in order");
+  // the encoding, language and empty description, then the lyrics
+  failures += check(tracer.GetCount(ID3_Tracer::DECOMPRESSED) == 5 + 4000,
+                    "decompressed bytes counted");
+  failures += check(tracer.GetCount(ID3_Tracer::BUFFERS) >= 3, "large buffers counted");
+  failures += check(tracer.GetSeconds(ID3_Tracer::PARSEV2) >= 0 &&
+                    tracer.GetSeconds(ID3_Tracer::PARSEV1) > 0 &&
+                    tracer.GetSeconds(ID3_Tracer::PARSEMP3) >= 0,
+                    "stages timed");
+
+  tracer.Reset();
+  {
+    ID3_Tag tag(FILENAME);
+    ID3_Field* fld = tag.Find(ID3FID_TITLE)->GetField(ID3FN_TEXT);
+    fld->SetEncoding(ID3TE_UTF16);
+    fld->SetEncoding(ID3TE_ISO8859_1);
+    failures += check(tracer.GetCount(ID3_Tracer::CONVERSIONS) == 2,
+                      "text conversions counted");
+
+    tracer.Reset();
+    ID3_AddTitle(&tag, "A new title", true);
+    tag.Update(ID3TT_ID3V2);
+    failures += check(tracer.GetCount(ID3_Tracer::INPLACEWRITES) == 1 &&
+                      tracer.GetCount(ID3_Tracer::REWRITES) == 0,
+                      "tag written in place");
+
+    tracer.Reset();
+    ID3_AddLyrics(&tag, words(20000).c_str(), "", "eng", true);
+    tag.Update(ID3TT_ID3V2);
+    failures += check(tracer.GetCount(ID3_Tracer::INPLACEWRITES) == 0 &&
+                      tracer.GetCount(ID3_Tracer::REWRITES) == 1 &&
+                      tracer.GetSeconds(ID3_Tracer::UPDATE) > 0,
+                      "file rewritten");
+  }
+
+  failures += check(ID3_Tracer::Install(NULL) == &tracer &&
+                    ID3_Tracer::GetInstalled() == NULL, "tracer uninstalled");
+  tracer.Reset();
+  {
+    ID3_Tag tag(FILENAME);
+  }
+  failures += check(tracer.GetCount(ID3_Tracer::BYTESREAD) == 0 &&
+                    tracer.GetCount(ID3_Tracer::FRAMES) == 0,
+                    "nothing counted once uninstalled");
+
+  writeFile(FILENAME, 2);
+  {
+    ID3_Tag tag(FILENAME);
+    failures += check(tag.GetParseStats() == NULL, "no parse statistics by default");
+  }
+  {
+    ID3_Tag tag;
+    tag.SetParseStats(true);
+    tag.Link(FILENAME);
+    const ID3_ParseStats* stats = tag.GetParseStats();
+    failures += check(stats != NULL && stats->bytes_read > fileSize &&
+                      stats->reads > 0 && stats->seeks > 0,
+                      "parse statistics of the reads");
+    failures += check(stats != NULL && stats->frames[ID3FID_COMMENT] == 2 &&
+                      stats->frames[ID3FID_UNSYNCEDLYRICS] == 1 &&
+                      stats->unknown_frames == 0 && stats->bad_frames == 0,
+                      "parse statistics of the frames");
+    failures += check(stats != NULL && stats->compressed && !stats->unsynced &&
+                      stats->decompressed == 5 + 4000 && stats->v1_seconds > 0,
+                      "parse statistics of a compressed frame");
+  }
+  writeRawFile(FILENAME);
+  tracer.Reset();
+  ID3_Tracer::Install(&tracer);
+  {
+    ID3_Tag tag;
+    tag.SetParseStats(true);
+    tag.Link(FILENAME);
+    const ID3_ParseStats* stats = tag.GetParseStats();
+    failures += check(tag.NumFrames() == 3 && stats != NULL &&
+                      stats->frames[ID3FID_TITLE] == 1 &&
+                      stats->frames[ID3FID_LEADARTIST] == 1 &&
+                      stats->unknown_frames == 1 && stats->bad_frames == 1,
+                      "parse statistics of unknown and bad frames");
+    failures += check(stats != NULL && stats->unsynced && !stats->compressed,
+                      "parse statistics of an unsynchronized tag");
+    failures += check(stats != NULL && tracer.GetCount(ID3_Tracer::BYTESREAD) == stats->bytes_read &&
+                      tracer.GetCount(ID3_Tracer::BADFRAMES) == 1 &&
+                      tracer.GetCount(ID3_Tracer::UNSYNCED) == 1,
+                      "installed tracer told as well");
+    tag.Clear();
+    failures += check(tag.GetParseStats() == NULL, "parse statistics cleared");
+  }
+  failures += check(ID3_Tracer::Install(NULL) == &tracer, "tracer put back after the parse");
+
+#if defined(HAVE_PTHREAD_H)
+  const char* names[2] = { "test-tracer-1.mp3", "test-tracer-2.mp3" };
+  writeFile(names[0], 1);
+  writeFile(names[1], 10);
+  Job jobs[2];
+  pthread_t threads[2];
+  for (size_t i = 0; i < 2; ++i)
+  {
+    jobs[i].name = names[i];
+    jobs[i].frames = 0;
+    pthread_create(&threads[i], NULL, run, &jobs[i]);
+  }
+  for (size_t i = 0; i < 2; ++i)
+  {
+    pthread_join(threads[i], NULL);
+    remove(names[i]);
+  }
+  failures += check(jobs[0].frames == 50 * 4 && jobs[1].frames == 50 * 13,
+                    "each thread's tracer sees only its own frames");
+#else
+  cout << "no pthreads, tracers of several threads not tested" << endl;
+#endif
+
+  remove(FILENAME);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+// Writes the same changes to two sets of files, one with ID3_Tag::Update()
+// and ID3_Tag::Strip() and one through an ID3_UpdateQueue, and compares the
+// files and the results.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <sstream>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/update_queue.h"
+#include "id3/misc_support.h"
+#include "id3/writers.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+namespace
+{
+  const size_t NUMFILES   = 40;
+  const size_t NUMTHREADS = 3;
+  const size_t MAXPENDING = 4;
+
+  string fileName(const char* set, size_t i)
+  {
+    char name[64];
+    sprintf(name, "test-queue-%s-%02lu.mp3", set, (unsigned long)i);
+    return name;
+  }
+
+  void writeFile(const string& name, size_t i)
+  {
+    ID3_Tag tag;
+    ID3_AddTitle(&tag, "Title");
+    ID3_AddArtist(&tag, "Artist");
+    ostringstream os;
+    ID3_OStreamWriter writer(os);
+    tag.Render(writer, ID3TT_ID3V2);
+
+    // a few frames of silence, mpeg 1 layer III, 128kbps, 44.1kHz
+    string frame(417, '\0');
+    frame[0] = '\xFF';
+    frame[1] = '\xFB';
+    frame[2] = '\x90';
+    string data = os.str();
+    for (size_t j = 0; j < 3 + i % 4; ++j)
+    {
+      data += frame;
+    }
+    ofstream file(name.c_str(), ios::out | ios::binary | ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  string readFile(const string& name)
+  {
+    ifstream file(name.c_str(), ios::in | ios::binary);
+    ostringstream os;
+    os << file.rdbuf();
+    return os.str();
+  }
+
+  // every fifth file is stripped, the others get a comment that is short
+  // enough to fit in the padding for some and too long for the others
+  bool strip(size_t i)
+  {
+    return i % 5 == 4;
+  }
+
+  void change(ID3_Tag& tag, size_t i)
+  {
+    tag.SetPadding(true);
+    string comment(i % 2 ? 10 : 4000, 'c');
+    ID3_AddComment(&tag, comment.c_str(), "", true);
+  }
+
+  struct Results
+  {
+    flags_t tags[NUMFILES];
+    ID3_Err errors[NUMFILES];
+  };
+
+  class Recorder : public ID3_UpdateQueue::Callback
+  {
+  public:
+    Recorder(Results& results, const ID3_UpdateQueue& queue)
+      : _results(results), _queue(queue), _calls(0), _maxpending(0)
+    { }
+
+    void Done(ID3_Tag& tag, flags_t tags, ID3_Err err)
+    {
+      size_t i = 0;
+      sscanf(tag.GetFileName(), "test-queue-async-%lu", (unsigned long*)&i);
+      _results.tags[i] = tags;
+      _results.errors[i] = err;
+      _maxpending = max(_maxpending, _queue.NumPending());
+      ++_calls;
+      delete &tag;
+    }
+
+    Results&               _results;
+    const ID3_UpdateQueue& _queue;
+    size_t                 _calls;
+    size_t                 _maxpending;
+  };
+};
+
+int main(int argc, char *argv[])
+{
+  Results sync, async;
+  for (size_t i = 0; i < NUMFILES; ++i)
+  {
+    writeFile(fileName("sync", i), i);
+    writeFile(fileName("async", i), i);
+  }
+
+  for (size_t i = 0; i < NUMFILES; ++i)
+  {
+    ID3_Tag tag(fileName("sync", i).c_str());
+    if (strip(i))
+    {
+      sync.tags[i] = tag.Strip(ID3TT_ID3V2);
+    }
+    else
+    {
+      change(tag, i);
+      sync.tags[i] = tag.Update(ID3TT_ID3V2);
+    }
+    sync.errors[i] = tag.GetLastError();
+  }
+
+  size_t calls = 0, maxpending = 0;
+  {
+    ID3_UpdateQueue queue(NUMTHREADS, MAXPENDING);
+    Recorder recorder(async, queue);
+    for (size_t i = 0; i < NUMFILES; ++i)
+    {
+      ID3_Tag* tag = new ID3_Tag(fileName("async", i).c_str());
+      if (strip(i))
+      {
+        queue.Strip(*tag, ID3TT_ID3V2, &recorder);
+      }
+      else
+      {
+        change(*tag, i);
+        queue.Update(*tag, ID3TT_ID3V2, &recorder);
+      }
+    }
+    queue.Wait();
+    calls = recorder._calls;
+    maxpending = recorder._maxpending;
+  }
+
+  size_t same = 0;
+  for (size_t i = 0; i < NUMFILES; ++i)
+  {
+    if (sync.tags[i] == async.tags[i] && sync.errors[i] == async.errors[i] &&
+        readFile(fileName("sync", i)) == readFile(fileName("async", i)))
+    {
+      ++same;
+    }
+    remove(fileName("sync", i).c_str());
+    remove(fileName("async", i).c_str());
+  }
+
+  cout << NUMFILES << " files, " << same << " the same, at most "
+       << maxpending << " pending" << endl;
+  size_t failures = 0;
+  failures += check(calls == NUMFILES, "every callback called once");
+  failures += check(maxpending <= MAXPENDING, "pending tags bounded");
+  failures += check(same == NUMFILES, "queued updates match direct updates");
+
+  return failures == 0 ? 0 : 1;
+}
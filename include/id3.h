@@ -54,6 +54,7 @@ extern "C"
   ID3_C_EXPORT void                 CCONV ID3Tag_AddFrame             (ID3Tag *tag, const ID3Frame *frame);
   ID3_C_EXPORT bool                 CCONV ID3Tag_AttachFrame          (ID3Tag *tag, ID3Frame *frame);
   ID3_C_EXPORT void                 CCONV ID3Tag_AddFrames            (ID3Tag *tag, const ID3Frame *frames, size_t num);
+  ID3_C_EXPORT size_t               CCONV ID3Tag_AttachFrames         (ID3Tag *tag, ID3Frame **frames, size_t num, bool trusted);
   ID3_C_EXPORT ID3Frame*            CCONV ID3Tag_RemoveFrame          (ID3Tag *tag, const ID3Frame *frame);
   ID3_C_EXPORT ID3_Err              CCONV ID3Tag_Parse                (ID3Tag *tag, const uchar header[ID3_TAGHEADERSIZE], const uchar *buffer);
   ID3_C_EXPORT size_t               CCONV ID3Tag_Link                 (ID3Tag *tag, const char *fileName);
@@ -69,6 +70,8 @@ extern "C"
   ID3_C_EXPORT bool                 CCONV ID3Tag_HasTagType           (const ID3Tag *tag, ID3_TagType);
   ID3_C_EXPORT ID3TagIterator*      CCONV ID3Tag_CreateIterator       (ID3Tag *tag);
   ID3_C_EXPORT ID3TagConstIterator* CCONV ID3Tag_CreateConstIterator  (const ID3Tag *tag);
+  ID3_C_EXPORT void                 CCONV ID3Tag_SetParseStats        (ID3Tag *tag, bool stats);
+  ID3_C_EXPORT const ID3_ParseStats* CCONV ID3Tag_GetParseStats       (const ID3Tag *tag);
 
   ID3_C_EXPORT void                 CCONV ID3TagIterator_Delete       (ID3TagIterator*);
   ID3_C_EXPORT ID3Frame*            CCONV ID3TagIterator_GetNext      (ID3TagIterator*);
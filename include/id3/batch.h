@@ -0,0 +1,84 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a software library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_BATCH_H_
+#define _ID3LIB_BATCH_H_
+
+#if defined(__BORLANDC__)
+// due to a bug in borland it sometimes still wants mfc compatibility even when you disable it
+#  if defined(_MSC_VER)
+#    undef _MSC_VER
+#  endif
+#  if defined(__MFC_COMPAT__)
+#    undef __MFC_COMPAT__
+#  endif
+#endif
+
+#include <id3/tag.h>
+
+class ID3_ParseCache;
+
+class ID3_CPP_EXPORT ID3_Batch
+{
+public:
+
+  class Handler
+  {
+  public:
+    virtual void Process(size_t index, const char* path, ID3_Tag& tag) { }
+    virtual bool Handle(size_t index, const char* path, ID3_Tag& tag) = 0;
+    virtual ~Handler() {};
+  };
+
+public:
+
+  ID3_Batch(flags_t = (flags_t) ID3TT_ALL);
+
+  void       SetTags(flags_t);
+  flags_t    GetTags() const { return _tags; }
+  void       SetCache(ID3_ParseCache*);
+  ID3_ParseCache* GetCache() const { return _cache; }
+  void       SetThreads(size_t);
+  size_t     GetThreads() const { return _threads; }
+  void       SetInputOrder(bool);
+  bool       GetInputOrder() const { return _input_order; }
+  void       SetQueueSize(size_t);
+  size_t     GetQueueSize() const { return _queue_size; }
+
+  size_t     Parse(const char* const* paths, size_t count, Handler&) const;
+
+  static size_t NumProcessors();
+
+private:
+  flags_t    _tags;        // which tag types to parse
+  ID3_ParseCache* _cache;  // cache to link the files through, if any
+  size_t     _threads;     // number of parsing threads, 0 for one per processor
+  bool       _input_order; // deliver the results in the order of the paths?
+  size_t     _queue_size;  // how many parsed tags may wait for the handler
+};
+
+#endif /* _ID3LIB_BATCH_H_ */
@@ -736,6 +736,14 @@ ID3_ENUM(Mp3_Crc)
   MP3CRC_OK = 1
 };
 
+ID3_ENUM(Mp3_VbrHeader)
+{
+  MP3VBRHEADER_NONE = 0,        // no vbr header found in the first frame
+  MP3VBRHEADER_XING,            // Xing header, a vbr file
+  MP3VBRHEADER_INFO,            // Info header, a cbr file written by LAME
+  MP3VBRHEADER_VBRI             // Fraunhofer VBRI header
+};
+
 ID3_STRUCT(Mp3_Headerinfo)
 {
   Mpeg_Layers layer;
@@ -753,6 +761,51 @@ ID3_STRUCT(Mp3_Headerinfo)
   bool privatebit;
   bool copyrighted;
   bool original;
+  Mp3_VbrHeader vbrheader;      // which vbr header the frames and time are taken from
+  uint32 vbr_bitrate;           // avg bitrate from the vbr header
+  uint32 vbr_bytes;             // nr of audio bytes according to the vbr header
+  bool   has_toc;               // whether toc below is filled in
+  uchar  toc[100];              // xing seek table, toc[i] * datasize / 256 is the offset at i percent
+  uint16 encoder_delay;         // nr of samples added by the encoder at the start (LAME)
+  uint16 encoder_padding;       // nr of samples added by the encoder at the end (LAME)
+  uint32 replaygain_peak;       // peak amplitude, 1 << 23 is full scale (LAME)
+  int16  replaygain_track;      // radio replaygain in 1/10 dB (LAME)
+  int16  replaygain_album;      // audiophile replaygain in 1/10 dB (LAME)
+  char   encoder[10];           // encoder version string, e.g. "LAME3.90a" (LAME)
+};
+
+ID3_STRUCT(Mp3_Scaninfo)
+{
+  uint32 frames;                // nr of audio frames walked
+  uint32 time;                  // nr of milliseconds in song
+  uint32 bitrate;               // avg bitrate over all frames
+  bool   vbr;                   // whether the frames differ in bitrate
+  uint32 bytes;                 // nr of bytes in the audio frames
+  uint32 skipped;               // nr of bytes skipped while looking for sync
+  uint32 resyncs;               // nr of times sync was lost and found again
+  uint32 crcframes;             // nr of frames with a crc that was checked
+  uint32 crcerrors;             // nr of those frames with a crc mismatch
+  size_t seekpoints;            // nr of entries in seekindex
+  const uint32* seekindex;      // seekindex[i] is the file offset of the frame at i/seekpoints of the time
+};
+
+ID3_STRUCT(ID3_ParseStats)
+{
+  size_t reads;                 // nr of calls to read from the file or reader
+  size_t seeks;                 // nr of moves of its read position
+  size_t bytes_read;            // nr of bytes read from it
+  size_t bytes_skipped;         // nr of bytes passed over without being read
+  size_t frames[ID3FID_LASTFRAMEID]; // nr of id3v2 frames parsed, by id
+  size_t unknown_frames;        // nr of those with an unknown id, frames[ID3FID_NOFRAME]
+  size_t bad_frames;            // nr of id3v2 frames that failed to parse and were dropped
+  size_t decompressed;          // nr of bytes inflated from compressed frames
+  double v2_seconds;            // time spent parsing the id3v2 tags
+  double musicmatch_seconds;    // time spent parsing a musicmatch tag
+  double lyrics3_seconds;       // time spent parsing a lyrics3 tag
+  double v1_seconds;            // time spent parsing an id3v1 tag
+  double mp3_seconds;           // time spent parsing the mpeg header
+  bool   unsynced;              // whether an id3v2 tag had to be resynchronized
+  bool   compressed;            // whether compressed frames were inflated
 };
 
 #define MASK(bits) ((1 << (bits)) - 1)
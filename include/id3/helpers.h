@@ -56,26 +56,31 @@ namespace dami
 
       ID3_C_EXPORT String     getFrameText(const ID3_TagImpl&, ID3_FrameID);
       ID3_C_EXPORT ID3_Frame* setFrameText(ID3_TagImpl&, ID3_FrameID, String);
+      ID3_C_EXPORT ID3_Frame* setFrameText(ID3_TagImpl&, ID3_FrameID, const char*);
       ID3_C_EXPORT size_t     removeFrames(ID3_TagImpl&, ID3_FrameID);
 
       ID3_C_EXPORT ID3_Frame* hasArtist(const ID3_TagImpl&);
       ID3_C_EXPORT String     getArtist(const ID3_TagImpl&);
       ID3_C_EXPORT ID3_Frame* setArtist(ID3_TagImpl&, String);
+      ID3_C_EXPORT ID3_Frame* setArtist(ID3_TagImpl&, const char*);
       ID3_C_EXPORT size_t     removeArtists(ID3_TagImpl&);
 
       ID3_C_EXPORT ID3_Frame* hasAlbum(const ID3_TagImpl&);
       ID3_C_EXPORT String     getAlbum(const ID3_TagImpl&);
       ID3_C_EXPORT ID3_Frame* setAlbum(ID3_TagImpl&, String);
+      ID3_C_EXPORT ID3_Frame* setAlbum(ID3_TagImpl&, const char*);
       ID3_C_EXPORT size_t     removeAlbums(ID3_TagImpl&);
 
       ID3_C_EXPORT ID3_Frame* hasTitle(const ID3_TagImpl&);
       ID3_C_EXPORT String     getTitle(const ID3_TagImpl&);
       ID3_C_EXPORT ID3_Frame* setTitle(ID3_TagImpl&, String);
+      ID3_C_EXPORT ID3_Frame* setTitle(ID3_TagImpl&, const char*);
       ID3_C_EXPORT size_t     removeTitles(ID3_TagImpl&);
 
       ID3_C_EXPORT ID3_Frame* hasYear(const ID3_TagImpl&);
       ID3_C_EXPORT String     getYear(const ID3_TagImpl&);
       ID3_C_EXPORT ID3_Frame* setYear(ID3_TagImpl&, String);
+      ID3_C_EXPORT ID3_Frame* setYear(ID3_TagImpl&, const char*);
       ID3_C_EXPORT size_t     removeYears(ID3_TagImpl&);
 
       ID3_C_EXPORT ID3_Frame* hasV1Comment(const ID3_TagImpl&);
@@ -106,6 +111,7 @@ namespace dami
 
       ID3_C_EXPORT String     getLyricist(const ID3_TagImpl&);
       ID3_C_EXPORT ID3_Frame* setLyricist(ID3_TagImpl&, String);
+      ID3_C_EXPORT ID3_Frame* setLyricist(ID3_TagImpl&, const char*);
       ID3_C_EXPORT size_t     removeLyricists(ID3_TagImpl&);
 
       ID3_C_EXPORT ID3_Frame* hasSyncLyrics(const ID3_TagImpl&, String lang, String desc);
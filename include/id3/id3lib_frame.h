@@ -48,7 +48,9 @@ class ID3_Writer;
 
 class ID3_CPP_EXPORT ID3_Frame
 {
-  ID3_FrameImpl* _impl;
+  friend class ID3_FrameImpl;
+  mutable ID3_FrameImpl* _impl;  // NULL after a move until the frame is used again
+  ID3_FrameImpl& impl() const;
 public:
 
   class Iterator
@@ -68,6 +70,11 @@ public:
 public:
   ID3_Frame(ID3_FrameID id = ID3FID_NOFRAME);
   ID3_Frame(const ID3_Frame&);
+#if __cplusplus >= 201103L
+  // takes over the fields of frame, which is left without an id; defined
+  // inline so the library's ABI doesn't depend on it
+  ID3_Frame(ID3_Frame&& frame) noexcept : _impl(frame._impl) { frame._impl = NULL; }
+#endif
 
   virtual ~ID3_Frame();
 
@@ -86,6 +93,15 @@ public:
   const char* GetTextID() const;
 
   ID3_Frame&  operator=(const ID3_Frame &);
+#if __cplusplus >= 201103L
+  ID3_Frame&  operator=(ID3_Frame &&rFrame) noexcept
+  {
+    ID3_FrameImpl* impl = _impl;
+    _impl = rFrame._impl;
+    rFrame._impl = impl;
+    return *this;
+  }
+#endif
   bool        HasChanged() const;
   bool        Parse(ID3_Reader&);
   ID3_Err     Render(ID3_Writer&) const;
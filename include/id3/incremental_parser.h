@@ -0,0 +1,76 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a software library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_INCREMENTAL_PARSER_H_
+#define _ID3LIB_INCREMENTAL_PARSER_H_
+
+#if defined(__BORLANDC__)
+// due to a bug in borland it sometimes still wants mfc compatibility even when you disable it
+#  if defined(_MSC_VER)
+#    undef _MSC_VER
+#  endif
+#  if defined(__MFC_COMPAT__)
+#    undef __MFC_COMPAT__
+#  endif
+#endif
+
+#include <id3/tag.h>
+
+class ID3_IncrementalParserImpl;
+
+class ID3_CPP_EXPORT ID3_IncrementalParser
+{
+  ID3_IncrementalParserImpl* _impl;
+public:
+
+  class Callback
+  {
+  public:
+    virtual void Frame(ID3_Frame* frame) = 0;
+    virtual ~Callback() {};
+  };
+
+public:
+
+  ID3_IncrementalParser(Callback&);
+  ~ID3_IncrementalParser();
+
+  size_t     Feed(const uchar* data, size_t size);
+
+  size_t     GetBytesNeeded() const;
+  bool       IsDone() const;
+  bool       HasTag() const;
+  ID3_V2Spec GetSpec() const;
+  size_t     GetTagSize() const;
+  size_t     NumFrames() const;
+
+private:
+  ID3_IncrementalParser(const ID3_IncrementalParser&);
+  ID3_IncrementalParser& operator=(const ID3_IncrementalParser&);
+};
+
+#endif /* _ID3LIB_INCREMENTAL_PARSER_H_ */
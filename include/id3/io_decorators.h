@@ -160,6 +160,43 @@ namespace dami
       virtual ~CompressedReader();
     };
 
+    /**
+     * Keeps a copy of the last part of the reader, from \c beg to the end, in
+     * memory.  Reads within the copy don't touch the underlying reader, reads
+     * before it are passed on.  The position is kept apart from the underlying
+     * reader's.
+     */
+    class ID3_CPP_EXPORT CachedReader : public ID3_Reader
+    {
+      ID3_Reader& _reader;
+      BString _cache;
+      pos_type _cacheBeg;
+      pos_type _cur;
+
+     public:
+      CachedReader(ID3_Reader& reader, pos_type beg);
+
+      pos_type getBeg() { return _reader.getBeg(); }
+      pos_type getCur() { return _cur; }
+      pos_type getEnd() { return _cacheBeg + _cache.size(); }
+      pos_type setCur(pos_type cur)
+      {
+        _cur = mid(this->getBeg(), cur, this->getEnd());
+        return _cur;
+      }
+
+      int_type readChar();
+      int_type peekChar();
+
+      size_type readChars(char_type buf[], size_type len);
+      size_type readChars(char buf[], size_type len)
+      {
+        return this->readChars((char_type*) buf, len);
+      }
+
+      void close() { ; }
+    };
+
     class ID3_CPP_EXPORT UnsyncedWriter : public ID3_Writer
     {
       typedef ID3_Writer SUPER;
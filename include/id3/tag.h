@@ -45,11 +45,17 @@
 class ID3_Reader;
 class ID3_Writer;
 class ID3_TagImpl;
+class ID3_CursorImpl;
 class ID3_Tag;
+class ID3_ParseCache;
+class ID3_StreamParser;
 
 class ID3_CPP_EXPORT ID3_Tag
 {
-  ID3_TagImpl* _impl;
+  friend class ID3_StreamParser;
+  friend class ID3_TagImpl;
+  mutable ID3_TagImpl* _impl;  // NULL after a move until the tag is used again
+  ID3_TagImpl& impl() const;
 public:
 
   class Iterator
@@ -66,10 +72,27 @@ public:
     virtual ~ConstIterator() {};
   };
 
+  class ID3_CPP_EXPORT Cursor
+  {
+    friend class ID3_TagImpl;
+    ID3_CursorImpl* _impl;  // NULL until the cursor is first used
+  public:
+    Cursor() : _impl(NULL) { }
+    Cursor(const Cursor&);
+    Cursor& operator=(const Cursor&);
+    ~Cursor();
+    void Reset();
+  };
+
 public:
 
   ID3_Tag(const char *name = NULL, flags_t = (flags_t) ID3TT_ALL);
   ID3_Tag(const ID3_Tag &tag);
+#if __cplusplus >= 201103L
+  // takes over the contents of tag, which is left empty; defined inline so
+  // the library's ABI doesn't depend on it
+  ID3_Tag(ID3_Tag &&tag) noexcept : _impl(tag._impl) { tag._impl = NULL; }
+#endif
   virtual ~ID3_Tag();
 
   void       Clear();
@@ -89,15 +112,19 @@ public:
   void       AddFrame(const ID3_Frame&);
   void       AddFrame(const ID3_Frame*);
   bool       AttachFrame(ID3_Frame*);
+  size_t     AttachFrames(ID3_Frame* const*, size_t, bool trusted = false);
   ID3_Frame* RemoveFrame(const ID3_Frame *);
 
   size_t     Parse(const uchar*, size_t);
   bool       Parse(ID3_Reader& reader);
   size_t     Render(uchar*, ID3_TagType = ID3TT_ID3V2) const;
   size_t     Render(ID3_Writer&, ID3_TagType = ID3TT_ID3V2) const;
+  size_t     Serialize(ID3_Writer&) const;
+  bool       Deserialize(const uchar*, size_t);
 
   size_t     Link(const char *fileInfo, flags_t = (flags_t) ID3TT_ALL);
   size_t     Link(ID3_Reader &reader, flags_t = (flags_t) ID3TT_ALL);
+  size_t     Link(const char *fileInfo, ID3_ParseCache&, flags_t = (flags_t) ID3TT_ALL);
 
   flags_t    Update(flags_t = (flags_t) ID3TT_ALL);
   flags_t    Strip(flags_t = (flags_t) ID3TT_ALL);
@@ -113,14 +140,38 @@ public:
   ID3_Frame* Find(ID3_FrameID, ID3_FieldID, const char*) const;
   ID3_Frame* Find(ID3_FrameID, ID3_FieldID, const unicode_t*) const;
 
+  ID3_Frame* Find(Cursor&, ID3_FrameID) const;
+  ID3_Frame* Find(Cursor&, ID3_FrameID, ID3_FieldID, uint32) const;
+  ID3_Frame* Find(Cursor&, ID3_FrameID, ID3_FieldID, const char*) const;
+  ID3_Frame* Find(Cursor&, ID3_FrameID, ID3_FieldID, const unicode_t*) const;
+
+  ID3_Frame* FindFirst(ID3_FrameID) const;
+  ID3_Frame* FindFirst(ID3_FrameID, ID3_FieldID, uint32) const;
+  ID3_Frame* FindFirst(ID3_FrameID, ID3_FieldID, const char*) const;
+  ID3_Frame* FindFirst(ID3_FrameID, ID3_FieldID, const unicode_t*) const;
+
   size_t     NumFrames() const;
 
   const Mp3_Headerinfo* GetMp3HeaderInfo() const;
+  const Mp3_Scaninfo* GetMp3ScanInfo() const;
+  const Mp3_Scaninfo* ScanMp3Frames(size_t seekpoints = 100);
+  const Mp3_Scaninfo* ScanMp3Frames(ID3_Reader&, size_t seekpoints = 100);
+  void       SetParseStats(bool);
+  const ID3_ParseStats* GetParseStats() const;
 
   Iterator*  CreateIterator();
   ConstIterator* CreateIterator() const;
 
   ID3_Tag&   operator=( const ID3_Tag & );
+#if __cplusplus >= 201103L
+  ID3_Tag&   operator=( ID3_Tag &&rTag ) noexcept
+  {
+    ID3_TagImpl* impl = _impl;
+    _impl = rTag._impl;
+    rTag._impl = impl;
+    return *this;
+  }
+#endif
 
   bool       HasTagType(ID3_TagType tt) const;
   ID3_V2Spec GetSpec() const;
@@ -0,0 +1,75 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a software library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_TAG_VIEW_H_
+#define _ID3LIB_TAG_VIEW_H_
+
+#if defined(__BORLANDC__)
+// due to a bug in borland it sometimes still wants mfc compatibility even when you disable it
+#  if defined(_MSC_VER)
+#    undef _MSC_VER
+#  endif
+#  if defined(__MFC_COMPAT__)
+#    undef __MFC_COMPAT__
+#  endif
+#endif
+
+#include <id3/globals.h>
+
+class ID3_CPP_EXPORT ID3_TagView
+{
+public:
+  ID3_TagView();
+  ID3_TagView(const uchar* data, size_t size);
+
+  bool         Set(const uchar* data, size_t size);
+  void         Clear();
+
+  bool         IsValid() const { return _data != NULL; }
+  size_t       Size() const;
+  ID3_V2Spec   GetSpec() const;
+  size_t       NumFrames() const;
+
+  size_t       Find(ID3_FrameID id, size_t from = 0) const;
+  ID3_FrameID  GetFrameID(size_t frame) const;
+  const char*  GetTextID(size_t frame) const;
+
+  bool         Contains(size_t frame, ID3_FieldID fld) const;
+  uint32       GetInteger(size_t frame, ID3_FieldID fld) const;
+  const char*  GetText(size_t frame, ID3_FieldID fld, size_t* size = NULL,
+                       ID3_TextEnc* enc = NULL, size_t* items = NULL) const;
+  const uchar* GetBinary(size_t frame, ID3_FieldID fld, size_t* size = NULL) const;
+
+private:
+  const uchar* entry(size_t frame) const;
+  const uchar* field(size_t frame, ID3_FieldID fld) const;
+
+  const uchar* _data;
+  size_t       _size;
+};
+
+#endif /* _ID3LIB_TAG_VIEW_H_ */
@@ -0,0 +1,105 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a software library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_TRACER_H_
+#define _ID3LIB_TRACER_H_
+
+#if defined(__BORLANDC__)
+// due to a bug in borland it sometimes still wants mfc compatibility even when you disable it
+#  if defined(_MSC_VER)
+#    undef _MSC_VER
+#  endif
+#  if defined(__MFC_COMPAT__)
+#    undef __MFC_COMPAT__
+#  endif
+#endif
+
+
+#include <id3/globals.h>
+
+class ID3_CPP_EXPORT ID3_Tracer
+{
+public:
+
+  enum Counter
+  {
+    BYTESREAD = 0,    // bytes read from the file or reader being parsed
+    READS,            // calls to read from it
+    SEEKS,            // moves of its read position
+    SKIPPED,          // bytes passed over without being read
+    FRAMES,           // id3v2 frames parsed
+    BADFRAMES,        // id3v2 frames that failed to parse and were dropped
+    DECOMPRESSED,     // bytes inflated from compressed frames
+    UNSYNCED,         // id3v2 tags that had to be resynchronized
+    CONVERSIONS,      // texts converted from one encoding to another
+    BUFFERS,          // buffers allocated for large field data
+    REWRITES,         // files rewritten through a temporary file
+    INPLACEWRITES,    // id3v2 tags written over the old one in the file
+    CONVERTEDFRAMES,  // frames converted to the spec of the tag they're in
+    DROPPEDFRAMES,    // frames dropped as invalid or duplicate in their tag
+    NUMCOUNTERS
+  };
+
+  enum Stage
+  {
+    PARSEV2 = 0,    // parsing the id3v2 tags at the start of the file
+    PARSEMUSICMATCH,// parsing a musicmatch tag at the end of the file
+    PARSELYRICS3,   // parsing a lyrics3 tag
+    PARSEV1,        // parsing an id3v1 tag
+    PARSEMP3,       // parsing the mpeg header
+    UPDATE,         // writing the tags to the file
+    NUMSTAGES
+  };
+
+  ID3_Tracer();
+  virtual ~ID3_Tracer();
+
+  virtual void Count(Counter, size_t);
+  virtual void FrameParsed(ID3_FrameID, size_t size);
+  virtual void StageDone(Stage, double seconds);
+
+  size_t     GetCount(Counter) const;
+  size_t     GetFrames(ID3_FrameID) const;
+  double     GetSeconds(Stage) const;
+  void       Reset();
+
+  static ID3_Tracer* Install(ID3_Tracer*);
+  static ID3_Tracer* GetInstalled();
+
+  static const char* GetCounterName(Counter);
+  static const char* GetStageName(Stage);
+
+private:
+  ID3_Tracer(const ID3_Tracer&);
+  ID3_Tracer& operator=(const ID3_Tracer&);
+
+  size_t _counts[NUMCOUNTERS];
+  size_t _frames[ID3FID_LASTFRAMEID];
+  double _seconds[NUMSTAGES];
+};
+
+#endif /* _ID3LIB_TRACER_H_ */
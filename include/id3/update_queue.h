@@ -0,0 +1,74 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a software library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_UPDATE_QUEUE_H_
+#define _ID3LIB_UPDATE_QUEUE_H_
+
+#if defined(__BORLANDC__)
+// due to a bug in borland it sometimes still wants mfc compatibility even when you disable it
+#  if defined(_MSC_VER)
+#    undef _MSC_VER
+#  endif
+#  if defined(__MFC_COMPAT__)
+#    undef __MFC_COMPAT__
+#  endif
+#endif
+
+#include <id3/tag.h>
+
+class ID3_UpdateQueueImpl;
+
+class ID3_CPP_EXPORT ID3_UpdateQueue
+{
+  ID3_UpdateQueueImpl* _impl;
+public:
+
+  class Callback
+  {
+  public:
+    virtual void Done(ID3_Tag& tag, flags_t tags, ID3_Err err) = 0;
+    virtual ~Callback() {};
+  };
+
+public:
+
+  ID3_UpdateQueue(size_t threads = 4, size_t maxPending = 16);
+  ~ID3_UpdateQueue();
+
+  void       Update(ID3_Tag&, flags_t = (flags_t) ID3TT_ALL, Callback* = NULL);
+  void       Strip(ID3_Tag&, flags_t = (flags_t) ID3TT_ALL, Callback* = NULL);
+
+  size_t     Poll();
+  void       Wait();
+  size_t     NumPending() const;
+
+private:
+  ID3_UpdateQueue(const ID3_UpdateQueue&);
+  ID3_UpdateQueue& operator=(const ID3_UpdateQueue&);
+};
+
+#endif /* _ID3LIB_UPDATE_QUEUE_H_ */
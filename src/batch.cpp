@@ -0,0 +1,596 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <list>
+#include <map>
+#include <vector>
+#if defined HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "batch.h"
+#include "parse_cache.h"
+#include "tag_impl.h"
+#include "utils.h"
+
+using namespace dami;
+
+/** \class ID3_Batch batch.h id3/batch.h
+ ** \brief Links many files at once, on several threads.
+ **
+ ** Linking a file is mostly waiting for the disk, so an application that
+ ** reads the tags of a whole collection spends most of its time idle when it
+ ** links one file after the other.  ID3_Batch parses a list of files on a
+ ** pool of threads and hands every parsed tag to a Handler.
+ **
+ ** \code
+ **   class Printer : public ID3_Batch::Handler
+ **   {
+ **   public:
+ **     bool Handle(size_t index, const char* path, ID3_Tag& tag)
+ **     {
+ **       cout << path << ": " << tag.NumFrames() << " frames" << endl;
+ **       return true;
+ **     }
+ **   };
+ **
+ **   Printer printer;
+ **   ID3_Batch batch(ID3TT_ID3V2);
+ **   batch.Parse(paths, numPaths, printer);
+ ** \endcode
+ **
+ ** Handle() is always called on the thread that called Parse(), one tag at
+ ** a time, so it doesn't need to be thread safe.  The tag passed to it is
+ ** linked to the file like ID3_Tag::Link() would and may be modified or
+ ** updated, but it is reused for another file once the handler returns.
+ **
+ ** Work that should be spread over the threads as well, such as changing the
+ ** tag and updating the file, goes in Process().  It is called on the thread
+ ** that linked the file, right after linking it, so it is called for several
+ ** files at once and must be thread safe.  If linking or Process() throws an
+ ** exception the tag is cleared and passed on to Handle() empty, and its
+ ** GetLastError() reports the error the tag had recorded, or ID3E_InvalidTag.
+ ** Otherwise GetLastError() reports what Link() did.
+ **
+ ** Each thread takes small blocks of paths from a shared queue and, once
+ ** the queue is empty, steals half of the paths another thread hasn't gotten
+ ** to yet, so a few large files don't hold up the rest of the batch.  Every
+ ** thread reuses the tags the handler is done with.  At most GetQueueSize()
+ ** parsed tags wait for the handler at any time, which bounds the memory used
+ ** when the handler is slower than the parsing.
+ **
+ ** Without pthreads, or with a single thread, the files are parsed on the
+ ** calling thread.
+ **/
+
+namespace
+{
+  const size_t DEFAULT_QUEUESIZE = 64;
+
+  void linkAndProcess(size_t index, const char* path, flags_t tags,
+                      ID3_ParseCache* cache, ID3_Batch::Handler& handler,
+                      ID3_Tag& tag)
+  {
+    try
+    {
+      if (cache)
+      {
+        tag.Link(path, *cache, tags);
+      }
+      else
+      {
+        tag.Link(path, tags);
+      }
+      handler.Process(index, path, tag);
+    }
+    catch (...)
+    {
+      ID3_Err err = tag.GetLastError();
+      tag.Clear();
+      ID3_TagImpl::Of(tag).SetLastError(err != ID3E_NoError ? err : ID3E_InvalidTag);
+    }
+  }
+
+  size_t parseSerially(const char* const* paths, size_t count, flags_t tags,
+                       ID3_ParseCache* cache, ID3_Batch::Handler& handler)
+  {
+    ID3_Tag tag;
+    size_t delivered = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      tag.Clear();
+      linkAndProcess(i, paths[i], tags, cache, handler, tag);
+      ++delivered;
+      if (!handler.Handle(i, paths[i], tag))
+      {
+        break;
+      }
+    }
+    return delivered;
+  }
+
+#if defined HAVE_PTHREAD_H
+  class Pool;
+
+  struct Worker
+  {
+    Pool*           pool;
+    pthread_t       thread;
+    bool            started;
+    pthread_mutex_t lock;           // guards next and end
+    size_t          next;           // the paths [next, end) are this worker's
+    size_t          end;
+    std::vector<ID3_Tag*> tags;     // tags to reuse, guarded by the pool's lock
+  };
+
+  struct Result
+  {
+    size_t   index;
+    ID3_Tag* tag;
+    Worker*  worker;
+  };
+
+  class Pool
+  {
+  public:
+    Pool(const char* const* paths, size_t count, flags_t tags,
+         ID3_ParseCache* cache, size_t threads, bool inputOrder,
+         size_t queueSize);
+    ~Pool();
+
+    size_t run(ID3_Batch::Handler&);
+    void   work(Worker&);
+
+  private:
+    bool   claim(Worker&, size_t& index);
+    bool   steal(Worker&, size_t& index);
+    bool   hasRoom(size_t index) const;
+    bool   nextResult(Result&);
+    void   finish();
+
+    const char* const* _paths;
+    size_t             _count;
+    flags_t            _tags;
+    ID3_ParseCache*    _cache;
+    bool               _input_order;
+    size_t             _queue_size;
+    size_t             _block_size;  // how many paths to take from the queue
+    ID3_Batch::Handler* _handler;
+
+    std::vector<Worker> _workers;
+    pthread_mutex_t    _lock;        // guards everything below
+    pthread_cond_t     _produced;    // a result is ready or a worker is done
+    pthread_cond_t     _consumed;    // the handler is done with a result
+    size_t             _queued;      // paths before this haven't been claimed
+    std::list<Result>  _done;        // results in completion order...
+    std::map<size_t, Result> _sorted;// ...or in input order
+    size_t             _delivered;   // results passed to the handler
+    size_t             _pending;     // claimed paths not yet delivered
+    size_t             _running;     // workers that haven't finished
+    bool               _stop;
+  };
+
+  void* runWorker(void* arg)
+  {
+    Worker* worker = static_cast<Worker*>(arg);
+    worker->pool->work(*worker);
+    return NULL;
+  }
+
+  Pool::Pool(const char* const* paths, size_t count, flags_t tags,
+             ID3_ParseCache* cache, size_t threads, bool inputOrder,
+             size_t queueSize)
+    : _paths(paths),
+      _count(count),
+      _tags(tags),
+      _cache(cache),
+      _input_order(inputOrder),
+      _queue_size(queueSize),
+      _block_size(max<size_t>(1, queueSize / (2 * threads))),
+      _handler(NULL),
+      _workers(threads),
+      _queued(0),
+      _delivered(0),
+      _pending(0),
+      _running(0),
+      _stop(false)
+  {
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_produced, NULL);
+    pthread_cond_init(&_consumed, NULL);
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+      Worker& worker = _workers[i];
+      worker.pool = this;
+      worker.started = false;
+      worker.next = worker.end = 0;
+      pthread_mutex_init(&worker.lock, NULL);
+    }
+  }
+
+  Pool::~Pool()
+  {
+    for (std::list<Result>::iterator ri = _done.begin(); ri != _done.end(); ++ri)
+    {
+      delete ri->tag;
+    }
+    for (std::map<size_t, Result>::iterator si = _sorted.begin(); si != _sorted.end(); ++si)
+    {
+      delete si->second.tag;
+    }
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+      Worker& worker = _workers[i];
+      for (size_t j = 0; j < worker.tags.size(); ++j)
+      {
+        delete worker.tags[j];
+      }
+      pthread_mutex_destroy(&worker.lock);
+    }
+    pthread_cond_destroy(&_consumed);
+    pthread_cond_destroy(&_produced);
+    pthread_mutex_destroy(&_lock);
+  }
+
+  // Takes the next path of the worker's own range, then a block of paths from
+  // the queue, then half of what is left of the largest other range.
+  bool Pool::claim(Worker& worker, size_t& index)
+  {
+    pthread_mutex_lock(&worker.lock);
+    bool found = worker.next < worker.end;
+    if (found)
+    {
+      index = worker.next++;
+    }
+    pthread_mutex_unlock(&worker.lock);
+    if (found)
+    {
+      return true;
+    }
+
+    pthread_mutex_lock(&_lock);
+    size_t beg = _queued;
+    size_t end = min(_count, beg + _block_size);
+    _queued = end;
+    pthread_mutex_unlock(&_lock);
+    if (beg < end)
+    {
+      pthread_mutex_lock(&worker.lock);
+      worker.next = beg + 1;
+      worker.end = end;
+      pthread_mutex_unlock(&worker.lock);
+      index = beg;
+      return true;
+    }
+
+    return this->steal(worker, index);
+  }
+
+  bool Pool::steal(Worker& worker, size_t& index)
+  {
+    for (;;)
+    {
+      Worker* victim = NULL;
+      size_t most = 0;
+      for (size_t i = 0; i < _workers.size(); ++i)
+      {
+        Worker& other = _workers[i];
+        if (&other == &worker)
+        {
+          continue;
+        }
+        pthread_mutex_lock(&other.lock);
+        size_t left = other.end - other.next;
+        pthread_mutex_unlock(&other.lock);
+        if (left > most)
+        {
+          most = left;
+          victim = &other;
+        }
+      }
+      if (victim == NULL)
+      {
+        return false;
+      }
+
+      // the victim keeps its next path unless that is all it has left, so
+      // that paths are still claimed roughly in order
+      pthread_mutex_lock(&victim->lock);
+      size_t left = victim->end - victim->next;
+      size_t beg = victim->next + left / 2;
+      size_t end = victim->end;
+      victim->end = beg;
+      pthread_mutex_unlock(&victim->lock);
+      if (beg < end)
+      {
+        pthread_mutex_lock(&worker.lock);
+        worker.next = beg + 1;
+        worker.end = end;
+        pthread_mutex_unlock(&worker.lock);
+        index = beg;
+        return true;
+      }
+      // someone else got there first, look again
+    }
+  }
+
+  // In input order a result may only be parsed if it is among the next
+  // _queue_size results to be delivered.  The first undelivered path is
+  // always the next one in its worker's range (or in the queue), so the
+  // results the handler waits for can always be parsed.
+  bool Pool::hasRoom(size_t index) const
+  {
+    return _input_order ? index < _delivered + _queue_size
+                        : _pending < _queue_size;
+  }
+
+  void Pool::work(Worker& worker)
+  {
+    size_t index = 0;
+    while (this->claim(worker, index))
+    {
+      ID3_Tag* tag = NULL;
+      pthread_mutex_lock(&_lock);
+      while (!_stop && !this->hasRoom(index))
+      {
+        pthread_cond_wait(&_consumed, &_lock);
+      }
+      if (_stop)
+      {
+        pthread_mutex_unlock(&_lock);
+        break;
+      }
+      ++_pending;
+      if (!worker.tags.empty())
+      {
+        tag = worker.tags.back();
+        worker.tags.pop_back();
+      }
+      pthread_mutex_unlock(&_lock);
+
+      if (tag == NULL)
+      {
+        tag = new ID3_Tag;
+      }
+      else
+      {
+        tag->Clear();
+      }
+      linkAndProcess(index, _paths[index], _tags, _cache, *_handler, *tag);
+
+      Result result = { index, tag, &worker };
+      pthread_mutex_lock(&_lock);
+      if (_input_order)
+      {
+        _sorted[index] = result;
+      }
+      else
+      {
+        _done.push_back(result);
+      }
+      pthread_cond_signal(&_produced);
+      pthread_mutex_unlock(&_lock);
+    }
+
+    pthread_mutex_lock(&_lock);
+    --_running;
+    pthread_cond_signal(&_produced);
+    pthread_mutex_unlock(&_lock);
+  }
+
+  // Waits for the next result to deliver; false once there are none left.
+  // Called with _lock held.
+  bool Pool::nextResult(Result& result)
+  {
+    for (;;)
+    {
+      if (_input_order)
+      {
+        std::map<size_t, Result>::iterator si = _sorted.find(_delivered);
+        if (si != _sorted.end())
+        {
+          result = si->second;
+          _sorted.erase(si);
+          return true;
+        }
+      }
+      else if (!_done.empty())
+      {
+        result = _done.front();
+        _done.pop_front();
+        return true;
+      }
+      if (_running == 0)
+      {
+        return false;
+      }
+      pthread_cond_wait(&_produced, &_lock);
+    }
+  }
+
+  // Stops the workers and waits for them.  Called with _lock held.
+  void Pool::finish()
+  {
+    _stop = true;
+    pthread_cond_broadcast(&_consumed);
+    pthread_mutex_unlock(&_lock);
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+      if (_workers[i].started)
+      {
+        pthread_join(_workers[i].thread, NULL);
+      }
+    }
+  }
+
+  size_t Pool::run(ID3_Batch::Handler& handler)
+  {
+    _handler = &handler;
+    pthread_mutex_lock(&_lock);
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+      Worker& worker = _workers[i];
+      worker.started = pthread_create(&worker.thread, NULL, runWorker, &worker) == 0;
+      if (worker.started)
+      {
+        ++_running;
+      }
+    }
+    if (_running == 0)
+    {
+      pthread_mutex_unlock(&_lock);
+      return parseSerially(_paths, _count, _tags, _cache, handler);
+    }
+
+    Result result;
+    while (this->nextResult(result))
+    {
+      pthread_mutex_unlock(&_lock);
+      bool more = true;
+      try
+      {
+        more = handler.Handle(result.index, _paths[result.index], *result.tag);
+      }
+      catch (...)
+      {
+        pthread_mutex_lock(&_lock);
+        result.worker->tags.push_back(result.tag);
+        this->finish();
+        throw;
+      }
+      pthread_mutex_lock(&_lock);
+      ++_delivered;
+      --_pending;
+      result.worker->tags.push_back(result.tag);
+      pthread_cond_broadcast(&_consumed);
+      if (!more)
+      {
+        break;
+      }
+    }
+    size_t delivered = _delivered;
+    this->finish();
+    return delivered;
+  }
+#endif /* HAVE_PTHREAD_H */
+};
+
+/** Creates a batch that parses the given tag types, with one thread per
+ ** processor, delivering the tags in the order they are parsed.
+ **
+ ** @param tags The tag types to parse, as for ID3_Tag::Link()
+ **/
+ID3_Batch::ID3_Batch(flags_t tags)
+  : _tags(tags),
+    _cache(NULL),
+    _threads(0),
+    _input_order(false),
+    _queue_size(DEFAULT_QUEUESIZE)
+{
+}
+
+/** Sets which tag types to parse, as for ID3_Tag::Link(). **/
+void ID3_Batch::SetTags(flags_t tags)
+{
+  _tags = tags;
+}
+
+/** Sets a cache to link the files through, see ID3_Tag::Link(const char*,
+ ** ID3_ParseCache&, flags_t).  NULL, the default, parses every file.
+ **/
+void ID3_Batch::SetCache(ID3_ParseCache* cache)
+{
+  _cache = cache;
+}
+
+/** Sets the number of parsing threads; 0 (the default) uses one thread per
+ ** processor.  Fewer threads are used when there are fewer paths.
+ **/
+void ID3_Batch::SetThreads(size_t threads)
+{
+  _threads = threads;
+}
+
+/** Sets whether the handler gets the tags in the order of the paths passed
+ ** to Parse() (true), or in the order they are parsed (false, the default).
+ ** Delivering the tags in order makes threads wait when the file the handler
+ ** needs next is slow to parse.
+ **/
+void ID3_Batch::SetInputOrder(bool inputOrder)
+{
+  _input_order = inputOrder;
+}
+
+/** Sets how many parsed tags may wait for the handler (64 by default).
+ **/
+void ID3_Batch::SetQueueSize(size_t size)
+{
+  _queue_size = max<size_t>(1, size);
+}
+
+/** Parses the files and passes each tag to the handler.
+ **
+ ** The handler returns whether to go on: once it returns false no more
+ ** tags are delivered and Parse() returns as soon as the files being parsed
+ ** are done.  Files that can't be opened are delivered as empty tags, with
+ ** a file size of 0.
+ **
+ ** @param paths The names of the files to parse
+ ** @param count The number of names
+ ** @param handler Gets the tags
+ ** @return The number of tags passed to the handler
+ **/
+size_t ID3_Batch::Parse(const char* const* paths, size_t count,
+                        Handler& handler) const
+{
+  size_t threads = _threads ? _threads : NumProcessors();
+  threads = min(threads, count);
+#if defined HAVE_PTHREAD_H
+  if (threads > 1)
+  {
+    Pool pool(paths, count, _tags, _cache, threads, _input_order, _queue_size);
+    return pool.run(handler);
+  }
+#endif
+  return parseSerially(paths, count, _tags, _cache, handler);
+}
+
+/** Returns the number of processors online, or 1 if it can't be determined.
+ **/
+size_t ID3_Batch::NumProcessors()
+{
+  long num = 1;
+#if defined HAVE_UNISTD_H && defined _SC_NPROCESSORS_ONLN
+  num = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return num > 0 ? (size_t) num : 1;
+}
@@ -138,6 +138,17 @@ extern "C"
     }
   }
 
+  ID3_C_EXPORT size_t CCONV
+  ID3Tag_AttachFrames(ID3Tag *tag, ID3Frame **frames, size_t num, bool trusted)
+  {
+    size_t attached = 0;
+    if (tag)
+    {
+      ID3_CATCH(attached = reinterpret_cast<ID3_Tag *>(tag)->AttachFrames(reinterpret_cast<ID3_Frame **>(frames), num, trusted));
+    }
+    return attached;
+  }
+
   ID3_C_EXPORT ID3Frame* CCONV
   ID3Tag_RemoveFrame(ID3Tag *tag, const ID3Frame *frame)
   {
@@ -338,6 +349,28 @@ extern "C"
     return reinterpret_cast<ID3TagConstIterator*>(iter);
   }
 
+  ID3_C_EXPORT void CCONV
+  ID3Tag_SetParseStats(ID3Tag *tag, bool stats)
+  {
+    if (tag)
+    {
+      ID3_CATCH(reinterpret_cast<ID3_Tag *>(tag)->SetParseStats(stats));
+    }
+  }
+
+  ID3_C_EXPORT const ID3_ParseStats* CCONV
+  ID3Tag_GetParseStats(const ID3Tag *tag)
+  {
+    const ID3_ParseStats* stats = NULL;
+
+    if (tag)
+    {
+      ID3_CATCH(stats = reinterpret_cast<const ID3_Tag *>(tag)->GetParseStats());
+    }
+
+    return stats;
+  }
+
   ID3_C_EXPORT void CCONV
   ID3TagIterator_Delete(ID3TagIterator *iter)
   {
@@ -0,0 +1,517 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <map>
+#include <vector>
+#include "exporter.h"
+#include "batch.h"
+#include "writer.h"
+#include "utils.h"
+#include "flat_io.h"
+
+/** \class ID3_Exporter exporter.h id3/exporter.h
+ ** \brief Writes chosen frames and mp3 properties of many files to a
+ ** columnar file.
+ **
+ ** Copying the tags of a whole collection into a database one
+ ** ID3_GetString() at a time allocates a string for every value and keeps a
+ ** single processor busy.  An ID3_Exporter parses the files with an
+ ** ID3_Batch and writes one row per file, with a column for every frame
+ ** field or property added, into a compact binary file the database can load
+ ** in bulk.
+ **
+ ** \code
+ **   ID3_Exporter exporter(ID3TT_ID3);
+ **   exporter.AddColumn(ID3_Exporter::FILENAME);
+ **   exporter.AddColumn(ID3FID_TITLE);
+ **   exporter.AddColumn(ID3FID_LEADARTIST);
+ **   exporter.AddColumn(ID3_Exporter::SECONDS);
+ **
+ **   ofstream file("library.id3x", ios::out | ios::binary | ios::trunc);
+ **   ID3_OStreamWriter writer(file);
+ **   exporter.Export(paths, numPaths, writer);
+ ** \endcode
+ **
+ ** The rows are written in row groups of GetRowGroupSize() files, so only
+ ** the values of one group are held in memory however many files there are.
+ ** Within a group every column is stored by itself.  The strings of a column
+ ** are kept once each in a pool, and the rows refer to them by number, so a
+ ** column with few distinct values, such as the artist or the album, takes
+ ** little more than four bytes a row.  Text is given as ID3_GetString() gives
+ ** it, and the first frame with the id is used when there are several.
+ **
+ ** All numbers are 32 bit little endian and everything starts on a 4 byte
+ ** boundary:
+ **
+ ** \code
+ **   file header
+ **      0  "ID3X"
+ **      4  format version
+ **      8  number of columns
+ **     12  reserved
+ **   one column description of 24 bytes per column
+ **      0  0 for a frame field, 1 for a property
+ **      4  0 for integers, 1 for strings
+ **      8  frame id or property
+ **     12  field id, 0 for a property
+ **     16  name, padded with nuls: the text id of the frame or the name of
+ **         the property
+ **   row groups, each
+ **      0  number of rows
+ **      4  one chunk per column: the values of an integer column, 0 where a
+ **         file has none, or for a string column
+ **         0  number of strings n
+ **         4  size of the pool p
+ **         8  n + 1 offsets into the pool, the last one p
+ **            the pool, padded with nuls to 4 bytes
+ **            one number per row, 0 where a file has no value and i + 1 for
+ **            the i-th string
+ **   footer
+ **      0  number of row groups g
+ **      4  g times the offset of the group (low 32 bits, then high) and its
+ **         number of rows
+ **         the total number of rows
+ **         the offset of the footer (low 32 bits, then high)
+ **         "ID3X"
+ ** \endcode
+ **
+ ** The footer is written last, so the file can be written to a stream that
+ ** can't seek; a reader finds it through the last 12 bytes of the file.
+ **/
+
+using namespace dami;
+
+namespace
+{
+  const char   EXPORT_MAGIC[4]     = { 'I', 'D', '3', 'X' };
+  const uint32 EXPORT_VERSION      = 1;
+  const size_t EXPORT_GROUP_SIZE   = 65536;
+
+  const char* const propertyNames[ID3_Exporter::NUMPROPERTIES] =
+  {
+    "file", "size", "tags", "layer", "version", "bitrate", "freq", "mode",
+    "seconds", "frames", "vbrrate", "encoder"
+  };
+
+  void putOffset(BString& data, size_t val)
+  {
+    putNumber(data, (uint32)(val & 0xFFFFFFFF));
+    putNumber(data, (uint32)((val >> 16) >> 16));
+  }
+
+  void putPadding(BString& data)
+  {
+    data.append((4 - data.size() % 4) % 4, '\0');
+  }
+
+  enum ColumnKind { FRAME_COLUMN = 0, PROPERTY_COLUMN = 1 };
+  enum ColumnType { INTEGER_COLUMN = 0, STRING_COLUMN = 1 };
+
+  // the values of one column in the row group being filled
+  struct Column
+  {
+    ColumnKind  kind;
+    ColumnType  type;
+    int         id;
+    ID3_FieldID field;
+    char        name[8];
+
+    std::map<String, uint32> strings;   // string -> its number + 1
+    std::vector<uint32>      offsets;   // where each string starts in pool
+    String                   pool;
+    std::vector<uint32>      values;    // one per row
+
+    void Add(uint32 val)
+    {
+      values.push_back(val);
+    }
+
+    void Add(const String& str)
+    {
+      std::map<String, uint32>::iterator si = strings.find(str);
+      if (si == strings.end())
+      {
+        offsets.push_back(pool.size());
+        pool += str;
+        si = strings.insert(std::make_pair(str, (uint32)offsets.size())).first;
+      }
+      values.push_back(si->second);
+    }
+
+    void Render(BString& data) const
+    {
+      if (type == STRING_COLUMN)
+      {
+        putNumber(data, offsets.size());
+        putNumber(data, pool.size());
+        for (size_t i = 0; i < offsets.size(); ++i)
+        {
+          putNumber(data, offsets[i]);
+        }
+        putNumber(data, pool.size());
+        data.append(reinterpret_cast<const uchar*>(pool.data()), pool.size());
+        putPadding(data);
+      }
+      for (size_t i = 0; i < values.size(); ++i)
+      {
+        putNumber(data, values[i]);
+      }
+    }
+
+    void Reset()
+    {
+      strings.clear();
+      offsets.clear();
+      pool.erase();
+      values.clear();
+    }
+  };
+
+  uint32 tagTypes(const ID3_Tag& tag)
+  {
+    static const ID3_TagType types[] =
+    {
+      ID3TT_ID3V1, ID3TT_ID3V2, ID3TT_LYRICS3, ID3TT_LYRICS3V2, ID3TT_MUSICMATCH
+    };
+    uint32 found = 0;
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i)
+    {
+      if (tag.HasTagType(types[i]))
+      {
+        found |= types[i];
+      }
+    }
+    return found;
+  }
+
+  // fills the columns on the thread that called Export() and writes them
+  // out whenever a row group is full
+  class RowGroupWriter : public ID3_Batch::Handler
+  {
+  public:
+    RowGroupWriter(std::vector<Column>& columns, size_t groupSize, ID3_Writer& writer)
+      : _columns(columns), _group_size(groupSize), _writer(writer), _rows(0),
+        _total(0), _offset(0)
+    { }
+
+    void WriteHeader()
+    {
+      BString data;
+      data.append(reinterpret_cast<const uchar*>(EXPORT_MAGIC), sizeof(EXPORT_MAGIC));
+      putNumber(data, EXPORT_VERSION);
+      putNumber(data, _columns.size());
+      putNumber(data, 0);
+      for (size_t i = 0; i < _columns.size(); ++i)
+      {
+        const Column& col = _columns[i];
+        putNumber(data, col.kind);
+        putNumber(data, col.type);
+        putNumber(data, col.id);
+        putNumber(data, col.kind == FRAME_COLUMN ? col.field : 0);
+        data.append(reinterpret_cast<const uchar*>(col.name), sizeof(col.name));
+      }
+      this->Write(data);
+    }
+
+    bool Handle(size_t index, const char* path, ID3_Tag& tag)
+    {
+      const ID3_Tag& ctag = tag;
+      const Mp3_Headerinfo* info = ctag.GetMp3HeaderInfo();
+      for (std::vector<Column>::iterator ci = _columns.begin(); ci != _columns.end(); ++ci)
+      {
+        Column& col = *ci;
+        if (col.kind == FRAME_COLUMN)
+        {
+          this->AddField(col, ctag);
+          continue;
+        }
+        switch (col.id)
+        {
+          case ID3_Exporter::FILENAME:    col.Add(String(path ? path : "")); break;
+          case ID3_Exporter::FILESIZE:    col.Add(ctag.GetFileSize()); break;
+          case ID3_Exporter::TAGTYPES:    col.Add(tagTypes(ctag)); break;
+          case ID3_Exporter::LAYER:       col.Add(info ? info->layer : 0); break;
+          case ID3_Exporter::MPEGVERSION: col.Add(info ? info->version : 0); break;
+          case ID3_Exporter::BITRATE:     col.Add(info ? info->bitrate : 0); break;
+          case ID3_Exporter::FREQUENCY:   col.Add(info ? info->frequency : 0); break;
+          case ID3_Exporter::CHANNELMODE: col.Add(info ? info->channelmode : 0); break;
+          case ID3_Exporter::SECONDS:     col.Add(info ? info->time : 0); break;
+          case ID3_Exporter::FRAMES:      col.Add(info ? info->frames : 0); break;
+          case ID3_Exporter::VBRBITRATE:  col.Add(info ? info->vbr_bitrate : 0); break;
+          case ID3_Exporter::ENCODER:
+            if (info && info->encoder[0] != '\0')
+            {
+              const char* end = static_cast<const char*>(
+                ::memchr(info->encoder, '\0', sizeof(info->encoder)));
+              col.Add(String(info->encoder, end ? end : info->encoder + sizeof(info->encoder)));
+            }
+            else
+            {
+              col.Add((uint32)0);
+            }
+            break;
+          default:
+            col.Add((uint32)0);
+            break;
+        }
+      }
+      if (++_rows == _group_size)
+      {
+        this->Flush();
+      }
+      return true;
+    }
+
+    // writes the rows that are left and the footer
+    size_t Finish()
+    {
+      if (_rows > 0)
+      {
+        this->Flush();
+      }
+      BString data;
+      const size_t footer = _offset;
+      putNumber(data, _groups.size());
+      for (size_t i = 0; i < _groups.size(); ++i)
+      {
+        putOffset(data, _groups[i].first);
+        putNumber(data, _groups[i].second);
+      }
+      putNumber(data, _total);
+      putOffset(data, footer);
+      data.append(reinterpret_cast<const uchar*>(EXPORT_MAGIC), sizeof(EXPORT_MAGIC));
+      this->Write(data);
+      return _total;
+    }
+
+  private:
+    void AddField(Column& col, const ID3_Tag& tag)
+    {
+      const ID3_Frame* frame = tag.FindFirst((ID3_FrameID)col.id);
+      const ID3_Field* fld = frame ? frame->GetField(col.field) : NULL;
+      if (fld == NULL)
+      {
+        col.Add((uint32)0);
+      }
+      else if (col.type == INTEGER_COLUMN)
+      {
+        col.Add(fld->Get());
+      }
+      else
+      {
+        // the same text as ID3_GetString()
+        String data = fld->GetText();
+        ID3_TextEnc enc = fld->GetEncoding();
+        if (fld->IsEncodable() && enc != ID3TE_ISO8859_1 &&
+            ID3TE_NONE < enc && enc < ID3TE_NUMENCODINGS)
+        {
+          data = convert(data, enc, ID3TE_ISO8859_1);
+        }
+        col.Add(data);
+      }
+    }
+
+    void Flush()
+    {
+      BString data;
+      putNumber(data, _rows);
+      for (std::vector<Column>::iterator ci = _columns.begin(); ci != _columns.end(); ++ci)
+      {
+        ci->Render(data);
+        ci->Reset();
+      }
+      _groups.push_back(std::make_pair(_offset, (uint32)_rows));
+      _total += _rows;
+      _rows = 0;
+      this->Write(data);
+    }
+
+    void Write(const BString& data)
+    {
+      _writer.writeChars(data.data(), data.size());
+      _offset += data.size();
+    }
+
+    std::vector<Column>& _columns;
+    size_t               _group_size;
+    ID3_Writer&          _writer;
+    size_t               _rows;      // rows in the group being filled
+    size_t               _total;     // rows written
+    size_t               _offset;    // bytes written
+    std::vector<std::pair<size_t, uint32> > _groups;
+  };
+};
+
+class ID3_ExporterImpl
+{
+public:
+  ID3_ExporterImpl(flags_t tags)
+    : _tags(tags), _group_size(EXPORT_GROUP_SIZE), _threads(0), _cache(NULL)
+  { }
+
+  flags_t             _tags;
+  size_t              _group_size;
+  size_t              _threads;
+  ID3_ParseCache*     _cache;
+  std::vector<Column> _columns;
+};
+
+/** Creates an exporter without columns that parses the given tag types.
+ **
+ ** @param tags The tag types to parse, as for ID3_Tag::Link()
+ **/
+ID3_Exporter::ID3_Exporter(flags_t tags)
+  : _impl(new ID3_ExporterImpl(tags))
+{
+}
+
+ID3_Exporter::~ID3_Exporter()
+{
+  delete _impl;
+}
+
+/** Adds a column with a field of the first frame with the given id, e.g.
+ ** ID3FN_TEXT of ID3FID_TITLE.  Text fields are exported as strings,
+ ** integer fields as numbers.  Returns false if frames of that id have no
+ ** such field or it is binary.
+ **/
+bool ID3_Exporter::AddColumn(ID3_FrameID id, ID3_FieldID fld)
+{
+  if (id <= ID3FID_NOFRAME || id >= ID3FID_LASTFRAMEID)
+  {
+    return false;
+  }
+  ID3_Frame frame(id);
+  const ID3_Field* field = frame.GetField(fld);
+  if (field == NULL || field->GetType() == ID3FTY_BINARY)
+  {
+    return false;
+  }
+  Column col;
+  col.kind  = FRAME_COLUMN;
+  col.type  = field->GetType() == ID3FTY_INTEGER ? INTEGER_COLUMN : STRING_COLUMN;
+  col.id    = id;
+  col.field = fld;
+  ::memset(col.name, 0, sizeof(col.name));
+  const char* textid = frame.GetTextID();
+  ::strncpy(col.name, textid ? textid : "", sizeof(col.name) - 1);
+  _impl->_columns.push_back(col);
+  return true;
+}
+
+/** Adds a column with a property of the file, see ID3_Exporter::Property.
+ ** FILENAME and ENCODER are strings, the others numbers, 0 when unknown.
+ **/
+bool ID3_Exporter::AddColumn(Property prop)
+{
+  if (prop < FILENAME || prop >= NUMPROPERTIES)
+  {
+    return false;
+  }
+  Column col;
+  col.kind  = PROPERTY_COLUMN;
+  col.type  = (prop == FILENAME || prop == ENCODER) ? STRING_COLUMN : INTEGER_COLUMN;
+  col.id    = prop;
+  col.field = ID3FN_NOFIELD;
+  ::memset(col.name, 0, sizeof(col.name));
+  ::strncpy(col.name, propertyNames[prop], sizeof(col.name) - 1);
+  _impl->_columns.push_back(col);
+  return true;
+}
+
+size_t ID3_Exporter::NumColumns() const
+{
+  return _impl->_columns.size();
+}
+
+/** The name of a property in the column descriptions of an exported file,
+ ** e.g. "seconds" for SECONDS, or NULL if there is no such property.
+ **/
+const char* ID3_Exporter::GetPropertyName(Property prop)
+{
+  return (prop >= FILENAME && prop < NUMPROPERTIES) ? propertyNames[prop] : NULL;
+}
+
+/** Sets the number of rows in a row group (65536 by default).  Larger groups
+ ** share their string pools among more rows; smaller ones use less memory.
+ **/
+void ID3_Exporter::SetRowGroupSize(size_t rows)
+{
+  _impl->_group_size = rows > 0 ? rows : 1;
+}
+
+size_t ID3_Exporter::GetRowGroupSize() const
+{
+  return _impl->_group_size;
+}
+
+/** Sets the number of parsing threads, see ID3_Batch::SetThreads(). **/
+void ID3_Exporter::SetThreads(size_t threads)
+{
+  _impl->_threads = threads;
+}
+
+size_t ID3_Exporter::GetThreads() const
+{
+  return _impl->_threads;
+}
+
+/** Sets a cache to link the files through, see ID3_Batch::SetCache(). **/
+void ID3_Exporter::SetCache(ID3_ParseCache* cache)
+{
+  _impl->_cache = cache;
+}
+
+/** Parses the files and writes a row for each, in the order of the paths,
+ ** to writer.  Files that can't be opened get a row without values but
+ ** their name.
+ **
+ ** @param paths The names of the files to export
+ ** @param count The number of names
+ ** @param writer Gets the columnar file
+ ** @return The number of rows written
+ **/
+size_t ID3_Exporter::Export(const char* const* paths, size_t count, ID3_Writer& writer) const
+{
+  ID3_Batch batch(_impl->_tags);
+  batch.SetThreads(_impl->_threads);
+  batch.SetCache(_impl->_cache);
+  batch.SetInputOrder(true);
+
+  std::vector<Column> columns = _impl->_columns;
+  RowGroupWriter rows(columns, _impl->_group_size, writer);
+  rows.WriteHeader();
+  if (count > 0)
+  {
+    batch.Parse(paths, count, rows);
+  }
+  return rows.Finish();
+}
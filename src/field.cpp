@@ -1000,7 +1000,8 @@ static ID3_FieldDef ID3FD_CDM[] =
     ID3V2_2_1,                          // ENDING SPEC
     ID3FF_NONE,                         // FLAGS
     ID3FN_NOFIELD                       // LINKED FIELD
-  }
+  },
+  { ID3FN_NOFIELD }
 };
 
 static ID3_FieldDef ID3FD_SyncLyrics[] =
@@ -1771,13 +1772,34 @@ ID3_FieldImpl::operator=( const ID3_Field &rhs )
       }
       case ID3FTY_TEXTSTRING:
       {
-        this->SetEncoding(fld->GetEncoding());
-        this->SetText(fld->GetText());
+        if (_fixed_size == fld->_fixed_size &&
+            (_enc == fld->_enc || this->IsEncodable()))
+        {
+          // refer to the same text if it is shared, and keep all its items
+          _text = fld->_text;
+          _enc = fld->_enc;
+          _num_items = fld->_num_items;
+          _changed = true;
+        }
+        else
+        {
+          this->SetEncoding(fld->GetEncoding());
+          this->SetText(fld->GetText());
+        }
         break;
       }
       case ID3FTY_BINARY:
       {
-        this->SetBinary(fld->GetBinary());
+        if (_fixed_size == 0 || _fixed_size == fld->_binary.size())
+        {
+          // refer to the same data if it is shared
+          _binary = fld->_binary;
+          _changed = true;
+        }
+        else
+        {
+          this->SetBinary(fld->GetBinary());
+        }
         break;
       }
       default:
@@ -1795,7 +1817,7 @@ bool ID3_FieldImpl::SetEncoding(ID3_TextEnc enc)
     (ID3TE_NONE < enc && enc < ID3TE_NUMENCODINGS);
   if (changed)
   {
-    _text = convert(_text, _enc, enc);
+    _text.assign(convert(_text.str(), _enc, enc));
     _enc = enc;
     _changed = true;
   }
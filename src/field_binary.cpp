@@ -59,20 +59,11 @@ size_t ID3_FieldImpl::SetBinary(BString data) //< data to assign to this field.
   if (this->GetType() == ID3FTY_BINARY)
   {
     this->Clear();
-    size_t fixed = _fixed_size;
-    size = data.size();
-    if (fixed == 0)
+    if (_fixed_size != 0)
     {
-      _binary = data;
-    }
-    else
-    {
-      _binary.assign(data, 0, min(size, fixed));
-      if (size < fixed)
-      {
-        _binary.append(fixed - size, '\0');
-      }
+      data.resize(_fixed_size, '\0');
     }
+    _binary.take(data);
     size = _binary.size();
     _changed = true;
   }
@@ -84,7 +75,7 @@ BString ID3_FieldImpl::GetBinary() const
   BString data;
   if (this->GetType() == ID3FTY_BINARY)
   {
-    data = _binary;
+    data.assign(_binary.data(), _binary.size());
   }
   return data;
 }
@@ -197,7 +188,8 @@ bool ID3_FieldImpl::ParseBinary(ID3_Reader& reader)
 {
   // copy the remaining bytes, unless we're fixed length, in which case copy
   // the minimum of the remaining bytes vs. the fixed length
-  _binary = io::readAllBinary(reader);
+  BString data = io::readAllBinary(reader);
+  _binary.take(data);
   return true;
 }
 
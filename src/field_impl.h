@@ -31,6 +31,7 @@
 
 #include "field.h"
 #include "id3lib_frame.h"
+#include "shared_binary.h"
 
 struct ID3_FieldDef;
 struct ID3_FrameDef;
@@ -38,6 +39,7 @@ struct ID3_FrameDef;
 class ID3_FieldImpl : public ID3_Field
 {
   friend class ID3_FrameImpl;
+  friend class ID3_TagImpl; // for Serialize() and Deserialize()
 public:
   ~ID3_FieldImpl();
 
@@ -67,6 +69,7 @@ public:
   dami::String  GetText() const;
   dami::String  GetTextItem(size_t) const;
   size_t        SetText(dami::String);
+  size_t        TakeText(dami::String&);  // as SetText(), taking over the string's data
   size_t        AddText(dami::String);
 
   // Unicode string field functions
@@ -113,8 +116,8 @@ public:
   bool          HasChanged() const;
 
 private:
-  size_t        SetText_i(dami::String);
-  size_t        AddText_i(dami::String);
+  size_t        SetText_i(dami::String&);  // takes over the string's data
+  size_t        AddText_i(dami::String&);
 
 private:
   // To prevent public instantiation, the constructor is made private
@@ -127,10 +130,10 @@ private:
   const ID3_V2Spec    _spec_end;    // spec begin
   const flags_t       _flags;       // special field flags
   const ID3_FieldID   _linked_field;    // the ID of field where fixed size comes from
-  mutable bool        _changed;     // field changed since last parse/render?
+  bool                _changed;     // field changed since last parse/update?
 
-  dami::BString       _binary;      // for binary strings
-  dami::String        _text;        // for ascii strings
+  dami::SharedBinary  _binary;      // for binary strings, shared when large
+  dami::SharedText    _text;        // for ascii strings, shared when large
   uint32              _integer;     // for numbers
 
   size_t              _fixed_size;  // for fixed length fields (0 if not)
@@ -127,7 +127,7 @@ String ID3_FieldImpl::GetText() const
   String data;
   if (this->GetType() == ID3FTY_TEXTSTRING)
   {
-    data = _text;
+    data = _text.str();
   }
   return data;
 }
@@ -149,7 +149,7 @@ String ID3_FieldImpl::GetTextItem(size_t index) const
 
 namespace
 {
-  String getFixed(String data, size_t size)
+  String getFixed(const String& data, size_t size)
   {
     String text(data, 0, size);
     if (text.size() < size)
@@ -161,18 +161,19 @@ namespace
 }
 
 
-size_t ID3_FieldImpl::SetText_i(String data)
+size_t ID3_FieldImpl::SetText_i(String& data)
 {
   this->Clear();
   if (_fixed_size > 0)
   {
-    _text = getFixed(data, _fixed_size);
+    String fixed = getFixed(data, _fixed_size);
+    _text.take(fixed);
   }
   else
   {
-    _text = data;
+    _text.take(data);
   }
-  ID3D_NOTICE( "SetText_i: text = \"" << _text << "\"" );
+  ID3D_NOTICE( "SetText_i: text = \"" << _text.str() << "\"" );
   _changed = true;
 
   if (_text.size() == 0)
@@ -188,6 +189,11 @@ size_t ID3_FieldImpl::SetText_i(String data)
 }
 
 size_t ID3_FieldImpl::SetText(String data)
+{
+  return this->TakeText(data);
+}
+
+size_t ID3_FieldImpl::TakeText(String& data)
 {
   size_t len = 0;
   if (this->GetType() == ID3FTY_TEXTSTRING)
@@ -211,7 +217,7 @@ size_t ID3_FieldImpl::SetText(String data)
  **
  ** \param string The string to add to the field
  **/
-size_t ID3_FieldImpl::AddText_i(String data)
+size_t ID3_FieldImpl::AddText_i(String& data)
 {
   size_t len = 0;  // how much of str we copied into this field (max is strLen)
   ID3D_NOTICE ("ID3_FieldImpl::AddText_i: Adding \"" << data << "\"" );
@@ -225,12 +231,14 @@ size_t ID3_FieldImpl::AddText_i(String data)
   {
 
     // ASSERT(_fixed_size == 0)
-    _text += '\0';
+    String& text = _text.edit();
+    text += '\0';
     if (ID3TE_IS_DOUBLE_BYTE_ENC(this->GetEncoding()))
     {
-      _text += '\0';
+      text += '\0';
     }
-    _text.append(data);
+    text.append(data);
+    _text.settle();
     len = data.size();
     _num_items++;
   }
@@ -385,13 +393,12 @@ void ID3_FieldImpl::RenderText(ID3_Writer& writer) const
 
   if (_flags & ID3FF_CSTR)
   {
-    writeEncodedString(writer, _text, enc);
+    writeEncodedString(writer, _text.str(), enc);
   }
   else
   {
-    writeEncodedText(writer, _text, enc);
+    writeEncodedText(writer, _text.str(), enc);
   }
-  _changed = false;
 };
 
 /** Returns the number of items in a text list.
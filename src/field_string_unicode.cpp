@@ -127,7 +127,7 @@ const unicode_t* ID3_FieldImpl::GetRawUnicodeTextItem(size_t index) const
       ID3TE_IS_DOUBLE_BYTE_ENC(this->GetEncoding()) &&
       index < this->GetNumTextItems())
   {
-    String unicode = _text + '\0' + '\0';
+    String unicode = _text.str() + '\0' + '\0';
     text = (unicode_t *) unicode.data();
     for (size_t i = 0; i < index; ++i)
     {
@@ -0,0 +1,67 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_FLAT_IO_H_
+#define _ID3LIB_FLAT_IO_H_
+
+#include "id3/id3lib_strings.h"
+
+// The little endian numbers of the flat forms id3lib keeps in memory and on
+// disk: serialized tags, cache entries and exported collections.
+
+namespace dami
+{
+  inline void putNumber(BString& data, uint32 val)
+  {
+    data += (uchar)(val & 0xFF);
+    data += (uchar)((val >> 8) & 0xFF);
+    data += (uchar)((val >> 16) & 0xFF);
+    data += (uchar)((val >> 24) & 0xFF);
+  }
+
+  inline void setNumber(BString& data, size_t pos, uint32 val)
+  {
+    data[pos]     = (uchar)(val & 0xFF);
+    data[pos + 1] = (uchar)((val >> 8) & 0xFF);
+    data[pos + 2] = (uchar)((val >> 16) & 0xFF);
+    data[pos + 3] = (uchar)((val >> 24) & 0xFF);
+  }
+
+  inline uint32 getNumber(const uchar* data)
+  {
+    return (uint32)data[0] | ((uint32)data[1] << 8) |
+      ((uint32)data[2] << 16) | ((uint32)data[3] << 24);
+  }
+
+  // are the size bytes at offset within total bytes?
+  inline bool inside(size_t offset, size_t size, size_t total)
+  {
+    return offset <= total && size <= total - offset;
+  }
+};
+
+#endif /* _ID3LIB_FLAT_IO_H_ */
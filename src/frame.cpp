@@ -32,6 +32,7 @@
 //#include "frame.h"
 //#include "readers.h"
 #include "frame_impl.h"
+#include "shared_binary.h"
 
 /** \class ID3_Frame frame.h id3/frame.h
  ** \brief The representative class of an id3v2 frame.
@@ -74,6 +75,12 @@ ID3_Frame::~ID3_Frame()
   delete _impl;
 }
 
+// a frame that was moved from carries on as a new one without an id
+ID3_FrameImpl& ID3_Frame::impl() const
+{
+  return dami::instance(_impl);
+}
+
 /** Clears the frame of all data and resets the frame such that it can take
  ** on the form of any id3v2 frame that id3lib supports.
  **
@@ -81,7 +88,7 @@ ID3_Frame::~ID3_Frame()
  **/
 void ID3_Frame::Clear()
 {
-  _impl->Clear();
+  impl().Clear();
 }
 
 /** Returns the type of frame that the object represents.
@@ -93,7 +100,7 @@ void ID3_Frame::Clear()
  **/
 ID3_FrameID ID3_Frame::GetID() const
 {
-  return _impl->GetID();
+  return impl().GetID();
 }
 
 /** Establishes the internal structure of an ID3_FrameImpl object so
@@ -115,17 +122,17 @@ ID3_FrameID ID3_Frame::GetID() const
  **/
 bool ID3_Frame::SetID(ID3_FrameID id)
 {
-  return _impl->SetID(id);
+  return impl().SetID(id);
 }
 
 bool ID3_Frame::SetSpec(ID3_V2Spec spec)
 {
-  return _impl->SetSpec(spec);
+  return impl().SetSpec(spec);
 }
 
 ID3_V2Spec ID3_Frame::GetSpec() const
 {
-  return _impl->GetSpec();
+  return impl().GetSpec();
 }
 
 /** Returns a pointer to the frame's internal field indicated by the
@@ -146,37 +153,44 @@ ID3_Field& ID3_Frame::Field(ID3_FieldID fieldName) const
 
 ID3_Field* ID3_Frame::GetField(ID3_FieldID fieldName) const
 {
-  return _impl->GetField(fieldName);
+  return impl().GetField(fieldName);
 }
 
 size_t ID3_Frame::NumFields() const
 {
-  return _impl->NumFields();
+  return impl().NumFields();
 }
 
 /*
 ID3_Field* ID3_Frame::GetFieldNum(size_t index) const
 {
-  return _impl->GetFieldNum(index);
+  return impl().GetFieldNum(index);
 }
 */
 
 size_t ID3_Frame::Size()
 {
-  return _impl->Size();
+  return impl().Size();
 }
 
 
 bool ID3_Frame::HasChanged() const
 {
-  return _impl->HasChanged();
+  return impl().HasChanged();
 }
 
 ID3_Frame& ID3_Frame::operator=( const ID3_Frame &rFrame )
 {
   if (this != &rFrame)
   {
-    *_impl = rFrame;
+    if (_impl == NULL)
+    {
+      _impl = new ID3_FrameImpl(rFrame);  // this frame was moved from
+    }
+    else
+    {
+      *_impl = rFrame;
+    }
   }
   return *this;
 }
@@ -188,27 +202,27 @@ const char* ID3_Frame::GetDescription(ID3_FrameID id)
 
 const char* ID3_Frame::GetDescription() const
 {
-  return _impl->GetDescription();
+  return impl().GetDescription();
 }
 
 const char* ID3_Frame::GetTextID() const
 {
-  return _impl->GetTextID();
+  return impl().GetTextID();
 }
 
 bool ID3_Frame::Parse(ID3_Reader& reader)
 {
-  return _impl->Parse(reader);
+  return impl().Parse(reader);
 }
 
 ID3_Err ID3_Frame::Render(ID3_Writer& writer) const
 {
-  return _impl->Render(writer);
+  return impl().Render(writer);
 }
 
 bool ID3_Frame::Contains(ID3_FieldID id) const
 {
-  return _impl->Contains(id);
+  return impl().Contains(id);
 }
 
 /** Sets the compression flag within the frame.  When the compression flag is
@@ -218,7 +232,7 @@ bool ID3_Frame::Contains(ID3_FieldID id) const
  **/
 bool ID3_Frame::SetCompression(bool b)
 {
-  return _impl->SetCompression(b);
+  return impl().SetCompression(b);
 }
 
 /** Returns whether or not the compression flag is set.  After parsing a tag,
@@ -231,32 +245,32 @@ bool ID3_Frame::SetCompression(bool b)
  **/
 bool ID3_Frame::GetCompression() const
 {
-  return _impl->GetCompression();
+  return impl().GetCompression();
 }
 
 size_t ID3_Frame::GetDataSize() const
 {
-  return _impl->GetDataSize();
+  return impl().GetDataSize();
 }
 
 bool ID3_Frame::SetEncryptionID(uchar id)
 {
-  return _impl->SetEncryptionID(id);
+  return impl().SetEncryptionID(id);
 }
 
 uchar ID3_Frame::GetEncryptionID() const
 {
-  return _impl->GetEncryptionID();
+  return impl().GetEncryptionID();
 }
 
 bool ID3_Frame::SetGroupingID(uchar id)
 {
-  return _impl->SetGroupingID(id);
+  return impl().SetGroupingID(id);
 }
 
 uchar ID3_Frame::GetGroupingID() const
 {
-  return _impl->GetGroupingID();
+  return impl().GetGroupingID();
 }
 
 namespace
@@ -309,12 +323,12 @@ namespace
 ID3_Frame::Iterator*
 ID3_Frame::CreateIterator()
 {
-  return new IteratorImpl(*_impl);
+  return new IteratorImpl(impl());
 }
 
 ID3_Frame::ConstIterator*
 ID3_Frame::CreateIterator() const
 {
-  return new ConstIteratorImpl(*_impl);
+  return new ConstIteratorImpl(impl());
 }
 
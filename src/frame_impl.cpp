@@ -193,9 +193,14 @@ size_t ID3_FrameImpl::Size()
       {
         enc = (ID3_TextEnc) (*fi)->Get();
       }
-      else
+      else if ((*fi)->IsEncodable() && (*fi)->GetEncoding() != enc)
       {
-        (*fi)->SetEncoding(enc);
+        // size of the field as it will be rendered, see renderFields(); the
+        // tag's frames have been converted by ConvertFields() on Update()
+        ID3_FieldImpl copy(*static_cast<ID3_FieldImpl*>(*fi));
+        copy.SetEncoding(enc);
+        bytesUsed += copy.BinSize();
+        continue;
       }
       bytesUsed += (*fi)->BinSize();
     }
@@ -220,6 +225,42 @@ bool ID3_FrameImpl::HasChanged() const
   return changed;
 }
 
+void ID3_FrameImpl::SetChanged(bool b)
+{
+  _changed = b;
+  if (!b)
+  {
+    for (iterator fi = _fields.begin(); fi != _fields.end(); ++fi)
+    {
+      if (*fi)
+      {
+        static_cast<ID3_FieldImpl*>(*fi)->_changed = false;
+      }
+    }
+  }
+}
+
+// Converts the encodable fields to the frame's text encoding in place, so
+// that Size() and Render() don't have to convert copies of them each time.
+void ID3_FrameImpl::ConvertFields()
+{
+  ID3_TextEnc enc = ID3TE_ISO8859_1;
+  for (iterator fi = _fields.begin(); fi != _fields.end(); ++fi)
+  {
+    if (*fi && (*fi)->InScope(this->GetSpec()))
+    {
+      if ((*fi)->GetID() == ID3FN_TEXTENC)
+      {
+        enc = (ID3_TextEnc) (*fi)->Get();
+      }
+      else if ((*fi)->IsEncodable() && (*fi)->GetEncoding() != enc)
+      {
+        (*fi)->SetEncoding(enc);
+      }
+    }
+  }
+}
+
 ID3_FrameImpl &
 ID3_FrameImpl::operator=( const ID3_Frame &rFrame )
 {
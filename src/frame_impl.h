@@ -50,6 +50,7 @@
 
 class ID3_FrameImpl
 {
+  friend class ID3_TagImpl; // for Serialize() and Deserialize()
   typedef std::bitset<ID3FN_LASTFIELDID> Bitset;
   typedef std::vector<ID3_Field *> Fields;
 public:
@@ -136,7 +137,12 @@ protected:
   void        _UpdateFieldDeps();
 
 private:
-  mutable bool        _changed;    // frame changed since last parse/render?
+  // ID3_TagImpl's access to the frames it owns
+  static ID3_FrameImpl& Of(ID3_Frame& frame) { return frame.impl(); }
+  void        SetChanged(bool);
+  void        ConvertFields();
+
+  bool        _changed;            // frame changed since last parse/update?
   Bitset      _bitset;             // which fields are present?
   Fields      _fields;
   ID3_FrameHeader _hdr;            //
@@ -37,6 +37,7 @@
 
 #include "tag.h"
 #include "frame_impl.h"
+#include "field_impl.h"
 #include "id3/io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
 #include "io_strings.h"
 #include "io_helpers.h"
@@ -59,9 +60,17 @@ namespace
           enc = static_cast<ID3_TextEnc>(fld->Get());
           ID3D_NOTICE( "id3::v2::renderFields(): found encoding = " << enc );
         }
-        else
+        else if (fld->IsEncodable() && fld->GetEncoding() != enc)
         {
-          fld->SetEncoding(enc);
+          // the field hasn't been converted to the frame's encoding by
+          // ConvertFields() yet; render a converted copy so that rendering
+          // doesn't modify the frame
+          ID3_FieldImpl copy(*static_cast<const ID3_FieldImpl*>(fld));
+          copy.SetEncoding(enc);
+          err = copy.Render(writer);
+          if (err != ID3E_NoError)
+            return err;
+          continue;
         }
         err = fld->Render(writer);
         if (err != ID3E_NoError)
@@ -162,7 +171,6 @@ ID3_Err ID3_FrameImpl::Render(ID3_Writer& writer) const
     // Write the field data
     writer.writeChars(flds.data(), fldSize);
   }
-  _changed = false;
   return ID3E_NoError;
 }
 
@@ -44,20 +44,19 @@ bool ID3_Header::SetSpec(ID3_V2Spec spec)
     {  4,     4,     2,     false, 6,   false }  // ID3V2_4_0
   };
   
-  bool changed = false;
   if (spec < ID3V2_EARLIEST || spec > ID3V2_LATEST)
   {
-    changed = _spec != ID3V2_UNKNOWN;
-    _spec = ID3V2_UNKNOWN;
-    _info = NULL;
+    spec = ID3V2_UNKNOWN;
   }
-  else
+  // don't write anything if the spec stays the same: ID3_TagImpl::Size()
+  // sets the spec of every frame and may be called from several threads
+  if (_spec == spec)
   {
-    changed = _spec != spec;
-    _spec = spec;
-    _info = &_spec_info[_spec - ID3V2_EARLIEST];
+    return false;
   }
-  _changed = _changed || changed;
-  return changed;
+  _spec = spec;
+  _info = (spec == ID3V2_UNKNOWN) ? NULL : &_spec_info[_spec - ID3V2_EARLIEST];
+  _changed = true;
+  return true;
 }
 
@@ -51,6 +51,7 @@ public:
   ID3_Header()
     : _spec (ID3V2_UNKNOWN),
       _data_size (0),
+      _info (NULL),
       _changed (false)
   {
     this->Clear();
@@ -97,7 +97,7 @@ bool ID3_FrameHeader::Parse(ID3_Reader& reader)
   {
     return false;
   }
-  if (reader.getEnd() < reader.getCur() + 10)
+  if (reader.getEnd() < reader.getCur() + this->Size())
   {
     return false;
   }
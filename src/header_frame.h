@@ -71,6 +71,15 @@ public:
   bool GetReadOnly() const    { return _flags.test(READONLY); }
   void                SetUnknownFrame(const char*);
 
+  // all of the flags at once, as they appear in the frame header
+  flags_t GetFlags() const    { return _flags.get(); }
+  bool ResetFlags(flags_t f)
+  {
+    bool changed = _flags.set(f);
+    _changed = _changed || changed;
+    return changed;
+  }
+
 protected:
   bool                SetFlags(uint16 f, bool b)
   {
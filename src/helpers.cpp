@@ -38,6 +38,7 @@
 
 #include "helpers.h"
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "field_impl.h"
 
 using namespace dami;
 
@@ -99,20 +100,50 @@ size_t id3::v2::removeFrames(ID3_TagImpl& tag, ID3_FrameID id)
 
 String id3::v2::getFrameText(const ID3_TagImpl& tag, ID3_FrameID id)
 {
-  ID3_Frame* frame = tag.Find(id);
+  ID3_Frame* frame = tag.FindFirst(id);
   return getString(frame, ID3FN_TEXT);
 }
 
-ID3_Frame* id3::v2::setFrameText(ID3_TagImpl& tag, ID3_FrameID id, String text)
+namespace
 {
-  ID3_Frame* frame = tag.Find(id);
-  if (!frame)
+  // the frame with the given id, added if there is none
+  ID3_Frame* textFrame(ID3_TagImpl& tag, ID3_FrameID id)
   {
-    frame = LEAKTESTNEW( ID3_Frame(id));
-    if(!tag.AttachFrame(frame)) return NULL;
+    ID3_Frame* frame = tag.Find(id);
+    if (!frame)
+    {
+      frame = LEAKTESTNEW( ID3_Frame(id));
+      if(!tag.AttachFrame(frame)) return NULL;
+    }
+    return frame;
   }
-  frame->GetField(ID3FN_TEXT)->Set(text.c_str());
 
+  // sets the text of the frame to text up to its first '\0', as
+  // Set(const char*) does, taking over text's data instead of copying it
+  ID3_Frame* takeFrameText(ID3_TagImpl& tag, ID3_FrameID id, String& text)
+  {
+    ID3_Frame* frame = textFrame(tag, id);
+    if (frame)
+    {
+      text.erase(min(text.find('\0'), text.size()));
+      static_cast<ID3_FieldImpl*>(frame->GetField(ID3FN_TEXT))->TakeText(text);
+    }
+    return frame;
+  }
+};
+
+ID3_Frame* id3::v2::setFrameText(ID3_TagImpl& tag, ID3_FrameID id, String text)
+{
+  return takeFrameText(tag, id, text);
+}
+
+ID3_Frame* id3::v2::setFrameText(ID3_TagImpl& tag, ID3_FrameID id, const char* text)
+{
+  ID3_Frame* frame = textFrame(tag, id);
+  if (frame)
+  {
+    frame->GetField(ID3FN_TEXT)->Set(text);
+  }
   return frame;
 }
 
@@ -121,10 +152,10 @@ ID3_Frame* id3::v2::setFrameText(ID3_TagImpl& tag, ID3_FrameID id, String text)
 ID3_Frame* id3::v2::hasArtist(const ID3_TagImpl& tag)
 {
   ID3_Frame* fp = NULL;
-  (fp = tag.Find(ID3FID_LEADARTIST)) ||
-  (fp = tag.Find(ID3FID_BAND))       ||
-  (fp = tag.Find(ID3FID_CONDUCTOR))  ||
-  (fp = tag.Find(ID3FID_COMPOSER));
+  (fp = tag.FindFirst(ID3FID_LEADARTIST)) ||
+  (fp = tag.FindFirst(ID3FID_BAND))       ||
+  (fp = tag.FindFirst(ID3FID_CONDUCTOR))  ||
+  (fp = tag.FindFirst(ID3FID_COMPOSER));
   return fp;
 }
 
@@ -135,6 +166,12 @@ String id3::v2::getArtist(const ID3_TagImpl& tag)
 }
 
 ID3_Frame* id3::v2::setArtist(ID3_TagImpl& tag, String text)
+{
+  removeArtists(tag);
+  return takeFrameText(tag, ID3FID_LEADARTIST, text);
+}
+
+ID3_Frame* id3::v2::setArtist(ID3_TagImpl& tag, const char* text)
 {
   removeArtists(tag);
   return setFrameText(tag, ID3FID_LEADARTIST, text);
@@ -159,7 +196,7 @@ size_t id3::v2::removeArtists(ID3_TagImpl& tag)
 
 ID3_Frame* id3::v2::hasAlbum(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_ALBUM);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_ALBUM);
   return(frame);
 }
 
@@ -169,6 +206,11 @@ String id3::v2::getAlbum(const ID3_TagImpl& tag)
 }
 
 ID3_Frame* id3::v2::setAlbum(ID3_TagImpl& tag, String text)
+{
+  return takeFrameText(tag, ID3FID_ALBUM, text);
+}
+
+ID3_Frame* id3::v2::setAlbum(ID3_TagImpl& tag, const char* text)
 {
   return setFrameText(tag, ID3FID_ALBUM, text);
 }
@@ -182,7 +224,7 @@ size_t id3::v2::removeAlbums(ID3_TagImpl& tag)
 
 ID3_Frame* id3::v2::hasTitle(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_TITLE);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_TITLE);
   return(frame);
 }
 
@@ -192,6 +234,11 @@ String id3::v2::getTitle(const ID3_TagImpl& tag)
 }
 
 ID3_Frame* id3::v2::setTitle(ID3_TagImpl& tag, String text)
+{
+  return takeFrameText(tag, ID3FID_TITLE, text);
+}
+
+ID3_Frame* id3::v2::setTitle(ID3_TagImpl& tag, const char* text)
 {
   return setFrameText(tag, ID3FID_TITLE, text);
 }
@@ -205,7 +252,7 @@ size_t id3::v2::removeTitles(ID3_TagImpl& tag)
 
 ID3_Frame* id3::v2::hasYear(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_YEAR);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_YEAR);
   return(frame);
 }
 
@@ -215,6 +262,11 @@ String id3::v2::getYear(const ID3_TagImpl& tag)
 }
 
 ID3_Frame* id3::v2::setYear(ID3_TagImpl& tag, String text)
+{
+  return takeFrameText(tag, ID3FID_YEAR, text);
+}
+
+ID3_Frame* id3::v2::setYear(ID3_TagImpl& tag, const char* text)
 {
   return setFrameText(tag, ID3FID_YEAR, text);
 }
@@ -229,30 +281,30 @@ size_t id3::v2::removeYears(ID3_TagImpl& tag)
 ID3_Frame* id3::v2::hasV1Comment(const ID3_TagImpl& tag)
 {
   ID3_Frame* frame = NULL;
-  (frame = tag.Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, STR_V1_COMMENT_DESC)) ||
-  (frame = tag.Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, ""                 )) ||
-  (frame = tag.Find(ID3FID_COMMENT));
+  (frame = tag.FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, STR_V1_COMMENT_DESC)) ||
+  (frame = tag.FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, ""                 )) ||
+  (frame = tag.FindFirst(ID3FID_COMMENT));
   return(frame);
 }
 
 ID3_Frame* id3::v2::hasComment(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_COMMENT);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_COMMENT);
   return(frame);
 }
 
 String id3::v2::getV1Comment(const ID3_TagImpl& tag)
 {
   ID3_Frame* frame;
-  (frame = tag.Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, STR_V1_COMMENT_DESC)) ||
-  (frame = tag.Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, ""                 )) ||
-  (frame = tag.Find(ID3FID_COMMENT));
+  (frame = tag.FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, STR_V1_COMMENT_DESC)) ||
+  (frame = tag.FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, ""                 )) ||
+  (frame = tag.FindFirst(ID3FID_COMMENT));
   return getString(frame, ID3FN_TEXT);
 }
 
 String id3::v2::getComment(const ID3_TagImpl& tag, String desc)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, desc.c_str());
+  ID3_Frame* frame = tag.FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, desc.c_str());
   return getString(frame, ID3FN_TEXT);
 }
 
@@ -339,7 +391,7 @@ size_t id3::v2::removeComments(ID3_TagImpl& tag, String desc)
 
 ID3_Frame* id3::v2::hasTrack(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_TRACKNUM);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_TRACKNUM);
   return(frame);
 }
 
@@ -377,7 +429,7 @@ size_t id3::v2::removeTracks(ID3_TagImpl& tag)
 
 ID3_Frame* id3::v2::hasGenre(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_CONTENTTYPE);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_CONTENTTYPE);
   return(frame);
 }
 
@@ -428,7 +480,7 @@ size_t id3::v2::removeGenres(ID3_TagImpl& tag)
 
 ID3_Frame* id3::v2::hasLyrics(const ID3_TagImpl& tag)
 {
-  ID3_Frame* frame = tag.Find(ID3FID_UNSYNCEDLYRICS);
+  ID3_Frame* frame = tag.FindFirst(ID3FID_UNSYNCEDLYRICS);
   return(frame);
 }
 
@@ -482,6 +534,11 @@ String id3::v2::getLyricist(const ID3_TagImpl& tag)
 }
 
 ID3_Frame* id3::v2::setLyricist(ID3_TagImpl& tag, String text)
+{
+  return takeFrameText(tag, ID3FID_LYRICIST, text);
+}
+
+ID3_Frame* id3::v2::setLyricist(ID3_TagImpl& tag, const char* text)
 {
   return setFrameText(tag, ID3FID_LYRICIST, text);
 }
@@ -496,8 +553,8 @@ size_t id3::v2::removeLyricists(ID3_TagImpl& tag)
 ID3_Frame* id3::v2::hasSyncLyrics(const ID3_TagImpl& tag, String lang, String desc)
 {
   ID3_Frame* frame=NULL;
-  (frame = tag.Find(ID3FID_SYNCEDLYRICS, ID3FN_LANGUAGE, lang)) ||
-  (frame = tag.Find(ID3FID_SYNCEDLYRICS, ID3FN_DESCRIPTION, desc));
+  (frame = tag.FindFirst(ID3FID_SYNCEDLYRICS, ID3FN_LANGUAGE, lang)) ||
+  (frame = tag.FindFirst(ID3FID_SYNCEDLYRICS, ID3FN_DESCRIPTION, desc));
   return(frame);
 }
 
@@ -529,9 +586,9 @@ BString id3::v2::getSyncLyrics(const ID3_TagImpl& tag, String lang, String desc)
 {
   // check if a SYLT frame of this language or descriptor exists
   ID3_Frame* frame = NULL;
-  (frame = tag.Find(ID3FID_SYNCEDLYRICS, ID3FN_LANGUAGE, lang)) ||
-  (frame = tag.Find(ID3FID_SYNCEDLYRICS, ID3FN_DESCRIPTION, desc)) ||
-  (frame = tag.Find(ID3FID_SYNCEDLYRICS));
+  (frame = tag.FindFirst(ID3FID_SYNCEDLYRICS, ID3FN_LANGUAGE, lang)) ||
+  (frame = tag.FindFirst(ID3FID_SYNCEDLYRICS, ID3FN_DESCRIPTION, desc)) ||
+  (frame = tag.FindFirst(ID3FID_SYNCEDLYRICS));
 
   // get the lyrics size
   ID3_Field* fld = frame->GetField(ID3FN_DATA);
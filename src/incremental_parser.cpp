@@ -0,0 +1,403 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "incremental_parser.h"
+#include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "header_frame.h"
+#include "readers.h"
+#include "io_helpers.h"
+#include "io_strings.h"
+#include "trace_hooks.h"
+
+/** \class ID3_IncrementalParser incremental_parser.h id3/incremental_parser.h
+ ** \brief Parses an id3v2 tag as its bytes arrive, handing out each frame
+ ** as soon as all of it is there.
+ **
+ ** An upload or a download can show what's in a tag long before the tag, let
+ ** alone the file, has been received.  The parser is fed the start of the
+ ** stream in chunks of any size.  It keeps only the frame it is waiting for,
+ ** and passes every frame that is complete to the Callback, which takes
+ ** responsibility for it: typically it attaches the frame to a tag.
+ **
+ ** \code
+ **   class Attach : public ID3_IncrementalParser::Callback
+ **   {
+ **   public:
+ **     Attach(ID3_Tag& tag) : _tag(tag) { }
+ **     void Frame(ID3_Frame* frame) { _tag.AttachFrame(frame); }
+ **   private:
+ **     ID3_Tag& _tag;
+ **   };
+ **
+ **   ID3_Tag tag;
+ **   Attach attach(tag);
+ **   ID3_IncrementalParser parser(attach);
+ **   while (!parser.IsDone() && (size = recv(sock, buf, sizeof(buf), 0)) > 0)
+ **   {
+ **     size_t used = parser.Feed(buf, size);
+ **     // buf + used, size - used is what follows the tag
+ **   }
+ ** \endcode
+ **
+ ** A tag that was unsynchronized is resynchronized on the fly, and frames
+ ** compressed by themselves or packed into an id3v2.2.1 compressed frame are
+ ** inflated as soon as they are complete, so none of them waits for the rest
+ ** of the tag.  The frames are parsed as linking the tag parses them, and
+ ** handed out in the same order; attaching them to a tag drops or converts
+ ** the ones it doesn't accept, as linking does.  Only the first of several
+ ** consecutive tags is parsed; Feed() leaves the bytes after it alone, so
+ ** they can be fed to another parser.
+ **/
+
+using namespace dami;
+
+class ID3_IncrementalParserImpl : public id3::v2::FrameSink
+{
+public:
+  ID3_IncrementalParserImpl(ID3_IncrementalParser::Callback& callback)
+    : _callback(callback), _state(HEADER), _tagSize(0), _rawLeft(0),
+      _lastRaw(0), _off(0), _needed(ID3_TagHeader::SIZE), _extSize(0),
+      _hasTag(false), _skipping(false), _frames(0)
+  { }
+
+  size_t Feed(const uchar* data, size_t size)
+  {
+    size_t used = 0;
+    while (used < size && _state != DONE)
+    {
+      if (_state == HEADER)
+      {
+        size_t num = min(size - used, ID3_TagHeader::SIZE - _buf.size());
+        _buf.append(data + used, num);
+        used += num;
+        _needed = ID3_TagHeader::SIZE - _buf.size();
+        if (_needed == 0)
+        {
+          this->parseHeader();
+        }
+        continue;
+      }
+
+      // the rest of the tag: the extended header, the frames and the padding
+      const uchar* raw = data + used;
+      size_t num = min(size - used, _rawLeft);
+      if (_state == EXTENDED)
+      {
+        // read as it is, as when linking
+        num = min(num, _needed);
+        _buf.append(raw, num);
+        _rawLeft -= num;
+        used += num;
+        this->parseExtended();
+      }
+      else
+      {
+        _rawLeft -= num;
+        used += num;
+        if (!_skipping)
+        {
+          this->append(raw, num);
+          this->parseFrames(_rawLeft == 0);
+        }
+      }
+      if (_rawLeft == 0)
+      {
+        this->done();
+      }
+    }
+    return used;
+  }
+
+  size_t GetBytesNeeded() const
+  {
+    if (_state == HEADER || _state == DONE)
+    {
+      return _needed;
+    }
+    // resynchronizing may need more bytes than this
+    return _skipping ? _rawLeft : min(_needed, _rawLeft);
+  }
+
+  bool       IsDone() const { return _state == DONE; }
+  bool       HasTag() const { return _hasTag; }
+  ID3_V2Spec GetSpec() const { return _hdr.GetSpec(); }
+  size_t     GetTagSize() const { return _tagSize; }
+  size_t     NumFrames() const { return _frames; }
+
+  // hands a frame out, as parsed by id3::v2::parseFrame()
+  void Frame(ID3_Frame* frame)
+  {
+    ++_frames;
+    _callback.Frame(frame);
+  }
+
+private:
+  enum State { HEADER, EXTENDED, FRAMES, DONE };
+
+  void parseHeader()
+  {
+    ID3_MemoryReader mr(_buf.data(), _buf.size());
+    const bool isTag = ID3_TagImpl::IsV2Tag(mr) > 0 && _hdr.Parse(mr);
+    _buf.clear();
+    if (!isTag)
+    {
+      ID3D_NOTICE( "ID3_IncrementalParser: no id3v2 tag" );
+      this->done();
+      return;
+    }
+    _hasTag = true;
+    _rawLeft = _hdr.GetDataSize();
+    _tagSize = ID3_TagHeader::SIZE + _rawLeft;
+    _state = _hdr.GetExtended() ? EXTENDED : FRAMES;
+    _needed = _hdr.GetExtended() ? 4 : this->frameHeaderSize();
+    if (_hdr.GetUnsync())
+    {
+      trace(ID3_Tracer::UNSYNCED);
+    }
+    if (_rawLeft == 0)
+    {
+      this->done();
+    }
+  }
+
+  // adds the next bytes of the tag, resynchronized if the tag was unsynced
+  void append(const uchar* raw, size_t size)
+  {
+    if (!_hdr.GetUnsync())
+    {
+      _buf.append(raw, size);
+      return;
+    }
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (_lastRaw != 0xFF || raw[i] != '\0')
+      {
+        _buf += raw[i];
+      }
+      _lastRaw = raw[i];
+    }
+  }
+
+  // parses as much of the extended header and the frames as has arrived,
+  // everything left if the tag is complete
+  void parseFrames(bool complete)
+  {
+    bool stop = false;
+    _off += this->parseFrames(_buf.data() + _off, _buf.size() - _off, complete, stop);
+    if (stop)
+    {
+      // the rest of the tag is padding, or can't be parsed
+      _skipping = true;
+      _buf.clear();
+      _off = 0;
+    }
+    else if (_off == _buf.size() || _off > _buf.size() / 2)
+    {
+      // the bytes of the frames handed out are dropped, only ever moving
+      // the bytes after them once
+      _buf.erase(0, _off);
+      _off = 0;
+    }
+  }
+
+  void parseExtended()
+  {
+    // the size is in the first 4 bytes: in id3v2.3 it's the number of bytes
+    // after it, 6 or 10, in id3v2.4 the size of the whole header
+    if (_extSize == 0 && _buf.size() == 4)
+    {
+      ID3_MemoryReader sr(_buf.data(), _buf.size());
+      const bool v24 = _hdr.GetSpec() == ID3V2_4_0;
+      size_t size = v24 ? io::readUInt28(sr) : 4 + io::readBENumber(sr, 4);
+      size = max(size, static_cast<size_t>(v24 ? 6 : 10));
+      _extSize = min(size, _buf.size() + _rawLeft);
+    }
+    _needed = (_extSize ? _extSize : 4) - _buf.size();
+    if (_needed > 0 && _rawLeft > 0)
+    {
+      return;
+    }
+    ID3_MemoryReader mr(_buf.data(), _buf.size());
+    _hdr.ParseExtended(mr);
+    _buf.clear();
+    _state = FRAMES;
+    _needed = this->frameHeaderSize();
+  }
+
+  // 6 bytes in id3v2.2, 10 after it
+  size_t frameHeaderSize() const
+  {
+    ID3_FrameHeader hdr;
+    hdr.SetSpec(_hdr.GetSpec());
+    return hdr.Size();
+  }
+
+  // Hands out the complete frames at the start of data, parsed one at a time
+  // as when linking.  Returns the number of bytes they took up, and sets
+  // stop at padding or at a frame that can't be parsed.
+  size_t parseFrames(const uchar* data, size_t size, bool complete, bool& stop)
+  {
+    size_t off = 0;
+    while (off < size)
+    {
+      if (data[off] == '\0')
+      {
+        ID3D_NOTICE( "ID3_IncrementalParser: padding at " << off );
+        stop = true;
+        break;
+      }
+      size_t avail = size - off;
+      ID3_MemoryReader mr(data + off, avail);
+      if (!complete)
+      {
+        ID3_FrameHeader hdr;
+        hdr.SetSpec(_hdr.GetSpec());
+        if (avail < hdr.Size())
+        {
+          _needed = hdr.Size() - avail;
+          break;
+        }
+        if (!hdr.Parse(mr))
+        {
+          // whatever this is, it's parsed with the rest of the tag
+          _needed = _rawLeft;
+          break;
+        }
+        size_t frameSize = hdr.Size() + hdr.GetDataSize();
+        if (avail < frameSize)
+        {
+          _needed = frameSize - avail;
+          break;
+        }
+        mr.setCur(mr.getBeg());
+      }
+
+      size_t frameSize = id3::v2::parseFrame(mr, _hdr.GetSpec(), *this);
+      if (frameSize == 0)
+      {
+        stop = true;
+        break;
+      }
+      off += frameSize;
+    }
+    if (off == size)
+    {
+      _needed = this->frameHeaderSize();
+    }
+    return off;
+  }
+
+  void done()
+  {
+    _state = DONE;
+    _needed = 0;
+    _rawLeft = 0;
+    _buf.clear();
+    _off = 0;
+  }
+
+  ID3_IncrementalParser::Callback& _callback;
+  State         _state;
+  ID3_TagHeader _hdr;
+  size_t        _tagSize;
+  size_t        _rawLeft;     // bytes of the tag still to come
+  uchar         _lastRaw;     // for resynchronizing
+  BString       _buf;         // the tag from _off on, resynchronized
+  size_t        _off;
+  size_t        _needed;
+  size_t        _extSize;     // of the extended header, once known
+  bool          _hasTag;
+  bool          _skipping;    // the rest of the tag is skipped
+  size_t        _frames;
+};
+
+/** Creates a parser that hands the frames it parses to callback. **/
+ID3_IncrementalParser::ID3_IncrementalParser(Callback& callback)
+  : _impl(new ID3_IncrementalParserImpl(callback))
+{
+}
+
+ID3_IncrementalParser::~ID3_IncrementalParser()
+{
+  delete _impl;
+}
+
+/** Passes on the next size bytes, handing every frame they complete to the
+ ** callback.  Returns how many of them the parser took, fewer than size only
+ ** when the tag ended among them.  If the data turns out not to start with
+ ** an id3v2 tag, the parser is done and HasTag() is false: the 10 bytes it
+ ** took for the tag header are the start of something else.
+ **/
+size_t ID3_IncrementalParser::Feed(const uchar* data, size_t size)
+{
+  return _impl->Feed(data, size);
+}
+
+/** The number of bytes needed before anything more can be parsed, i.e. the
+ ** rest of the tag header or of the frame being waited for; 0 when done.  In
+ ** an unsynced tag this is only the least number of bytes needed.
+ **/
+size_t ID3_IncrementalParser::GetBytesNeeded() const
+{
+  return _impl->GetBytesNeeded();
+}
+
+/** Whether the whole tag has been parsed, or there turned out to be none. **/
+bool ID3_IncrementalParser::IsDone() const
+{
+  return _impl->IsDone();
+}
+
+/** Whether the data starts with an id3v2 tag, as far as is known yet. **/
+bool ID3_IncrementalParser::HasTag() const
+{
+  return _impl->HasTag();
+}
+
+/** The version of the tag, once its header has been parsed. **/
+ID3_V2Spec ID3_IncrementalParser::GetSpec() const
+{
+  return _impl->GetSpec();
+}
+
+/** The size of the whole tag, header included, once its header has been
+ ** parsed.
+ **/
+size_t ID3_IncrementalParser::GetTagSize() const
+{
+  return _impl->GetTagSize();
+}
+
+/** The number of frames handed to the callback so far. **/
+size_t ID3_IncrementalParser::NumFrames() const
+{
+  return _impl->NumFrames();
+}
@@ -33,6 +33,7 @@
 
 #include "id3/io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
 #include "zlib.h"
+#include "trace_hooks.h"
 
 using namespace dami;
 
@@ -204,11 +205,16 @@ io::CompressedReader::CompressedReader(ID3_Reader& reader, size_type newSize)
 
   BString binary = readBinary(reader, oldSize);
 
-  ::uncompress(_uncompressed,
-               reinterpret_cast<luint*>(&newSize),
-               reinterpret_cast<const uchar*>(binary.data()),
-               oldSize);
-  this->setBuffer(_uncompressed, newSize);
+  // zlib wants the size as a uLongf, which is wider than size_type on LP64
+  uLongf size = newSize;
+  if (::uncompress(_uncompressed, &size,
+                   reinterpret_cast<const uchar*>(binary.data()),
+                   oldSize) != Z_OK)
+  {
+    size = 0;
+  }
+  trace(ID3_Tracer::DECOMPRESSED, size);
+  this->setBuffer(_uncompressed, size);
 }
 
 io::CompressedReader::~CompressedReader()
@@ -216,6 +222,67 @@ io::CompressedReader::~CompressedReader()
   delete [] _uncompressed;
 }
 
+io::CachedReader::CachedReader(ID3_Reader& reader, pos_type beg)
+  : _reader(reader), _cache(), _cacheBeg(0), _cur(0)
+{
+  _cacheBeg = _reader.setCur(beg);
+  _cache = readAllBinary(_reader);
+  _cur = _cacheBeg;
+  ID3D_NOTICE( "CachedReader: cached [" << _cacheBeg << ", " <<
+               this->getEnd() << "]" );
+}
+
+ID3_Reader::int_type io::CachedReader::readChar()
+{
+  int_type ch = this->peekChar();
+  if (ch != END_OF_READER)
+  {
+    ++_cur;
+  }
+  return ch;
+}
+
+ID3_Reader::int_type io::CachedReader::peekChar()
+{
+  if (_cur >= this->getEnd())
+  {
+    return END_OF_READER;
+  }
+  if (_cur >= _cacheBeg)
+  {
+    return static_cast<char_type>(_cache[_cur - _cacheBeg]);
+  }
+  _reader.setCur(_cur);
+  return _reader.peekChar();
+}
+
+ID3_Reader::size_type io::CachedReader::readChars(char_type buf[], size_type len)
+{
+  size_type size = 0;
+  if (_cur < _cacheBeg && len > 0)
+  {
+    // the part before the cache comes from the reader itself
+    _reader.setCur(_cur);
+    size = _reader.readChars(buf, min<size_type>(len, _cacheBeg - _cur));
+    _cur += size;
+    if (_cur < _cacheBeg)
+    {
+      return size;
+    }
+  }
+  if (_cur >= _cacheBeg && size < len)
+  {
+    size_type num = min<size_type>(len - size, this->getEnd() - _cur);
+    if (buf != NULL)
+    {
+      _cache.copy(buf + size, num, _cur - _cacheBeg);
+    }
+    _cur += num;
+    size += num;
+  }
+  return size;
+}
+
 ID3_Writer::int_type io::UnsyncedWriter::writeChar(char_type ch)
 {
   if (_last == 0xFF && (ch == 0x00 || ch >= 0xE0))
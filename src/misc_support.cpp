@@ -27,6 +27,7 @@
 
 #include <ctype.h> //for isdigit()
 #include <stdio.h>
+#include <string.h>
 
 #include "misc_support.h"
 #include "id3/utils.h" // has <config.h> "id3/id3lib_streams.h" "id3/globals.h" "id3/id3lib_strings.h"
@@ -41,13 +42,18 @@ char *ID3_GetString(const ID3_Frame *frame, ID3_FieldID fldName)
   ID3_Field* fld;
   if (NULL != frame && NULL != (fld = frame->GetField(fldName)))
   {
-//    ID3_Field* fld = frame->GetField(fldName);
+    // convert a copy of the text, the field itself is left alone so that
+    // the frame can be read from several threads at once
+    dami::String data = fld->GetText();
     ID3_TextEnc enc = fld->GetEncoding();
-    fld->SetEncoding(ID3TE_ISO8859_1);
-    size_t nText = fld->Size();
-    text = LEAKTESTNEW(char[nText + 1]);
-    fld->Get(text, nText + 1);
-    fld->SetEncoding(enc);
+    if (fld->IsEncodable() && enc != ID3TE_ISO8859_1 &&
+        ID3TE_NONE < enc && enc < ID3TE_NUMENCODINGS)
+    {
+      data = dami::convert(data, enc, ID3TE_ISO8859_1);
+    }
+    text = LEAKTESTNEW(char[data.size() + 1]);
+    ::memcpy(text, data.data(), data.size());
+    text[data.size()] = '\0';
   }
   return text;
 }
@@ -79,10 +85,10 @@ char *ID3_GetArtist(const ID3_Tag *tag)
   }
 
   ID3_Frame *frame = NULL;
-  if ((frame = tag->Find(ID3FID_LEADARTIST)) ||
-      (frame = tag->Find(ID3FID_BAND))       ||
-      (frame = tag->Find(ID3FID_CONDUCTOR))  ||
-      (frame = tag->Find(ID3FID_COMPOSER)))
+  if ((frame = tag->FindFirst(ID3FID_LEADARTIST)) ||
+      (frame = tag->FindFirst(ID3FID_BAND))       ||
+      (frame = tag->FindFirst(ID3FID_CONDUCTOR))  ||
+      (frame = tag->FindFirst(ID3FID_COMPOSER)))
   {
     sArtist = ID3_GetString(frame, ID3FN_TEXT);
   }
@@ -161,7 +167,7 @@ char *ID3_GetAlbum(const ID3_Tag *tag)
     return sAlbum;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_ALBUM);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_ALBUM);
   if (frame != NULL)
   {
     sAlbum = ID3_GetString(frame, ID3FN_TEXT);
@@ -220,7 +226,7 @@ char *ID3_GetTitle(const ID3_Tag *tag)
     return sTitle;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_TITLE);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_TITLE);
   if (frame != NULL)
   {
     sTitle = ID3_GetString(frame, ID3FN_TEXT);
@@ -279,7 +285,7 @@ char *ID3_GetYear(const ID3_Tag *tag)
     return sYear;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_YEAR);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_YEAR);
   if (frame != NULL)
   {
     sYear = ID3_GetString(frame, ID3FN_TEXT);
@@ -341,13 +347,14 @@ char *ID3_GetComment(const ID3_Tag *tag, const char* desc)
   ID3_Frame* frame = NULL;
   if (desc)
   {
-    frame = tag->Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, desc);
+    frame = tag->FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, desc);
   }
   else
   {
-    frame = tag->Find(ID3FID_COMMENT);
-    if(frame == tag->Find(ID3FID_COMMENT, ID3FN_DESCRIPTION, STR_V1_COMMENT_DESC))
-      frame = tag->Find(ID3FID_COMMENT);
+    ID3_Tag::Cursor cursor;
+    frame = tag->Find(cursor, ID3FID_COMMENT);
+    if(frame == tag->FindFirst(ID3FID_COMMENT, ID3FN_DESCRIPTION, STR_V1_COMMENT_DESC))
+      frame = tag->Find(cursor, ID3FID_COMMENT);
   }
 
   if (frame)
@@ -470,7 +477,7 @@ char *ID3_GetTrack(const ID3_Tag *tag)
     return sTrack;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_TRACKNUM);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_TRACKNUM);
   if (frame != NULL)
   {
     sTrack = ID3_GetString(frame, ID3FN_TEXT);
@@ -534,7 +541,7 @@ int ID3_GetPictureData(const ID3_Tag *tag, const char *TempPicPath)
   else
   {
     ID3_Frame* frame = NULL;
-    frame = tag->Find(ID3FID_PICTURE);
+    frame = tag->FindFirst(ID3FID_PICTURE);
     if (frame != NULL)
     {
       ID3_Field* myField = frame->GetField(ID3FN_DATA);
@@ -557,7 +564,7 @@ char* ID3_GetPictureMimeType(const ID3_Tag *tag)
     return sPicMimetype;
 
   ID3_Frame* frame = NULL;
-  frame = tag->Find(ID3FID_PICTURE);
+  frame = tag->FindFirst(ID3FID_PICTURE);
   if (frame != NULL)
   {
     sPicMimetype = ID3_GetString(frame, ID3FN_MIMETYPE);
@@ -792,7 +799,7 @@ char *ID3_GetGenre(const ID3_Tag *tag)
     return sGenre;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_CONTENTTYPE);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_CONTENTTYPE);
   if (frame != NULL)
   {
     sGenre = ID3_GetString(frame, ID3FN_TEXT);
@@ -1189,7 +1196,7 @@ char *ID3_GetLyrics(const ID3_Tag *tag)
     return sLyrics;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_UNSYNCEDLYRICS);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_UNSYNCEDLYRICS);
   if (frame != NULL)
   {
     sLyrics = ID3_GetString(frame, ID3FN_TEXT);
@@ -1262,7 +1269,7 @@ char *ID3_GetLyricist(const ID3_Tag *tag)
     return sLyricist;
   }
 
-  ID3_Frame *frame = tag->Find(ID3FID_LYRICIST);
+  ID3_Frame *frame = tag->FindFirst(ID3FID_LYRICIST);
   if (frame != NULL)
   {
     sLyricist = ID3_GetString(frame, ID3FN_TEXT);
@@ -1391,17 +1398,17 @@ ID3_Frame *ID3_GetSyncLyricsInfo(const ID3_Tag *tag, const char *desc,
   if (NULL != lang)
   {
     // search through language
-    frmExist = tag->Find(ID3FID_SYNCEDLYRICS, ID3FN_LANGUAGE, lang);
+    frmExist = tag->FindFirst(ID3FID_SYNCEDLYRICS, ID3FN_LANGUAGE, lang);
   }
   else if (NULL != desc)
   {
     // search through descriptor
-    frmExist = tag->Find(ID3FID_SYNCEDLYRICS, ID3FN_DESCRIPTION, desc);
+    frmExist = tag->FindFirst(ID3FID_SYNCEDLYRICS, ID3FN_DESCRIPTION, desc);
   }
   else
   {
     // both language and description not specified, search the first SYLT frame
-    frmExist = tag->Find(ID3FID_SYNCEDLYRICS);
+    frmExist = tag->FindFirst(ID3FID_SYNCEDLYRICS);
   }
 
   if (!frmExist)
@@ -28,18 +28,23 @@
 #ifndef _MP3_HEADER_H_
 #define _MP3_HEADER_H_
 
+#include <vector>
 #include "io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
 
 class Mp3Info
 {
 public:
-  Mp3Info() { _mp3_header_output = LEAKTESTNEW(Mp3_Headerinfo); };
+  Mp3Info() : _mp3_scan_output(NULL) { _mp3_header_output = LEAKTESTNEW(Mp3_Headerinfo); };
   ~Mp3Info() { this->Clean(); };
   void Clean();
 
   const Mp3_Headerinfo* GetMp3HeaderInfo() const { return _mp3_header_output; };
+  void SetMp3HeaderInfo(const Mp3_Headerinfo& info) { *_mp3_header_output = info; };
   bool Parse(ID3_Reader&, size_t mp3size);
 
+  const Mp3_Scaninfo* GetMp3ScanInfo() const { return _mp3_scan_output; };
+  bool Scan(ID3_Reader&, size_t seekpoints);
+
   Mpeg_Layers Layer() const { return _mp3_header_output->layer; };
   Mpeg_Version Version() const { return _mp3_header_output->version; };
   MP3_BitRates Bitrate() const { return _mp3_header_output->bitrate; };
@@ -81,6 +86,8 @@ private:
   };
 
   Mp3_Headerinfo* _mp3_header_output;
+  Mp3_Scaninfo* _mp3_scan_output;
+  std::vector<uint32> _seekindex;
 }; //Info
 
 #endif /* _MP3_HEADER_H_ */
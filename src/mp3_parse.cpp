@@ -25,6 +25,7 @@
 // id3lib.  These files are distributed with id3lib at
 // http://download.sourceforge.net/id3lib/
 
+#include <string.h> //for memcmp and memcpy
 #include "mp3_header.h"
 
 uint32 fto_nearest_i(float f)
@@ -44,36 +45,302 @@ uint32 fto_nearest_i(float f)
     return i;
 }
 
-uint16 calcCRC(char *pFrame, size_t audiodatasize)
+// CRC-16 with polynomial 0x8005, crctable[i] is the crc of the byte i
+static const uint16 crctable[256] =
+{
+    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022,
+    0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072,
+    0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041,
+    0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2,
+    0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1,
+    0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1,
+    0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082,
+    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192,
+    0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1,
+    0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1,
+    0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2,
+    0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151,
+    0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162,
+    0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132,
+    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101,
+    0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312,
+    0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321,
+    0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371,
+    0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342,
+    0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1,
+    0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2,
+    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2,
+    0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381,
+    0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291,
+    0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2,
+    0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2,
+    0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1,
+    0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252,
+    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261,
+    0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231,
+    0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202
+};
+
+// the crc of a frame covers the last two bytes of the header and the side
+// info (layer III) following the stored crc, pFrame points to the header
+uint16 calcCRC(const char *pFrame, size_t audiodatasize)
 {
   size_t icounter;
-  int tmpchar, crcmask, tmpi;
   uint16 crc = 0xffff;
 
   for (icounter = 2;  icounter < audiodatasize;  ++icounter)
   {
     if (icounter != 4  &&  icounter != 5) //skip the 2 chars of the crc itself
     {
-      crcmask = 1 << 8;
-      tmpchar = pFrame[icounter];
-      while (crcmask >>= 1)
-      {
-        tmpi = crc & 0x8000;
-        crc <<= 1;
-        if (!tmpi ^ !(tmpchar & crcmask))
-          crc ^= 0x8005;
-      }
+      crc = (crc << 8) ^ crctable[((crc >> 8) ^ pFrame[icounter]) & 0xff];
     }
   }
-  crc &= 0xffff;
   return crc;
 }
 
+namespace
+{
+  uint32 getBENumber(const uchar* data, size_t len)
+  {
+    uint32 val = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+      val = (val << 8) | data[i];
+    }
+    return val;
+  }
+
+  int16 getReplayGain(const uchar* data)
+  {
+    // 3 bits name code, 3 bits originator code, 1 sign bit, 9 bits gain
+    uint32 val = getBENumber(data, 2);
+    if ((val >> 13) == 0) // not set
+      return 0;
+    int16 gain = (int16)(val & 0x1FF);
+    return (val & 0x200) ? -gain : gain;
+  }
+
+  // http://gabriel.mp3-tech.org/mp3infotag.html
+  void parseLameTag(const uchar* data, size_t size, Mp3_Headerinfo* info)
+  {
+    const size_t LAMETAGSIZE = 36;
+    if (size < LAMETAGSIZE ||
+        (memcmp(data, "LAME", 4) != 0 && memcmp(data, "Lavf", 4) != 0 &&
+         memcmp(data, "Lavc", 4) != 0))
+    {
+      return;
+    }
+    memcpy(info->encoder, data, 9);
+    info->encoder[9] = '\0';
+    info->replaygain_peak = getBENumber(data + 11, 4);
+    info->replaygain_track = getReplayGain(data + 15);
+    info->replaygain_album = getReplayGain(data + 17);
+    uint32 delaypadding = getBENumber(data + 21, 3);
+    info->encoder_delay = (uint16)(delaypadding >> 12);
+    info->encoder_padding = (uint16)(delaypadding & 0xFFF);
+  }
+
+  // http://www.codeproject.com/audio/MPEGAudioInfo.asp
+  bool parseXingHeader(const uchar* data, size_t size, Mp3_Headerinfo* info)
+  {
+    const size_t XINGFLAGSIZE = 4 + 4;
+    const uint32 XING_FRAMES = 0x0001, XING_BYTES = 0x0002,
+                 XING_TOC = 0x0004, XING_QUALITY = 0x0008;
+    if (size < XINGFLAGSIZE)
+      return false;
+    if (memcmp(data, "Xing", 4) == 0)
+      info->vbrheader = MP3VBRHEADER_XING;
+    else if (memcmp(data, "Info", 4) == 0)
+      info->vbrheader = MP3VBRHEADER_INFO;
+    else
+      return false;
+
+    uint32 flags = getBENumber(data + 4, 4);
+    size_t pos = XINGFLAGSIZE;
+    if ((flags & XING_FRAMES) && pos + 4 <= size)
+    {
+      info->frames = getBENumber(data + pos, 4);
+      pos += 4;
+    }
+    if ((flags & XING_BYTES) && pos + 4 <= size)
+    {
+      info->vbr_bytes = getBENumber(data + pos, 4);
+      pos += 4;
+    }
+    if ((flags & XING_TOC) && pos + 100 <= size)
+    {
+      memcpy(info->toc, data + pos, 100);
+      info->has_toc = true;
+      pos += 100;
+    }
+    if (flags & XING_QUALITY)
+      pos += 4;
+    if (pos < size)
+      parseLameTag(data + pos, size - pos, info);
+    return true;
+  }
+
+  bool parseVbriHeader(const uchar* data, size_t size, Mp3_Headerinfo* info)
+  {
+    // id(4), version(2), delay(2), quality(2), bytes(4), frames(4)
+    if (size < 18 || memcmp(data, "VBRI", 4) != 0)
+      return false;
+    info->vbrheader = MP3VBRHEADER_VBRI;
+    info->vbr_bytes = getBENumber(data + 10, 4);
+    info->frames = getBENumber(data + 14, 4);
+    return true;
+  }
+};
+
+namespace
+{
+  // bitrates in kbps, [mpeg 1 or not][layer I, II, III][bitrate_index]
+  const uint16 SCAN_BITRATES[2][3][16] =
+  {
+    {
+      { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0 },
+      { 0, 32, 48, 56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320, 384, 0 },
+      { 0, 32, 40, 48,  56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320, 0 }
+    },
+    {
+      { 0, 32, 48, 56,  64,  80,  96, 112, 128, 144, 160, 176, 192, 224, 256, 0 },
+      { 0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160, 0 },
+      { 0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160, 0 }
+    }
+  };
+
+  // samplerates, [version id][frequency index]
+  const uint32 SCAN_FREQUENCIES[4][4] =
+  {
+    { 11025, 12000,  8000, 0 },  //MPEGVERSION_2_5
+    {     0,     0,     0, 0 },  //MPEGVERSION_Reserved
+    { 22050, 24000, 16000, 0 },  //MPEGVERSION_2
+    { 44100, 48000, 32000, 0 }   //MPEGVERSION_1
+  };
+
+  struct ScanHeader
+  {
+    uint32 bitrate;    // in bps
+    uint32 frequency;
+    uint32 samples;    // samples per frame
+    uint32 size;       // frame size including the header
+    uint32 signature;  // version, layer and samplerate bits, equal for all frames
+    uint32 crclen;     // bytes from the header to the end of the crc protected
+                       // side info, 0 if the frame has no crc we can check
+  };
+
+  // decodes the frame header at h, returns false when it isn't a valid
+  // header or when it is a free format frame (frame size unknown)
+  bool decodeHeader(const uchar* h, ScanHeader& hdr)
+  {
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0)
+      return false;
+    uint32 id      = (h[1] >> 3) & 0x03;
+    uint32 layer   = (h[1] >> 1) & 0x03;  // 3 = layer I, 1 = layer III
+    uint32 brindex = (h[2] >> 4) & 0x0F;
+    uint32 frindex = (h[2] >> 2) & 0x03;
+    uint32 padding = (h[2] >> 1) & 0x01;
+    if (id == 1 || layer == 0)
+      return false;
+    hdr.bitrate = SCAN_BITRATES[id == 3 ? 0 : 1][3 - layer][brindex] * 1000;
+    hdr.frequency = SCAN_FREQUENCIES[id][frindex];
+    if (hdr.bitrate == 0 || hdr.frequency == 0)
+      return false;
+    if (layer == 3)
+    {
+      hdr.samples = 384;
+      hdr.size = (12 * hdr.bitrate / hdr.frequency + padding) * 4;
+    }
+    else if (layer == 2 || id == 3)
+    {
+      hdr.samples = 1152;
+      hdr.size = 144 * hdr.bitrate / hdr.frequency + padding;
+    }
+    else
+    {
+      hdr.samples = 576;
+      hdr.size = 72 * hdr.bitrate / hdr.frequency + padding;
+    }
+    hdr.signature = (h[1] & 0x1E) << 8 | (h[2] & 0x0C);
+    // only the layer III crc has a fixed length, for layer I and II it
+    // depends on the bit allocation
+    hdr.crclen = 0;
+    if (!(h[1] & 0x01) && layer == 1)
+    {
+      bool mono = (h[3] >> 6) == 3;
+      if (id == 3)
+        hdr.crclen = 4 + 2 + (mono ? 17 : 32);
+      else
+        hdr.crclen = 4 + 2 + (mono ? 9 : 17);
+      if (hdr.crclen > hdr.size)
+        hdr.crclen = 0;
+    }
+    return true;
+  }
+
+  // keeps a large window of the reader in memory, so the frames can be
+  // walked without a seek and a read per frame
+  class ScanWindow
+  {
+    ID3_Reader& _reader;
+    std::vector<uchar> _buf;
+    ID3_Reader::pos_type _beg;
+    size_t _size;
+  public:
+    ScanWindow(ID3_Reader& reader, size_t size)
+      : _reader(reader), _buf(size), _beg(0), _size(0) { ; }
+
+    // returns a pointer to at least len bytes at pos, avail is set to the
+    // number of bytes available from pos.  NULL if the reader hasn't got len
+    // bytes left at pos.
+    const uchar* get(ID3_Reader::pos_type pos, size_t len, size_t& avail)
+    {
+      if (pos < _beg || pos - _beg > _size || len > _size - (pos - _beg))
+      {
+        if (len > _buf.size())
+          _buf.resize(len);
+        _reader.setCur(pos);
+        _beg = pos;
+        _size = _reader.readChars(&_buf[0], _buf.size());
+      }
+      avail = _beg + _size - pos;
+      if (pos < _beg || avail < len)
+        return NULL;
+      return &_buf[pos - _beg];
+    }
+  };
+
+  // is the frame with header hdr at pos followed by a header of the same
+  // stream, or does it end right where the reader does?  Audio data often
+  // contains a few bytes that decode as a header, so a header found while
+  // searching for sync is only taken when the next one confirms it.
+  bool confirmed(ScanWindow& window, ID3_Reader::pos_type pos,
+                 const ScanHeader& hdr, ID3_Reader::pos_type end)
+  {
+    const size_t HEADERSIZE = 4;
+    if (hdr.size > end - pos)
+      return false;
+    ID3_Reader::pos_type next = pos + hdr.size;
+    if (next == end)
+      return true;
+    size_t avail;
+    const uchar* data = window.get(next, HEADERSIZE, avail);
+    ScanHeader nexthdr;
+    return data != NULL && decodeHeader(data, nexthdr) &&
+           nexthdr.signature == hdr.signature;
+  }
+};
+
 void Mp3Info::Clean()
 {
   if (_mp3_header_output != NULL)
     delete _mp3_header_output;
   _mp3_header_output = NULL;
+  if (_mp3_scan_output != NULL)
+    delete _mp3_scan_output;
+  _mp3_scan_output = NULL;
+  _seekindex.clear();
 }
 
 using namespace dami;
@@ -209,6 +476,7 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   const size_t HEADERSIZE = 4;//
   char buf[HEADERSIZE+1]; //+1 to hold the \0 char
   ID3_Reader::pos_type beg = reader.getCur() ;
+  const ID3_Reader::pos_type frame_beg = beg;
   ID3_Reader::pos_type end = beg + HEADERSIZE ;
   reader.setCur(beg);
   int bitrate_index;
@@ -224,6 +492,17 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   _mp3_header_output->framesize = 0;
   _mp3_header_output->frames = 0;
   _mp3_header_output->time = 0;
+  _mp3_header_output->vbrheader = MP3VBRHEADER_NONE;
+  _mp3_header_output->vbr_bitrate = 0;
+  _mp3_header_output->vbr_bytes = 0;
+  _mp3_header_output->has_toc = false;
+  memset(_mp3_header_output->toc, 0, sizeof(_mp3_header_output->toc));
+  _mp3_header_output->encoder_delay = 0;
+  _mp3_header_output->encoder_padding = 0;
+  _mp3_header_output->replaygain_peak = 0;
+  _mp3_header_output->replaygain_track = 0;
+  _mp3_header_output->replaygain_album = 0;
+  _mp3_header_output->encoder[0] = '\0';
 
   reader.readChars(buf, HEADERSIZE);
   buf[HEADERSIZE]='\0';
@@ -412,7 +691,53 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
     if (crcstored == crc16)
       _mp3_header_output->crc = MP3CRC_OK;
   }
-  if (_mp3_header_output->framesize > 0 && mp3size >= _mp3_header_output->framesize) // this means bitrate is not none too
+
+  // the first frame of a vbr file is a silent one holding a Xing/Info or VBRI
+  // header, which knows the exact number of frames.  The Xing header follows
+  // the side info, the VBRI header is always 32 bytes after the frame header.
+  const size_t VBRBUFSIZE = 4 + 2 + 32 + 120 + 36 + 1;
+  uchar vbrbuf[VBRBUFSIZE];
+  size_t vbrsize = dami::min<size_t>(VBRBUFSIZE, mp3size);
+  if (_mp3_header_output->framesize > 0)
+    vbrsize = dami::min<size_t>(vbrsize, _mp3_header_output->framesize);
+  reader.setCur(frame_beg);
+  vbrsize = reader.readChars(vbrbuf, vbrsize);
+
+  size_t xing_offset = HEADERSIZE + (_tmpheader->protection_bit ? 0 : CRCSIZE);
+  if (_mp3_header_output->version == MPEGVERSION_1)
+    xing_offset += (_mp3_header_output->channelmode == MP3CHANNELMODE_SINGLE_CHANNEL) ? 17 : 32;
+  else
+    xing_offset += (_mp3_header_output->channelmode == MP3CHANNELMODE_SINGLE_CHANNEL) ? 9 : 17;
+  const size_t vbri_offset = HEADERSIZE + 32;
+
+  if (_mp3_header_output->layer == MPEGLAYER_III && vbrsize > xing_offset &&
+      !parseXingHeader(vbrbuf + xing_offset, vbrsize - xing_offset, _mp3_header_output) &&
+      vbrsize > vbri_offset)
+  {
+    parseVbriHeader(vbrbuf + vbri_offset, vbrsize - vbri_offset, _mp3_header_output);
+  }
+
+  if (_mp3_header_output->vbrheader != MP3VBRHEADER_NONE &&
+      _mp3_header_output->frames > 0 && _mp3_header_output->frequency > 0)
+  {
+    // the duration follows from the number of frames, no need to guess it
+    // from the size of the file
+    uint32 samples_per_frame;
+    if (_mp3_header_output->layer == MPEGLAYER_I)
+      samples_per_frame = 384;
+    else if (_mp3_header_output->layer == MPEGLAYER_II || _mp3_header_output->version == MPEGVERSION_1)
+      samples_per_frame = 1152;
+    else
+      samples_per_frame = 576;
+
+    float seconds = (float)_mp3_header_output->frames * samples_per_frame / _mp3_header_output->frequency;
+    _mp3_header_output->time = fto_nearest_i(seconds);
+
+    size_t audiobytes = _mp3_header_output->vbr_bytes > 0 ? _mp3_header_output->vbr_bytes : mp3size;
+    if (seconds > 0)
+      _mp3_header_output->vbr_bitrate = fto_nearest_i(audiobytes * 8 / seconds);
+  }
+  else if (_mp3_header_output->framesize > 0 && mp3size >= _mp3_header_output->framesize) // this means bitrate is not none too
   {
     _mp3_header_output->frames = fto_nearest_i((float)mp3size / _mp3_header_output->framesize);
     // bitrate becomes byterate (per second) if divided by 8
@@ -428,4 +753,155 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   return true;
 }
 
+// Walks every frame from the current position until the end of the reader,
+// the reader should be windowed to the audio data.  Frames are found by
+// hopping from header to header with the frame size, when a hop doesn't land
+// on a header of the same stream we search for the next one.
+bool Mp3Info::Scan(ID3_Reader& reader, size_t seekpoints)
+{
+  io::ExitTrigger et(reader);
+  const size_t SCANBUFSIZE = 64 * 1024;
+  const size_t HEADERSIZE = 4;
+  ScanWindow window(reader, SCANBUFSIZE);
+
+  ID3_Reader::pos_type pos = reader.getCur();
+  ID3_Reader::pos_type end = reader.getEnd();
+
+  // the seek index is filled in from every stride'th frame, when it is full
+  // every other entry is dropped and the stride doubles.  Offsets are reader
+  // positions, so they can't be wider than pos_type.
+  const size_t maxentries = seekpoints * 16;
+  std::vector<ID3_Reader::pos_type> entries;
+  size_t stride = 1;
+
+  ScanHeader hdr = ScanHeader(), first = ScanHeader();
+  bool synced = false;
+  bool skipfirst = _mp3_header_output != NULL &&
+                   _mp3_header_output->vbrheader != MP3VBRHEADER_NONE;
+  double samples = 0;
+  uint32 frames = 0, bytes = 0, skipped = 0, resyncs = 0;
+  uint32 crcframes = 0, crcerrors = 0;
+  bool vbr = false;
+  size_t avail;
+
+  // pos never passes end, the comparisons are written as end - pos so they
+  // can't wrap near the end of a reader that is close to 4 GB
+  while (end - pos >= HEADERSIZE)
+  {
+    const uchar* data = window.get(pos, HEADERSIZE, avail);
+    if (data == NULL)
+      break;
+    if (!decodeHeader(data, hdr) || (synced && hdr.signature != first.signature))
+    {
+      // lost sync, look for the next header of this stream
+      if (synced)
+        ++resyncs;
+      ID3_Reader::pos_type found = end;
+      for (ID3_Reader::pos_type cur = pos + 1; end - cur >= HEADERSIZE; )
+      {
+        data = window.get(cur, HEADERSIZE, avail);
+        if (data == NULL)
+          break;
+        const uchar* ff = (const uchar*)memchr(data, 0xFF, avail - (HEADERSIZE - 1));
+        if (ff == NULL)
+        {
+          cur += avail - (HEADERSIZE - 1);
+          continue;
+        }
+        cur += ff - data;
+        if (decodeHeader(ff, hdr) && (!synced || hdr.signature == first.signature) &&
+            confirmed(window, cur, hdr, end))
+        {
+          found = cur;
+          break;
+        }
+        ++cur;
+      }
+      skipped += found - pos;
+      pos = found;
+      continue;
+    }
+    if (hdr.size > end - pos)
+    {
+      // truncated last frame
+      skipped += end - pos;
+      break;
+    }
+    if (!synced)
+    {
+      first = hdr;
+      synced = true;
+      if (skipfirst)
+      {
+        // the first frame holds the vbr header, it's not part of the song
+        pos += hdr.size;
+        first.bitrate = 0;
+        continue;
+      }
+    }
+    if (first.bitrate == 0)
+      first.bitrate = hdr.bitrate;
+    else if (hdr.bitrate != first.bitrate)
+      vbr = true;
+
+    if (seekpoints > 0 && frames % stride == 0)
+    {
+      if (entries.size() == maxentries)
+      {
+        for (size_t i = 0; i < entries.size() / 2; ++i)
+          entries[i] = entries[i * 2];
+        entries.resize(entries.size() / 2);
+        stride *= 2;
+      }
+      if (frames % stride == 0)
+        entries.push_back(pos);
+    }
 
+    if (hdr.crclen > 0 && (data = window.get(pos, hdr.crclen, avail)) != NULL)
+    {
+      // a mismatch doesn't stop the scan, the frame is just damaged
+      ++crcframes;
+      uint16 crcstored = (uint16)getBENumber(data + HEADERSIZE, 2);
+      if (calcCRC((const char*)data, hdr.crclen) != crcstored)
+        ++crcerrors;
+    }
+
+    ++frames;
+    samples += hdr.samples;
+    bytes += hdr.size;
+    pos += hdr.size;
+  }
+
+  if (_mp3_scan_output == NULL)
+    _mp3_scan_output = LEAKTESTNEW(Mp3_Scaninfo);
+  _mp3_scan_output->frames = frames;
+  _mp3_scan_output->bytes = bytes;
+  _mp3_scan_output->skipped = skipped;
+  _mp3_scan_output->resyncs = resyncs;
+  _mp3_scan_output->vbr = vbr;
+  _mp3_scan_output->crcframes = crcframes;
+  _mp3_scan_output->crcerrors = crcerrors;
+  _mp3_scan_output->time = 0;
+  _mp3_scan_output->bitrate = 0;
+  if (frames > 0)
+  {
+    double seconds = samples / first.frequency;
+    _mp3_scan_output->time = (uint32)(seconds * 1000 + 0.5);
+    if (seconds > 0)
+      _mp3_scan_output->bitrate = (uint32)((double)bytes * 8 / seconds + 0.5);
+  }
+
+  _seekindex.clear();
+  if (frames > 0 && !entries.empty())
+  {
+    for (size_t i = 0; i < seekpoints; ++i)
+    {
+      size_t frame = (size_t)((double)frames * i / seekpoints);
+      _seekindex.push_back(entries[dami::min(frame / stride, entries.size() - 1)]);
+    }
+  }
+  _mp3_scan_output->seekpoints = _seekindex.size();
+  _mp3_scan_output->seekindex = _seekindex.empty() ? NULL : &_seekindex[0];
+
+  return frames > 0;
+}
@@ -0,0 +1,322 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <map>
+#if defined HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "shared_binary.h"
+#include "binary_store.h"
+
+/** \class ID3_BinaryStore binary_store.h id3/binary_store.h
+ ** \brief Shares the data of large binary fields among all tags of the
+ ** process.
+ **
+ ** The tracks of an album usually carry the same picture, often of several
+ ** hundred kilobytes, and parsing the whole album would otherwise keep a copy
+ ** of it for every track.  Whenever a binary field of at least
+ ** GetThreshold() bytes is parsed, restored from a cache or set, its data is
+ ** looked up by content in a store shared by the whole process, and fields
+ ** with the same data refer to a single copy.  Copying a tag or frame then
+ ** copies only the reference.  A field that is given new data lets go of the
+ ** shared copy rather than changing it, and a copy is freed with the last
+ ** field referring to it.
+ **
+ ** The store is safe to use from several threads.  The threshold should be
+ ** set before tags are parsed; 0 turns interning off.
+ **/
+
+using namespace dami;
+
+namespace
+{
+  const size_t DEFAULT_THRESHOLD = 1024;
+
+  typedef SharedPayload<BString> Payload;
+  typedef std::multimap<uint32, Payload*> Payloads;
+
+  class Store
+  {
+  public:
+    Store() : _threshold(DEFAULT_THRESHOLD), _bytes(0)
+    {
+#if defined HAVE_PTHREAD_H
+      pthread_mutex_init(&_lock, NULL);
+#endif
+    }
+
+    void Lock()
+    {
+#if defined HAVE_PTHREAD_H
+      pthread_mutex_lock(&_lock);
+#endif
+    }
+
+    void Unlock()
+    {
+#if defined HAVE_PTHREAD_H
+      pthread_mutex_unlock(&_lock);
+#endif
+    }
+
+    // read without the lock by every field that may be interned
+    size_t Threshold()
+    {
+#if defined __ATOMIC_RELAXED
+      return __atomic_load_n(&_threshold, __ATOMIC_RELAXED);
+#else
+      this->Lock();
+      size_t threshold = _threshold;
+      this->Unlock();
+      return threshold;
+#endif
+    }
+
+    void SetThreshold(size_t threshold)
+    {
+#if defined __ATOMIC_RELAXED
+      __atomic_store_n(&_threshold, threshold, __ATOMIC_RELAXED);
+#else
+      this->Lock();
+      _threshold = threshold;
+      this->Unlock();
+#endif
+    }
+
+    size_t   _threshold;  // through Threshold() and SetThreshold()
+    Payloads _payloads;
+    size_t   _bytes;
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_t _lock;
+#endif
+  };
+
+  // never destroyed, so tags that outlive main() can still let go of their
+  // payloads
+  Store& store()
+  {
+    static Store* s = new Store;
+    return *s;
+  }
+
+  uint32 fnv1a(const BString& data)
+  {
+    uint32 hash = 2166136261UL;
+    const uchar* p = data.data();
+    for (const uchar* end = p + data.size(); p != end; ++p)
+    {
+      hash = (hash ^ *p) * 16777619UL;
+    }
+    return hash;
+  }
+};
+
+#if defined HAVE_PTHREAD_H
+namespace
+{
+  pthread_mutex_t count_lock = PTHREAD_MUTEX_INITIALIZER;
+};
+#endif
+
+void dami::lockCounts()
+{
+#if defined HAVE_PTHREAD_H
+  pthread_mutex_lock(&count_lock);
+#endif
+}
+
+void dami::unlockCounts()
+{
+#if defined HAVE_PTHREAD_H
+  pthread_mutex_unlock(&count_lock);
+#endif
+}
+
+long dami::retain(long& refs)
+{
+#if defined __GNUC__
+  return __sync_add_and_fetch(&refs, 1);
+#elif defined HAVE_PTHREAD_H
+  pthread_mutex_lock(&count_lock);
+  long n = ++refs;
+  pthread_mutex_unlock(&count_lock);
+  return n;
+#else
+  return ++refs;
+#endif
+}
+
+long dami::release(long& refs)
+{
+#if defined __GNUC__
+  return __sync_sub_and_fetch(&refs, 1);
+#elif defined HAVE_PTHREAD_H
+  pthread_mutex_lock(&count_lock);
+  long n = --refs;
+  pthread_mutex_unlock(&count_lock);
+  return n;
+#else
+  return --refs;
+#endif
+}
+
+long dami::count(long& refs)
+{
+#if defined __GNUC__
+  return __sync_fetch_and_add(&refs, 0);
+#elif defined HAVE_PTHREAD_H
+  pthread_mutex_lock(&count_lock);
+  long n = refs;
+  pthread_mutex_unlock(&count_lock);
+  return n;
+#else
+  return refs;
+#endif
+}
+
+// Copies of a field retain its payload without the store's lock; that is
+// safe because the payload cannot reach zero references while the field
+// being copied still holds it.  Lookups and releases happen under the lock,
+// so a payload found in the store is never freed under our feet.
+SharedPayload<BString>* dami::intern(BString& data)
+{
+  Store& s = store();
+  const size_t threshold = s.Threshold();
+  if (threshold == 0 || data.size() < threshold)
+  {
+    return NULL;
+  }
+
+  const uint32 hash = fnv1a(data);
+  Payload* payload = NULL;
+  s.Lock();
+  std::pair<Payloads::iterator, Payloads::iterator> range = s._payloads.equal_range(hash);
+  for (Payloads::iterator pi = range.first; pi != range.second; ++pi)
+  {
+    if (pi->second->data == data)
+    {
+      payload = pi->second;
+      retain(payload->refs);
+      data.erase();
+      break;
+    }
+  }
+  const bool created = payload == NULL;
+  if (created)
+  {
+    payload = new Payload;
+    payload->data.swap(data);
+    payload->hash = hash;
+    payload->refs = 1;
+    payload->interned = true;
+    s._payloads.insert(std::make_pair(hash, payload));
+    s._bytes += payload->data.size();
+  }
+  s.Unlock();
+  if (created)
+  {
+    trace(ID3_Tracer::BUFFERS);
+  }
+  return payload;
+}
+
+void dami::release(SharedPayload<BString>* payload)
+{
+  Payload* unused = NULL;
+  Store& s = store();
+  s.Lock();
+  if (release(payload->refs) == 0)
+  {
+    std::pair<Payloads::iterator, Payloads::iterator> range =
+      s._payloads.equal_range(payload->hash);
+    for (Payloads::iterator pi = range.first; pi != range.second; ++pi)
+    {
+      if (pi->second == payload)
+      {
+        s._payloads.erase(pi);
+        break;
+      }
+    }
+    s._bytes -= payload->data.size();
+    unused = payload;
+  }
+  s.Unlock();
+  delete unused;
+}
+
+/** Sets the size from which binary fields are shared (1024 bytes by
+ ** default).  Fields that are already shared stay so.
+ **/
+void ID3_BinaryStore::SetThreshold(size_t bytes)
+{
+  store().SetThreshold(bytes);
+}
+
+size_t ID3_BinaryStore::GetThreshold()
+{
+  return store().Threshold();
+}
+
+/** The number of distinct payloads in the store. **/
+size_t ID3_BinaryStore::NumPayloads()
+{
+  Store& s = store();
+  s.Lock();
+  size_t n = s._payloads.size();
+  s.Unlock();
+  return n;
+}
+
+/** The number of fields referring to payloads in the store. **/
+size_t ID3_BinaryStore::NumReferences()
+{
+  Store& s = store();
+  size_t n = 0;
+  s.Lock();
+  for (Payloads::iterator pi = s._payloads.begin(); pi != s._payloads.end(); ++pi)
+  {
+    // copies may retain a payload without the lock
+    n += count(pi->second->refs);
+  }
+  s.Unlock();
+  return n;
+}
+
+/** The number of bytes held by the payloads in the store. **/
+size_t ID3_BinaryStore::NumBytes()
+{
+  Store& s = store();
+  s.Lock();
+  size_t n = s._bytes;
+  s.Unlock();
+  return n;
+}
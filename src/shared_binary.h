@@ -0,0 +1,245 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_SHARED_BINARY_H_
+#define _ID3LIB_SHARED_BINARY_H_
+
+#include "id3/globals.h" //has "sized_types.h"
+#include "id3/id3lib_strings.h"
+#include "trace_hooks.h"
+
+namespace dami
+{
+  // Field data of at least SHARED_SIZE bytes is kept in a reference counted
+  // payload, so copying a field, frame or tag only copies a pointer.  A
+  // payload is never changed while it is shared: a field that changes its
+  // data takes a copy of its own first.  Binary payloads of at least
+  // ID3_BinaryStore::GetThreshold() bytes are interned as well, so fields
+  // with the same data share it even when they were parsed separately.
+  // Smaller data is kept by each field itself, where copying it costs about
+  // as much as counting references would.
+  const size_t SHARED_SIZE = 64;
+
+  template <class S>
+  struct SharedPayload
+  {
+    S      data;
+    long   refs;
+    bool   interned;  // listed in the binary store?
+    uint32 hash;      // of data, if interned
+  };
+
+  long retain(long& refs);   // atomically adds one, returns the new count
+  long release(long& refs);  // atomically takes one, returns the new count
+  long count(long& refs);    // atomically reads the count
+  void lockCounts();         // what retain() and release() hold without atomics
+  void unlockCounts();
+
+  // the object slot points at; a NULL slot is first pointed at a new T, which
+  // is safe while other threads use the slot as well
+  template <class T>
+  T& instance(T*& slot)
+  {
+#if defined __ATOMIC_ACQUIRE
+    T* obj = __atomic_load_n(&slot, __ATOMIC_ACQUIRE);
+    if (obj == NULL)
+    {
+      T* made = new T;
+      if (__atomic_compare_exchange_n(&slot, &obj, made, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      {
+        obj = made;
+      }
+      else
+      {
+        delete made;  // another thread got there first
+      }
+    }
+    return *obj;
+#else
+    lockCounts();
+    if (slot == NULL)
+    {
+      slot = new T;
+    }
+    T* obj = slot;
+    unlockCounts();
+    return *obj;
+#endif
+  }
+
+  // interns data if it is large enough, taking over its bytes; returns NULL
+  // and leaves data alone otherwise
+  SharedPayload<BString>* intern(BString& data);
+  void release(SharedPayload<BString>* interned);
+
+  template <class S>
+  class Shared
+  {
+  public:
+    typedef SharedPayload<S>              Payload;
+    typedef typename S::value_type        char_type;
+
+    Shared() : _shared(NULL) { }
+    Shared(const Shared& rhs) : _own(rhs._own), _shared(rhs._shared)
+    {
+      if (_shared)
+      {
+        retain(_shared->refs);
+      }
+    }
+    ~Shared() { this->erase(); }
+    Shared& operator=(const Shared& rhs)
+    {
+      if (this != &rhs && !(_shared && _shared == rhs._shared))
+      {
+        Shared copy(rhs);
+        this->swap(copy);
+      }
+      return *this;
+    }
+
+    const S&         str() const { return _shared ? _shared->data : _own; }
+    const char_type* data() const { return this->str().data(); }
+    const char_type* c_str() const { return this->str().c_str(); }
+    size_t           size() const { return this->str().size(); }
+    bool             shared() const { return _shared != NULL; }
+
+    // takes over the contents of data, leaving it empty
+    void take(S& data)
+    {
+      this->erase();
+      if (data.size() >= SHARED_SIZE && (_shared = share(data)) != NULL)
+      {
+        return;
+      }
+      _own.swap(data);
+    }
+    void assign(const S& data) { S copy(data); this->take(copy); }
+    void assign(const char_type* data, size_t size) { S copy(data, size); this->take(copy); }
+    void assign(size_t size, char_type ch) { S copy(size, ch); this->take(copy); }
+
+    // the data to change in place, no longer shared with anyone else; call
+    // settle() when done
+    S& edit()
+    {
+      if (_shared)
+      {
+        trace(ID3_Tracer::BUFFERS);
+        S copy(_shared->data);
+        this->erase();
+        _own.swap(copy);
+      }
+      return _own;
+    }
+    void settle()
+    {
+      if (!_shared && _own.size() >= SHARED_SIZE)
+      {
+        S data;
+        data.swap(_own);
+        this->take(data);
+      }
+    }
+
+    void erase()
+    {
+      _own.erase();
+      if (_shared)
+      {
+        drop(_shared);
+        _shared = NULL;
+      }
+    }
+
+    void swap(Shared& rhs)
+    {
+      _own.swap(rhs._own);
+      Payload* shared = _shared;
+      _shared = rhs._shared;
+      rhs._shared = shared;
+    }
+
+  private:
+    static Payload* share(S& data)
+    {
+      trace(ID3_Tracer::BUFFERS);
+      Payload* payload = new Payload;
+      payload->data.swap(data);
+      payload->refs = 1;
+      payload->interned = false;
+      payload->hash = 0;
+      return payload;
+    }
+
+    static void drop(Payload* payload)
+    {
+      if (release(payload->refs) == 0)
+      {
+        delete payload;
+      }
+    }
+
+    S        _own;     // the data, unless it is shared
+    Payload* _shared;  // the shared data, or NULL
+  };
+
+  typedef Shared<String>  SharedText;
+  typedef Shared<BString> SharedBinary;
+
+  // binary data is interned when large enough
+  template <>
+  inline SharedPayload<BString>* Shared<BString>::share(BString& data)
+  {
+    SharedPayload<BString>* payload = intern(data);
+    if (payload == NULL)
+    {
+      trace(ID3_Tracer::BUFFERS);
+      payload = new SharedPayload<BString>;
+      payload->data.swap(data);
+      payload->refs = 1;
+      payload->interned = false;
+      payload->hash = 0;
+    }
+    return payload;
+  }
+
+  template <>
+  inline void Shared<BString>::drop(SharedPayload<BString>* payload)
+  {
+    if (payload->interned)
+    {
+      release(payload);
+    }
+    else if (release(payload->refs) == 0)
+    {
+      delete payload;
+    }
+  }
+};
+
+#endif /* _ID3LIB_SHARED_BINARY_H_ */
@@ -0,0 +1,381 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include "stream_parser.h"
+#include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "readers.h"
+
+/** \class ID3_StreamParser stream_parser.h id3/stream_parser.h
+ ** \brief Parses the tags of a stream as it arrives, from a pipe, a socket
+ ** or the body of an http response, without the stream having to be kept.
+ **
+ ** Linking a tag needs a reader it can seek in and that knows where it ends,
+ ** for the tags at the end of a file and for the size of its audio.  An
+ ** ID3_StreamParser is fed the bytes of the stream instead, in chunks of any
+ ** size, and only keeps those it needs: the id3v2 tags at the start, a few
+ ** kilobytes after them for the mp3 header, and a rolling copy of the last
+ ** \c tailSize bytes for the tags at the end.
+ **
+ ** As soon as the leading tags and the mp3 header have arrived they are
+ ** parsed into the tag, and HasHead() becomes true; their frames can be used
+ ** while the rest of the stream is still coming in.  Finish() then parses the
+ ** tags at the end of the stream, and completes the mp3 header information
+ ** that depends on the size of the audio, like the number of frames and the
+ ** playing time.  Afterwards the tag holds what linking a file with the same
+ ** contents would give, as long as the tags at its end fit in \c tailSize
+ ** bytes.  A tailSize of 0 skips them, as does leaving out ID3TT_APPENDED
+ ** from the tag types.
+ **
+ ** \code
+ **   ID3_Tag tag;
+ **   ID3_StreamParser parser(tag);
+ **   while ((size = recv(sock, buf, sizeof(buf), 0)) > 0)
+ **   {
+ **     parser.Feed(buf, size);
+ **     if (parser.HasHead() && !shown)
+ **     {
+ **       // show the title, the bitrate...
+ **     }
+ **   }
+ **   parser.Finish();
+ ** \endcode
+ **
+ ** Like Link(), feeding a stream adds the frames found to those already in
+ ** the tag.  The tag must not be changed while it is being fed.
+ **/
+
+using namespace dami;
+
+namespace
+{
+  // the part of the stream after the leading tags kept for finding the mp3
+  // sync byte and parsing the header of the first mp3 frame
+  const size_t HEADSIZE = 8 * 1024;
+
+  // the part of the stream after the mp3 sync byte kept for parsing the
+  // first mp3 frame: its header, side info and Xing or VBRI header
+  const size_t MP3HEADSIZE = 256;
+
+  // A reader over the parts of the stream that were kept: its head, from
+  // headBeg, and its tail, from tailBeg on.  What's in between or after them
+  // wasn't kept and reads as zeros.
+  class StreamReader : public ID3_Reader
+  {
+  public:
+    StreamReader(const BString& head, pos_type headBeg, const BString& tail,
+                 pos_type tailBeg, pos_type end)
+      : _head(head), _headBeg(headBeg), _tail(tail), _tailBeg(tailBeg),
+        _end(end), _cur(0) { }
+
+    void close() { ; }
+
+    pos_type getBeg() { return 0; }
+    pos_type getCur() { return _cur; }
+    pos_type getEnd() { return _end; }
+    pos_type setCur(pos_type pos)
+    {
+      _cur = mid<pos_type>(0, pos, _end);
+      return _cur;
+    }
+
+    int_type peekChar()
+    {
+      if (_cur >= _end)
+      {
+        return END_OF_READER;
+      }
+      char_type ch = '\0';
+      this->copy(&ch, _cur, 1);
+      return ch;
+    }
+
+    int_type readChar()
+    {
+      int_type ch = this->peekChar();
+      if (ch != END_OF_READER)
+      {
+        ++_cur;
+      }
+      return ch;
+    }
+
+    size_type readChars(char_type buf[], size_type len)
+    {
+      size_type size = min<size_type>(len, _end - _cur);
+      if (buf != NULL)
+      {
+        this->copy(buf, _cur, size);
+      }
+      _cur += size;
+      return size;
+    }
+    size_type readChars(char buf[], size_type len)
+    {
+      return this->readChars(reinterpret_cast<char_type *>(buf), len);
+    }
+
+    size_type skipChars(size_type len)
+    {
+      size_type size = min<size_type>(len, _end - _cur);
+      _cur += size;
+      return size;
+    }
+
+  private:
+    // copies size bytes from pos on, a part of the stream at a time
+    void copy(char_type* buf, pos_type pos, size_type size)
+    {
+      const pos_type headEnd = _headBeg + _head.size();
+      while (size > 0)
+      {
+        size_type num;
+        if (pos >= _headBeg && pos < headEnd)
+        {
+          num = min<size_type>(size, headEnd - pos);
+          ::memcpy(buf, _head.data() + (pos - _headBeg), num);
+        }
+        else if (pos >= _tailBeg && pos - _tailBeg < _tail.size())
+        {
+          num = min<size_type>(size, _tail.size() - (pos - _tailBeg));
+          ::memcpy(buf, _tail.data() + (pos - _tailBeg), num);
+        }
+        else
+        {
+          // up to the next part kept, if any
+          pos_type next = pos + size;
+          if (pos < _headBeg)
+          {
+            next = min(next, _headBeg);
+          }
+          if (pos < _tailBeg)
+          {
+            next = min(next, _tailBeg);
+          }
+          num = next - pos;
+          ::memset(buf, 0, num);
+        }
+        buf += num;
+        pos += num;
+        size -= num;
+      }
+    }
+
+    const BString& _head;
+    pos_type       _headBeg;
+    const BString& _tail;
+    pos_type       _tailBeg;
+    pos_type       _end;
+    pos_type       _cur;
+  };
+};
+
+class ID3_StreamParserImpl
+{
+public:
+  ID3_StreamParserImpl(ID3_TagImpl& tag, flags_t flags, size_t tailSize)
+    : _tag(tag), _flags(flags),
+      _tailSize((flags & ID3TT_APPENDED) ? tailSize : 0),
+      _headBeg(0), _leadingEnd(0), _scanning((flags & ID3TT_ID3V2) != 0),
+      _hasLeading(false), _hasHead(false), _tailBeg(0), _fed(0),
+      _bytesTillSync(0), _finished(false)
+  { }
+
+  void Feed(const uchar* data, size_t size)
+  {
+    if (_finished || size == 0)
+    {
+      return;
+    }
+    _fed += size;
+    if (!_hasHead)
+    {
+      // after the leading tags, only the start of the first mp3 frame
+      _head.append(data, _hasLeading ? min(size, MP3HEADSIZE - _head.size()) : size);
+      if (!_hasLeading && this->headArrived())
+      {
+        this->parseLeading();
+      }
+      if (_hasLeading && _head.size() >= MP3HEADSIZE)
+      {
+        this->parseMp3Header();
+      }
+    }
+    if (_tailSize == 0)
+    {
+      _tailBeg = _fed;
+      return;
+    }
+    if (size >= _tailSize)
+    {
+      _tail.assign(data + size - _tailSize, _tailSize);
+    }
+    else
+    {
+      // trimmed once it holds twice as much as needed, so each byte is
+      // moved at most once
+      _tail.append(data, size);
+      if (_tail.size() > 2 * _tailSize)
+      {
+        _tail.erase(0, _tail.size() - _tailSize);
+      }
+    }
+    _tailBeg = _fed - _tail.size();
+  }
+
+  void Finish()
+  {
+    if (_finished)
+    {
+      return;
+    }
+    if (!_hasLeading)
+    {
+      this->parseLeading();
+    }
+    // the mp3 header is parsed again by ParseStreamTail()
+    _hasHead = true;
+    if (_tail.size() > _tailSize)
+    {
+      _tail.erase(0, _tail.size() - _tailSize);
+    }
+    _tailBeg = _fed - _tail.size();
+    StreamReader reader(_head, _headBeg, _tail, _tailBeg, _fed);
+    _tag.ParseStreamTail(reader, _bytesTillSync, _tail.size());
+    _finished = true;
+    _head.clear();
+    _tail.clear();
+  }
+
+  bool   HasHead() const { return _hasHead; }
+  bool   IsFinished() const { return _finished; }
+  size_t GetBytesFed() const { return _fed; }
+
+private:
+  // whether the leading id3v2 tags and enough after them have arrived, going
+  // from one tag header to the next as they come in
+  bool headArrived()
+  {
+    while (_scanning && _head.size() >= _leadingEnd + ID3_TagHeader::SIZE)
+    {
+      ID3_MemoryReader mr(_head.data() + _leadingEnd, ID3_TagHeader::SIZE);
+      size_t tagSize = ID3_TagImpl::IsV2Tag(mr);
+      if (tagSize == 0)
+      {
+        _scanning = false;
+      }
+      _leadingEnd += tagSize;
+    }
+    return !_scanning && _head.size() >= _leadingEnd + HEADSIZE;
+  }
+
+  // parses the leading tags, then drops all of the head before the mp3 sync
+  // byte, whose frame is parsed once MP3HEADSIZE bytes of it have arrived
+  void parseLeading()
+  {
+    StreamReader reader(_head, 0, _tail, _fed, _head.size());
+    _bytesTillSync = _tag.ParseStreamHead(reader, _flags);
+    _hasLeading = true;
+    size_t audioBeg = min(_tag.GetPrependedBytes() + _bytesTillSync, _head.size());
+    _head.erase(0, audioBeg);
+    _headBeg = audioBeg;
+  }
+
+  // parses the mp3 header, which is parsed again by Finish()
+  void parseMp3Header()
+  {
+    StreamReader reader(_head, _headBeg, _tail, _fed, _headBeg + _head.size());
+    _tag.ParseStreamMp3Header(reader, _bytesTillSync);
+    _hasHead = true;
+  }
+
+  ID3_TagImpl& _tag;
+  flags_t      _flags;
+  size_t       _tailSize;
+  BString      _head;         // the start of the stream, from _headBeg
+  size_t       _headBeg;
+  size_t       _leadingEnd;   // the end of the id3v2 tags found so far
+  bool         _scanning;     // looking for more id3v2 tags?
+  bool         _hasLeading;   // have the leading tags been parsed?
+  bool         _hasHead;
+  BString      _tail;         // the last part of the stream, from _tailBeg
+  size_t       _tailBeg;
+  size_t       _fed;
+  size_t       _bytesTillSync;
+  bool         _finished;
+};
+
+/** Parses a stream into tag, looking for the given tag types and keeping
+ ** the last tailSize bytes of the stream for the tags at its end.
+ **/
+ID3_StreamParser::ID3_StreamParser(ID3_Tag& tag, flags_t flags, size_t tailSize)
+  : _impl(new ID3_StreamParserImpl(tag.impl(), flags, tailSize))
+{
+}
+
+ID3_StreamParser::~ID3_StreamParser()
+{
+  delete _impl;
+}
+
+/** Passes on the next size bytes of the stream.  The leading tags and the
+ ** mp3 header are parsed as soon as they have all arrived.
+ **/
+void ID3_StreamParser::Feed(const uchar* data, size_t size)
+{
+  _impl->Feed(data, size);
+}
+
+/** Tells the parser the stream has ended, which parses the tags at its end.
+ ** Bytes fed afterwards are ignored.
+ **/
+void ID3_StreamParser::Finish()
+{
+  _impl->Finish();
+}
+
+/** Whether the leading tags and the mp3 header have been parsed. **/
+bool ID3_StreamParser::HasHead() const
+{
+  return _impl->HasHead();
+}
+
+/** Whether Finish() has been called. **/
+bool ID3_StreamParser::IsFinished() const
+{
+  return _impl->IsFinished();
+}
+
+/** The number of bytes of the stream fed so far. **/
+size_t ID3_StreamParser::GetBytesFed() const
+{
+  return _impl->GetBytesFed();
+}
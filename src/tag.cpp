@@ -28,6 +28,7 @@
 //#include "readers.h"
 #include "writers.h"
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "shared_binary.h"
 
 using namespace dami;
 
@@ -160,7 +161,22 @@ using namespace dami;
  ** can be found.  If more than one frame meets the search criteria, subsequent
  ** calls to Find() with the same parameters will return the other matching
  ** frames.  The Find() method is guaranteed to return all matching frames
- ** before it wraps around to return the first matching frame.
+ ** before it wraps around to return the first matching frame.  FindFirst()
+ ** always returns the first matching frame, and Find() with an
+ ** ID3_Tag::Cursor steps through the matches without the tag keeping track.
+ **
+ ** \code
+ **   ID3_Tag::Cursor cursor;
+ **   ID3_Frame* first = myTag.Find(cursor, ID3FID_COMMENT);
+ **   ID3_Frame* next = myTag.Find(cursor, ID3FID_COMMENT);
+ ** \endcode
+ **
+ ** Apart from Find() without a cursor, which moves the cursor kept by the tag,
+ ** none of the const methods of ID3_Tag (FindFirst(), NumFrames(), Size(),
+ ** Render(), HasChanged(), ...) modify the tag, so a linked tag can be read
+ ** from several threads at once, as long as no thread modifies it (or any of
+ ** its frames) at the same time; each thread that steps through frames needs
+ ** a cursor of its own.
  **
  ** All ID3_Frame objects are comprised of a collection of ID3_Field objects.
  ** These fields can represent text, numbers, or binary data.  As with frames,
@@ -326,6 +342,12 @@ ID3_Tag::~ID3_Tag()
   delete _impl;
 }
 
+// a tag that was moved from carries on as a new, empty one
+ID3_TagImpl& ID3_Tag::impl() const
+{
+  return instance(_impl);
+}
+
 /** Clears the object and disassociates it from any files.
  **
  ** Frees any resources for which the object is responsible, including all
@@ -334,12 +356,13 @@ ID3_Tag::~ID3_Tag()
  **/
 void ID3_Tag::Clear()
 {
-  _impl->Clear();
+  impl().Clear();
 }
 
 
-/** Indicates whether the tag has been altered since the last parse, render,
- ** or update.
+/** Indicates whether the tag has been altered since the last parse or
+ ** update.  Rendering the tag into a buffer or writer doesn't reset it, as
+ ** Render() is const and leaves the tag untouched.
  **
  ** If you have a tag linked to a file, you do not need this method since the
  ** Update() method will check for changes before writing the tag.
@@ -363,7 +386,7 @@ void ID3_Tag::Clear()
  **/
 bool ID3_Tag::HasChanged() const
 {
-  return _impl->HasChanged();
+  return impl().HasChanged();
 }
 
 /** Returns an over estimate of the number of bytes required to store a
@@ -398,7 +421,7 @@ bool ID3_Tag::HasChanged() const
  **/
 size_t ID3_Tag::Size() const
 {
-  return _impl->Size();
+  return impl().Size();
 }
 
 /** Turns unsynchronization on or off, dependant on the value of the boolean
@@ -420,7 +443,7 @@ size_t ID3_Tag::Size() const
  **/
 bool ID3_Tag::SetUnsync(bool b)
 {
-  return _impl->SetUnsync(b);
+  return impl().SetUnsync(b);
 }
 
 
@@ -439,7 +462,7 @@ bool ID3_Tag::SetUnsync(bool b)
  **/
 bool ID3_Tag::SetExtendedHeader(bool ext)
 {
-  return _impl->SetExtended(ext);
+  return impl().SetExtended(ext);
 }
 
 /** Turns padding on or off, dependant on the value of the boolean
@@ -473,32 +496,32 @@ bool ID3_Tag::SetExtendedHeader(bool ext)
  **/
 bool ID3_Tag::SetPadding(bool pad)
 {
-  return _impl->SetPadding(pad);
+  return impl().SetPadding(pad);
 }
 
 bool ID3_Tag::SetExperimental(bool exp)
 {
-  return _impl->SetExperimental(exp);
+  return impl().SetExperimental(exp);
 }
 
 bool ID3_Tag::GetUnsync() const
 {
-  return _impl->GetUnsync();
+  return impl().GetUnsync();
 }
 
 bool ID3_Tag::GetExtendedHeader() const
 {
-  return _impl->GetExtended();
+  return impl().GetExtended();
 }
 
 bool ID3_Tag::GetExperimental() const
 {
-  return _impl->GetExperimental();
+  return impl().GetExperimental();
 }
 
 void ID3_Tag::AddFrame(const ID3_Frame& frame)
 {
-  _impl->AddFrame(frame);
+  impl().AddFrame(frame);
 }
 
 /** Attaches a frame to the tag; the tag doesn't take responsibility for
@@ -522,7 +545,7 @@ void ID3_Tag::AddFrame(const ID3_Frame& frame)
  **/
 void ID3_Tag::AddFrame(const ID3_Frame* frame)
 {
-  _impl->AddFrame(frame);
+  impl().AddFrame(frame);
 }
 
 /** Attaches a frame to the tag; the tag takes responsibility for
@@ -541,7 +564,39 @@ void ID3_Tag::AddFrame(const ID3_Frame* frame)
  **/
 bool ID3_Tag::AttachFrame(ID3_Frame *frame)
 {
-  return _impl->AttachFrame(frame);
+  return impl().AttachFrame(frame);
+}
+
+/** Attaches an array of frames to the tag in one go; the tag takes
+ ** responsibility for releasing the frames' memory, as with AttachFrame().
+ **
+ ** Each frame is checked as AttachFrame() would check it, and the invalid
+ ** ones are deleted.  The tag's find cursor is reset only once for the
+ ** whole array, so attaching many frames this way is cheaper than calling
+ ** AttachFrame() for each.  When \c trusted is set, the frames are
+ ** attached without any checks at all: use it only for frames known to be
+ ** valid, e.g. built by the application itself.  Frames that are outdated
+ ** in the tag's spec are still dropped or converted when the tag is
+ ** updated.
+ **
+ ** \code
+ **   ID3_Frame* frames[2];
+ **   frames[0] = new ID3_Frame(ID3FID_TITLE);
+ **   frames[1] = new ID3_Frame(ID3FID_LEADARTIST);
+ **   ...
+ **   myTag.AttachFrames(frames, 2, true);
+ ** \endcode
+ **
+ ** \param frames An array of pointers to the frames to attach; NULL
+ **        entries are skipped.
+ ** \param numFrames The number of pointers in the array.
+ ** \param trusted Whether to attach the frames without checking them.
+ ** \return The number of frames attached.
+ **/
+size_t ID3_Tag::AttachFrames(ID3_Frame* const* frames, size_t numFrames,
+                             bool trusted)
+{
+  return impl().AttachFrames(frames, numFrames, trusted);
 }
 
 
@@ -567,19 +622,19 @@ bool ID3_Tag::AttachFrame(ID3_Frame *frame)
  **/
 ID3_Frame* ID3_Tag::RemoveFrame(const ID3_Frame *frame)
 {
-  return _impl->RemoveFrame(frame);
+  return impl().RemoveFrame(frame);
 }
 
 bool ID3_Tag::Parse(ID3_Reader& reader)
 {
-  return id3::v2::parse(*_impl, reader);
+  return id3::v2::parse(impl(), reader);
 }
 
 size_t ID3_Tag::Parse(const uchar* buffer, size_t bytes)
 {
   ID3_MemoryReader mr(buffer, bytes);
   ID3_Reader::pos_type beg = mr.getCur();
-  id3::v2::parse(*_impl, mr);
+  id3::v2::parse(impl(), mr);
   return mr.getEnd() - beg;
 }
 
@@ -678,7 +733,7 @@ size_t ID3_Tag::Render(ID3_Writer& writer, ID3_TagType tt) const
   {
     ID3_Err err = id3::v2::render(writer, *this);
     if (err != ID3E_NoError)
-      _impl->SetLastError(err);
+      impl().SetLastError(err);
   }
   else if (ID3TT_ID3V1 & tt)
   {
@@ -687,6 +742,44 @@ size_t ID3_Tag::Render(ID3_Writer& writer, ID3_TagType tt) const
   return writer.getCur() - beg;
 }
 
+/** Writes the tag's frames in id3lib's flat form.
+ **
+ ** Unlike a rendered tag, the flat form is laid out the way the frames are
+ ** kept in memory: it is aligned, versioned and starts with a table of the
+ ** frames, so Deserialize() restores it without any parsing and an
+ ** ID3_TagView can read single frames and fields right where the data lies.
+ ** The flat form is meant for caches and databases, not for files other
+ ** programs read; it is only understood by the same version of id3lib.
+ **
+ ** \code
+ **   ostringstream os;
+ **   ID3_OStreamWriter writer(os);
+ **   myTag.Serialize(writer);
+ **   string flat = os.str();
+ **   // ...
+ **   ID3_Tag copy;
+ **   copy.Deserialize(reinterpret_cast<const uchar*>(flat.data()), flat.size());
+ ** \endcode
+ **
+ ** \return The number of bytes written
+ **/
+size_t ID3_Tag::Serialize(ID3_Writer& writer) const
+{
+  BString data;
+  impl().Serialize(data);
+  return writer.writeChars(data.data(), data.size());
+}
+
+/** Adds the frames in the flat form at data (see Serialize()) to the tag,
+ ** the way Parse() adds the frames of a rendered tag, and takes over the
+ ** tag's header settings.  Returns false, leaving the tag as it was, if the
+ ** data is damaged or was written by another version of id3lib.
+ **/
+bool ID3_Tag::Deserialize(const uchar* data, size_t size)
+{
+  return impl().Deserialize(data, size);
+}
+
 
 /** Attaches a file to the tag, parses the file, and adds any tag information
  ** found in the file to the tag.
@@ -726,7 +819,7 @@ size_t ID3_Tag::Render(ID3_Writer& writer, ID3_TagType tt) const
  **/
 size_t ID3_Tag::Link(const char *fileInfo, flags_t flags)
 {
-  return _impl->Link(fileInfo, flags);
+  return impl().Link(fileInfo, flags);
 }
 
 /**
@@ -734,12 +827,25 @@ size_t ID3_Tag::Link(const char *fileInfo, flags_t flags)
  */
 size_t ID3_Tag::Link(ID3_Reader &reader, flags_t flags)
 {
-  return _impl->Link(reader, flags);
+  return impl().Link(reader, flags);
+}
+
+/**
+ ** Same as the first, but restores the tag from the cache if the file hasn't
+ ** changed since it was last linked through it, and stores what was parsed
+ ** in the cache otherwise.  Unlike the other Link()s, this one clears the
+ ** tag first.
+ **
+ ** @see ID3_ParseCache
+ */
+size_t ID3_Tag::Link(const char *fileInfo, ID3_ParseCache& cache, flags_t flags)
+{
+  return impl().Link(fileInfo, cache, flags);
 }
 
 flags_t ID3_Tag::Update(flags_t flags)
 {
-  return _impl->Update(flags);
+  return impl().Update(flags);
 }
 
 /**
@@ -749,7 +855,71 @@ flags_t ID3_Tag::Update(flags_t flags)
  **/
 const Mp3_Headerinfo* ID3_Tag::GetMp3HeaderInfo() const
 {
-  return _impl->GetMp3HeaderInfo();
+  return impl().GetMp3HeaderInfo();
+}
+
+/**
+ ** Returns the results of the last ScanMp3Frames(), NULL if the frames
+ ** haven't been scanned.
+ **/
+const Mp3_Scaninfo* ID3_Tag::GetMp3ScanInfo() const
+{
+  return impl().GetMp3ScanInfo();
+}
+
+/**
+ ** Walks every mpeg frame of the linked file to get the exact number of
+ ** frames, the duration and the average bitrate, whether the file is vbr, the
+ ** number of frames with a crc mismatch (layer III only) and a seek index
+ ** with the file offsets of the frames at every 1/seekpoints of the song.
+ ** This reads all of the audio data, so it is only done on request; for
+ ** files with a Xing or VBRI header GetMp3HeaderInfo() has the exact number of
+ ** frames too.
+ ** Can be run after Link(<filename>), returns NULL if there's no mp3 data.
+ **/
+const Mp3_Scaninfo* ID3_Tag::ScanMp3Frames(size_t seekpoints)
+{
+  return impl().ScanMp3Frames(seekpoints);
+}
+
+/**
+ ** Same as above, but reads the audio data from the reader the tag was
+ ** linked with.
+ */
+const Mp3_Scaninfo* ID3_Tag::ScanMp3Frames(ID3_Reader& reader, size_t seekpoints)
+{
+  return impl().ScanMp3Frames(reader, seekpoints);
+}
+
+/**
+ ** Turns the statistics of the following parses on or off, see
+ ** GetParseStats().  They are off by default, as they cost a little time.
+ **
+ ** \code
+ **   ID3_Tag myTag;
+ **   myTag.SetParseStats(true);
+ **   myTag.Link("song.mp3");
+ **   const ID3_ParseStats* stats = myTag.GetParseStats();
+ ** \endcode
+ **/
+void ID3_Tag::SetParseStats(bool b)
+{
+  impl().SetParseStats(b);
+}
+
+/**
+ ** Returns the statistics of the last parse: how often the file was read
+ ** from and seeked in, how many bytes were read and passed over, the id3v2
+ ** frames parsed by id, those of an unknown id and those dropped because
+ ** they failed to parse, how many bytes were decompressed, whether the tag
+ ** had to be resynchronized, and the time spent on each tag type and on the
+ ** mpeg header.
+ ** Can be run after Link(), returns NULL if it was run without
+ ** SetParseStats(true) or the tag came from a parse cache.
+ **/
+const ID3_ParseStats* ID3_Tag::GetParseStats() const
+{
+  return impl().GetParseStats();
 }
 
 /**
@@ -760,7 +930,7 @@ const Mp3_Headerinfo* ID3_Tag::GetMp3HeaderInfo() const
  **/
 ID3_Err ID3_Tag::GetLastError()
 {
-  return _impl->GetLastError();
+  return impl().GetLastError();
 }
 
 /** Strips the tag(s) from the attached file. The type of tag stripped
@@ -771,27 +941,27 @@ ID3_Err ID3_Tag::GetLastError()
  **/
 flags_t ID3_Tag::Strip(flags_t flags)
 {
-  return _impl->Strip(flags);
+  return impl().Strip(flags);
 }
 
 size_t ID3_Tag::GetPrependedBytes() const
 {
-  return _impl->GetPrependedBytes();
+  return impl().GetPrependedBytes();
 }
 
 size_t ID3_Tag::GetAppendedBytes() const
 {
-  return _impl->GetAppendedBytes();
+  return impl().GetAppendedBytes();
 }
 
 size_t ID3_Tag::GetFileSize() const
 {
-  return _impl->GetFileSize();
+  return impl().GetFileSize();
 }
 
 const char* ID3_Tag::GetFileName() const
 {
-  return _impl->GetFileName().c_str();
+  return impl().GetFileName().c_str();
 }
 
 /// Finds frame with given frame id
@@ -800,7 +970,9 @@ const char* ID3_Tag::GetFileName() const
    **
    ** If there are multiple frames in the tag with the same ID (which, for some
    ** frames, is allowed), then subsequent calls to Find() will return
-   ** subsequent frame pointers, wrapping if necessary.
+   ** subsequent frame pointers, wrapping if necessary.  This moves a cursor
+   ** kept by the tag, so unlike FindFirst() and Find() with a cursor of your
+   ** own, it is not safe to call from several threads at once.
    **
    ** \code
    **   ID3_Frame *myFrame;
@@ -855,32 +1027,149 @@ const char* ID3_Tag::GetFileName() const
    **
    ** @name   Find
    ** @param  id The ID of the frame that is to be located
-   ** @return A pointer to the first frame found that has the given frame id,
+   ** @return A pointer to the next frame found that has the given frame id,
    **         or NULL if no such frame.
    **/
 ID3_Frame* ID3_Tag::Find(ID3_FrameID id) const
 {
-  return _impl->Find(id);
+  return impl().Find(id);
 }
 
 /// Finds frame with given frame id, fld id, and integer data
 ID3_Frame* ID3_Tag::Find(ID3_FrameID id, ID3_FieldID fld, uint32 data) const
 {
-  return _impl->Find(id, fld, data);
+  return impl().Find(id, fld, data);
 }
 
 /// Finds frame with given frame id, fld id, and ascii data
 ID3_Frame* ID3_Tag::Find(ID3_FrameID id, ID3_FieldID fld, const char* data) const
 {
   String str(data);
-  return _impl->Find(id, fld, str);
+  return impl().Find(id, fld, str);
 }
 
 /// Finds frame with given frame id, fld id, and unicode data
 ID3_Frame* ID3_Tag::Find(ID3_FrameID id, ID3_FieldID fld, const unicode_t* data) const
 {
   WString str = toWString(data, ucslen(data));
-  return _impl->Find(id, fld, str);
+  return impl().Find(id, fld, str);
+}
+
+/// Finds the next frame with given frame id after the cursor
+  /** Searches from the frame after the one last found through the cursor to
+   ** the end of the tag, then wraps around to the beginning.  A new (or
+   ** Reset()) cursor starts at the first frame.  The cursor is left at the
+   ** frame found, and is left untouched if no frame is found.
+   **
+   ** Only the cursor is modified, so several threads can each step through the
+   ** same tag with cursors of their own.
+   **
+   ** \code
+   **   ID3_Tag::Cursor cursor;
+   **   for (size_t i = 0; i < numComments; ++i)
+   **   {
+   **     ID3_Frame* comment = myTag.Find(cursor, ID3FID_COMMENT);
+   **     // ...
+   **   }
+   ** \endcode
+   **
+   ** @name   Find
+   ** @param  cursor Where the previous search left off
+   ** @param  id The ID of the frame that is to be located
+   ** @return A pointer to the next frame found that has the given frame id,
+   **         or NULL if no such frame.
+   **/
+ID3_Frame* ID3_Tag::Find(Cursor& cursor, ID3_FrameID id) const
+{
+  return impl().Find(cursor, id);
+}
+
+/// Finds the next frame with given frame id, fld id, and integer data
+ID3_Frame* ID3_Tag::Find(Cursor& cursor, ID3_FrameID id, ID3_FieldID fld, uint32 data) const
+{
+  return impl().Find(cursor, id, fld, data);
+}
+
+/// Finds the next frame with given frame id, fld id, and ascii data
+ID3_Frame* ID3_Tag::Find(Cursor& cursor, ID3_FrameID id, ID3_FieldID fld, const char* data) const
+{
+  String str(data);
+  return impl().Find(cursor, id, fld, str);
+}
+
+/// Finds the next frame with given frame id, fld id, and unicode data
+ID3_Frame* ID3_Tag::Find(Cursor& cursor, ID3_FrameID id, ID3_FieldID fld, const unicode_t* data) const
+{
+  WString str = toWString(data, ucslen(data));
+  return impl().Find(cursor, id, fld, str);
+}
+
+/// Finds the first frame with given frame id
+  /** Returns a pointer to the first ID3_Frame with the given ID3_FrameID, or
+   ** NULL if there is none.  Unlike Find(), it doesn't move the cursor kept by
+   ** the tag, so it returns the same frame every time and can be called from
+   ** several threads at once.
+   **
+   ** @name   FindFirst
+   ** @param  id The ID of the frame that is to be located
+   ** @return A pointer to the first frame found that has the given frame id,
+   **         or NULL if no such frame.
+   **/
+ID3_Frame* ID3_Tag::FindFirst(ID3_FrameID id) const
+{
+  return impl().FindFirst(id);
+}
+
+/// Finds the first frame with given frame id, fld id, and integer data
+ID3_Frame* ID3_Tag::FindFirst(ID3_FrameID id, ID3_FieldID fld, uint32 data) const
+{
+  return impl().FindFirst(id, fld, data);
+}
+
+/// Finds the first frame with given frame id, fld id, and ascii data
+ID3_Frame* ID3_Tag::FindFirst(ID3_FrameID id, ID3_FieldID fld, const char* data) const
+{
+  String str(data);
+  return impl().FindFirst(id, fld, str);
+}
+
+/// Finds the first frame with given frame id, fld id, and unicode data
+ID3_Frame* ID3_Tag::FindFirst(ID3_FrameID id, ID3_FieldID fld, const unicode_t* data) const
+{
+  WString str = toWString(data, ucslen(data));
+  return impl().FindFirst(id, fld, str);
+}
+
+ID3_Tag::Cursor::Cursor(const Cursor& cursor)
+  : _impl(cursor._impl ? new ID3_CursorImpl(*cursor._impl) : NULL)
+{
+}
+
+ID3_Tag::Cursor& ID3_Tag::Cursor::operator=(const Cursor& cursor)
+{
+  if (this != &cursor)
+  {
+    ID3_CursorImpl* impl = cursor._impl ? new ID3_CursorImpl(*cursor._impl) : NULL;
+    delete _impl;
+    _impl = impl;
+  }
+  return *this;
+}
+
+ID3_Tag::Cursor::~Cursor()
+{
+  delete _impl;
+}
+
+/** Sets the cursor back, so that the next search through it starts at the
+ ** first frame.
+ **/
+void ID3_Tag::Cursor::Reset()
+{
+  if (_impl)
+  {
+    _impl->Reset();
+  }
 }
 
 /** Returns the number of frames present in the tag object.
@@ -892,7 +1181,7 @@ ID3_Frame* ID3_Tag::Find(ID3_FrameID id, ID3_FieldID fld, const unicode_t* data)
  **/
 size_t ID3_Tag::NumFrames() const
 {
-  return _impl->NumFrames();
+  return impl().NumFrames();
 }
 
 /** Returns a pointer to the frame with the given index; returns NULL if
@@ -921,7 +1210,7 @@ ID3_Frame* ID3_Tag::GetFrameNum(size_t num) const
   ID3_Frame* frame = NULL;
   size_t curNum = 0;
   // search from the cursor to the end
-  for (ID3_TagImpl::const_iterator cur = _impl->begin(); cur != _impl->end(); ++cur)
+  for (ID3_TagImpl::const_iterator cur = impl().begin(); cur != impl().end(); ++cur)
   {
     if (curNum++ == num)
     {
@@ -953,27 +1242,34 @@ ID3_Tag& ID3_Tag::operator=( const ID3_Tag &rTag )
 {
   if (this != &rTag)
   {
-    *_impl = rTag;
+    if (_impl == NULL)
+    {
+      _impl = new ID3_TagImpl(rTag);  // this tag was moved from
+    }
+    else
+    {
+      *_impl = rTag;
+    }
   }
   return *this;
 }
 
 bool ID3_Tag::HasTagType(ID3_TagType tt) const
 {
-  return _impl->HasTagType(tt);
+  return impl().HasTagType(tt);
 }
 
 ID3_V2Spec ID3_Tag::GetSpec() const
 {
-  return _impl->GetSpec();
+  return impl().GetSpec();
 }
 
 bool ID3_Tag::SetSpec(ID3_V2Spec spec)
 {
   //a user cannot set a spec lower than ID3V2_3_0, it's obsolete!
   ID3_V2Spec spec2use = spec < ID3V2_3_0 ? ID3V2_LATEST : spec;
-  _impl->UserUpdatedSpec = _impl->GetSpec() != spec2use;
-  return _impl->SetSpec(spec2use);
+  impl().UserUpdatedSpec = impl().GetSpec() != spec2use;
+  return impl().SetSpec(spec2use);
 }
 
 /** Analyses a buffer to determine if we have a valid ID3v2 tag header.
@@ -994,7 +1290,7 @@ size_t ID3_Tag::IsV2Tag(ID3_Reader& reader)
 /// Deprecated
 void ID3_Tag::AddNewFrame(ID3_Frame* f)
 {
-  _impl->AttachFrame(f);
+  impl().AttachFrame(f);
 }
 
 /** Copies an array of frames to the tag.
@@ -1023,7 +1319,7 @@ void ID3_Tag::AddFrames(const ID3_Frame *frames, size_t numFrames)
 
 size_t ID3_Tag::Link(const char *fileInfo, bool parseID3v1, bool parseLyrics3)
 {
-  return _impl->Link(fileInfo, parseID3v1, parseLyrics3);
+  return impl().Link(fileInfo, parseID3v1, parseLyrics3);
 }
 
 void ID3_Tag::SetCompression(bool b)
@@ -1142,12 +1438,12 @@ namespace
 ID3_Tag::Iterator*
 ID3_Tag::CreateIterator()
 {
-  return new IteratorImpl(*_impl);
+  return new IteratorImpl(impl());
 }
 
 ID3_Tag::ConstIterator*
 ID3_Tag::CreateIterator() const
 {
-  return new ConstIteratorImpl(*_impl);
+  return new ConstIteratorImpl(impl());
 }
 
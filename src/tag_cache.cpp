@@ -0,0 +1,543 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>  //for remove & rename
+#include <string.h>
+#include <vector>
+#if defined HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#if defined HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#if defined HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if defined HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if defined HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#include "parse_cache.h"
+#include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "id3/id3lib_streams.h"
+#include "flat_io.h"
+
+/** \class ID3_ParseCache parse_cache.h id3/parse_cache.h
+ ** \brief Keeps the results of linking files in a directory, so linking them
+ ** again is a stat() and the read of one small file.
+ **
+ ** A media library that rescans its files at every start parses the same
+ ** tags over and over, although hardly any of them changed.  Linking through
+ ** an ID3_ParseCache stores what was found in a file, i.e. the frames, the
+ ** mp3 header information, the sizes of the tags at the start and the end
+ ** of the file and which tag types it contains, in an entry of the cache
+ ** directory.  The next time the file is linked through the cache, the tag is
+ ** restored from the entry if the file's size, modification and change times,
+ ** inode and device are still those recorded in it.
+ **
+ ** \code
+ **   ID3_ParseCache cache("/var/cache/myplayer/tags");
+ **   for (size_t i = 0; i < numFiles; ++i)
+ **   {
+ **     ID3_Tag tag;
+ **     tag.Link(files[i], cache);
+ **     // ...
+ **   }
+ ** \endcode
+ **
+ ** Updating or stripping a tag linked through a cache removes the file's
+ ** entry, which is written anew the next time the file is linked.  Changes
+ ** made by other programs are noticed by the file's times and size; a change
+ ** within the same second that leaves the size alone is not, so such files
+ ** should be invalidated explicitly.  The entries are named after the path
+ ** the file was linked by.
+ **
+ ** The cache directory has to exist.  Entries are replaced atomically, so
+ ** several threads and processes may use the same directory at once.  One
+ ** ID3_ParseCache may be shared by several threads, and must live as long as
+ ** the tags linked through it are in use.
+ **/
+
+using namespace dami;
+
+// An entry is a header of 96 bytes, followed by the path of the file, the mp3
+// header information and the flat form of the tag (see tag_flat.cpp).  Like
+// the latter, all numbers are 32 bit little endian and everything starts on
+// a 4 byte boundary, so an entry is used right where it is mapped.
+//
+//      0  "ID3C"
+//      4  format version
+//      8  size of the entry
+//     12  tag types that were parsed
+//     16  key: file size, modification time, change time, inode and device,
+//         the low 32 bits of each first
+//     56  tag types found in the file
+//     60  prepended bytes
+//     64  appended bytes
+//     68  offset, size of the path
+//     76  offset, size of the mp3 header information, 0 if there was none
+//     84  offset, size of the flat tag
+//     92  fnv-1a checksum of everything after the header
+
+class ID3_ParseCacheImpl
+{
+public:
+  ID3_ParseCacheImpl(const char* dir)
+    : _dir(dir ? dir : ""), _hits(0), _misses(0)
+  {
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_init(&_lock, NULL);
+#endif
+  }
+  ~ID3_ParseCacheImpl()
+  {
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_destroy(&_lock);
+#endif
+  }
+
+  void Count(bool hit)
+  {
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_lock(&_lock);
+#endif
+    if (hit)
+    {
+      ++_hits;
+    }
+    else
+    {
+      ++_misses;
+    }
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_unlock(&_lock);
+#endif
+  }
+
+  size_t Get(const size_t& counter) const
+  {
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_lock(&_lock);
+#endif
+    size_t val = counter;
+#if defined HAVE_PTHREAD_H
+    pthread_mutex_unlock(&_lock);
+#endif
+    return val;
+  }
+
+  const String _dir;
+  size_t       _hits;
+  size_t       _misses;
+#if defined HAVE_PTHREAD_H
+  mutable pthread_mutex_t _lock;
+#endif
+};
+
+namespace
+{
+  const uchar  CACHE_MAGIC[4]    = { 'I', 'D', '3', 'C' };
+  const uint32 CACHE_VERSION     = 1;
+  const size_t CACHE_HEADER_SIZE = 96;
+  const size_t KEY_OFFSET        = 16;
+  const size_t KEY_WORDS         = 10;
+  const size_t MP3_WORDS         = 24;
+  const size_t MP3_SIZE          = MP3_WORDS * 4 + 100 + 12;
+
+  uint32 checksum(const uchar* data, size_t size)
+  {
+    uint32 sum = 2166136261UL;
+    for (size_t i = 0; i < size; ++i)
+    {
+      sum = ((sum ^ data[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return sum;
+  }
+
+  template <typename T>
+  void splitKey(uint32* key, T val)
+  {
+    key[0] = (uint32)(val & 0xFFFFFFFFUL);
+    key[1] = (uint32)((val >> 16) >> 16);
+  }
+
+  // the value splitKey() stored, as much of it as fits a size_t
+  size_t joinKey(const uint32* key)
+  {
+    return (size_t)key[0] | (((size_t)key[1] << 16) << 16);
+  }
+
+  // the stat information that must not change for an entry to stay valid
+  bool statKey(const char* path, uint32 key[KEY_WORDS])
+  {
+#if defined HAVE_SYS_STAT_H
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+      return false;
+    }
+    splitKey(key,     st.st_size);
+    splitKey(key + 2, st.st_mtime);
+    splitKey(key + 4, st.st_ctime);
+    splitKey(key + 6, st.st_ino);
+    splitKey(key + 8, st.st_dev);
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  String entryName(const String& dir, const char* path)
+  {
+    // two fnv-1a hashes with different offsets make collisions unlikely;
+    // the path is stored in the entry anyway
+    uint32 h1 = 2166136261UL, h2 = 3735928559UL;
+    for (const char* p = path; *p != '\0'; ++p)
+    {
+      h1 = ((h1 ^ (uchar)*p) * 16777619UL) & 0xFFFFFFFFUL;
+      h2 = ((h2 ^ (uchar)*p) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    char name[32];
+    sprintf(name, "%08lx%08lx.id3c", (unsigned long)h1, (unsigned long)h2);
+    return dir + "/" + name;
+  }
+
+  void putMp3Info(BString& data, const Mp3_Headerinfo& info)
+  {
+    const uint32 words[MP3_WORDS] =
+    {
+      (uint32)info.layer, (uint32)info.version, (uint32)info.bitrate,
+      (uint32)info.channelmode, (uint32)info.modeext, (uint32)info.emphasis,
+      (uint32)info.crc, (uint32)info.frequency, (uint32)info.framesize,
+      (uint32)info.frames, (uint32)info.time, (uint32)info.datasize,
+      (uint32)info.privatebit, (uint32)info.copyrighted, (uint32)info.original,
+      (uint32)info.vbrheader, (uint32)info.vbr_bitrate, (uint32)info.vbr_bytes,
+      (uint32)info.has_toc, (uint32)info.encoder_delay,
+      (uint32)info.encoder_padding, (uint32)info.replaygain_peak,
+      (uint32)(uint16)info.replaygain_track, (uint32)(uint16)info.replaygain_album
+    };
+    for (size_t i = 0; i < MP3_WORDS; ++i)
+    {
+      putNumber(data, words[i]);
+    }
+    data.append(info.toc, sizeof(info.toc));
+    data.append(reinterpret_cast<const uchar*>(info.encoder), sizeof(info.encoder));
+    data.append(2, '\0');
+  }
+
+  void getMp3Info(const uchar* data, Mp3_Headerinfo& info)
+  {
+    uint32 w[MP3_WORDS];
+    for (size_t i = 0; i < MP3_WORDS; ++i)
+    {
+      w[i] = getNumber(data + 4 * i);
+    }
+    info.layer            = (Mpeg_Layers)w[0];
+    info.version          = (Mpeg_Version)w[1];
+    info.bitrate          = (MP3_BitRates)w[2];
+    info.channelmode      = (Mp3_ChannelMode)w[3];
+    info.modeext          = (Mp3_ModeExt)w[4];
+    info.emphasis         = (Mp3_Emphasis)w[5];
+    info.crc              = (Mp3_Crc)w[6];
+    info.frequency        = w[7];
+    info.framesize        = w[8];
+    info.frames           = w[9];
+    info.time             = w[10];
+    info.datasize         = w[11];
+    info.privatebit       = w[12] != 0;
+    info.copyrighted      = w[13] != 0;
+    info.original         = w[14] != 0;
+    info.vbrheader        = (Mp3_VbrHeader)w[15];
+    info.vbr_bitrate      = w[16];
+    info.vbr_bytes        = w[17];
+    info.has_toc          = w[18] != 0;
+    info.encoder_delay    = (uint16)w[19];
+    info.encoder_padding  = (uint16)w[20];
+    info.replaygain_peak  = w[21];
+    info.replaygain_track = (int16)(uint16)w[22];
+    info.replaygain_album = (int16)(uint16)w[23];
+    memcpy(info.toc, data + 4 * MP3_WORDS, sizeof(info.toc));
+    memcpy(info.encoder, data + 4 * MP3_WORDS + sizeof(info.toc), sizeof(info.encoder));
+    info.encoder[sizeof(info.encoder) - 1] = '\0';
+  }
+
+  // writes to a temporary file first, so readers never see half an entry
+  bool writeEntry(const String& name, const BString& data)
+  {
+#if defined HAVE_MKSTEMP && defined HAVE_UNISTD_H
+    String tmp = name + ".XXXXXX";
+    std::vector<char> buf(tmp.begin(), tmp.end());
+    buf.push_back('\0');
+    int fd = mkstemp(&buf[0]);
+    if (fd < 0)
+    {
+      return false;
+    }
+    size_t done = 0;
+    while (done < data.size())
+    {
+      ssize_t n = write(fd, data.data() + done, data.size() - done);
+      if (n <= 0)
+      {
+        break;
+      }
+      done += n;
+    }
+    bool ok = close(fd) == 0 && done == data.size() &&
+      rename(&buf[0], name.c_str()) == 0;
+    if (!ok)
+    {
+      remove(&buf[0]);
+    }
+    return ok;
+#else
+    std::ofstream file(name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return file.good();
+#endif
+  }
+
+  // an entry mapped into memory if possible, read otherwise
+  class Entry
+  {
+  public:
+    Entry() : _data(NULL), _size(0), _mapped(false) { }
+    ~Entry()
+    {
+#if defined HAVE_SYS_MMAN_H
+      if (_mapped)
+      {
+        munmap(const_cast<uchar*>(_data), _size);
+      }
+#endif
+    }
+
+    bool Open(const String& name)
+    {
+#if defined HAVE_SYS_MMAN_H && defined HAVE_FCNTL_H && defined HAVE_SYS_STAT_H
+      int fd = open(name.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+        return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size >= (off_t)CACHE_HEADER_SIZE)
+      {
+        void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED)
+        {
+          _data = static_cast<const uchar*>(addr);
+          _size = st.st_size;
+          _mapped = true;
+        }
+      }
+      close(fd);
+      return _mapped;
+#else
+      std::ifstream file(name.c_str(), std::ios::in | std::ios::binary);
+      if (!file)
+      {
+        return false;
+      }
+      char buf[4096];
+      while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+      {
+        _buffer.append(reinterpret_cast<uchar*>(buf), file.gcount());
+      }
+      _data = _buffer.data();
+      _size = _buffer.size();
+      return _size >= CACHE_HEADER_SIZE;
+#endif
+    }
+
+    bool Matches(const char* path, flags_t tags, const uint32 key[KEY_WORDS]) const
+    {
+      if (memcmp(_data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+          getNumber(_data + 4) != CACHE_VERSION ||
+          getNumber(_data + 8) != _size ||
+          getNumber(_data + 12) != tags)
+      {
+        return false;
+      }
+      for (size_t i = 0; i < KEY_WORDS; ++i)
+      {
+        if (getNumber(_data + KEY_OFFSET + 4 * i) != key[i])
+        {
+          return false;
+        }
+      }
+      const size_t offset = getNumber(_data + 68), size = getNumber(_data + 72);
+      return inside(offset, size, _size) && size == strlen(path) &&
+        memcmp(_data + offset, path, size) == 0 &&
+        inside(getNumber(_data + 76), getNumber(_data + 80), _size) &&
+        inside(getNumber(_data + 84), getNumber(_data + 88), _size) &&
+        (getNumber(_data + 76) == 0 || getNumber(_data + 80) == MP3_SIZE) &&
+        getNumber(_data + 92) == checksum(_data + CACHE_HEADER_SIZE, _size - CACHE_HEADER_SIZE);
+    }
+
+    const uchar* Data() const { return _data; }
+
+  private:
+    const uchar* _data;
+    size_t       _size;
+    bool         _mapped;
+    BString      _buffer;
+  };
+};
+
+/** Uses dir, which must exist, to keep the cache entries in. **/
+ID3_ParseCache::ID3_ParseCache(const char* dir)
+  : _impl(new ID3_ParseCacheImpl(dir))
+{
+}
+
+ID3_ParseCache::~ID3_ParseCache()
+{
+  delete _impl;
+}
+
+const char* ID3_ParseCache::GetDirectory() const
+{
+  return _impl->_dir.c_str();
+}
+
+/** Removes the entry of a file, so it is parsed the next time it's linked
+ ** through the cache.  Returns true if there was an entry.
+ **/
+bool ID3_ParseCache::Invalidate(const char* fileInfo) const
+{
+  return fileInfo != NULL && remove(entryName(_impl->_dir, fileInfo).c_str()) == 0;
+}
+
+/** The number of links that were answered from the cache. **/
+size_t ID3_ParseCache::GetHits() const
+{
+  return _impl->Get(_impl->_hits);
+}
+
+/** The number of links that had to parse the file. **/
+size_t ID3_ParseCache::GetMisses() const
+{
+  return _impl->Get(_impl->_misses);
+}
+
+size_t ID3_TagImpl::Link(const char *fileInfo, ID3_ParseCache& cache, flags_t tag_types)
+{
+  this->Clear();
+  uint32 key[KEY_WORDS];
+  if (NULL == fileInfo || !statKey(fileInfo, key))
+  {
+    return this->Link(fileInfo, tag_types);
+  }
+  const String name = entryName(cache._impl->_dir, fileInfo);
+
+  Entry entry;
+  bool hit = entry.Open(name) && entry.Matches(fileInfo, tag_types, key);
+  if (hit)
+  {
+    const uchar* data = entry.Data();
+    _tags_to_parse.set(tag_types);
+    _file_name       = fileInfo;
+    _file_size       = joinKey(key);
+    _file_tags.set(getNumber(data + 56));
+    _prepended_bytes = getNumber(data + 60);
+    _appended_bytes  = getNumber(data + 64);
+    if (getNumber(data + 76) != 0)
+    {
+      Mp3_Headerinfo info;
+      getMp3Info(data + getNumber(data + 76), info);
+      _mp3_info = LEAKTESTNEW(Mp3Info);
+      _mp3_info->SetMp3HeaderInfo(info);
+    }
+    hit = this->Deserialize(data + getNumber(data + 84), getNumber(data + 88));
+    if (!hit)
+    {
+      this->Clear();
+    }
+  }
+  if (!hit)
+  {
+    this->Link(fileInfo, tag_types);
+    if (ID3E_NoError == _last_error)
+    {
+      BString data(CACHE_HEADER_SIZE, '\0');
+      data.replace(0, sizeof(CACHE_MAGIC), CACHE_MAGIC, sizeof(CACHE_MAGIC));
+      setNumber(data, 4, CACHE_VERSION);
+      setNumber(data, 12, tag_types);
+      for (size_t i = 0; i < KEY_WORDS; ++i)
+      {
+        setNumber(data, KEY_OFFSET + 4 * i, key[i]);
+      }
+      setNumber(data, 56, _file_tags.get());
+      setNumber(data, 60, _prepended_bytes);
+      setNumber(data, 64, _appended_bytes);
+
+      const size_t pathSize = strlen(fileInfo);
+      setNumber(data, 68, data.size());
+      setNumber(data, 72, pathSize);
+      data.append(reinterpret_cast<const uchar*>(fileInfo), pathSize);
+      data.append(4 - data.size() % 4, '\0');
+      const Mp3_Headerinfo* info = this->GetMp3HeaderInfo();
+      if (info)
+      {
+        setNumber(data, 76, data.size());
+        setNumber(data, 80, MP3_SIZE);
+        putMp3Info(data, *info);
+      }
+      const size_t tag = data.size();
+      this->Serialize(data);
+      setNumber(data, 84, tag);
+      setNumber(data, 88, data.size() - tag);
+      setNumber(data, 8, data.size());
+      setNumber(data, 92, checksum(data.data() + CACHE_HEADER_SIZE,
+                                   data.size() - CACHE_HEADER_SIZE));
+      writeEntry(name, data);
+    }
+  }
+  cache._impl->Count(hit);
+  _cache_dir = cache._impl->_dir;
+
+  return this->GetPrependedBytes();
+}
+
+// called before and after the file is written, so an entry made meanwhile by
+// someone else linking the half written file is removed as well
+void ID3_TagImpl::InvalidateCache()
+{
+  if (!_cache_dir.empty())
+  {
+    remove(entryName(_cache_dir, _file_name.c_str()).c_str());
+  }
+}
@@ -26,9 +26,11 @@
 // http://download.sourceforge.net/id3lib/
 
 #include <stdio.h>  //for BUFSIZ and functions remove & rename
+#include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "frame_impl.h"
 #include "writers.h"
 #include "io_strings.h"
-#include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "trace_hooks.h"
 
 using namespace dami;
 
@@ -131,6 +133,7 @@ size_t ID3_TagImpl::Link(const char *fileInfo, bool parseID3v1, bool parseLyrics
 size_t ID3_TagImpl::Link(const char *fileInfo, flags_t tag_types)
 {
   _tags_to_parse.set(tag_types);
+  _cache_dir = "";
 
   if (NULL == fileInfo)
   {
@@ -149,6 +152,7 @@ size_t ID3_TagImpl::Link(const char *fileInfo, flags_t tag_types)
 size_t ID3_TagImpl::Link(ID3_Reader &reader, flags_t tag_types)
 {
   _tags_to_parse.set(tag_types);
+  _cache_dir = "";
 
   _file_name = "";
   _changed = true;
@@ -232,11 +236,13 @@ size_t RenderV2ToFile(const ID3_TagImpl& tag, fstream& file)
   if ((!tag.GetPrependedBytes() && !ID3_GetDataSize(tag)) ||
       (tagSize == tag.GetPrependedBytes()))
   {
+    trace(ID3_Tracer::INPLACEWRITES);
     file.seekp(0, ios::beg);
     file.write(tagData, tagSize);
   }
   else
   {
+    trace(ID3_Tracer::REWRITES);
     String filename = tag.GetFileName();
     String sTmpSuffix = ".XXXXXX";
     if (filename.size() + sTmpSuffix.size() > ID3_PATH_LENGTH)
@@ -337,7 +343,9 @@ size_t RenderV2ToFile(const ID3_TagImpl& tag, fstream& file)
 
 flags_t ID3_TagImpl::Update(flags_t ulTagFlag)
 {
+  TracedStage stage(ID3_Tracer::UPDATE);
   flags_t tags = ID3TT_NONE;
+  this->InvalidateCache();
 
   fstream file;
   String filename = this->GetFileName();
@@ -364,6 +372,14 @@ flags_t ID3_TagImpl::Update(flags_t ulTagFlag)
     this->SetSpec(spec2use);
     this->checkFrames();
     _prepended_bytes = RenderV2ToFile(*this, file);
+    // rendering doesn't touch the frames, they are marked as written here
+    for (iterator fi = _frames.begin(); fi != _frames.end(); ++fi)
+    {
+      if (*fi)
+      {
+        ID3_FrameImpl::Of(**fi).SetChanged(false);
+      }
+    }
     if (_prepended_bytes < 17) //17 = minimal tag size, errors should not be higher numbered than 16
     {
       //must be an error
@@ -394,6 +410,7 @@ flags_t ID3_TagImpl::Update(flags_t ulTagFlag)
   _file_tags.add(tags);
   _file_size = getFileSize(file);
   file.close();
+  this->InvalidateCache();
   return tags;
 }
 
@@ -401,6 +418,7 @@ flags_t ID3_TagImpl::Strip(flags_t ulTagFlag)
 {
   flags_t ulTags = ID3TT_NONE;
   const size_t data_size = ID3_GetDataSize(*this);
+  this->InvalidateCache();
 
   // First remove the v2 tag, if requested
   if (ulTagFlag & ID3TT_PREPENDED & _file_tags.get())
@@ -502,8 +520,10 @@ flags_t ID3_TagImpl::Strip(flags_t ulTagFlag)
   {
     // log this
     _last_error = ID3E_NoFile;
+    this->InvalidateCache();
     return 0;
   }
+  this->InvalidateCache();
 
   _prepended_bytes = (ulTags & ID3TT_PREPENDED) ? 0 : _prepended_bytes;
   _appended_bytes  = (ulTags & ID3TT_APPENDED)  ? 0 : _appended_bytes;
@@ -59,182 +59,230 @@ ID3_TagImpl::iterator ID3_TagImpl::Find(const ID3_Frame *frame)
   return cur;
 }
 
-ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id) const
+namespace
 {
-  ID3_Frame *frame = NULL;
-
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
+  // What a Find() is looking for: a frame id and, optionally, a field whose
+  // value has to match
+  class FrameQuery
   {
-    _cursor = _frames.begin();
-  }
-
-
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+    ID3_FrameID    _id;
+    ID3_FieldID    _fld;
+    enum { BY_ID, BY_INTEGER, BY_TEXT, BY_UNICODE } _type;
+    uint32         _num;
+    String         _text;
+    WString        _unicode;
+  public:
+    FrameQuery(ID3_FrameID id)
+      : _id(id), _fld(ID3FN_NOFIELD), _type(BY_ID), _num(0) { ; }
+    FrameQuery(ID3_FrameID id, ID3_FieldID fld, uint32 data)
+      : _id(id), _fld(fld), _type(BY_INTEGER), _num(data) { ; }
+    FrameQuery(ID3_FrameID id, ID3_FieldID fld, const String& data)
+      : _id(id), _fld(fld), _type(BY_TEXT), _num(0), _text(data) { ; }
+    FrameQuery(ID3_FrameID id, ID3_FieldID fld, const WString& data)
+      : _id(id), _fld(fld), _type(BY_UNICODE), _num(0), _unicode(data) { ; }
+
+    bool matches(const ID3_Frame* frame) const
+    {
+      if (NULL == frame || frame->GetID() != _id)
+      {
+        return false;
+      }
+      if (BY_ID == _type)
+      {
+        return true;
+      }
+      ID3_Field* fld = frame->GetField(_fld);
+      if (NULL == fld)
+      {
+        return false;
+      }
+      if (BY_INTEGER == _type)
+      {
+        return fld->Get() == _num;
+      }
+      if (BY_TEXT == _type)
+      {
+        const char* raw = fld->GetRawText();
+        return raw != NULL && String(raw, fld->Size()) == _text;
+      }
+      const unicode_t* raw = fld->GetRawUnicodeText();
+      return raw != NULL && toWString(raw, fld->Size()) == _unicode;
+    }
+  };
+
+  // Searches from start to the end of the list and, if unsuccessful, from
+  // the beginning of the list up to start.  Returns end if nothing matches.
+  ID3_TagImpl::const_iterator findFrame(ID3_TagImpl::const_iterator begin,
+                                        ID3_TagImpl::const_iterator end,
+                                        ID3_TagImpl::const_iterator start,
+                                        const FrameQuery& query)
   {
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
+    for (ID3_TagImpl::const_iterator cur = start; cur != end; ++cur)
     {
-      if ((*cur != NULL) && ((*cur)->GetID() == id))
+      if (query.matches(*cur))
       {
-        // We've found a valid frame.  Set the cursor to be the next element
-        frame = *cur;
-        _cursor = ++cur;
-        break;
+        return cur;
       }
     }
+    for (ID3_TagImpl::const_iterator cur = begin; cur != start; ++cur)
+    {
+      if (query.matches(*cur))
+      {
+        return cur;
+      }
+    }
+    return end;
   }
 
-  return frame;
+  ID3_Frame* frameAt(ID3_TagImpl::const_iterator cur, ID3_TagImpl::const_iterator end)
+  {
+    return cur != end ? *cur : NULL;
+  }
+};
+
+ID3_Frame *ID3_TagImpl::FindFirst(ID3_FrameID id) const
+{
+  return frameAt(findFrame(this->begin(), this->end(), this->begin(),
+                           FrameQuery(id)), this->end());
 }
 
-ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, String data) const
+ID3_Frame *ID3_TagImpl::FindFirst(ID3_FrameID id, ID3_FieldID fldID, String data) const
 {
-  ID3_Frame *frame = NULL;
-  ID3D_NOTICE( "Find: looking for comment with data = " << data.c_str() );
+  ID3D_NOTICE( "Find: looking for frame with data = " << data.c_str() );
+  return frameAt(findFrame(this->begin(), this->end(), this->begin(),
+                           FrameQuery(id, fldID, data)), this->end());
+}
 
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
-  {
-    _cursor = _frames.begin();
-    ID3D_NOTICE( "Find: resetting cursor" );
-  }
+ID3_Frame *ID3_TagImpl::FindFirst(ID3_FrameID id, ID3_FieldID fldID, WString data) const
+{
+  return frameAt(findFrame(this->begin(), this->end(), this->begin(),
+                           FrameQuery(id, fldID, data)), this->end());
+}
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+ID3_Frame *ID3_TagImpl::FindFirst(ID3_FrameID id, ID3_FieldID fldID, uint32 data) const
+{
+  return frameAt(findFrame(this->begin(), this->end(), this->begin(),
+                           FrameQuery(id, fldID, data)), this->end());
+}
+
+// A cursor gets its implementation the first time it is used.
+ID3_CursorImpl& ID3_TagImpl::cursorImpl(ID3_Tag::Cursor& cursor)
+{
+  if (cursor._impl == NULL)
   {
-    ID3D_NOTICE( "Find: iCount = " << iCount );
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
-    {
-      ID3D_NOTICE( "Find: frame = 0x" << hex << (uint32) *cur << dec );
-      if ((*cur != NULL) && ((*cur)->GetID() == id) &&
-          (*cur)->Contains(fldID))
-      {
-        ID3_Field* fld = (*cur)->GetField(fldID);
-        if (NULL == fld)
-        {
-          continue;
-          ID3D_NOTICE( "Find: didn't have the right field" );
-        }
-
-        String text(fld->GetRawText(), fld->Size());
-        ID3D_NOTICE( "Find: text = " << text.c_str() );
-
-        if (text == data)
-        {
-          // We've found a valid frame.  Set cursor to be the next element
-          frame = *cur;
-          _cursor = ++cur;
-          break;
-        }
-      }
-    }
+    cursor._impl = new ID3_CursorImpl;
   }
-
-  return frame;
+  return *cursor._impl;
 }
 
-ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, WString data) const
+// A search with a cursor starts after the frame the cursor was left at.  The
+// cursor keeps where that frame is in the list, which is used as long as it
+// was left by this tag, told apart from others by its serial, and no frame
+// was removed from the tag since; otherwise the frame is looked up again, and
+// if it is gone the search starts at the beginning.
+ID3_TagImpl::const_iterator ID3_TagImpl::cursorStart(const ID3_CursorImpl& cursor) const
 {
-  ID3_Frame *frame = NULL;
-
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
+  if (cursor._frame == NULL)
+  {
+    return this->begin();
+  }
+  const_iterator cur = this->end();
+  if (cursor._tag == _serial && cursor._removals == _removals)
+  {
+    cur = cursor._pos;
+  }
+  else
   {
-    _cursor = _frames.begin();
+    cur = this->Find(cursor._frame);
   }
+  return cur == this->end() ? this->begin() : ++cur;
+}
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+// The cursor is only moved when a frame is found, so that a failed search
+// doesn't restart the next one from the beginning of the list.
+ID3_Frame* ID3_TagImpl::moveCursor(ID3_CursorImpl& cursor, const_iterator found) const
+{
+  if (found == this->end())
   {
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
-    {
-      if ((*cur != NULL) && ((*cur)->GetID() == id) &&
-          (*cur)->Contains(fldID))
-      {
-        ID3_Field* fld = (*cur)->GetField(fldID);
-        if (NULL == fld)
-        {
-          continue;
-        }
-        WString text = toWString(fld->GetRawUnicodeText(), fld->Size());
-
-        if (text == data)
-        {
-          // We've found a valid frame.  Set cursor to be the next element
-          frame = *cur;
-          _cursor = ++cur;
-          break;
-        }
-      }
-    }
+    return NULL;
   }
+  cursor._frame = *found;
+  cursor._pos = found;
+  cursor._tag = _serial;
+  cursor._removals = _removals;
+  return *found;
+}
 
-  return frame;
+ID3_Frame *ID3_TagImpl::Find(ID3_CursorImpl& cursor, ID3_FrameID id) const
+{
+  return this->moveCursor(cursor, findFrame(this->begin(), this->end(),
+                                            this->cursorStart(cursor),
+                                            FrameQuery(id)));
 }
 
-ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, uint32 data) const
+ID3_Frame *ID3_TagImpl::Find(ID3_CursorImpl& cursor, ID3_FrameID id,
+                             ID3_FieldID fldID, String data) const
 {
-  ID3_Frame *frame = NULL;
+  return this->moveCursor(cursor, findFrame(this->begin(), this->end(),
+                                            this->cursorStart(cursor),
+                                            FrameQuery(id, fldID, data)));
+}
 
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
-  {
-    _cursor = _frames.begin();
-  }
+ID3_Frame *ID3_TagImpl::Find(ID3_CursorImpl& cursor, ID3_FrameID id,
+                             ID3_FieldID fldID, WString data) const
+{
+  return this->moveCursor(cursor, findFrame(this->begin(), this->end(),
+                                            this->cursorStart(cursor),
+                                            FrameQuery(id, fldID, data)));
+}
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
-  {
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
-    {
-      if ((*cur != NULL) && ((*cur)->GetID() == id) &&
-          ((*cur)->GetField(fldID)->Get() == data))
-      {
-        // We've found a valid frame.  Set the cursor to be the next element
-        frame = *cur;
-        _cursor = ++cur;
-        break;
-      }
-    }
-  }
+ID3_Frame *ID3_TagImpl::Find(ID3_CursorImpl& cursor, ID3_FrameID id,
+                             ID3_FieldID fldID, uint32 data) const
+{
+  return this->moveCursor(cursor, findFrame(this->begin(), this->end(),
+                                            this->cursorStart(cursor),
+                                            FrameQuery(id, fldID, data)));
+}
 
-  return frame;
+ID3_Frame *ID3_TagImpl::Find(ID3_Tag::Cursor& cursor, ID3_FrameID id) const
+{
+  return this->Find(cursorImpl(cursor), id);
+}
+
+ID3_Frame *ID3_TagImpl::Find(ID3_Tag::Cursor& cursor, ID3_FrameID id,
+                             ID3_FieldID fldID, String data) const
+{
+  return this->Find(cursorImpl(cursor), id, fldID, data);
 }
 
+ID3_Frame *ID3_TagImpl::Find(ID3_Tag::Cursor& cursor, ID3_FrameID id,
+                             ID3_FieldID fldID, WString data) const
+{
+  return this->Find(cursorImpl(cursor), id, fldID, data);
+}
+
+ID3_Frame *ID3_TagImpl::Find(ID3_Tag::Cursor& cursor, ID3_FrameID id,
+                             ID3_FieldID fldID, uint32 data) const
+{
+  return this->Find(cursorImpl(cursor), id, fldID, data);
+}
+
+ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id)
+{
+  return this->Find(_cursor, id);
+}
+
+ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, String data)
+{
+  return this->Find(_cursor, id, fldID, data);
+}
+
+ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, WString data)
+{
+  return this->Find(_cursor, id, fldID, data);
+}
+
+ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, uint32 data)
+{
+  return this->Find(_cursor, id, fldID, data);
+}
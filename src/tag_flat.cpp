@@ -0,0 +1,542 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "frame_impl.h"
+#include "field_impl.h"
+#include "frame_def.h"
+#include "id3/tag_view.h"
+#include "flat_io.h"
+
+using namespace dami;
+
+// The flat form of a tag holds its frames and fields the way they are kept in
+// memory rather than rendered as id3v2, so restoring it needs no parsing,
+// unsyncing, decompression or conversion.  All numbers are 32 bit little
+// endian and everything starts on a 4 byte boundary, so the data can be used
+// right where it was read or mapped.  The offsets count from the start of the
+// data.
+//
+//   tag header (32 bytes)
+//      0  "ID3F"
+//      4  format version
+//      8  total size
+//     12  id3v2 spec
+//     16  flags: unsync, extended, experimental, footer, padded
+//     20  number of frames
+//     24  offset of the frame table
+//     28  reserved
+//   frame table, 20 bytes per frame
+//      0  text id, padded with nuls to 8 bytes
+//      8  frame id
+//     12  offset of the frame record
+//     16  number of fields
+//   frame record
+//      0  frame header flags
+//      4  spec
+//      8  encryption id | grouping id << 8
+//     12  reserved
+//     16  one entry of 20 bytes per field
+//      0  field id | type << 8 | (encoding + 1) << 16
+//      4  the value of an integer field, the number of items of a text field
+//      8  offset of the text or binary data
+//     12  size of the text or binary data
+//     16  fixed size of the field, 0 if none
+//   text and binary data, each followed by at least two nuls
+//
+// The nuls after the data mean a text id or text can be handed out as a
+// string right where it lies, which is what ID3_TagView does.  The format
+// changes with FLAT_VERSION whenever the layout or the frame definitions
+// change, and data of any other version is refused.
+
+namespace
+{
+  const uchar  FLAT_MAGIC[4]     = { 'I', 'D', '3', 'F' };
+  const uint32 FLAT_VERSION      = 1;
+  const size_t FLAT_HEADER_SIZE  = 32;
+  const size_t FLAT_FRAME_SIZE   = 20;
+  const size_t FLAT_RECORD_SIZE  = 16;
+  const size_t FLAT_FIELD_SIZE   = 20;
+
+  enum
+  {
+    FLAT_UNSYNC       = 1 << 0,
+    FLAT_EXTENDED     = 1 << 1,
+    FLAT_EXPERIMENTAL = 1 << 2,
+    FLAT_FOOTER       = 1 << 3,
+    FLAT_PADDED       = 1 << 4
+  };
+
+  // appends the bytes and nuls up to the next 4 byte boundary after beg, at
+  // least two
+  void putData(BString& data, size_t beg, const uchar* buf, size_t size)
+  {
+    data.append(buf, size);
+    data.append(2, '\0');
+    data.append((4 - (data.size() - beg) % 4) % 4, '\0');
+  }
+};
+
+/** Appends the flat form of the tag's frames and header settings to data,
+ ** see above.  Nothing about the linked file is included.
+ **/
+void ID3_TagImpl::Serialize(BString& data) const
+{
+  const size_t beg = data.size();
+  uint32 flags =
+    (_hdr.GetUnsync()       ? FLAT_UNSYNC       : 0) |
+    (_hdr.GetExtended()     ? FLAT_EXTENDED     : 0) |
+    (_hdr.GetExperimental() ? FLAT_EXPERIMENTAL : 0) |
+    (_hdr.GetFooter()       ? FLAT_FOOTER       : 0) |
+    (_is_padded             ? FLAT_PADDED       : 0);
+
+  data.append(FLAT_MAGIC, sizeof(FLAT_MAGIC));
+  putNumber(data, FLAT_VERSION);
+  putNumber(data, 0);
+  putNumber(data, (uint32)_hdr.GetSpec());
+  putNumber(data, flags);
+  putNumber(data, _frames.size());
+  putNumber(data, FLAT_HEADER_SIZE);
+  putNumber(data, 0);
+
+  const size_t table = data.size();
+  data.append(_frames.size() * FLAT_FRAME_SIZE, '\0');
+
+  size_t entry = table;
+  for (const_iterator fi = _frames.begin(); fi != _frames.end(); ++fi, entry += FLAT_FRAME_SIZE)
+  {
+    const ID3_FrameImpl& frame = ID3_FrameImpl::Of(**fi);
+    const char* textid = frame.GetTextID();
+    for (size_t i = 0; textid != NULL && i < 7 && textid[i] != '\0'; ++i)
+    {
+      data[entry + i] = textid[i];
+    }
+    setNumber(data, entry + 8, frame.GetID());
+    setNumber(data, entry + 12, data.size() - beg);
+    setNumber(data, entry + 16, frame._fields.size());
+
+    putNumber(data, frame._hdr.GetFlags());
+    putNumber(data, (uint32)frame._hdr.GetSpec());
+    putNumber(data, frame._encryption_id | (frame._grouping_id << 8));
+    putNumber(data, 0);
+
+    size_t field = data.size();
+    data.append(frame._fields.size() * FLAT_FIELD_SIZE, '\0');
+    for (ID3_FrameImpl::const_iterator li = frame.begin(); li != frame.end();
+         ++li, field += FLAT_FIELD_SIZE)
+    {
+      const ID3_FieldImpl& fld = *static_cast<const ID3_FieldImpl*>(*li);
+      setNumber(data, field, fld._id | (fld._type << 8) | ((fld._enc + 1) << 16));
+      setNumber(data, field + 16, fld._fixed_size);
+      switch (fld._type)
+      {
+        case ID3FTY_INTEGER:
+          setNumber(data, field + 4, fld._integer);
+          break;
+        case ID3FTY_BINARY:
+          setNumber(data, field + 8, data.size() - beg);
+          setNumber(data, field + 12, fld._binary.size());
+          putData(data, beg, fld._binary.data(), fld._binary.size());
+          break;
+        case ID3FTY_TEXTSTRING:
+          setNumber(data, field + 4, fld._num_items);
+          setNumber(data, field + 8, data.size() - beg);
+          setNumber(data, field + 12, fld._text.size());
+          putData(data, beg, reinterpret_cast<const uchar*>(fld._text.data()),
+                  fld._text.size());
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  setNumber(data, beg + 8, data.size() - beg);
+}
+
+/** Adds the frames in the flat form at data to the tag and takes over the
+ ** header settings stored with them.  Returns false, leaving the tag as it
+ ** was, if the data is damaged, too short or of another format version.
+ **/
+bool ID3_TagImpl::Deserialize(const uchar* data, size_t size)
+{
+  if (data == NULL || size < FLAT_HEADER_SIZE ||
+      memcmp(data, FLAT_MAGIC, sizeof(FLAT_MAGIC)) != 0 ||
+      getNumber(data + 4) != FLAT_VERSION || getNumber(data + 8) > size)
+  {
+    return false;
+  }
+  size = getNumber(data + 8);
+  const uint32 flags     = getNumber(data + 16);
+  const size_t numFrames = getNumber(data + 20);
+  const size_t table     = getNumber(data + 24);
+  if (numFrames > size / FLAT_FRAME_SIZE ||
+      !inside(table, numFrames * FLAT_FRAME_SIZE, size))
+  {
+    return false;
+  }
+
+  Frames frames;
+  bool ok = true;
+  for (size_t i = 0; ok && i < numFrames; ++i)
+  {
+    const uchar* entry = data + table + i * FLAT_FRAME_SIZE;
+    const ID3_FrameID id   = (ID3_FrameID)getNumber(entry + 8);
+    const size_t record    = getNumber(entry + 12);
+    const size_t numFields = getNumber(entry + 16);
+    if (entry[7] != '\0' || numFields > size / FLAT_FIELD_SIZE ||
+        !inside(record, FLAT_RECORD_SIZE + numFields * FLAT_FIELD_SIZE, size) ||
+        (id != ID3FID_NOFRAME && ID3_FindFrameDef(id) == NULL))
+    {
+      ok = false;
+      break;
+    }
+
+    ID3_Frame* frame = LEAKTESTNEW(ID3_Frame);
+    frames.push_back(frame);
+    ID3_FrameImpl& impl = ID3_FrameImpl::Of(*frame);
+    if (id == ID3FID_NOFRAME)
+    {
+      impl._ClearFields();
+      impl._hdr.SetUnknownFrame(reinterpret_cast<const char*>(entry));
+      impl._InitFields();
+    }
+    else
+    {
+      impl.SetID(id);
+    }
+    impl._hdr.SetSpec((ID3_V2Spec)getNumber(data + record + 4));
+    impl._hdr.ResetFlags(getNumber(data + record));
+    const uint32 ids = getNumber(data + record + 8);
+    impl._encryption_id = (uchar)(ids & 0xFF);
+    impl._grouping_id   = (uchar)((ids >> 8) & 0xFF);
+    if (impl._fields.size() != numFields)
+    {
+      ok = false;
+      break;
+    }
+
+    const uchar* field = data + record + FLAT_RECORD_SIZE;
+    for (ID3_FrameImpl::iterator li = impl.begin(); li != impl.end();
+         ++li, field += FLAT_FIELD_SIZE)
+    {
+      ID3_FieldImpl& fld = *static_cast<ID3_FieldImpl*>(*li);
+      const uint32 desc   = getNumber(field);
+      const uint32 value  = getNumber(field + 4);
+      const size_t offset = getNumber(field + 8);
+      const size_t bytes  = getNumber(field + 12);
+      if ((desc & 0xFF) != (uint32)fld._id || ((desc >> 8) & 0xFF) != (uint32)fld._type ||
+          ((desc >> 16) & 0xFF) > ID3TE_NUMENCODINGS || !inside(offset, bytes, size))
+      {
+        ok = false;
+        break;
+      }
+      fld._enc        = (ID3_TextEnc)((int)((desc >> 16) & 0xFF) - 1);
+      fld._fixed_size = getNumber(field + 16);
+      switch (fld._type)
+      {
+        case ID3FTY_INTEGER:
+          fld._integer = value;
+          break;
+        case ID3FTY_BINARY:
+          fld._binary.assign(data + offset, bytes);
+          break;
+        case ID3FTY_TEXTSTRING:
+          fld._text.assign(reinterpret_cast<const char*>(data + offset), bytes);
+          fld._num_items = value;
+          break;
+        default:
+          break;
+      }
+      fld._changed = true;
+    }
+    impl._changed = false;
+  }
+
+  if (!ok)
+  {
+    for (iterator fi = frames.begin(); fi != frames.end(); ++fi)
+    {
+      delete *fi;
+    }
+    return false;
+  }
+
+  _frames.splice(_frames.end(), frames);
+  _cursor.Reset();
+  _hdr.SetSpec((ID3_V2Spec)getNumber(data + 12));
+  _hdr.SetUnsync((flags & FLAT_UNSYNC) != 0);
+  _hdr.SetExtended((flags & FLAT_EXTENDED) != 0);
+  _hdr.SetExperimental((flags & FLAT_EXPERIMENTAL) != 0);
+  _hdr.SetFooter((flags & FLAT_FOOTER) != 0);
+  _is_padded = (flags & FLAT_PADDED) != 0;
+  _changed = true;
+  return true;
+}
+
+/** \class ID3_TagView tag_view.h id3/tag_view.h
+ ** \brief Reads the flat form of a tag in place.
+ **
+ ** An ID3_TagView looks at data written by ID3_Tag::Serialize() without
+ ** copying any of it or creating frames and fields, so a tag kept in a
+ ** memory mapped file or a database can be queried as it lies.  The data is
+ ** checked once when it is set; after that every lookup is a few reads.
+ **
+ ** \code
+ **   ID3_TagView view(data, size);
+ **   size_t frame = view.Find(ID3FID_TITLE);
+ **   if (frame < view.NumFrames())
+ **   {
+ **     const char* title = view.GetText(frame, ID3FN_TEXT);
+ **   }
+ ** \endcode
+ **
+ ** The view doesn't own the data, which must stay put for as long as the
+ ** view is used.  Frames are numbered in the order of the tag they were
+ ** taken from.
+ **/
+
+ID3_TagView::ID3_TagView()
+  : _data(NULL),
+    _size(0)
+{
+}
+
+ID3_TagView::ID3_TagView(const uchar* data, size_t size)
+  : _data(NULL),
+    _size(0)
+{
+  this->Set(data, size);
+}
+
+/** Looks at the flat tag at data from now on.  Returns false, and leaves the
+ ** view empty, if the data is damaged, too short or of another format
+ ** version.
+ **/
+bool ID3_TagView::Set(const uchar* data, size_t size)
+{
+  this->Clear();
+  if (data == NULL || size < FLAT_HEADER_SIZE ||
+      memcmp(data, FLAT_MAGIC, sizeof(FLAT_MAGIC)) != 0 ||
+      getNumber(data + 4) != FLAT_VERSION || getNumber(data + 8) > size ||
+      getNumber(data + 8) < FLAT_HEADER_SIZE)
+  {
+    return false;
+  }
+  size = getNumber(data + 8);
+  const size_t numFrames = getNumber(data + 20);
+  const size_t table     = getNumber(data + 24);
+  if (numFrames > size / FLAT_FRAME_SIZE ||
+      !inside(table, numFrames * FLAT_FRAME_SIZE, size))
+  {
+    return false;
+  }
+  for (size_t i = 0; i < numFrames; ++i)
+  {
+    const uchar* entry = data + table + i * FLAT_FRAME_SIZE;
+    const size_t record    = getNumber(entry + 12);
+    const size_t numFields = getNumber(entry + 16);
+    if (entry[7] != '\0' || numFields > size / FLAT_FIELD_SIZE ||
+        !inside(record, FLAT_RECORD_SIZE + numFields * FLAT_FIELD_SIZE, size))
+    {
+      return false;
+    }
+    const uchar* field = data + record + FLAT_RECORD_SIZE;
+    for (size_t j = 0; j < numFields; ++j, field += FLAT_FIELD_SIZE)
+    {
+      const uint32 desc   = getNumber(field);
+      const size_t offset = getNumber(field + 8);
+      const size_t bytes  = getNumber(field + 12);
+      const uint32 type   = (desc >> 8) & 0xFF;
+      if (((desc >> 16) & 0xFF) > ID3TE_NUMENCODINGS)
+      {
+        return false;
+      }
+      if ((type == ID3FTY_BINARY || type == ID3FTY_TEXTSTRING) &&
+          (bytes > size || !inside(offset, bytes + 2, size) ||
+           data[offset + bytes] != '\0' || data[offset + bytes + 1] != '\0'))
+      {
+        return false;
+      }
+    }
+  }
+  _data = data;
+  _size = size;
+  return true;
+}
+
+void ID3_TagView::Clear()
+{
+  _data = NULL;
+  _size = 0;
+}
+
+/** The size of the flat tag, which may be less than the size it was set
+ ** with.
+ **/
+size_t ID3_TagView::Size() const
+{
+  return _size;
+}
+
+ID3_V2Spec ID3_TagView::GetSpec() const
+{
+  return _data ? (ID3_V2Spec)getNumber(_data + 12) : ID3V2_UNKNOWN;
+}
+
+size_t ID3_TagView::NumFrames() const
+{
+  return _data ? getNumber(_data + 20) : 0;
+}
+
+/** Returns the number of the first frame with the given id at or after
+ ** from, or NumFrames() if there is none.
+ **/
+size_t ID3_TagView::Find(ID3_FrameID id, size_t from) const
+{
+  const size_t numFrames = this->NumFrames();
+  for (; from < numFrames; ++from)
+  {
+    if ((ID3_FrameID)getNumber(this->entry(from) + 8) == id)
+    {
+      break;
+    }
+  }
+  return from < numFrames ? from : numFrames;
+}
+
+ID3_FrameID ID3_TagView::GetFrameID(size_t frame) const
+{
+  const uchar* entry = this->entry(frame);
+  return entry ? (ID3_FrameID)getNumber(entry + 8) : ID3FID_NOFRAME;
+}
+
+/** The four (or, for id3v2.2, three) character id of the frame, or NULL
+ ** if there is no such frame.
+ **/
+const char* ID3_TagView::GetTextID(size_t frame) const
+{
+  const uchar* entry = this->entry(frame);
+  return entry ? reinterpret_cast<const char*>(entry) : NULL;
+}
+
+bool ID3_TagView::Contains(size_t frame, ID3_FieldID fld) const
+{
+  return this->field(frame, fld) != NULL;
+}
+
+/** The value of an integer field, 0 if the frame has no such field.
+ **/
+uint32 ID3_TagView::GetInteger(size_t frame, ID3_FieldID fld) const
+{
+  const uchar* field = this->field(frame, fld);
+  if (field == NULL || ((getNumber(field) >> 8) & 0xFF) != ID3FTY_INTEGER)
+  {
+    return 0;
+  }
+  return getNumber(field + 4);
+}
+
+/** The text of a text field, or NULL if the frame has no such field.
+ **
+ ** The text is given as id3lib keeps it (see ID3_Field::GetRawText() and
+ ** ID3_Field::GetRawUnicodeText()): the items of a list are separated by
+ ** nuls, and unicode text is in the byte order of the machine that wrote it.
+ ** The text is followed by at least two nuls, so it can be used as a string
+ ** of either width.  Its size in bytes, encoding and number of items are
+ ** stored where the pointers given point.
+ **/
+const char* ID3_TagView::GetText(size_t frame, ID3_FieldID fld, size_t* size,
+                                 ID3_TextEnc* enc, size_t* items) const
+{
+  const uchar* field = this->field(frame, fld);
+  if (field == NULL || ((getNumber(field) >> 8) & 0xFF) != ID3FTY_TEXTSTRING)
+  {
+    return NULL;
+  }
+  if (size)
+  {
+    *size = getNumber(field + 12);
+  }
+  if (enc)
+  {
+    *enc = (ID3_TextEnc)((int)((getNumber(field) >> 16) & 0xFF) - 1);
+  }
+  if (items)
+  {
+    *items = getNumber(field + 4);
+  }
+  return reinterpret_cast<const char*>(_data + getNumber(field + 8));
+}
+
+/** The data of a binary field, or NULL if the frame has no such field.  Its
+ ** size is stored where size points.
+ **/
+const uchar* ID3_TagView::GetBinary(size_t frame, ID3_FieldID fld, size_t* size) const
+{
+  const uchar* field = this->field(frame, fld);
+  if (field == NULL || ((getNumber(field) >> 8) & 0xFF) != ID3FTY_BINARY)
+  {
+    return NULL;
+  }
+  if (size)
+  {
+    *size = getNumber(field + 12);
+  }
+  return _data + getNumber(field + 8);
+}
+
+const uchar* ID3_TagView::entry(size_t frame) const
+{
+  if (frame >= this->NumFrames())
+  {
+    return NULL;
+  }
+  return _data + getNumber(_data + 24) + frame * FLAT_FRAME_SIZE;
+}
+
+const uchar* ID3_TagView::field(size_t frame, ID3_FieldID fld) const
+{
+  const uchar* entry = this->entry(frame);
+  if (entry == NULL)
+  {
+    return NULL;
+  }
+  const size_t numFields = getNumber(entry + 16);
+  const uchar* field = _data + getNumber(entry + 12) + FLAT_RECORD_SIZE;
+  for (size_t i = 0; i < numFields; ++i, field += FLAT_FIELD_SIZE)
+  {
+    if ((ID3_FieldID)(getNumber(field) & 0xFF) == fld)
+    {
+      return field;
+    }
+  }
+  return NULL;
+}
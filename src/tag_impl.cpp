@@ -30,9 +30,12 @@
 #endif
 
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
+#include "frame_impl.h"
 //#include "io_helpers.h"
 #include "io_strings.h"
 #include "frame_def.h"
+#include "trace_hooks.h"
+#include "shared_binary.h"
 
 ID3_FrameDef *ID3_FindFrameDef(ID3_FrameID id);
 
@@ -94,6 +97,19 @@ bool ValidFrameOwner(String owner)
     return false;
 }
 
+namespace
+{
+  // removes and deletes a frame another one with the same owner replaces
+  void dropDuplicate(ID3_TagImpl& tag, ID3_Frame* frame)
+  {
+    delete tag.RemoveFrame(frame);
+    trace(ID3_Tracer::DROPPEDFRAMES);
+  }
+
+  // the last serial given to a tag
+  long serials = 0;
+};
+
 size_t ID3_TagImpl::IsV2Tag(ID3_Reader& reader)
 {
   io::ExitTrigger et(reader);
@@ -149,13 +165,18 @@ size_t ID3_TagImpl::IsV2Tag(ID3_Reader& reader)
 
 ID3_TagImpl::ID3_TagImpl(const char *name, flags_t flags)
   : _frames(),
-    _cursor(_frames.begin()),
+    _cursor(),
+    _serial(retain(serials)),
+    _removals(0),
     _file_name(),
+    _cache_dir(),
     _file_size(0),
     _prepended_bytes(0),
     _appended_bytes(0),
     _is_file_writable(false),
-    _mp3_info(NULL) // need to do this before this->Clear()
+    _mp3_info(NULL), // need to do this before this->Clear()
+    _parse_stats_wanted(false),
+    _parse_stats(NULL)
 {
 // added for detecting memory leaks in VC
 #if (defined(_DEBUG) && defined(_MSC_VER) && _MSC_VER > 1000 && ID3LIB_LINKOPTION == LINKOPTION_CREATE_DYNAMIC)
@@ -171,13 +192,18 @@ ID3_TagImpl::ID3_TagImpl(const char *name, flags_t flags)
 
 ID3_TagImpl::ID3_TagImpl(const ID3_Tag &tag)
   : _frames(),
-    _cursor(_frames.begin()),
+    _cursor(),
+    _serial(retain(serials)),
+    _removals(0),
     _file_name(),
+    _cache_dir(),
     _file_size(0),
     _prepended_bytes(0),
     _appended_bytes(0),
     _is_file_writable(false),
-    _mp3_info(NULL) // need to do this before this->Clear()
+    _mp3_info(NULL), // need to do this before this->Clear()
+    _parse_stats_wanted(false),
+    _parse_stats(NULL)
 {
 // added for detecting memory leaks in VC
 #if (defined(_DEBUG) && defined(_MSC_VER) && _MSC_VER > 1000 && ID3LIB_LINKOPTION == LINKOPTION_CREATE_DYNAMIC)
@@ -204,8 +230,9 @@ void ID3_TagImpl::Clear()
   }
   UserUpdatedSpec = false;
 
+  _removals += _frames.size();
   _frames.clear();
-  _cursor = _frames.begin();
+  _cursor.Reset();
   _is_padded = true;
 
   _hdr.Clear();
@@ -214,9 +241,16 @@ void ID3_TagImpl::Clear()
   _tags_to_parse.clear();
   if (_mp3_info)
     delete _mp3_info; // Also deletes _mp3_header
+  delete _parse_stats;
 
   _file_name = "";
+  _cache_dir = "";
+  _file_size = 0;
+  _prepended_bytes = 0;
+  _appended_bytes = 0;
+  _file_tags.clear();
   _mp3_info = NULL;
+  _parse_stats = NULL;
   _last_error = ID3E_NoError;
   _changed = true;
 }
@@ -260,8 +294,9 @@ bool ID3_TagImpl::IsValidFrame(ID3_Frame& frame, bool testlinkedFrames)
       tmpFrame = myFrameDef->convert(testframe, this->GetSpec());
       if (tmpFrame)
       {
-        testframe = tmpFrame;
         frame = *tmpFrame;
+        delete tmpFrame;
+        trace(ID3_Tracer::CONVERTEDFRAMES);
       }
       else //it's too old, and i couldn't convert
         return false; //disregard frame
@@ -269,7 +304,7 @@ bool ID3_TagImpl::IsValidFrame(ID3_Frame& frame, bool testlinkedFrames)
     else //it's too old and doesn't have a conversion routine
       return false; //disregard frame
   }
-  else if (myFrameDef->convert != NULL) //fields have stayed the same, but inside the field was a structure change
+  else if (myFrameDef != NULL && myFrameDef->convert != NULL) //fields have stayed the same, but inside the field was a structure change
   {
     //TODO: add here code when conversion routine of tcon is ready v2.3 <> v2.4
   }
@@ -284,7 +319,7 @@ bool ID3_TagImpl::IsValidFrame(ID3_Frame& frame, bool testlinkedFrames)
       {
         tmpFrame = this->Find(ID3FID_UNIQUEFILEID, ID3FN_OWNER, tmpField->GetRawText());
         if (tmpFrame && tmpFrame != testframe)
-          this->RemoveFrame(tmpFrame); //remove old one, there can be only one
+          dropDuplicate(*this, tmpFrame); //remove old one, there can be only one
         return true;
       }
       else
@@ -299,11 +334,11 @@ bool ID3_TagImpl::IsValidFrame(ID3_Frame& frame, bool testlinkedFrames)
       {
         tmpFrame = this->Find(ID3FID_CRYPTOREG, ID3FN_OWNER, tmpField->GetRawText());
         if (tmpFrame && tmpFrame != testframe)
-          this->RemoveFrame(tmpFrame); //remove old one, there can be only one
+          dropDuplicate(*this, tmpFrame); //remove old one, there can be only one
         tmpField = testframe->GetField(ID3FN_ID);
         tmpFrame = this->Find(ID3FID_CRYPTOREG, ID3FN_ID, tmpField->Get());
         if (tmpFrame && tmpFrame != testframe)
-          this->RemoveFrame(tmpFrame); //remove old one, there can be only one
+          dropDuplicate(*this, tmpFrame); //remove old one, there can be only one
         return true;
       }
       else
@@ -318,11 +353,11 @@ bool ID3_TagImpl::IsValidFrame(ID3_Frame& frame, bool testlinkedFrames)
       {
         tmpFrame = this->Find(ID3FID_GROUPINGREG, ID3FN_OWNER, tmpField->GetRawText());
         if (tmpFrame && tmpFrame != testframe)
-          this->RemoveFrame(tmpFrame); //remove old one, there can be only one
+          dropDuplicate(*this, tmpFrame); //remove old one, there can be only one
         tmpField = testframe->GetField(ID3FN_ID);
         tmpFrame = this->Find(ID3FID_CRYPTOREG, ID3FN_ID, tmpField->Get());
         if (tmpFrame && tmpFrame != testframe)
-          this->RemoveFrame(tmpFrame); //remove old one, there can be only one
+          dropDuplicate(*this, tmpFrame); //remove old one, there can be only one
         return true;
       }
       else
@@ -463,29 +498,52 @@ bool ID3_TagImpl::IsValidFrame(ID3_Frame& frame, bool testlinkedFrames)
   }
 }
 
+// Drops the frames that aren't valid for the tag's spec and converts the
+// outdated ones that can be, in a single pass over the frames.  Validating a
+// frame may remove a duplicate elsewhere in the list, which leaves the
+// iterator to the frame itself valid.
 void ID3_TagImpl::checkFrames()
 {
-  bool restart = false;
+  size_t dropped = 0;
 
-  for (iterator iter = this->begin(); iter != this->end(); ++iter)
+  iterator iter = _frames.begin();
+  while (iter != _frames.end())
   {
     ID3_Frame* frame = *iter;
     ID3_Frame& testframe = *frame;
 
     if (this->IsValidFrame(testframe, true) == false)
     {
-      _frames.erase(iter);
+      // the cursor may point at the frame, don't leave it dangling
+      _cursor.Reset();
+      iter = _frames.erase(iter);
+      ++_removals;
       delete frame;
-      restart = true;
-      break;
+      ++dropped;
     }
+    else
+    {
+      // convert the fields once here rather than on each Size() and Render()
+      ID3_FrameImpl::Of(*frame).ConvertFields();
+      ++iter;
+    }
+  }
+  if (dropped > 0)
+  {
+    _changed = true;
+    trace(ID3_Tracer::DROPPEDFRAMES, dropped);
+    ID3D_NOTICE( "ID3_TagImpl::checkFrames(): dropped " << dropped <<
+                 " frames invalid in the tag's spec" );
   }
-  if (restart)
-    this->checkFrames();
 }
 
 bool ID3_TagImpl::AttachFrame(ID3_Frame* frame)
 {
+  // the MusicMatch parser attaches a NULL frame for every empty field
+  if (frame == NULL)
+  {
+    return false;
+  }
   ID3_Frame& testframe = *frame;
 
   bool isvalid = IsValidFrame(testframe, false);
@@ -493,7 +551,7 @@ bool ID3_TagImpl::AttachFrame(ID3_Frame* frame)
   {
     frame = &testframe;
     _frames.push_back(frame);
-    _cursor = _frames.begin();
+    _cursor.Reset();
     _changed = true;
     return true;
   }
@@ -506,6 +564,58 @@ bool ID3_TagImpl::AttachFrame(ID3_Frame* frame)
   return false;
 }
 
+// Like AttachFrame() for each of the frames, but resets the cursor and marks
+// the tag as changed only once.  Trusted frames aren't validated at all and
+// are spliced onto the end of the list in one go; the ones outdated in the
+// tag's spec are still dropped or converted by checkFrames() on Update().
+size_t ID3_TagImpl::AttachFrames(ID3_Frame* const* frames, size_t numFrames,
+                                 bool trusted)
+{
+  size_t attached = 0;
+  if (trusted)
+  {
+    Frames batch;
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+      if (frames[i] != NULL)
+      {
+        batch.push_back(frames[i]);
+      }
+    }
+    attached = batch.size();
+    _frames.splice(_frames.end(), batch);
+  }
+  else
+  {
+    // each frame is validated against the ones attached before it, so that
+    // a duplicate in the batch replaces the earlier frame as it would one
+    // already in the tag
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+      ID3_Frame* frame = frames[i];
+      if (frame == NULL)
+      {
+        continue;
+      }
+      if (this->IsValidFrame(*frame, false))
+      {
+        _frames.push_back(frame);
+        ++attached;
+      }
+      else
+      {
+        delete frame;
+      }
+    }
+  }
+  if (attached > 0)
+  {
+    _cursor.Reset();
+    _changed = true;
+  }
+  return attached;
+}
+
 
 ID3_Frame* ID3_TagImpl::RemoveFrame(const ID3_Frame *frame)
 {
@@ -516,7 +626,8 @@ ID3_Frame* ID3_TagImpl::RemoveFrame(const ID3_Frame *frame)
   {
     frm = *fi;
     _frames.erase(fi);
-    _cursor = _frames.begin();
+    ++_removals;
+    _cursor.Reset();
     _changed = true;
   }
 
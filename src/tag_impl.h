@@ -47,6 +47,7 @@
 
 class ID3_Reader;
 class ID3_Writer;
+class ID3_ParseCache;
 
 namespace dami
 {
@@ -61,6 +62,16 @@ namespace dami
     {
       bool parse(ID3_TagImpl& tag, ID3_Reader& rdr);
       ID3_Err render(ID3_Writer& writer, const ID3_TagImpl& tag);
+
+      // takes the frames parseFrame() hands out
+      class FrameSink
+      {
+      public:
+        virtual void Frame(ID3_Frame*) = 0;
+        virtual ~FrameSink() { }
+      };
+      size_t parseFrame(ID3_Reader&, ID3_V2Spec, FrameSink&);
+      void parseFrames(ID3_Reader&, ID3_V2Spec, FrameSink&);
     };
   };
   namespace lyr3
@@ -80,6 +91,21 @@ namespace dami
   };
 };
 
+// Where an ID3_Tag::Cursor was left: the frame found last and where it is in
+// the frames of the tag it was found in.  The position is only used while
+// that same tag hasn't removed a frame since.
+class ID3_CursorImpl
+{
+public:
+  ID3_CursorImpl() : _frame(NULL), _pos(), _tag(0), _removals(0) { }
+  void Reset() { _frame = NULL; _tag = 0; }
+
+  const ID3_Frame* _frame;
+  std::list<ID3_Frame *>::const_iterator _pos;
+  long             _tag;       // the serial of the tag, never 0
+  size_t           _removals;
+};
+
 class ID3_TagImpl
 {
   typedef std::list<ID3_Frame *> Frames;
@@ -91,6 +117,9 @@ public:
   ID3_TagImpl(const ID3_Tag &tag);
   virtual ~ID3_TagImpl();
 
+  // the library's access to the implementation behind a tag
+  static ID3_TagImpl& Of(ID3_Tag& tag) { return tag.impl(); }
+
   void       Clear();
   bool       HasChanged() const;
   void       SetChanged(bool b) { _changed = b; }
@@ -111,28 +140,46 @@ public:
   void       AddFrame(const ID3_Frame&);
   void       AddFrame(const ID3_Frame*);
   bool       AttachFrame(ID3_Frame*);
+  size_t     AttachFrames(ID3_Frame* const*, size_t, bool trusted);
   bool       IsValidFrame(ID3_Frame&, bool);
   void       checkFrames();
   ID3_Frame* RemoveFrame(const ID3_Frame *);
 
   size_t     Link(const char *fileInfo, flags_t = (flags_t) ID3TT_ALL);
   size_t     Link(ID3_Reader &reader, flags_t = (flags_t) ID3TT_ALL);
+  size_t     Link(const char *fileInfo, ID3_ParseCache&, flags_t = (flags_t) ID3TT_ALL);
   flags_t    Update(flags_t = (flags_t) ID3TT_ALL);
   flags_t    Strip(flags_t = (flags_t) ID3TT_ALL);
 
   size_t     GetPrependedBytes() const { return _prepended_bytes; }
   size_t     GetAppendedBytes() const { return _appended_bytes; }
   size_t     GetFileSize() const { return _file_size; }
-  dami::String GetFileName() const { return _file_name; }
+  const dami::String& GetFileName() const { return _file_name; }
+
+  // the first matching frame, doesn't touch any cursor
+  ID3_Frame* FindFirst(ID3_FrameID id) const;
+  ID3_Frame* FindFirst(ID3_FrameID id, ID3_FieldID fld, uint32 data) const;
+  ID3_Frame* FindFirst(ID3_FrameID id, ID3_FieldID fld, dami::String) const;
+  ID3_Frame* FindFirst(ID3_FrameID id, ID3_FieldID fld, dami::WString) const;
+
+  // the next matching frame after the cursor, wrapping if necessary
+  ID3_Frame* Find(ID3_Tag::Cursor&, ID3_FrameID id) const;
+  ID3_Frame* Find(ID3_Tag::Cursor&, ID3_FrameID id, ID3_FieldID fld, uint32 data) const;
+  ID3_Frame* Find(ID3_Tag::Cursor&, ID3_FrameID id, ID3_FieldID fld, dami::String) const;
+  ID3_Frame* Find(ID3_Tag::Cursor&, ID3_FrameID id, ID3_FieldID fld, dami::WString) const;
 
-  ID3_Frame* Find(ID3_FrameID id) const;
-  ID3_Frame* Find(ID3_FrameID id, ID3_FieldID fld, uint32 data) const;
-  ID3_Frame* Find(ID3_FrameID id, ID3_FieldID fld, dami::String) const;
-  ID3_Frame* Find(ID3_FrameID id, ID3_FieldID fld, dami::WString) const;
+  // as above, using the tag's own cursor
+  ID3_Frame* Find(ID3_FrameID id);
+  ID3_Frame* Find(ID3_FrameID id, ID3_FieldID fld, uint32 data);
+  ID3_Frame* Find(ID3_FrameID id, ID3_FieldID fld, dami::String);
+  ID3_Frame* Find(ID3_FrameID id, ID3_FieldID fld, dami::WString);
 
   size_t     NumFrames() const { return _frames.size(); }
   ID3_TagImpl&   operator=( const ID3_Tag & );
 
+  void       Serialize(dami::BString&) const;
+  bool       Deserialize(const uchar*, size_t);
+
   bool       HasTagType(ID3_TagType tt) const { return _file_tags.test(tt); }
   ID3_V2Spec GetSpec() const;
   bool       SetSpec(ID3_V2Spec);
@@ -142,6 +189,16 @@ public:
   void       SetLastError(ID3_Err err) { _last_error = err; }
 
   const Mp3_Headerinfo* GetMp3HeaderInfo() const { if (_mp3_info) return _mp3_info->GetMp3HeaderInfo(); else return NULL; }
+  const Mp3_Scaninfo* GetMp3ScanInfo() const { if (_mp3_info) return _mp3_info->GetMp3ScanInfo(); else return NULL; }
+  void       SetParseStats(bool b) { _parse_stats_wanted = b; }
+  const ID3_ParseStats* GetParseStats() const { return _parse_stats; }
+  const Mp3_Scaninfo* ScanMp3Frames(size_t seekpoints);
+  const Mp3_Scaninfo* ScanMp3Frames(ID3_Reader&, size_t seekpoints);
+
+  // parsing a stream as it arrives, see ID3_StreamParser
+  size_t     ParseStreamHead(ID3_Reader&, flags_t);
+  void       ParseStreamMp3Header(ID3_Reader&, size_t bytes_till_sync);
+  void       ParseStreamTail(ID3_Reader&, size_t bytes_till_sync, size_t tailSize);
 
   iterator         begin()       { return _frames.begin(); }
   iterator         end()         { return _frames.end(); }
@@ -162,9 +219,21 @@ public:
 protected:
   const_iterator Find(const ID3_Frame *) const;
   iterator Find(const ID3_Frame *);
+  static ID3_CursorImpl& cursorImpl(ID3_Tag::Cursor&);
+  const_iterator cursorStart(const ID3_CursorImpl&) const;
+  ID3_Frame* moveCursor(ID3_CursorImpl&, const_iterator) const;
+  ID3_Frame* Find(ID3_CursorImpl&, ID3_FrameID id) const;
+  ID3_Frame* Find(ID3_CursorImpl&, ID3_FrameID id, ID3_FieldID fld, uint32 data) const;
+  ID3_Frame* Find(ID3_CursorImpl&, ID3_FrameID id, ID3_FieldID fld, dami::String) const;
+  ID3_Frame* Find(ID3_CursorImpl&, ID3_FrameID id, ID3_FieldID fld, dami::WString) const;
 
   void       ParseFile();
   void       ParseReader(ID3_Reader &reader);
+  size_t     parseLeadingTags(dami::io::WindowedReader&);
+  void       parseAppendedTags(ID3_Reader&, ID3_Reader::pos_type beg,
+                               ID3_Reader::pos_type end, size_t tailSize);
+  void       parseMp3Header(dami::io::WindowedReader&, size_t bytes_till_sync);
+  void       InvalidateCache();
 
 private:
   ID3_TagHeader _hdr;          // information relevant to the tag header
@@ -172,11 +241,14 @@ private:
 
   Frames     _frames;
 
-  mutable const_iterator   _cursor;  // which frame in list are we at
-  mutable bool       _changed; // has tag changed since last parse or render?
+  ID3_CursorImpl _cursor;     // where the Find()s without a cursor continue
+  long       _serial;          // tells the tag apart from all others
+  size_t     _removals;        // nr of frames ever removed, for the cursors
+  bool       _changed;         // has tag changed since last parse or update?
 
   // file-related member variables
   dami::String _file_name;       // name of the file we are linked to
+  dami::String _cache_dir;       // parse cache the file was linked through
   size_t     _file_size;       // the size of the file
   size_t     _prepended_bytes; // number of tag bytes at start of file
   size_t     _appended_bytes;  // number of tag bytes at end of file
@@ -184,6 +256,8 @@ private:
   ID3_Flags  _tags_to_parse;   // which tag types should attempt to be parsed
   ID3_Flags  _file_tags;       // which tag types does the file contain
   Mp3Info*   _mp3_info;   // class used to retrieve _mp3_header
+  bool       _parse_stats_wanted; // fill in _parse_stats when parsing?
+  ID3_ParseStats* _parse_stats;   // statistics of the last parse
   ID3_Err    _last_error; //storage place for last error
 };
 
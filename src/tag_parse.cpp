@@ -36,102 +36,276 @@
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
 //#include "id3/io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
 #include "io_strings.h"
+#include "trace_hooks.h"
 
 using namespace dami;
 
+/** Parses the frame at the current position of rdr, as a frame of a tag of
+ ** the given spec, and hands it to sink, or the frames packed into it if it
+ ** is an id3v2.2.1 compressed frame.  Returns the number of bytes the frame
+ ** took up, which is 0 if the frames that follow it can't be parsed.
+ **/
+size_t id3::v2::parseFrame(ID3_Reader& rdr, ID3_V2Spec spec, FrameSink& sink)
+{
+  const ID3_Reader::pos_type beg = rdr.getCur();
+  ID3_Frame* f = LEAKTESTNEW(ID3_Frame);
+  f->SetSpec(spec);
+  bool goodParse = f->Parse(rdr);
+  size_t frameSize = rdr.getCur() - beg;
+
+  if (frameSize == 0)
+  {
+    // There is a problem.
+    // If the frame size is 0, then we can't progress.
+    ID3D_WARNING( "id3::v2::parseFrame(): frame size is 0, can't " <<
+                  "continue parsing frames");
+    delete f;
+    trace(ID3_Tracer::BADFRAMES);
+  }
+  else if (!goodParse)
+  {
+    // bad parse!  we can't attach this frame.
+    ID3D_WARNING( "id3::v2::parseFrame(): bad parse, deleting frame");
+    delete f;
+    trace(ID3_Tracer::BADFRAMES);
+  }
+  else if (f->GetID() != ID3FID_METACOMPRESSION)
+  {
+    // a good, uncompressed frame.  hand it out!
+    traceFrame(f->GetID(), frameSize);
+    sink.Frame(f);
+  }
+  else
+  {
+    ID3D_NOTICE( "id3::v2::parseFrame(): parsing ID3v2.2.1 " <<
+                 "compressed frame");
+    traceFrame(f->GetID(), frameSize);
+    // hmm.  an ID3v2.2.1 compressed frame.  It contains 1 or more
+    // compressed frames.  Uncompress and parse them.
+    ID3_Field* fld = f->GetField(ID3FN_DATA);
+    if (fld == NULL || fld->BinSize() < 1 + sizeof(uint32) ||
+        fld->GetRawBinary()[0] != 'z')
+    {
+      // unknown compression method
+      ID3D_WARNING( "id3::v2::parseFrame(): unknown compression" );
+    }
+    else
+    {
+      ID3_MemoryReader mr(fld->GetRawBinary(), fld->BinSize());
+      mr.readChar();
+      uint32 newSize = io::readBENumber(mr, sizeof(uint32));
+      io::CompressedReader cr(mr, newSize);
+      parseFrames(cr, spec, sink);
+      if (!cr.atEnd())
+      {
+        // hmm.  it didn't parse the entire uncompressed data.  wonder
+        // why.
+        ID3D_WARNING( "id3::v2::parseFrame(): didn't parse entire " <<
+                      "id3v2.2.1 compressed memory stream");
+      }
+    }
+    delete f;
+  }
+  return frameSize;
+}
+
+/** Parses the frames from the current position of rdr up to the padding or
+ ** the end of rdr with parseFrame(), and leaves rdr after the last frame it
+ ** could parse.
+ **/
+void id3::v2::parseFrames(ID3_Reader& rdr, ID3_V2Spec spec, FrameSink& sink)
+{
+  io::ExitTrigger et(rdr);
+  while (!rdr.atEnd() && rdr.peekChar() != '\0')
+  {
+    if (parseFrame(rdr, spec, sink) == 0)
+    {
+      // Break for now.
+      break;
+    }
+    et.setExitPos(rdr.getCur());
+  }
+  if (rdr.peekChar() == '\0')
+  {
+    ID3D_NOTICE( "id3::v2::parseFrames: done parsing, padding at postion " <<
+                 rdr.getCur() );
+  }
+  else
+  {
+    ID3D_NOTICE( "id3::v2::parseFrames: done parsing, [cur, end] = [" <<
+                 rdr.getCur() << ", " << rdr.getEnd() << "]" );
+  }
+}
+
 namespace
 {
-  bool parseFrames(ID3_TagImpl& tag, ID3_Reader& rdr)
+  // attaches the frames parsed when linking to the tag
+  class AttachFrames : public id3::v2::FrameSink
+  {
+  public:
+    AttachFrames(ID3_TagImpl& tag) : _tag(tag) { }
+    void Frame(ID3_Frame* frame) { _tag.AttachFrame(frame); }
+  private:
+    ID3_TagImpl& _tag;
+  };
+
+  // Both of these read ahead from the current position in blocks, so
+  // megabytes of padding or junk don't cost a seek and a read per byte.
+  // They leave the reader at the returned position, which is the end of the
+  // reader if nothing is found.
+  const size_t SCANBUFSIZE = 8 * 1024;
+
+  // the part of the end of the file read at once for parsing the appended
+  // tags, enough for all but tags with large images or lyrics
+  const size_t TAILSIZE = 64 * 1024;
+
+  // returns the position of the first byte that isn't '\0'
+  ID3_Reader::pos_type skipZeros(ID3_Reader& rdr)
   {
-    ID3_Reader::pos_type beg = rdr.getCur();
-    io::ExitTrigger et(rdr, beg);
-    ID3_Reader::pos_type last_pos = beg;
-    size_t totalSize = 0;
-    size_t frameSize = 0;
-    while (!rdr.atEnd() && rdr.peekChar() != '\0')
+    ID3_Reader::char_type buf[SCANBUFSIZE];
+    ID3_Reader::pos_type cur = rdr.getCur();
+    while (!rdr.atEnd())
     {
-      ID3D_NOTICE( "id3::v2::parseFrames(): rdr.getBeg() = " << rdr.getBeg() );
-      ID3D_NOTICE( "id3::v2::parseFrames(): rdr.getCur() = " << rdr.getCur() );
-      ID3D_NOTICE( "id3::v2::parseFrames(): rdr.getEnd() = " << rdr.getEnd() );
-      last_pos = rdr.getCur();
-      ID3_Frame* f = LEAKTESTNEW(ID3_Frame);
-      f->SetSpec(tag.GetSpec());
-      bool goodParse = f->Parse(rdr);
-      frameSize = rdr.getCur() - last_pos;
-      ID3D_NOTICE( "id3::v2::parseFrames(): frameSize = " << frameSize );
-      totalSize += frameSize;
-
-      if (frameSize == 0)
+      size_t size = rdr.readChars(buf, SCANBUFSIZE);
+      if (size == 0)
       {
-        // There is a problem.
-        // If the frame size is 0, then we can't progress.
-        ID3D_WARNING( "id3::v2::parseFrames(): frame size is 0, can't " <<
-                      "continue parsing frames");
-        delete f;
-        // Break for now.
         break;
       }
-      else if (!goodParse)
+      size_t i = 0;
+      // compare a word at a time, memcpy keeps this safe for any alignment
+      for (unsigned long word; i + sizeof(word) <= size; i += sizeof(word))
+      {
+        ::memcpy(&word, buf + i, sizeof(word));
+        if (word != 0)
+        {
+          break;
+        }
+      }
+      while (i < size && buf[i] == '\0')
       {
-        // bad parse!  we can't attach this frame.
-        ID3D_WARNING( "id3::v2::parseFrames(): bad parse, deleting frame");
-        delete f;
+        ++i;
       }
-      else if (f->GetID() != ID3FID_METACOMPRESSION)
+      cur += i;
+      if (i < size)
       {
-        ID3D_NOTICE( "id3::v2::parseFrames(): attaching non-compressed " <<
-                     "frame");
-        // a good, uncompressed frame.  attach away!
-        tag.AttachFrame(f);
+        break;
       }
-      else
+    }
+    rdr.setCur(cur);
+    return cur;
+  }
+
+  // returns the position of the first possible mp3 sync byte
+  ID3_Reader::pos_type findSync(ID3_Reader& rdr)
+  {
+    ID3_Reader::char_type buf[SCANBUFSIZE];
+    ID3_Reader::pos_type cur = rdr.getCur();
+    while (!rdr.atEnd())
+    {
+      size_t size = rdr.readChars(buf, SCANBUFSIZE);
+      if (size == 0)
       {
-        ID3D_NOTICE( "id3::v2::parseFrames(): parsing ID3v2.2.1 " <<
-                     "compressed frame");
-        // hmm.  an ID3v2.2.1 compressed frame.  It contains 1 or more
-        // compressed frames.  Uncompress and call parseFrames recursively.
-        ID3_Field* fld = f->GetField(ID3FN_DATA);
-        if (fld)
-        {
-          ID3_MemoryReader mr(fld->GetRawBinary(), fld->BinSize());
-          ID3_Reader::char_type ch = mr.readChar();
-          if (ch != 'z')
-          {
-            // unknown compression method
-            ID3D_WARNING( "id3::v2::parseFrames(): unknown compression id " <<
-                          " = '" << ch << "'" );
-          }
-          else
-          {
-            uint32 newSize = io::readBENumber(mr, sizeof(uint32));
-            size_t oldSize = f->GetDataSize() - sizeof(uint32) - 1;
-            io::CompressedReader cr(mr, newSize);
-            parseFrames(tag, cr);
-            if (!cr.atEnd())
-            {
-              // hmm.  it didn't parse the entire uncompressed data.  wonder
-              // why.
-              ID3D_WARNING( "id3::v2::parseFrames(): didn't parse entire " <<
-                            "id3v2.2.1 compressed memory stream");
-            }
-          }
-        }
-        delete f;
+        break;
       }
-      et.setExitPos(rdr.getCur());
+      const void* sync = ::memchr(buf, 0xFF, size);
+      if (sync != NULL)
+      {
+        cur += static_cast<const ID3_Reader::char_type*>(sync) - buf;
+        break;
+      }
+      cur += size;
     }
-    if (rdr.peekChar() == '\0')
+    rdr.setCur(cur);
+    return cur;
+  }
+
+  // runs one of the parsers of the tags at the end of the file as a stage
+  bool parseStage(bool (*parse)(ID3_TagImpl&, ID3_Reader&), ID3_Tracer::Stage stage,
+                  ID3_TagImpl& tag, ID3_Reader& rdr)
+  {
+    TracedStage timer(stage);
+    return parse(tag, rdr);
+  }
+
+  // fills in the statistics of a parse, passing everything on to the tracer
+  // that was installed before it, if any
+  class StatsTracer : public ID3_Tracer
+  {
+  public:
+    StatsTracer(ID3_ParseStats& stats, ID3_Tracer* next)
+      : _stats(stats), _next(next) { }
+
+    void Count(Counter counter, size_t n)
     {
-      ID3D_NOTICE( "id3::v2::parseFrames: done parsing, padding at postion " <<
-                   rdr.getCur() );
+      switch (counter)
+      {
+        case READS:        _stats.reads += n;         break;
+        case SEEKS:        _stats.seeks += n;         break;
+        case BYTESREAD:    _stats.bytes_read += n;    break;
+        case SKIPPED:      _stats.bytes_skipped += n; break;
+        case BADFRAMES:    _stats.bad_frames += n;    break;
+        case UNSYNCED:     _stats.unsynced = true;    break;
+        case DECOMPRESSED:
+          _stats.decompressed += n;
+          _stats.compressed = true;
+          break;
+        default: break;
+      }
+      if (_next)
+      {
+        _next->Count(counter, n);
+      }
     }
-    else
+
+    void FrameParsed(ID3_FrameID id, size_t size)
     {
-      ID3D_NOTICE( "id3::v2::parseFrames: done parsing, [cur, end] = [" <<
-                   rdr.getCur() << ", " << rdr.getEnd() << "]" );
+      if (id < ID3FID_LASTFRAMEID)
+      {
+        ++_stats.frames[id];
+      }
+      if (id == ID3FID_NOFRAME)
+      {
+        ++_stats.unknown_frames;
+      }
+      if (_next)
+      {
+        _next->FrameParsed(id, size);
+      }
     }
-    return true;
-  }
+
+    void StageDone(Stage stage, double seconds)
+    {
+      switch (stage)
+      {
+        case PARSEV2:         _stats.v2_seconds += seconds;         break;
+        case PARSEMUSICMATCH: _stats.musicmatch_seconds += seconds; break;
+        case PARSELYRICS3:    _stats.lyrics3_seconds += seconds;    break;
+        case PARSEV1:         _stats.v1_seconds += seconds;         break;
+        case PARSEMP3:        _stats.mp3_seconds += seconds;        break;
+        default: break;
+      }
+      if (_next)
+      {
+        _next->StageDone(stage, seconds);
+      }
+    }
+
+  private:
+    ID3_ParseStats& _stats;
+    ID3_Tracer*     _next;
+  };
+
+  // installs a tracer for the lifetime of the object, then puts back the
+  // one installed before
+  class InstalledTracer
+  {
+  public:
+    explicit InstalledTracer(ID3_Tracer& tracer)
+      : _previous(ID3_Tracer::Install(&tracer)) { }
+    ~InstalledTracer() { ID3_Tracer::Install(_previous); }
+  private:
+    ID3_Tracer* _previous;
+  };
 };
 
 bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
@@ -167,7 +341,8 @@ bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
   if (!hdr.GetUnsync())
   {
     tag.SetUnsync(false);
-    parseFrames(tag, wr);
+    AttachFrames attach(tag);
+    parseFrames(wr, tag.GetSpec(), attach);
   }
   else
   {
@@ -185,6 +360,7 @@ bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
     BString raw = io::readAllBinary(wr);
     io::BStringReader bsr(raw);
     io::UnsyncedReader ur(bsr);
+    trace(ID3_Tracer::UNSYNCED);
     ID3D_NOTICE( "ID3_TagImpl::Parse(ID3_Reader&): unsync beg = " << ur.getBeg() );
     ID3D_NOTICE( "ID3_TagImpl::Parse(ID3_Reader&): unsync cur = " << ur.getCur() );
     ID3D_NOTICE( "ID3_TagImpl::Parse(ID3_Reader&): unsync end = " << ur.getEnd() );
@@ -196,17 +372,16 @@ bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
     // character at a time for every call
     BString synced = io::readAllBinary(ur);
     io::BStringReader sr(synced);
-    parseFrames(tag, sr);
+    AttachFrames attach(tag);
+    parseFrames(sr, tag.GetSpec(), attach);
   }
 
   return true;
 }
 
 void ID3_TagImpl::ParseFile()
-{ //changes in this routine should also be made in the routine for streaming parsing below
+{
   ifstream file;
-  size_t mp3_core_size;
-  size_t bytes_till_sync;
 
   _last_error = openReadableFile(this->GetFileName(), file);
   if (ID3E_NoError != _last_error)
@@ -215,20 +390,70 @@ void ID3_TagImpl::ParseFile()
     return;
   }
   ID3_IFStreamReader ifsr(file);
-  io::WindowedReader wr(ifsr);
+  this->ParseReader(ifsr);
+  // the reader's positions are 32 bits, the size of the file may not be
+  _file_size = getFileSize(file);
+  file.close();
+}
+
+//also used for streaming media
+void ID3_TagImpl::ParseReader(ID3_Reader &reader)
+{
+  // the statistics of the parse are filled in by a tracer of their own,
+  // installed in front of the one of the calling thread
+  ID3_Tracer* tracer = dami::tracer();
+  if (_parse_stats_wanted && dynamic_cast<StatsTracer*>(tracer) == NULL)
+  {
+    if (!_parse_stats)
+    {
+      _parse_stats = LEAKTESTNEW(ID3_ParseStats);
+    }
+    ::memset(_parse_stats, 0, sizeof(ID3_ParseStats));
+    StatsTracer stats(*_parse_stats, tracer);
+    InstalledTracer installed(stats);
+    this->ParseReader(reader);
+    return;
+  }
+
+  // with a tracer installed, everything is read through a reader that
+  // counts the bytes read and the seeks
+  if (tracer && dynamic_cast<TracedReader*>(&reader) == NULL)
+  {
+    TracedReader traced(reader, *tracer);
+    this->ParseReader(traced);
+    return;
+  }
+
+  io::WindowedReader wr(reader);
   wr.setBeg(wr.getCur());
 
   _file_tags.clear();
-  _file_size = getFileSize(file);
+  _file_size = reader.getEnd();
+
+  size_t bytes_till_sync = this->parseLeadingTags(wr);
 
+  if (_file_size > _prepended_bytes)
+  {
+    this->parseAppendedTags(reader, wr.getBeg(), wr.getEnd(), TAILSIZE);
+    this->parseMp3Header(wr, bytes_till_sync);
+  }
+  else
+    this->SetPadding(false); //no need to pad an empty file
+}
+
+// Parses the id3v2 tags at the beginning of the reader and skips the padding
+// after them, leaving the window of the reader at the data that follows.
+// Returns the number of bytes between that and the first mp3 sync byte.
+size_t ID3_TagImpl::parseLeadingTags(io::WindowedReader& wr)
+{
   ID3_Reader::pos_type beg  = wr.getBeg();
   ID3_Reader::pos_type cur  = wr.getCur();
-  ID3_Reader::pos_type end  = wr.getEnd();
 
   ID3_Reader::pos_type last = cur;
 
   if (_tags_to_parse.test(ID3TT_ID3V2))
   {
+    TracedStage stage(ID3_Tracer::PARSEV2);
     do
     {
       last = cur;
@@ -244,28 +469,17 @@ void ID3_TagImpl::ParseFile()
   // add silly padding outside the tag to _prepended_bytes
   if (!wr.atEnd() && wr.peekChar() == '\0')
   {
-    ID3D_NOTICE( "ID3_TagImpl::ParseFile(): found padding outside tag" );
-    do
-    {
-      last = cur;
-      cur = wr.getCur() + 1;
-      wr.setBeg(cur);
-      wr.setCur(cur);
-    } while (!wr.atEnd() &&  cur > last && wr.peekChar() == '\0');
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): found padding outside tag" );
+    cur = skipZeros(wr);
+    wr.setBeg(cur);
   }
   if (!wr.atEnd() && _file_size - (cur - beg) > 4 && wr.peekChar() == 255)
   { //unfortunatly, this is necessary for finding an invalid padding
     wr.setCur(cur + 1); //cur is known by peekChar
     if (wr.readChar() == '\0' && wr.readChar() == '\0' && wr.peekChar() == '\0')
     { //three empty bytes found, enough for me, this is stupid padding
-      cur += 3; //those are now allready read in (excluding the peekChar, since it will be added by do{})
-      do
-      {
-        last = cur;
-        cur = wr.getCur() + 1;
-        wr.setBeg(cur);
-        wr.setCur(cur);
-      } while (!wr.atEnd() &&  cur > last && wr.peekChar() == '\0');
+      cur = skipZeros(wr);
+      wr.setBeg(cur);
     }
     else
       wr.setCur(cur);
@@ -278,7 +492,7 @@ void ID3_TagImpl::ParseFile()
   beg  = wr.getBeg();
   if (!wr.atEnd() && wr.peekChar() != 0xFF) //no sync byte, so, either this is not followed by a mp3 file or it's a fLaC file, or an encapsulating format, better check it
   {
-    ID3D_NOTICE( "ID3_TagImpl::ParseFile(): Didn't find mp3 sync byte" );
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): Didn't find mp3 sync byte" );
     if ((_file_size - (cur - beg)) >= 4)
     { //there is room to search for some kind of ID
       unsigned char buf[5];
@@ -293,12 +507,7 @@ void ID3_TagImpl::ParseFile()
         // loop until first possible sync byte
         if (!wr.atEnd() && wr.peekChar() != 0xFF)
         {
-          do
-          {
-            last = cur;
-            cur = wr.getCur() + 1;
-            wr.setCur(cur);
-          } while (!wr.atEnd() &&  cur > last && wr.peekChar() != 0xFF);
+          cur = findSync(wr);
         }
       }
       else if (strncmp((char*)buf, "fLaC", 4) == 0)
@@ -313,283 +522,204 @@ void ID3_TagImpl::ParseFile()
         //go looking for a sync byte
         if (!wr.atEnd() && wr.peekChar() != 0xFF) //no sync byte, we have an unknown byte
         {
-          do
-          {
-            last = cur;
-            cur = wr.getCur() + 1;
-            wr.setCur(cur);
-          } while (!wr.atEnd() &&  cur > last && wr.peekChar() != 0xFF);
+          cur = findSync(wr);
         }
       }
     } //if ((_file_size - (cur - beg)) >= 4)
     else
     { //remaining size is smaller than 4 bytes, can't be useful, but leave it for now
       beg = cur;
-      //file.close();
-      //return;
     }
   }
-  bytes_till_sync = cur - beg;
+  return cur - beg;
+}
 
-  cur = wr.setCur(end);
-  if (_file_size > _prepended_bytes)
+// Parses the tags at the end of the reader, before end and after beg, from a
+// copy of at most tailSize bytes before end.
+void ID3_TagImpl::parseAppendedTags(ID3_Reader& reader, ID3_Reader::pos_type beg,
+                                    ID3_Reader::pos_type end, size_t tailSize)
+{
+  ID3_Reader::pos_type cur;
+  ID3_Reader::pos_type last;
+
+  // the tags at the end are parsed from a copy of the last part of the
+  // file, so their parsers don't need a seek and a read for every field
+  ID3_Reader::pos_type tail_beg = beg;
+  if (end - tail_beg > tailSize)
   {
-    do
+    tail_beg = end - tailSize;
+  }
+  io::CachedReader cache(reader, tail_beg);
+  io::WindowedReader tail(cache);
+  tail.setBeg(beg);
+  tail.setEnd(end);
+  cur = tail.setCur(end);
+  do
+  {
+    last = cur;
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): beg = " << tail.getBeg() );
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): cur = " << tail.getCur() );
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): end = " << tail.getEnd() );
+    // ...then the tags at the end
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): musicmatch? cur = " << tail.getCur() );
+    if (_tags_to_parse.test(ID3TT_MUSICMATCH) &&
+        parseStage(mm::parse, ID3_Tracer::PARSEMUSICMATCH, *this, tail))
     {
-      last = cur;
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): beg = " << wr.getBeg() );
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): cur = " << wr.getCur() );
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): end = " << wr.getEnd() );
-      // ...then the tags at the end
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): musicmatch? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_MUSICMATCH) && mm::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseFile(): musicmatch! cur = " << wr.getCur() );
-        _file_tags.add(ID3TT_MUSICMATCH);
-        wr.setEnd(wr.getCur());
-      }
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): lyr3v1? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_LYRICS3) && lyr3::v1::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseFile(): lyr3v1! cur = " << wr.getCur() );
-        _file_tags.add(ID3TT_LYRICS3);
-        wr.setEnd(wr.getCur());
-      }
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v2? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_LYRICS3V2) && lyr3::v2::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v2! cur = " << wr.getCur() );
-        _file_tags.add(ID3TT_LYRICS3V2);
-        cur = wr.getCur();
-        wr.setCur(wr.getEnd());//set to end to seek id3v1 tag
-        //check for id3v1 tag and set End accordingly
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1? cur = " << wr.getCur() );
-        if (_tags_to_parse.test(ID3TT_ID3V1) && id3::v1::parse(*this, wr))
-        {
-          ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1! cur = " << wr.getCur() );
-          _file_tags.add(ID3TT_ID3V1);
-        }
-        wr.setCur(cur);
-        wr.setEnd(cur);
-      }
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): id3v1? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_ID3V1) && id3::v1::parse(*this, wr))
+      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): musicmatch! cur = " << tail.getCur() );
+      _file_tags.add(ID3TT_MUSICMATCH);
+      tail.setEnd(tail.getCur());
+    }
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v1? cur = " << tail.getCur() );
+    if (_tags_to_parse.test(ID3TT_LYRICS3) &&
+        parseStage(lyr3::v1::parse, ID3_Tracer::PARSELYRICS3, *this, tail))
+    {
+      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v1! cur = " << tail.getCur() );
+      _file_tags.add(ID3TT_LYRICS3);
+      tail.setEnd(tail.getCur());
+    }
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v2? cur = " << tail.getCur() );
+    if (_tags_to_parse.test(ID3TT_LYRICS3V2) &&
+        parseStage(lyr3::v2::parse, ID3_Tracer::PARSELYRICS3, *this, tail))
+    {
+      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v2! cur = " << tail.getCur() );
+      _file_tags.add(ID3TT_LYRICS3V2);
+      cur = tail.getCur();
+      tail.setCur(tail.getEnd());//set to end to seek id3v1 tag
+      //check for id3v1 tag and set End accordingly
+      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1? cur = " << tail.getCur() );
+      if (_tags_to_parse.test(ID3TT_ID3V1) &&
+          parseStage(id3::v1::parse, ID3_Tracer::PARSEV1, *this, tail))
       {
-        ID3D_NOTICE( "ID3_TagImpl::ParseFile(): id3v1! cur = " << wr.getCur() );
-        wr.setEnd(wr.getCur());
+        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1! cur = " << tail.getCur() );
         _file_tags.add(ID3TT_ID3V1);
       }
-      cur = wr.getCur();
-    } while (cur != last);
-    _appended_bytes = end - cur;
-
-    // Now get the mp3 header
-    mp3_core_size = (_file_size - _appended_bytes) - (_prepended_bytes + bytes_till_sync);
-    if (mp3_core_size >= 4)
-    { //it has at least the size for a mp3 header (a mp3 header is 4 bytes)
-      wr.setBeg(_prepended_bytes + bytes_till_sync);
-      wr.setCur(_prepended_bytes + bytes_till_sync);
-      wr.setEnd(_file_size - _appended_bytes);
-
-      _mp3_info = LEAKTESTNEW(Mp3Info);
-      ID3D_NOTICE( "ID3_TagImpl::ParseFile(): mp3header? cur = " << wr.getCur() );
-
-      if (_mp3_info->Parse(wr, mp3_core_size))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseFile(): mp3header! cur = " << wr.getCur() );
-      }
-      else
-      {
-        delete _mp3_info;
-        _mp3_info = NULL;
-      }
+      tail.setCur(cur);
+      tail.setEnd(cur);
+    }
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1? cur = " << tail.getCur() );
+    if (_tags_to_parse.test(ID3TT_ID3V1) &&
+        parseStage(id3::v1::parse, ID3_Tracer::PARSEV1, *this, tail))
+    {
+      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1! cur = " << tail.getCur() );
+      tail.setEnd(tail.getCur());
+      _file_tags.add(ID3TT_ID3V1);
+    }
+    cur = tail.getCur();
+  } while (cur != last);
+  _appended_bytes = end - cur;
+}
+
+// Parses the first mp3 frame header, after the leading tags and the
+// bytes_till_sync bytes of whatever follows them
+void ID3_TagImpl::parseMp3Header(io::WindowedReader& wr, size_t bytes_till_sync)
+{
+  // left from an earlier parse, or from the head of a stream
+  delete _mp3_info;
+  _mp3_info = NULL;
+
+  size_t mp3_core_size = (_file_size - _appended_bytes) - (_prepended_bytes + bytes_till_sync);
+  if (mp3_core_size >= 4)
+  { //it has at least the size for a mp3 header (a mp3 header is 4 bytes)
+    wr.setBeg(_prepended_bytes + bytes_till_sync);
+    wr.setCur(_prepended_bytes + bytes_till_sync);
+    wr.setEnd(_file_size - _appended_bytes);
+
+    TracedStage mp3stage(ID3_Tracer::PARSEMP3);
+    _mp3_info = LEAKTESTNEW(Mp3Info);
+    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): mp3header? cur = " << wr.getCur() );
+
+    if (_mp3_info->Parse(wr, mp3_core_size))
+    {
+      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): mp3header! cur = " << wr.getCur() );
+    }
+    else
+    {
+      delete _mp3_info;
+      _mp3_info = NULL;
     }
   }
-  else
-    this->SetPadding(false); //no need to pad an empty file
-  file.close();
 }
 
-//used for streaming media
-void ID3_TagImpl::ParseReader(ID3_Reader &reader)
+const Mp3_Scaninfo* ID3_TagImpl::ScanMp3Frames(size_t seekpoints)
 {
-//allthough largely the same, stays a severate routine than ParseFile() above.
-  size_t mp3_core_size;
-  size_t bytes_till_sync;
+  ifstream file;
+  if (ID3E_NoError != openReadableFile(this->GetFileName(), file))
+  {
+    return NULL;
+  }
+  ID3_IFStreamReader ifsr(file);
+  const Mp3_Scaninfo* info = this->ScanMp3Frames(ifsr, seekpoints);
+  file.close();
+  return info;
+}
 
+const Mp3_Scaninfo* ID3_TagImpl::ScanMp3Frames(ID3_Reader& reader, size_t seekpoints)
+{
+  const Mp3_Headerinfo* mp3header = this->GetMp3HeaderInfo();
+  if (mp3header == NULL || _file_size < _appended_bytes + mp3header->datasize)
+  {
+    return NULL;
+  }
+  // the audio data is right before the appended tags
+  size_t audio_end = _file_size - _appended_bytes;
   io::WindowedReader wr(reader);
-  wr.setBeg(wr.getCur());
+  wr.setBeg(audio_end - mp3header->datasize);
+  wr.setEnd(audio_end);
+  wr.setCur(wr.getBeg());
+  ID3D_NOTICE( "ID3_TagImpl::ScanMp3Frames(): scanning [" << wr.getBeg() <<
+               ", " << wr.getEnd() << "]" );
+  if (!_mp3_info->Scan(wr, seekpoints))
+  {
+    return NULL;
+  }
+  return _mp3_info->GetMp3ScanInfo();
+}
+
+// Parses the id3v2 tags a stream starts with, once they have arrived.
+// Returns the number of bytes between them and the mp3 sync byte, which
+// ParseStreamMp3Header() and ParseStreamTail() need.
+size_t ID3_TagImpl::ParseStreamHead(ID3_Reader& reader, flags_t tag_types)
+{
+  _tags_to_parse.set(tag_types);
+  _cache_dir = "";
+  _file_name = "";
+  _changed = true;
 
+  io::WindowedReader wr(reader);
   _file_tags.clear();
   _file_size = reader.getEnd();
+  _appended_bytes = 0;
 
-  ID3_Reader::pos_type beg  = wr.getBeg();
-  ID3_Reader::pos_type cur  = wr.getCur();
-  ID3_Reader::pos_type end  = wr.getEnd();
-
-  ID3_Reader::pos_type last = cur;
+  return this->parseLeadingTags(wr);
+}
 
-  if (_tags_to_parse.test(ID3TT_ID3V2))
-  {
-    do
-    {
-      last = cur;
-      // Parse tags at the beginning of the file first...
-      if (id3::v2::parse(*this, wr))
-      {
-        _file_tags.add(ID3TT_ID3V2);
-      }
-      cur  = wr.getCur();
-      wr.setBeg(cur);
-    } while (!wr.atEnd() && cur > last);
-  }
-  // add silly padding outside the tag to _prepended_bytes
-  if (!wr.atEnd() && wr.peekChar() == '\0')
-  {
-    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): found padding outside tag" );
-    do
-    {
-      last = cur;
-      cur = wr.getCur() + 1;
-      wr.setBeg(cur);
-      wr.setCur(cur);
-    } while (!wr.atEnd() &&  cur > last && wr.peekChar() == '\0');
-  }
-  _prepended_bytes = cur - beg;
-  // go looking for the first sync byte to add to bytes_till_sync
-  // by not adding it to _prepended_bytes, we preserve this 'unknown' data
-  // The routine's only effect is helping the lib to find things as bitrate etc.
-  beg  = wr.getBeg();
-  if (!wr.atEnd() && wr.peekChar() != 0xFF) //no sync byte, so, either this is not followed by a mp3 file or it's a fLaC file, or an encapsulating format, better check it
+// Parses the first mp3 frame header of a stream, once the bytes after its
+// sync byte have arrived.  The reader ends where the stream has arrived.
+void ID3_TagImpl::ParseStreamMp3Header(ID3_Reader& reader, size_t bytes_till_sync)
+{
+  io::WindowedReader wr(reader);
+  _file_size = reader.getEnd();
+  if (_file_size > _prepended_bytes)
   {
-    ID3D_NOTICE( "ID3_TagImpl::ParseReader(): Didn't find mp3 sync byte" );
-    if ((_file_size - (cur - beg)) >= 4)
-    { //there is room to search for some kind of ID
-      unsigned char buf[5];
-      wr.readChars(buf, 4);
-      buf[4] = '\0';
-      // check for RIFF (an encapsulating format) ID
-      if (strncmp((char*)buf, "RIFF", 4) == 0 || strncmp((char*)buf, "RIFX", 4) == 0)
-      {
-        // next 4 bytes are RIFF size, skip them
-        cur = wr.getCur() + 4;
-        wr.setCur(cur);
-        // loop until first possible sync byte
-        if (!wr.atEnd() && wr.peekChar() != 0xFF)
-        {
-          do
-          {
-            last = cur;
-            cur = wr.getCur() + 1;
-            wr.setCur(cur);
-          } while (!wr.atEnd() &&  cur > last && wr.peekChar() != 0xFF);
-        }
-      }
-      else if (strncmp((char*)buf, "fLaC", 4) == 0)
-      { //a FLAC file, no need looking for a sync byte
-        beg = cur;
-      }
-      else
-      { //since we set the cursor 4 bytes ahead for looking for RIFF, RIFX or fLaC, better set it back
-        // but peekChar allready checked the first one, so we add one
-        cur = cur + 1;
-        wr.setCur(cur);
-        //go looking for a sync byte
-        if (!wr.atEnd() && wr.peekChar() != 0xFF) //no sync byte, we have an unknown byte
-        {
-          do
-          {
-            last = cur;
-            cur = wr.getCur() + 1;
-            wr.setCur(cur);
-          } while (!wr.atEnd() &&  cur > last && wr.peekChar() != 0xFF);
-        }
-      }
-    } //if ((_file_size - (cur - beg)) >= 4)
-    else
-    { //remaining size is smaller than 4 bytes, can't be useful, but leave it for now
-      beg = cur;
-      //file.close();
-      //return;
-    }
+    this->parseMp3Header(wr, bytes_till_sync);
   }
-  bytes_till_sync = cur - beg;
+}
+
+// Parses the tags at the end of a stream once it has all arrived.  The reader
+// holds the head of the stream and its last tailSize bytes, and ends where
+// the stream ended.  The mp3 header is parsed again, now the size of the audio
+// is known.
+void ID3_TagImpl::ParseStreamTail(ID3_Reader& reader, size_t bytes_till_sync,
+                                  size_t tailSize)
+{
+  io::WindowedReader wr(reader);
+  _file_size = reader.getEnd();
 
-  cur = wr.setCur(end);
   if (_file_size > _prepended_bytes)
   {
-    do
-    {
-      last = cur;
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): beg = " << wr.getBeg() );
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): cur = " << wr.getCur() );
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): end = " << wr.getEnd() );
-      // ...then the tags at the end
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): musicmatch? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_MUSICMATCH) && mm::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): musicmatch! cur = " << wr.getCur() );
-        _file_tags.add(ID3TT_MUSICMATCH);
-        wr.setEnd(wr.getCur());
-      }
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v1? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_LYRICS3) && lyr3::v1::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v1! cur = " << wr.getCur() );
-        _file_tags.add(ID3TT_LYRICS3);
-        wr.setEnd(wr.getCur());
-      }
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v2? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_LYRICS3V2) && lyr3::v2::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): lyr3v2! cur = " << wr.getCur() );
-        _file_tags.add(ID3TT_LYRICS3V2);
-        cur = wr.getCur();
-        wr.setCur(wr.getEnd());//set to end to seek id3v1 tag
-        //check for id3v1 tag and set End accordingly
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1? cur = " << wr.getCur() );
-        if (_tags_to_parse.test(ID3TT_ID3V1) && id3::v1::parse(*this, wr))
-        {
-          ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1! cur = " << wr.getCur() );
-          _file_tags.add(ID3TT_ID3V1);
-        }
-        wr.setCur(cur);
-        wr.setEnd(cur);
-      }
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1? cur = " << wr.getCur() );
-      if (_tags_to_parse.test(ID3TT_ID3V1) && id3::v1::parse(*this, wr))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): id3v1! cur = " << wr.getCur() );
-        wr.setEnd(wr.getCur());
-        _file_tags.add(ID3TT_ID3V1);
-      }
-      cur = wr.getCur();
-    } while (cur != last);
-    _appended_bytes = end - cur;
-
-    // Now get the mp3 header
-    mp3_core_size = (_file_size - _appended_bytes) - (_prepended_bytes + bytes_till_sync);
-    if (mp3_core_size >= 4)
-    { //it has at least the size for a mp3 header (a mp3 header is 4 bytes)
-      wr.setBeg(_prepended_bytes + bytes_till_sync);
-      wr.setCur(_prepended_bytes + bytes_till_sync);
-      wr.setEnd(_file_size - _appended_bytes);
-
-      _mp3_info = LEAKTESTNEW(Mp3Info);
-      ID3D_NOTICE( "ID3_TagImpl::ParseReader(): mp3header? cur = " << wr.getCur() );
-
-      if (_mp3_info->Parse(wr, mp3_core_size))
-      {
-        ID3D_NOTICE( "ID3_TagImpl::ParseReader(): mp3header! cur = " << wr.getCur() );
-      }
-      else
-      {
-        delete _mp3_info;
-        _mp3_info = NULL;
-      }
-    }
+    this->parseAppendedTags(reader, _prepended_bytes, _file_size, tailSize);
+    this->parseMp3Header(wr, bytes_till_sync);
   }
   else
     this->SetPadding(false); //no need to pad an empty file
 }
-
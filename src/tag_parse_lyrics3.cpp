@@ -27,6 +27,7 @@
 
 #include <ctype.h>
 #include <memory.h>
+#include <algorithm>
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
 #include "helpers.h"
 #include "id3/io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
@@ -90,29 +91,37 @@ namespace
       return true;
     }
 
-    size_t index = 0;
+    // search a block at a time, keeping the last text.size() - 1 chars of a
+    // block in front of the next, so a match across two blocks isn't missed
+    const size_t BUFSIZE = 1024;
+    if (text.size() > BUFSIZE)
+    {
+      return false;
+    }
+    ID3_Reader::char_type buf[BUFSIZE];
+    ID3_Reader::pos_type beg = reader.getCur(); // the position of buf[0]
+    size_t size = 0;
     while (!reader.atEnd())
     {
-      ID3_Reader::char_type ch = reader.readChar();
-      if (ch == text[index])
-      {
-        index++;
-      }
-      else if (ch == text[0])
+      size_t numRead = reader.readChars(buf + size, BUFSIZE - size);
+      if (numRead == 0)
       {
-        index = 1;
-      }
-      else
-      {
-        index = 0;
+        break;
       }
-      if (index == text.size())
+      size += numRead;
+      const ID3_Reader::char_type* found =
+        std::search(buf, buf + size, text.begin(), text.end());
+      if (found != buf + size)
       {
-        reader.setCur(reader.getCur() - index);
+        reader.setCur(beg + (found - buf));
         ID3D_NOTICE( "findText: found \"" << text << "\" at " <<
                      reader.getCur() );
         break;
       }
+      size_t keep = min(size, text.size() - 1);
+      ::memmove(buf, buf + size - keep, keep);
+      beg += size - keep;
+      size = keep;
     }
     return !reader.atEnd();
   };
@@ -0,0 +1,149 @@
+// -*- C++ -*-
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#ifndef _ID3LIB_TRACE_HOOKS_H_
+#define _ID3LIB_TRACE_HOOKS_H_
+
+#include "tracer.h"
+#include "reader.h"
+
+namespace dami
+{
+  // The hooks through which the library reports to the ID3_Tracer of the
+  // calling thread.  While no thread has a tracer installed, a hook costs a
+  // single load and branch.
+  extern long tracers;                // installed in all threads
+  ID3_Tracer* installedTracer();      // of the calling thread
+  double now();                       // in seconds
+
+  inline ID3_Tracer* tracer()
+  {
+#if defined __ATOMIC_RELAXED
+    if (__atomic_load_n(&tracers, __ATOMIC_RELAXED) == 0)
+#else
+    if (tracers == 0)
+#endif
+    {
+      return NULL;
+    }
+    return installedTracer();
+  }
+
+  inline void trace(ID3_Tracer::Counter counter, size_t n = 1)
+  {
+    ID3_Tracer* t = tracer();
+    if (t)
+    {
+      t->Count(counter, n);
+    }
+  }
+
+  inline void traceFrame(ID3_FrameID id, size_t size)
+  {
+    ID3_Tracer* t = tracer();
+    if (t)
+    {
+      t->FrameParsed(id, size);
+    }
+  }
+
+  // reports the time from its construction to done() or its destruction,
+  // whichever comes first
+  class TracedStage
+  {
+  public:
+    explicit TracedStage(ID3_Tracer::Stage stage)
+      : _tracer(tracer()), _stage(stage), _beg(_tracer ? now() : 0) { }
+    ~TracedStage() { this->done(); }
+    void done()
+    {
+      if (_tracer)
+      {
+        _tracer->StageDone(_stage, now() - _beg);
+        _tracer = NULL;
+      }
+    }
+  private:
+    ID3_Tracer*       _tracer;
+    ID3_Tracer::Stage _stage;
+    double            _beg;
+  };
+
+  // counts the bytes read from, the reads, the seeks and the bytes skipped
+  // on the reader it decorates; it is put in front of a reader only when
+  // there is a tracer
+  class TracedReader : public ID3_Reader
+  {
+  public:
+    TracedReader(ID3_Reader& reader, ID3_Tracer& tracer)
+      : _reader(reader), _tracer(tracer) { }
+
+    void     close() { _reader.close(); }
+    pos_type getBeg() { return _reader.getBeg(); }
+    pos_type getEnd() { return _reader.getEnd(); }
+    pos_type getCur() { return _reader.getCur(); }
+    pos_type setCur(pos_type pos)
+    {
+      pos_type cur = _reader.getCur();
+      if (pos != cur)
+      {
+        _tracer.Count(ID3_Tracer::SEEKS, 1);
+      }
+      pos = _reader.setCur(pos);
+      if (pos > cur)
+      {
+        _tracer.Count(ID3_Tracer::SKIPPED, pos - cur);
+      }
+      return pos;
+    }
+
+    int_type peekChar() { return _reader.peekChar(); }
+    size_type readChars(char_type buf[], size_type len)
+    {
+      size_type size = _reader.readChars(buf, len);
+      _tracer.Count(ID3_Tracer::READS, 1);
+      _tracer.Count(ID3_Tracer::BYTESREAD, size);
+      return size;
+    }
+    size_type readChars(char buf[], size_type len)
+    {
+      return this->readChars(reinterpret_cast<char_type*>(buf), len);
+    }
+    size_type skipChars(size_type len)
+    {
+      size_type size = _reader.skipChars(len);
+      _tracer.Count(ID3_Tracer::SKIPPED, size);
+      return size;
+    }
+
+  private:
+    ID3_Reader& _reader;
+    ID3_Tracer& _tracer;
+  };
+};
+
+#endif /* _ID3LIB_TRACE_HOOKS_H_ */
@@ -0,0 +1,268 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <time.h>
+#if defined HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#if defined HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "trace_hooks.h"
+#include "shared_binary.h"
+
+/** \class ID3_Tracer tracer.h id3/tracer.h
+ ** \brief Counts what the library does while parsing and writing tags.
+ **
+ ** The debug notices of the library are compiled in or out and only print
+ ** text.  An ID3_Tracer is told at run time how many bytes were read from
+ ** the file being parsed and in how many calls, how often its read position
+ ** moved and how many bytes were passed over, which frames were parsed and
+ ** how many were dropped, how many bytes were decompressed and how many tags
+ ** were resynchronized, how many texts were converted from one encoding to
+ ** another, how many buffers were allocated for large field data, whether a
+ ** file was rewritten through a temporary file or had its tag written in
+ ** place, and how long each stage of parsing and writing took.
+ **
+ ** A tracer is installed for the calling thread and sees only the work done
+ ** by that thread, so the costs of each file can be told apart even when
+ ** many files are parsed at once.  As long as no thread has a tracer
+ ** installed, reporting costs the library a single test.
+ **
+ ** \code
+ **   ID3_Tracer tracer;
+ **   ID3_Tracer::Install(&tracer);
+ **   ID3_Tag tag("song.mp3");
+ **   ID3_Tracer::Install(NULL);
+ **   cout << tracer.GetCount(ID3_Tracer::BYTESREAD) << " bytes read in "
+ **        << tracer.GetSeconds(ID3_Tracer::PARSEV2) << "s" << endl;
+ ** \endcode
+ **
+ ** By itself a tracer adds everything up, to be read with GetCount(),
+ ** GetFrames() and GetSeconds() and cleared with Reset().  A subclass can
+ ** override Count(), FrameParsed() and StageDone() to pass the figures on,
+ ** for example to a monitoring system, and call the versions of this class
+ ** to keep adding them up as well.
+ **/
+
+using namespace dami;
+
+long dami::tracers = 0;
+
+namespace
+{
+  const char* const COUNTER_NAMES[ID3_Tracer::NUMCOUNTERS] =
+  {
+    "bytesread",
+    "reads",
+    "seeks",
+    "skipped",
+    "frames",
+    "badframes",
+    "decompressed",
+    "unsynced",
+    "conversions",
+    "buffers",
+    "rewrites",
+    "inplacewrites",
+    "convertedframes",
+    "droppedframes"
+  };
+
+  const char* const STAGE_NAMES[ID3_Tracer::NUMSTAGES] =
+  {
+    "parsev2",
+    "parsemusicmatch",
+    "parselyrics3",
+    "parsev1",
+    "parsemp3",
+    "update"
+  };
+
+#if defined HAVE_PTHREAD_H
+  pthread_key_t  key;
+  pthread_once_t once = PTHREAD_ONCE_INIT;
+
+  void createKey()
+  {
+    pthread_key_create(&key, NULL);
+  }
+
+  ID3_Tracer* getTracer()
+  {
+    pthread_once(&once, createKey);
+    return static_cast<ID3_Tracer*>(pthread_getspecific(key));
+  }
+
+  void setTracer(ID3_Tracer* tracer)
+  {
+    pthread_once(&once, createKey);
+    pthread_setspecific(key, tracer);
+  }
+#else
+  ID3_Tracer* installed = NULL;
+
+  ID3_Tracer* getTracer() { return installed; }
+  void setTracer(ID3_Tracer* tracer) { installed = tracer; }
+#endif
+};
+
+ID3_Tracer* dami::installedTracer()
+{
+  return getTracer();
+}
+
+double dami::now()
+{
+#if defined HAVE_SYS_TIME_H
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+ID3_Tracer::ID3_Tracer()
+{
+  this->Reset();
+}
+
+/** A tracer must not be destroyed while it is installed in another thread.
+ ** It is uninstalled if it is installed in the calling thread.
+ **/
+ID3_Tracer::~ID3_Tracer()
+{
+  if (getTracer() == this)
+  {
+    Install(NULL);
+  }
+}
+
+/** Installs a tracer for the calling thread, replacing the one installed
+ ** before, and returns that one.  NULL uninstalls the tracer.
+ **/
+ID3_Tracer* ID3_Tracer::Install(ID3_Tracer* tracer)
+{
+  ID3_Tracer* previous = getTracer();
+  setTracer(tracer);
+  if (tracer && !previous)
+  {
+    retain(tracers);
+  }
+  else if (!tracer && previous)
+  {
+    release(tracers);
+  }
+  return previous;
+}
+
+/** The tracer installed for the calling thread, or NULL.
+ **/
+ID3_Tracer* ID3_Tracer::GetInstalled()
+{
+  return getTracer();
+}
+
+/** Called with what was done, in amounts of one or more.
+ **/
+void ID3_Tracer::Count(Counter counter, size_t n)
+{
+  if (counter < NUMCOUNTERS)
+  {
+    _counts[counter] += n;
+  }
+}
+
+/** Called for every id3v2 frame parsed, with its size in the tag.  It adds
+ ** one to the FRAMES counter as well as to the frames with the id.
+ **/
+void ID3_Tracer::FrameParsed(ID3_FrameID id, size_t)
+{
+  if (id < ID3FID_LASTFRAMEID)
+  {
+    ++_frames[id];
+  }
+  ++_counts[FRAMES];
+}
+
+/** Called when a stage is done, with the time it took.
+ **/
+void ID3_Tracer::StageDone(Stage stage, double seconds)
+{
+  if (stage < NUMSTAGES)
+  {
+    _seconds[stage] += seconds;
+  }
+}
+
+size_t ID3_Tracer::GetCount(Counter counter) const
+{
+  return counter < NUMCOUNTERS ? _counts[counter] : 0;
+}
+
+/** The number of frames with the id parsed; frames of an unknown id are
+ ** counted under ID3FID_NOFRAME.
+ **/
+size_t ID3_Tracer::GetFrames(ID3_FrameID id) const
+{
+  return id < ID3FID_LASTFRAMEID ? _frames[id] : 0;
+}
+
+double ID3_Tracer::GetSeconds(Stage stage) const
+{
+  return stage < NUMSTAGES ? _seconds[stage] : 0.0;
+}
+
+void ID3_Tracer::Reset()
+{
+  ::memset(_counts, 0, sizeof(_counts));
+  ::memset(_frames, 0, sizeof(_frames));
+  for (size_t i = 0; i < NUMSTAGES; ++i)
+  {
+    _seconds[i] = 0.0;
+  }
+}
+
+/** The name of the counter, such as "bytesread", for reports.
+ **/
+const char* ID3_Tracer::GetCounterName(Counter counter)
+{
+  return counter < NUMCOUNTERS ? COUNTER_NAMES[counter] : NULL;
+}
+
+/** The name of the stage, such as "parsev2", for reports.
+ **/
+const char* ID3_Tracer::GetStageName(Stage stage)
+{
+  return stage < NUMSTAGES ? STAGE_NAMES[stage] : NULL;
+}
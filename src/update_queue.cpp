@@ -0,0 +1,410 @@
+// $Id$
+
+// id3lib: a C++ library for creating and manipulating id3v1/v2 tags
+// Copyright 2002 Thijmen Klok (thijmen@id3lib.org)
+
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Library General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+// License for more details.
+//
+// You should have received a copy of the GNU Library General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+// The id3lib authors encourage improvements and optimisations to be sent to
+// the id3lib coordinator.  Please see the README file for details on where to
+// send such submissions.  See the AUTHORS file for a list of people who have
+// contributed to id3lib.  See the ChangeLog file for a list of changes to
+// id3lib.  These files are distributed with id3lib at
+// http://download.sourceforge.net/id3lib/
+
+#if defined HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <list>
+#include <vector>
+#if defined HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "update_queue.h"
+
+/** \class ID3_UpdateQueue update_queue.h id3/update_queue.h
+ ** \brief Updates and strips the tags of files in the background.
+ **
+ ** ID3_Tag::Update() and ID3_Tag::Strip() wait for the file to be written,
+ ** and when a tag grows that means copying the whole file.  An
+ ** ID3_UpdateQueue writes the tags on a few threads of its own instead, so
+ ** the application can go on linking and changing the next tags meanwhile.
+ **
+ ** \code
+ **   class Report : public ID3_UpdateQueue::Callback
+ **   {
+ **   public:
+ **     void Done(ID3_Tag& tag, flags_t tags, ID3_Err err)
+ **     {
+ **       cout << tag.GetFileName() << ": " << (tags ? "updated" : "failed") << endl;
+ **       delete &tag;
+ **     }
+ **   };
+ **
+ **   Report report;
+ **   ID3_UpdateQueue queue;
+ **   for (size_t i = 0; i < numFiles; ++i)
+ **   {
+ **     ID3_Tag* tag = new ID3_Tag(files[i]);
+ **     ID3_AddArtist(tag, "Artist", true);
+ **     queue.Update(*tag, ID3TT_ID3V2, &report);
+ **   }
+ **   queue.Wait();
+ ** \endcode
+ **
+ ** A tag that has been handed to the queue belongs to it until its callback
+ ** is called: it must not be used, changed or destroyed before then, nor be
+ ** queued a second time.  Two tags linked to the same file must not be in
+ ** the queue at the same time.
+ **
+ ** The callbacks are called on the thread that uses the queue, from
+ ** Update(), Strip(), Poll() and Wait(), so they don't need to be thread
+ ** safe and may queue more tags.  Update() and Strip() wait when the number
+ ** of tags being written reaches the limit passed to the constructor, which
+ ** bounds the disk traffic and the memory held by tags waiting to be written.
+ **
+ ** Without pthreads the tags are written right away by Update() and Strip().
+ **/
+
+namespace
+{
+  struct Job
+  {
+    ID3_Tag*                   tag;
+    flags_t                    flags;
+    bool                       strip;
+    ID3_UpdateQueue::Callback* callback;
+    flags_t                    result;  // the tags written or stripped
+    ID3_Err                    error;
+  };
+
+  // runs the job, turning an exception out of the update into an error of the
+  // job, whichever thread runs it
+  void runJob(Job& job)
+  {
+    try
+    {
+      job.tag->GetLastError(); // resets the tag's last error
+      job.result = job.strip ? job.tag->Strip(job.flags) : job.tag->Update(job.flags);
+      job.error = job.tag->GetLastError();
+    }
+    catch (...)
+    {
+      job.result = ID3TT_NONE;
+      job.error = ID3E_InvalidTag;
+    }
+  }
+};
+
+class ID3_UpdateQueueImpl
+{
+public:
+  ID3_UpdateQueueImpl(size_t threads, size_t maxPending);
+  ~ID3_UpdateQueueImpl();
+
+  void   Submit(const Job&);
+  size_t Poll();
+  void   Wait();
+  size_t NumPending() const;
+
+private:
+  size_t deliver();
+#if defined HAVE_PTHREAD_H
+  void   work();
+  static void* run(void*);
+
+  std::vector<pthread_t> _threads;
+  size_t                 _max_pending;
+  mutable pthread_mutex_t _lock;      // guards everything below
+  pthread_cond_t         _submitted;  // a job was queued, or the threads must stop
+  pthread_cond_t         _finished;   // a job was written
+  std::list<Job>         _queued;     // jobs no thread has taken yet
+  size_t                 _pending;    // jobs queued or being written
+  bool                   _stop;
+#endif
+  std::list<Job>         _done;       // jobs whose callbacks haven't been called
+};
+
+#if defined HAVE_PTHREAD_H
+
+ID3_UpdateQueueImpl::ID3_UpdateQueueImpl(size_t threads, size_t maxPending)
+  : _max_pending(maxPending > 0 ? maxPending : 1),
+    _pending(0),
+    _stop(false)
+{
+  pthread_mutex_init(&_lock, NULL);
+  pthread_cond_init(&_submitted, NULL);
+  pthread_cond_init(&_finished, NULL);
+  for (size_t i = 0; i < threads; ++i)
+  {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, run, this) == 0)
+    {
+      _threads.push_back(thread);
+    }
+  }
+}
+
+ID3_UpdateQueueImpl::~ID3_UpdateQueueImpl()
+{
+  pthread_mutex_lock(&_lock);
+  while (_pending > 0)
+  {
+    pthread_cond_wait(&_finished, &_lock);
+  }
+  _stop = true;
+  pthread_cond_broadcast(&_submitted);
+  pthread_mutex_unlock(&_lock);
+  for (size_t i = 0; i < _threads.size(); ++i)
+  {
+    pthread_join(_threads[i], NULL);
+  }
+  pthread_cond_destroy(&_finished);
+  pthread_cond_destroy(&_submitted);
+  pthread_mutex_destroy(&_lock);
+}
+
+void* ID3_UpdateQueueImpl::run(void* arg)
+{
+  static_cast<ID3_UpdateQueueImpl*>(arg)->work();
+  return NULL;
+}
+
+void ID3_UpdateQueueImpl::work()
+{
+  pthread_mutex_lock(&_lock);
+  for (;;)
+  {
+    while (!_stop && _queued.empty())
+    {
+      pthread_cond_wait(&_submitted, &_lock);
+    }
+    if (_queued.empty())
+    {
+      break;
+    }
+    Job job = _queued.front();
+    _queued.pop_front();
+    pthread_mutex_unlock(&_lock);
+
+    runJob(job);
+
+    pthread_mutex_lock(&_lock);
+    _done.push_back(job);
+    --_pending;
+    pthread_cond_broadcast(&_finished);
+  }
+  pthread_mutex_unlock(&_lock);
+}
+
+void ID3_UpdateQueueImpl::Submit(const Job& job)
+{
+  if (_threads.empty())
+  {
+    Job done = job;
+    runJob(done);
+    pthread_mutex_lock(&_lock);
+    _done.push_back(done);
+    pthread_mutex_unlock(&_lock);
+    this->deliver();
+    return;
+  }
+
+  pthread_mutex_lock(&_lock);
+  while (_pending >= _max_pending)
+  {
+    pthread_cond_wait(&_finished, &_lock);
+  }
+  _queued.push_back(job);
+  ++_pending;
+  pthread_cond_signal(&_submitted);
+  pthread_mutex_unlock(&_lock);
+  this->deliver();
+}
+
+// Calls the callbacks of the jobs that are done, on the calling thread.
+size_t ID3_UpdateQueueImpl::deliver()
+{
+  size_t delivered = 0;
+  for (;;)
+  {
+    pthread_mutex_lock(&_lock);
+    if (_done.empty())
+    {
+      pthread_mutex_unlock(&_lock);
+      break;
+    }
+    Job job = _done.front();
+    _done.pop_front();
+    pthread_mutex_unlock(&_lock);
+
+    ++delivered;
+    if (job.callback)
+    {
+      job.callback->Done(*job.tag, job.result, job.error);
+    }
+  }
+  return delivered;
+}
+
+void ID3_UpdateQueueImpl::Wait()
+{
+  for (;;)
+  {
+    this->deliver();
+    pthread_mutex_lock(&_lock);
+    while (_pending > 0 && _done.empty())
+    {
+      pthread_cond_wait(&_finished, &_lock);
+    }
+    bool finished = _pending == 0 && _done.empty();
+    pthread_mutex_unlock(&_lock);
+    if (finished)
+    {
+      break;
+    }
+  }
+}
+
+size_t ID3_UpdateQueueImpl::NumPending() const
+{
+  pthread_mutex_lock(&_lock);
+  size_t pending = _pending + _done.size();
+  pthread_mutex_unlock(&_lock);
+  return pending;
+}
+
+#else /* !HAVE_PTHREAD_H */
+
+ID3_UpdateQueueImpl::ID3_UpdateQueueImpl(size_t, size_t)
+{
+}
+
+ID3_UpdateQueueImpl::~ID3_UpdateQueueImpl()
+{
+}
+
+void ID3_UpdateQueueImpl::Submit(const Job& job)
+{
+  Job done = job;
+  runJob(done);
+  _done.push_back(done);
+  this->deliver();
+}
+
+size_t ID3_UpdateQueueImpl::deliver()
+{
+  size_t delivered = 0;
+  while (!_done.empty())
+  {
+    Job job = _done.front();
+    _done.pop_front();
+    ++delivered;
+    if (job.callback)
+    {
+      job.callback->Done(*job.tag, job.result, job.error);
+    }
+  }
+  return delivered;
+}
+
+void ID3_UpdateQueueImpl::Wait()
+{
+  this->deliver();
+}
+
+size_t ID3_UpdateQueueImpl::NumPending() const
+{
+  return _done.size();
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+size_t ID3_UpdateQueueImpl::Poll()
+{
+  return this->deliver();
+}
+
+/** Creates a queue that writes the tags on the given number of threads.
+ **
+ ** @param threads The number of tags written at the same time; with 0 the
+ **                tags are written right away by Update() and Strip()
+ ** @param maxPending The number of tags that may be queued or being written
+ **                   before Update() and Strip() wait for one to be done
+ **/
+ID3_UpdateQueue::ID3_UpdateQueue(size_t threads, size_t maxPending)
+  : _impl(new ID3_UpdateQueueImpl(threads, maxPending))
+{
+}
+
+/** Waits for the tags still being written.  The callbacks of tags that
+ ** haven't been reported yet are not called; call Wait() first if they
+ ** matter.
+ **/
+ID3_UpdateQueue::~ID3_UpdateQueue()
+{
+  delete _impl;
+}
+
+/** Queues the tag to be written to its file as ID3_Tag::Update() would.
+ **
+ ** When the tag has been written, the callback (if any) is called with the
+ ** tag, the tag types written (the return value of ID3_Tag::Update()) and
+ ** the error that ID3_Tag::GetLastError() would have returned.  Waits if too
+ ** many tags are being written, and calls the callbacks of the tags that are
+ ** done before returning.
+ **
+ ** @param tag The tag to write; see the class description for its lifetime
+ ** @param flags The tag types to write
+ ** @param callback Is told when the tag is written
+ **/
+void ID3_UpdateQueue::Update(ID3_Tag& tag, flags_t flags, Callback* callback)
+{
+  Job job = { &tag, flags, false, callback, ID3TT_NONE, ID3E_NoError };
+  _impl->Submit(job);
+}
+
+/** Queues the tag to be stripped from its file as ID3_Tag::Strip() would.
+ ** The callback gets the tag types stripped; otherwise this works like
+ ** Update().
+ **/
+void ID3_UpdateQueue::Strip(ID3_Tag& tag, flags_t flags, Callback* callback)
+{
+  Job job = { &tag, flags, true, callback, ID3TT_NONE, ID3E_NoError };
+  _impl->Submit(job);
+}
+
+/** Calls the callbacks of the tags that have been written since the last
+ ** call, without waiting for the others.
+ **
+ ** @return The number of tags reported
+ **/
+size_t ID3_UpdateQueue::Poll()
+{
+  return _impl->Poll();
+}
+
+/** Waits until all queued tags are written, calling their callbacks. **/
+void ID3_UpdateQueue::Wait()
+{
+  _impl->Wait();
+}
+
+/** Returns the number of queued tags whose callbacks haven't been called. **/
+size_t ID3_UpdateQueue::NumPending() const
+{
+  return _impl->NumPending();
+}
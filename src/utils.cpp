@@ -37,6 +37,7 @@
 #endif
 
 #include "id3/utils.h" // has <config.h> "id3/id3lib_streams.h" "id3/globals.h" "id3/id3lib_strings.h"
+#include "trace_hooks.h"
 
 #if defined HAVE_ICONV_H
    // check if we have all unicodes
@@ -205,16 +206,18 @@ String dami::renderNumber(uint32 val, size_t size)
 
 namespace
 {
-  String convert_i(iconv_t cd, String source)
+  String convert_i(iconv_t cd, const String& source)
   {
     String target;
     size_t source_size = source.size();
 #if defined(ID3LIB_ICONV_OLDSTYLE)
     const char *source_str = source.data();
 #else
-    char *source_str = LEAKTESTNEW(char[source.size()+1]);
-    source.copy(source_str, String::npos);
-    source_str[source.length()] = 0;
+    // iconv() advances source_str, so keep the start of the copy around
+    char *source_buf = LEAKTESTNEW(char[source.size()+1]);
+    source.copy(source_buf, String::npos);
+    source_buf[source.length()] = 0;
+    char *source_str = source_buf;
 #endif
 
 #define ID3LIB_BUFSIZ 1024
@@ -232,17 +235,22 @@ namespace
       {
 // errno is probably EILSEQ here, which means either an invalid byte sequence or a valid but unconvertible byte sequence
 #if !defined(ID3LIB_ICONV_OLDSTYLE)
-        delete [] source_str;
+        delete [] source_buf;
 #endif
         return target;
       }
       target.append(buf, ID3LIB_BUFSIZ - target_size);
       target_str = buf;
       target_size = ID3LIB_BUFSIZ;
+      if (nconv == (size_t) -1 && errno == EINVAL)
+      {
+        // incomplete sequence at the end of the source, nothing more to do
+        break;
+      }
     }
     while (source_size > 0);
 #if !defined(ID3LIB_ICONV_OLDSTYLE)
-    delete [] source_str;
+    delete [] source_buf;
 #endif
     return target;
   }
@@ -281,6 +289,7 @@ String dami::convert(String data, ID3_TextEnc sourceEnc, ID3_TextEnc targetEnc)
   String target;
   if ((sourceEnc != targetEnc) && (data.size() > 0 ))
   {
+    trace(ID3_Tracer::CONVERSIONS);
 #if !defined HAVE_ICONV_H
 #  if defined(HAVE_MS_CONVERT)
     target = msconvert(data, sourceEnc, targetEnc);
@@ -466,16 +475,14 @@ String dami::toString(uint32 val)
   {
     return "0";
   }
-  String text;
+  char digits[16];
+  char* text = digits + sizeof(digits);
   while (val > 0)
   {
-    String tmp;
-    char ch = (val % 10) + '0';
-    tmp += ch;
-    text = tmp + text;
+    *--text = (val % 10) + '0';
     val /= 10;
   }
-  return text;
+  return String(text, digits + sizeof(digits) - text);
 }
 
 WString dami::toWString(const unicode_t buf[], size_t len)